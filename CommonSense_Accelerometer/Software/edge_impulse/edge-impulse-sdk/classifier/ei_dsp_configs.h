@@ -0,0 +1,61 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EI_CLASSIFIER_DSP_CONFIGS_H_
+#define _EI_CLASSIFIER_DSP_CONFIGS_H_
+
+#include <stdint.h>
+
+/**
+ * Configs of the DSP blocks that live in the SDK only. Studio exports
+ * model_metadata.h with the configs of its own blocks, these are kept
+ * here so a new export does not drop them.
+ */
+
+typedef struct {
+    uint16_t implementation_version;
+    int axes;
+    float scale_axes;
+    const char * frequencies;
+    bool hann_window;
+} ei_dsp_config_goertzel_t;
+
+typedef struct {
+    uint16_t implementation_version;
+    int axes;
+    float scale_axes;
+    float band_low;
+    float band_high;
+    int filter_order;
+    float envelope_max_freq;
+    int fft_length;
+} ei_dsp_config_envelope_t;
+
+typedef struct {
+    uint16_t implementation_version;
+    int axes;
+    float scale_axes;
+    const char * wavelet;
+    int depth;
+} ei_dsp_config_wavelet_packet_t;
+
+#endif // _EI_CLASSIFIER_DSP_CONFIGS_H_
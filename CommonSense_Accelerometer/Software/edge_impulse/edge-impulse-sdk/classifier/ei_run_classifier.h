@@ -39,6 +39,7 @@
 #include "ei_sampler.h"
 #endif
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "edge-impulse-sdk/dsp/ei_profiler.h"
 #include "model-parameters/dsp_blocks.h"
 
 #if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED != 1)
@@ -180,6 +181,15 @@ extern "C" void run_classifier_init(void)
     classifier_continuous_features_written = 0;
     ei_dsp_clear_continuous_audio_state();
 
+    // parse the spectral configs of this model once, up front
+    int (*spectral_fn)(signal_t*, matrix_t*, void*, const float) = &extract_spectral_analysis_features;
+    ei_dsp_clear_config_cache();
+    for (size_t ix = 0; ix < ei_dsp_blocks_size; ix++) {
+        if (ei_dsp_blocks[ix].extract_fn == spectral_fn) {
+            ei_dsp_get_spectral_config(ei_dsp_blocks[ix].config, EI_CLASSIFIER_FREQUENCY);
+        }
+    }
+
     for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
         clear_moving_average_filter(&classifier_maf[ix]);
     }
@@ -214,6 +224,7 @@ extern "C" EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal, ei_impul
     bool is_spectrogram = false;
 
     for (size_t ix = 0; ix < ei_dsp_blocks_size; ix++) {
+        EI_PROFILE_SCOPE_INDEX("dsp", ix);
         ei_model_dsp_t block = ei_dsp_blocks[ix];
 
         if (out_features_index + block.n_output_features > EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) {
@@ -738,6 +749,7 @@ static EI_IMPULSE_ERROR inference_tflite_run(uint64_t ctx_start_us,
     uint8_t* tensor_arena,
     ei_impulse_result_t *result,
     bool debug) {
+    EI_PROFILE_START(nn_prof, "nn");
 #if (EI_CLASSIFIER_COMPILED == 1)
     trained_model_invoke();
 #else
@@ -750,6 +762,7 @@ static EI_IMPULSE_ERROR inference_tflite_run(uint64_t ctx_start_us,
     }
     delete interpreter;
 #endif
+    EI_PROFILE_STOP(nn_prof);
 
     uint64_t ctx_end_us = ei_read_timer_us();
 
@@ -785,6 +798,9 @@ static EI_IMPULSE_ERROR inference_tflite_run(uint64_t ctx_start_us,
 #endif
 
 #if (EI_CLASSIFIER_COMPILED == 1)
+    if (debug) {
+        trained_model_print_nodes();
+    }
     trained_model_reset(ei_aligned_free);
 #else
     ei_aligned_free(tensor_arena);
@@ -1114,6 +1130,7 @@ extern "C" EI_IMPULSE_ERROR run_inference(
 
     // Anomaly detection
     {
+        EI_PROFILE_SCOPE("anomaly");
         uint64_t anomaly_start_us = ei_read_timer_us();
 
         float input[EI_CLASSIFIER_ANOM_AXIS_SIZE];
@@ -1217,6 +1234,7 @@ extern "C" EI_IMPULSE_ERROR run_inference_i16(
 
     // Anomaly detection
     {
+        EI_PROFILE_SCOPE("anomaly");
         uint64_t anomaly_start_us = ei_read_timer_us();
 
         float input[EI_CLASSIFIER_ANOM_AXIS_SIZE];
@@ -1292,6 +1310,7 @@ extern "C" EI_IMPULSE_ERROR run_classifier(
     size_t out_features_index = 0;
 
     for (size_t ix = 0; ix < ei_dsp_blocks_size; ix++) {
+        EI_PROFILE_SCOPE_INDEX("dsp", ix);
         ei_model_dsp_t block = ei_dsp_blocks[ix];
 
         if (out_features_index + block.n_output_features > EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) {
@@ -1362,6 +1381,7 @@ extern "C" EI_IMPULSE_ERROR run_classifier_i16(
     size_t out_features_index = 0;
 
     for (size_t ix = 0; ix < ei_dsp_blocks_size; ix++) {
+        EI_PROFILE_SCOPE_INDEX("dsp", ix);
         ei_model_dsp_i16_t block = ei_dsp_blocks_i16[ix];
 
         if (out_features_index + block.n_output_features > EI_CLASSIFIER_NN_INPUT_FRAME_SIZE) {
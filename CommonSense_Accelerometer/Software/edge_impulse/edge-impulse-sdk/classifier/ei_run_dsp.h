@@ -24,6 +24,7 @@
 #define _EDGE_IMPULSE_RUN_DSP_H_
 
 #include "model-parameters/model_metadata.h"
+#include "edge-impulse-sdk/classifier/ei_dsp_configs.h"
 #include "edge-impulse-sdk/dsp/spectral/spectral.hpp"
 #include "edge-impulse-sdk/dsp/speechpy/speechpy.hpp"
 #include "edge-impulse-sdk/classifier/ei_signal_with_range.h"
@@ -51,58 +52,144 @@ static float *ei_dsp_cont_current_frame = nullptr;
 static size_t ei_dsp_cont_current_frame_size = 0;
 static int ei_dsp_cont_current_frame_ix = 0;
 
-__attribute__((unused)) int extract_spectral_analysis_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
-    ei_dsp_config_spectral_analysis_t config = *((ei_dsp_config_spectral_analysis_t*)config_ptr);
+#ifndef EI_DSP_AUDIO_STREAM_COUNT
+#define EI_DSP_AUDIO_STREAM_COUNT           2
+#endif
 
-    int ret;
+#if !defined(__cplusplus) || EI_C_LINKAGE != 1
+/** Streaming MFE / MFCC state for continuous audio, one per DSP block config */
+typedef struct {
+    const void *config_ptr;
+    speechpy::feature_stream stream;
+} ei_dsp_audio_stream_t;
 
-    const float sampling_freq = frequency;
+static ei_dsp_audio_stream_t ei_dsp_audio_streams[EI_DSP_AUDIO_STREAM_COUNT];
 
-    // input matrix from the raw signal
-    matrix_t input_matrix(signal->total_length / config.axes, config.axes);
-    if (!input_matrix.buffer) {
-        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+/**
+ * @brief      Get the stream of a DSP block, (re)initializing a free or the
+ *             least recently added slot if the block has none yet
+ *
+ * @param[in]  config_ptr  DSP block config, used as key
+ * @param[in]  config      Stream configuration
+ * @param[out] stream      The stream
+ *
+ * @return     EIDSP_OK if OK
+ */
+static int ei_dsp_get_audio_stream(const void *config_ptr, const speechpy::feature_stream_config_t *config,
+    speechpy::feature_stream **stream)
+{
+    static size_t next_slot = 0;
+
+    for (size_t ix = 0; ix < EI_DSP_AUDIO_STREAM_COUNT; ix++) {
+        if (ei_dsp_audio_streams[ix].config_ptr == config_ptr && ei_dsp_audio_streams[ix].stream.is_initialized()) {
+            *stream = &ei_dsp_audio_streams[ix].stream;
+            return EIDSP_OK;
+        }
     }
 
-    signal->get_data(0, signal->total_length, input_matrix.buffer);
+    ei_dsp_audio_stream_t *slot = &ei_dsp_audio_streams[next_slot];
+    next_slot = (next_slot + 1) % EI_DSP_AUDIO_STREAM_COUNT;
 
-    // scale the signal
-    ret = numpy::scale(&input_matrix, config.scale_axes);
+    slot->config_ptr = NULL;
+    int ret = slot->stream.init(config);
     if (ret != EIDSP_OK) {
-        ei_printf("ERR: Failed to scale signal (%d)\n", ret);
-        EIDSP_ERR(ret);
+        return ret;
     }
+    slot->config_ptr = config_ptr;
 
-    // transpose the matrix so we have one row per axis (nifty!)
-    ret = numpy::transpose(&input_matrix);
-    if (ret != EIDSP_OK) {
-        ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
-        EIDSP_ERR(ret);
-    }
+    *stream = &slot->stream;
+    return EIDSP_OK;
+}
+#endif
 
-    // the spectral edges that we want to calculate
-    matrix_t edges_matrix_in(64, 1);
-    size_t edge_matrix_ix = 0;
+#ifndef EI_DSP_SPECTRAL_MAX_EDGES
+#define EI_DSP_SPECTRAL_MAX_EDGES           64
+#endif
 
-    char spectral_str[128] = { 0 };
-    if (strlen(config.spectral_power_edges) > sizeof(spectral_str) - 1) {
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+#ifndef EI_DSP_SPECTRAL_CONFIG_CACHE_SIZE
+#define EI_DSP_SPECTRAL_CONFIG_CACHE_SIZE   4
+#endif
+
+/**
+ * Parsed form of a spectral analysis config: edges as numbers and the filter
+ * type as enum. Keyed on the config pointer (one per DSP block); the string
+ * pointers and sampling frequency are kept to detect a different model.
+ */
+typedef struct {
+    const void *config_ptr;
+    const char *spectral_power_edges;
+    const char *filter_type_str;
+    float sampling_freq;
+    int fft_length;
+    spectral::filter_t filter_type;
+    uint32_t edges_count;
+    float edges[EI_DSP_SPECTRAL_MAX_EDGES];
+    EIDSP_i16 edges_i16[EI_DSP_SPECTRAL_MAX_EDGES];
+    /** FFT bins of every spectral power band, for sampling_freq and fft_length */
+    spectral::processing::spectral_band_t bands[EI_DSP_SPECTRAL_MAX_EDGES - 1];
+} ei_dsp_spectral_config_cache_t;
+
+static ei_dsp_spectral_config_cache_t ei_dsp_spectral_config_cache[EI_DSP_SPECTRAL_CONFIG_CACHE_SIZE];
+static size_t ei_dsp_spectral_config_cache_next = 0;
+
+/**
+ * Drop all parsed spectral configs, call when a different model is loaded
+ */
+__attribute__((unused)) void ei_dsp_clear_config_cache(void) {
+    memset(ei_dsp_spectral_config_cache, 0, sizeof(ei_dsp_spectral_config_cache));
+    ei_dsp_spectral_config_cache_next = 0;
+}
+
+/**
+ * Parse a spectral analysis config, or return the entry parsed earlier for this block.
+ * run_classifier_init() parses the blocks of the model up front, without it the
+ * first run_classifier() call parses them.
+ * @param config_ptr Pointer to the ei_dsp_config_spectral_analysis_t of the DSP block
+ * @param sampling_freq Sampling frequency, used to normalize the int16 edges
+ * @returns Parsed config or NULL if the config is invalid
+ */
+__attribute__((unused)) const ei_dsp_spectral_config_cache_t *ei_dsp_get_spectral_config(const void *config_ptr, const float sampling_freq) {
+    const ei_dsp_config_spectral_analysis_t *config = (const ei_dsp_config_spectral_analysis_t*)config_ptr;
+
+    for (size_t ix = 0; ix < EI_DSP_SPECTRAL_CONFIG_CACHE_SIZE; ix++) {
+        ei_dsp_spectral_config_cache_t *entry = &ei_dsp_spectral_config_cache[ix];
+        if (entry->config_ptr == config_ptr &&
+            entry->spectral_power_edges == config->spectral_power_edges &&
+            entry->filter_type_str == config->filter_type &&
+            entry->sampling_freq == sampling_freq &&
+            entry->fft_length == config->fft_length) {
+            return entry;
+        }
     }
-    memcpy(spectral_str, config.spectral_power_edges, strlen(config.spectral_power_edges));
+
+    // not cached yet (or stale), parse into the next slot
+    ei_dsp_spectral_config_cache_t *entry = &ei_dsp_spectral_config_cache[ei_dsp_spectral_config_cache_next];
+    ei_dsp_spectral_config_cache_next = (ei_dsp_spectral_config_cache_next + 1) % EI_DSP_SPECTRAL_CONFIG_CACHE_SIZE;
+    entry->config_ptr = NULL;
 
     // convert spectral_power_edges (string) into float array
-    char *spectral_ptr = spectral_str;
+    size_t edge_matrix_ix = 0;
+    const char *spectral_ptr = config->spectral_power_edges;
     while (spectral_ptr != NULL) {
         while((*spectral_ptr) == ' ') {
             spectral_ptr++;
         }
 
-        edges_matrix_in.buffer[edge_matrix_ix++] = atof(spectral_ptr);
+        if (edge_matrix_ix >= EI_DSP_SPECTRAL_MAX_EDGES) {
+            return NULL;
+        }
+
+        float edge = atof(spectral_ptr);
+        entry->edges[edge_matrix_ix] = edge;
+
+        edge = edge / (float)(sampling_freq / 2.f);
+        numpy::float_to_int16(&edge, &entry->edges_i16[edge_matrix_ix], 1);
+        edge_matrix_ix++;
 
         // find next (spectral) delimiter (or '\0' character)
         while((*spectral_ptr != ',')) {
-            spectral_ptr++;
             if (*spectral_ptr == '\0') break;
+            spectral_ptr++;
         }
 
         if (*spectral_ptr == '\0') {
@@ -112,7 +199,68 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_t *signal,
             spectral_ptr++;
         }
     }
-    edges_matrix_in.rows = edge_matrix_ix;
+    entry->edges_count = edge_matrix_ix;
+
+    if (spectral::processing::spectral_power_bands_init(sampling_freq, config->fft_length,
+            entry->edges, entry->edges_count, entry->bands) != EIDSP_OK) {
+        return NULL;
+    }
+
+    if (strcmp(config->filter_type, "low") == 0) {
+        entry->filter_type = spectral::filter_lowpass;
+    }
+    else if (strcmp(config->filter_type, "high") == 0) {
+        entry->filter_type = spectral::filter_highpass;
+    }
+    else {
+        entry->filter_type = spectral::filter_none;
+    }
+
+    entry->spectral_power_edges = config->spectral_power_edges;
+    entry->filter_type_str = config->filter_type;
+    entry->sampling_freq = sampling_freq;
+    entry->fft_length = config->fft_length;
+    entry->config_ptr = config_ptr;
+
+    return entry;
+}
+
+__attribute__((unused)) int extract_spectral_analysis_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
+    ei_dsp_config_spectral_analysis_t config = *((ei_dsp_config_spectral_analysis_t*)config_ptr);
+
+    int ret;
+
+    const float sampling_freq = frequency;
+
+    const ei_dsp_spectral_config_cache_t *parsed = ei_dsp_get_spectral_config(config_ptr, sampling_freq);
+    if (!parsed) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    // input matrix from the raw signal
+    matrix_t input_matrix(signal->total_length / config.axes, config.axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, input_matrix.buffer);
+
+    // scale the signal
+    ret = numpy::scale(&input_matrix, config.scale_axes);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to scale signal (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // transpose the matrix so we have one row per axis (nifty!)
+    ret = numpy::transpose(&input_matrix);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // the spectral edges that we want to calculate (read-only view on the cache)
+    matrix_t edges_matrix_in(parsed->edges_count, 1, const_cast<float*>(parsed->edges));
 
     // calculate how much room we need for the output matrix
     size_t output_matrix_cols = spectral::feature::calculate_spectral_buffer_size(
@@ -126,20 +274,10 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_t *signal,
     output_matrix->cols = output_matrix_cols;
     output_matrix->rows = config.axes;
 
-    spectral::filter_t filter_type;
-    if (strcmp(config.filter_type, "low") == 0) {
-        filter_type = spectral::filter_lowpass;
-    }
-    else if (strcmp(config.filter_type, "high") == 0) {
-        filter_type = spectral::filter_highpass;
-    }
-    else {
-        filter_type = spectral::filter_none;
-    }
-
     ret = spectral::feature::spectral_analysis(output_matrix, &input_matrix,
-        sampling_freq, filter_type, config.filter_cutoff, config.filter_order,
-        config.fft_length, config.spectral_peaks_count, config.spectral_peaks_threshold, &edges_matrix_in);
+        sampling_freq, parsed->filter_type, config.filter_cutoff, config.filter_order,
+        config.fft_length, config.spectral_peaks_count, config.spectral_peaks_threshold, &edges_matrix_in,
+        parsed->bands);
     if (ret != EIDSP_OK) {
         ei_printf("ERR: Failed to calculate spectral features (%d)\n", ret);
         EIDSP_ERR(ret);
@@ -152,51 +290,6 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_t *signal,
     return EIDSP_OK;
 }
 
-matrix_i16_t *create_edges_matrix(ei_dsp_config_spectral_analysis_t config, const float sampling_freq)
-{
-    // the spectral edges that we want to calculate
-    static matrix_i16_t edges_matrix_in(64, 1);
-    static bool matrix_created = false;
-    size_t edge_matrix_ix = 0;
-
-    if(matrix_created == false) {
-
-        char spectral_str[128] = { 0 };
-        if (strlen(config.spectral_power_edges) > sizeof(spectral_str) - 1) {
-            return NULL;
-        }
-        memcpy(spectral_str, config.spectral_power_edges, strlen(config.spectral_power_edges));
-
-        // convert spectral_power_edges (string) into float array
-        char *spectral_ptr = spectral_str;
-        while (spectral_ptr != NULL) {
-            while((*spectral_ptr) == ' ') {
-                spectral_ptr++;
-            }
-
-            float edge = (atof(spectral_ptr) / (float)(sampling_freq/2.f));
-            numpy::float_to_int16(&edge, &edges_matrix_in.buffer[edge_matrix_ix++], 1);
-
-            // find next (spectral) delimiter (or '\0' character)
-            while((*spectral_ptr != ',')) {
-                spectral_ptr++;
-                if (*spectral_ptr == '\0') break;
-            }
-
-            if (*spectral_ptr == '\0') {
-                spectral_ptr = NULL;
-            }
-            else  {
-                spectral_ptr++;
-            }
-        }
-        edges_matrix_in.rows = edge_matrix_ix;
-        matrix_created = true;
-    }
-
-    return &edges_matrix_in;
-}
-
 __attribute__((unused)) int extract_spectral_analysis_features(signal_i16_t *signal, matrix_i32_t *output_matrix, void *config_ptr, const float frequency) {
     ei_dsp_config_spectral_analysis_t config = *((ei_dsp_config_spectral_analysis_t*)config_ptr);
 
@@ -226,15 +319,17 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_i16_t *sig
         EIDSP_ERR(ret);
     }
 
-    matrix_i16_t *edges_matrix_in = create_edges_matrix(config, sampling_freq);
-
-    if(edges_matrix_in == NULL) {
+    const ei_dsp_spectral_config_cache_t *parsed = ei_dsp_get_spectral_config(config_ptr, sampling_freq);
+    if (!parsed) {
         EIDSP_ERR(EIDSP_PARAMETER_INVALID);
     }
 
+    // the spectral edges that we want to calculate (read-only view on the cache)
+    matrix_i16_t edges_matrix_in(parsed->edges_count, 1, const_cast<EIDSP_i16*>(parsed->edges_i16));
+
     // calculate how much room we need for the output matrix
     size_t output_matrix_cols = spectral::feature::calculate_spectral_buffer_size(
-        true, config.spectral_peaks_count, edges_matrix_in->rows
+        true, config.spectral_peaks_count, edges_matrix_in.rows
     );
     // ei_printf("output_matrix_size %hux%zu\n", input_matrix.rows, output_matrix_cols);
     if (output_matrix->cols * output_matrix->rows != static_cast<uint32_t>(output_matrix_cols * config.axes)) {
@@ -244,22 +339,197 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_i16_t *sig
     output_matrix->cols = output_matrix_cols;
     output_matrix->rows = config.axes;
 
-    spectral::filter_t filter_type;
-    if (strcmp(config.filter_type, "low") == 0) {
-        filter_type = spectral::filter_lowpass;
+    ret = spectral::feature::spectral_analysis(output_matrix, &input_matrix,
+        sampling_freq, parsed->filter_type, config.filter_cutoff, config.filter_order,
+        config.fft_length, config.spectral_peaks_count, config.spectral_peaks_threshold, &edges_matrix_in);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to calculate spectral features (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // flatten again
+    output_matrix->cols = config.axes * output_matrix_cols;
+    output_matrix->rows = 1;
+
+    return EIDSP_OK;
+}
+
+/**
+ * Envelope spectrum of every axis, see spectral::feature::envelope_analysis
+ */
+__attribute__((unused)) int extract_envelope_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
+    ei_dsp_config_envelope_t config = *((ei_dsp_config_envelope_t*)config_ptr);
+
+    int ret;
+
+    // input matrix from the raw signal
+    matrix_t input_matrix(signal->total_length / config.axes, config.axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, input_matrix.buffer);
+
+    // scale the signal
+    ret = numpy::scale(&input_matrix, config.scale_axes);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to scale signal (%d)\n", ret);
+        EIDSP_ERR(ret);
     }
-    else if (strcmp(config.filter_type, "high") == 0) {
-        filter_type = spectral::filter_highpass;
+
+    // transpose the matrix so we have one row per axis
+    ret = numpy::transpose(&input_matrix);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    size_t output_matrix_cols = spectral::feature::calculate_envelope_buffer_size(config.fft_length);
+    if (output_matrix->cols * output_matrix->rows != static_cast<uint32_t>(output_matrix_cols * config.axes)) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    output_matrix->cols = output_matrix_cols;
+    output_matrix->rows = config.axes;
+
+    ret = spectral::feature::envelope_analysis(output_matrix, &input_matrix,
+        frequency, config.band_low, config.band_high, config.filter_order,
+        config.envelope_max_freq, config.fft_length, NULL);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to calculate envelope features (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // flatten again
+    output_matrix->cols = config.axes * output_matrix_cols;
+    output_matrix->rows = 1;
+
+    return EIDSP_OK;
+}
+
+#ifndef EI_DSP_WAVELET_PACKET_MAX_DEPTH
+#define EI_DSP_WAVELET_PACKET_MAX_DEPTH     8
+#endif
+
+static int ei_dsp_parse_wavelet_packet_config(const ei_dsp_config_wavelet_packet_t *config, spectral::wavelet_t *type) {
+    if (config->depth < 1 || config->depth > EI_DSP_WAVELET_PACKET_MAX_DEPTH) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    if (strcmp(config->wavelet, "haar") == 0) {
+        *type = spectral::wavelet_haar;
+    }
+    else if (strcmp(config->wavelet, "db2") == 0) {
+        *type = spectral::wavelet_db2;
+    }
+    else if (strcmp(config->wavelet, "cdf53") == 0) {
+        *type = spectral::wavelet_cdf53;
     }
     else {
-        filter_type = spectral::filter_none;
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
     }
 
-    ret = spectral::feature::spectral_analysis(output_matrix, &input_matrix,
-        sampling_freq, filter_type, config.filter_cutoff, config.filter_order,
-        config.fft_length, config.spectral_peaks_count, config.spectral_peaks_threshold, edges_matrix_in);
+    return EIDSP_OK;
+}
+
+/**
+ * Wavelet packet energies and entropies of every axis, see
+ * spectral::feature::wavelet_packet_analysis
+ */
+__attribute__((unused)) int extract_wavelet_packet_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
+    ei_dsp_config_wavelet_packet_t config = *((ei_dsp_config_wavelet_packet_t*)config_ptr);
+
+    spectral::wavelet_t type;
+    int ret = ei_dsp_parse_wavelet_packet_config(&config, &type);
     if (ret != EIDSP_OK) {
-        ei_printf("ERR: Failed to calculate spectral features (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // input matrix from the raw signal
+    matrix_t input_matrix(signal->total_length / config.axes, config.axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, input_matrix.buffer);
+
+    // scale the signal
+    ret = numpy::scale(&input_matrix, config.scale_axes);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to scale signal (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // transpose the matrix so we have one row per axis
+    ret = numpy::transpose(&input_matrix);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    size_t output_matrix_cols = spectral::feature::calculate_wavelet_packet_buffer_size(config.depth);
+    if (output_matrix->cols * output_matrix->rows != static_cast<uint32_t>(output_matrix_cols * config.axes)) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    output_matrix->cols = output_matrix_cols;
+    output_matrix->rows = config.axes;
+
+    ret = spectral::feature::wavelet_packet_analysis(output_matrix, &input_matrix, type, config.depth);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to calculate wavelet packet features (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // flatten again
+    output_matrix->cols = config.axes * output_matrix_cols;
+    output_matrix->rows = 1;
+
+    return EIDSP_OK;
+}
+
+__attribute__((unused)) int extract_wavelet_packet_features(signal_i16_t *signal, matrix_i32_t *output_matrix, void *config_ptr, const float frequency) {
+    ei_dsp_config_wavelet_packet_t config = *((ei_dsp_config_wavelet_packet_t*)config_ptr);
+
+    spectral::wavelet_t type;
+    int ret = ei_dsp_parse_wavelet_packet_config(&config, &type);
+    if (ret != EIDSP_OK) {
+        EIDSP_ERR(ret);
+    }
+
+    // input matrix from the raw signal
+    matrix_i16_t input_matrix(signal->total_length / config.axes, config.axes);
+    if (!input_matrix.buffer) {
+        EIDSP_ERR(EIDSP_OUT_OF_MEM);
+    }
+
+    signal->get_data(0, signal->total_length, (EIDSP_i16 *)&input_matrix.buffer[0]);
+
+    // scale the signal
+    ret = numpy::scale(&input_matrix, config.scale_axes);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to scale signal (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    // transpose the matrix so we have one row per axis
+    ret = numpy::transpose(&input_matrix);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to transpose matrix (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    size_t output_matrix_cols = spectral::feature::calculate_wavelet_packet_buffer_size(config.depth);
+    if (output_matrix->cols * output_matrix->rows != static_cast<uint32_t>(output_matrix_cols * config.axes)) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    output_matrix->cols = output_matrix_cols;
+    output_matrix->rows = config.axes;
+
+    ret = spectral::feature::wavelet_packet_analysis(output_matrix, &input_matrix, type, config.depth);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to calculate wavelet packet features (%d)\n", ret);
         EIDSP_ERR(ret);
     }
 
@@ -270,6 +540,81 @@ __attribute__((unused)) int extract_spectral_analysis_features(signal_i16_t *sig
     return EIDSP_OK;
 }
 
+#ifndef EI_DSP_GOERTZEL_MAX_FREQUENCIES
+#define EI_DSP_GOERTZEL_MAX_FREQUENCIES     16
+#endif
+
+/** Values read from the signal at once by the Goertzel block */
+#define EI_DSP_GOERTZEL_CHUNK_SIZE          96
+
+/**
+ * Goertzel filter bank: the amplitude of every axis at a few configured
+ * frequencies (comma separated, in Hz), e.g. bearing fault frequencies.
+ * The signal is streamed through the filters in small chunks, so no input
+ * matrix or FFT buffers are allocated. Output is axis major.
+ */
+__attribute__((unused)) int extract_goertzel_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
+    ei_dsp_config_goertzel_t config = *((ei_dsp_config_goertzel_t*)config_ptr);
+
+    int ret;
+
+    if (config.axes <= 0 || config.axes > EI_DSP_GOERTZEL_CHUNK_SIZE) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    // convert frequencies (string) into float array
+    float frequencies[EI_DSP_GOERTZEL_MAX_FREQUENCIES];
+    size_t frequency_count = 0;
+    const char *frequency_ptr = config.frequencies;
+    while (frequency_ptr != NULL && *frequency_ptr != '\0') {
+        if (frequency_count >= EI_DSP_GOERTZEL_MAX_FREQUENCIES) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        frequencies[frequency_count++] = atof(frequency_ptr);
+
+        frequency_ptr = strchr(frequency_ptr, ',');
+        if (frequency_ptr != NULL) {
+            frequency_ptr++;
+        }
+    }
+
+    if (frequency_count == 0) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
+
+    if (output_matrix->rows * output_matrix->cols != frequency_count * config.axes) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+    }
+
+    size_t frames = signal->total_length / config.axes;
+
+    spectral::goertzel_bank bank;
+    ret = bank.init(frequencies, frequency_count, config.axes, frequency, frames, config.hann_window);
+    if (ret != EIDSP_OK) {
+        ei_printf("ERR: Failed to initialize Goertzel filters (%d)\n", ret);
+        EIDSP_ERR(ret);
+    }
+
+    float chunk[EI_DSP_GOERTZEL_CHUNK_SIZE];
+    size_t chunk_frames = EI_DSP_GOERTZEL_CHUNK_SIZE / config.axes;
+
+    for (size_t frame = 0; frame < frames; frame += chunk_frames) {
+        size_t count = frames - frame < chunk_frames ? frames - frame : chunk_frames;
+
+        ret = signal->get_data(frame * config.axes, count * config.axes, chunk);
+        if (ret != 0) {
+            EIDSP_ERR(ret);
+        }
+
+        for (size_t ix = 0; ix < count; ix++) {
+            bank.push_frame(chunk + (ix * config.axes), config.scale_axes);
+        }
+    }
+
+    return bank.magnitudes(output_matrix);
+}
+
 __attribute__((unused)) int extract_raw_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float frequency) {
     ei_dsp_config_raw_t config = *((ei_dsp_config_raw_t*)config_ptr);
 
@@ -459,210 +804,54 @@ __attribute__((unused)) int extract_mfcc_features(signal_t *signal, matrix_t *ou
 }
 
 
-static int extract_mfcc_run_slice(signal_t *signal, matrix_t *output_matrix, ei_dsp_config_mfcc_t *config, const float sampling_frequency, matrix_size_t *matrix_size_out, int implementation_version) {
-    uint32_t frequency = (uint32_t)sampling_frequency;
-
-    int x;
-
-    // calculate the size of the spectrogram matrix
-    matrix_size_t out_matrix_size =
-        speechpy::feature::calculate_mfcc_buffer_size(
-            signal->total_length, frequency, config->frame_length, config->frame_stride, config->num_cepstral,
-            implementation_version);
-
-    // we roll the output matrix back so we have room at the end...
-    x = numpy::roll(output_matrix->buffer, output_matrix->rows * output_matrix->cols,
-        -(out_matrix_size.rows * out_matrix_size.cols));
-    if (x != EIDSP_OK) {
-        EIDSP_ERR(x);
-    }
-
-    // slice in the output matrix to write to
-    // the offset in the classification matrix here is always at the end
-    size_t output_matrix_offset = (output_matrix->rows * output_matrix->cols) -
-        (out_matrix_size.rows * out_matrix_size.cols);
-
-    matrix_t output_matrix_slice(out_matrix_size.rows, out_matrix_size.cols, output_matrix->buffer + output_matrix_offset);
-
-    // and run the MFCC extraction
-    x = speechpy::feature::mfcc(&output_matrix_slice, signal,
-        frequency, config->frame_length, config->frame_stride, config->num_cepstral, config->num_filters, config->fft_length,
-        config->low_frequency, config->high_frequency, true, implementation_version);
-    if (x != EIDSP_OK) {
-        ei_printf("ERR: MFCC failed (%d)\n", x);
-        EIDSP_ERR(x);
-    }
-
-    matrix_size_out->rows += out_matrix_size.rows;
-    if (out_matrix_size.cols > 0) {
-        matrix_size_out->cols = out_matrix_size.cols;
-    }
-
-    return EIDSP_OK;
-}
-
 __attribute__((unused)) int extract_mfcc_per_slice_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float sampling_frequency, matrix_size_t *matrix_size_out) {
 #if defined(__cplusplus) && EI_C_LINKAGE == 1
     ei_printf("ERR: Continuous audio is not supported when EI_C_LINKAGE is defined\n");
     EIDSP_ERR(EIDSP_NOT_SUPPORTED);
-#else
-
-    ei_dsp_config_mfcc_t config = *((ei_dsp_config_mfcc_t*)config_ptr);
-
-    if (config.axes != 1) {
-        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
-    }
-
-    if(config.implementation_version != 1 && config.implementation_version != 2) {
-        EIDSP_ERR(EIDSP_BLOCK_VERSION_INCORRECT);
-    }
-
-    if (signal->total_length == 0) {
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    const uint32_t frequency = static_cast<uint32_t>(sampling_frequency);
-
-    // preemphasis class to preprocess the audio...
-    class speechpy::processing::preemphasis pre(signal, config.pre_shift, config.pre_cof, false);
-    preemphasis = &pre;
-
-    signal_t preemphasized_audio_signal;
-    preemphasized_audio_signal.total_length = signal->total_length;
-    preemphasized_audio_signal.get_data = &preemphasized_audio_signal_get_data;
-
-    // Go from the time (e.g. 0.25 seconds to number of frames based on freq)
-    const size_t frame_length_values = frequency * config.frame_length;
-    const size_t frame_stride_values = frequency * config.frame_stride;
-    const int frame_overlap_values = static_cast<int>(frame_length_values) - static_cast<int>(frame_stride_values);
-
-    if (frame_overlap_values < 0) {
-        ei_printf("ERR: frame_length (%f) cannot be lower than frame_stride (%f) for continuous classification\n",
-            config.frame_length, config.frame_stride);
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    int x;
-
-    // have current frame, but wrong size? then free
-    if (ei_dsp_cont_current_frame && ei_dsp_cont_current_frame_size != frame_length_values) {
-        ei_free(ei_dsp_cont_current_frame);
-        ei_dsp_cont_current_frame = nullptr;
-    }
-
-    int implementation_version = config.implementation_version;
-
-    // this is the offset in the signal from which we'll work
-    size_t offset_in_signal = 0;
-
-    if (!ei_dsp_cont_current_frame) {
-        ei_dsp_cont_current_frame = (float*)ei_calloc(frame_length_values * sizeof(float), 1);
-        if (!ei_dsp_cont_current_frame) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
-        }
-        ei_dsp_cont_current_frame_size = frame_length_values;
-        ei_dsp_cont_current_frame_ix = 0;
-    }
-
-
-    if ((frame_length_values) > preemphasized_audio_signal.total_length  + ei_dsp_cont_current_frame_ix) {
-        ei_printf("ERR: frame_length (%d) cannot be larger than signal's total length (%d) for continuous classification\n",
-            (int)frame_length_values, (int)preemphasized_audio_signal.total_length  + ei_dsp_cont_current_frame_ix);
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    matrix_size_out->rows = 0;
-    matrix_size_out->cols = 0;
-
-    // for continuous use v2 stack frame calculations
-    if (implementation_version == 1) {
-        implementation_version = 2;
-    }
-
-    if (ei_dsp_cont_current_frame_ix > (int)ei_dsp_cont_current_frame_size) {
-        ei_printf("ERR: ei_dsp_cont_current_frame_ix is larger than frame size (ix=%d size=%d)\n",
-            ei_dsp_cont_current_frame_ix, (int)ei_dsp_cont_current_frame_size);
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    // if we still have some code from previous run
-    while (ei_dsp_cont_current_frame_ix > 0) {
-        // then from the current frame we need to read `frame_length_values - ei_dsp_cont_current_frame_ix`
-        // starting at offset 0
-        x = preemphasized_audio_signal.get_data(0, frame_length_values - ei_dsp_cont_current_frame_ix, ei_dsp_cont_current_frame + ei_dsp_cont_current_frame_ix);
-        if (x != EIDSP_OK) {
-            EIDSP_ERR(x);
-        }
-
-        // now ei_dsp_cont_current_frame is complete
-        signal_t frame_signal;
-        x = numpy::signal_from_buffer(ei_dsp_cont_current_frame, frame_length_values, &frame_signal);
-        if (x != EIDSP_OK) {
-            EIDSP_ERR(x);
-        }
-
-        x = extract_mfcc_run_slice(&frame_signal, output_matrix, &config, sampling_frequency, matrix_size_out, implementation_version);
-        if (x != EIDSP_OK) {
-            EIDSP_ERR(x);
-        }
-
-        // if there's overlap between frames we roll through
-        if (frame_stride_values > 0) {
-            numpy::roll(ei_dsp_cont_current_frame, frame_length_values, -frame_stride_values);
-        }
+#else
 
-        ei_dsp_cont_current_frame_ix -= frame_stride_values;
-    }
+    ei_dsp_config_mfcc_t config = *((ei_dsp_config_mfcc_t*)config_ptr);
 
-    if (ei_dsp_cont_current_frame_ix < 0) {
-        offset_in_signal = -ei_dsp_cont_current_frame_ix;
-        ei_dsp_cont_current_frame_ix = 0;
+    if (config.axes != 1) {
+        EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
     }
 
-    if (offset_in_signal >= signal->total_length) {
-        offset_in_signal -= signal->total_length;
-        return EIDSP_OK;
+    if(config.implementation_version != 1 && config.implementation_version != 2) {
+        EIDSP_ERR(EIDSP_BLOCK_VERSION_INCORRECT);
     }
 
-    // now... we need to discard part of the signal...
-    SignalWithRange signal_with_range(&preemphasized_audio_signal, offset_in_signal, signal->total_length);
+    if (signal->total_length == 0) {
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
 
-    signal_t *range_signal = signal_with_range.get_signal();
-    size_t range_signal_orig_length = range_signal->total_length;
+    if (config.frame_length < config.frame_stride) {
+        ei_printf("ERR: frame_length (%f) cannot be lower than frame_stride (%f) for continuous classification\n",
+            config.frame_length, config.frame_stride);
+        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+    }
 
-    // then we'll just go through normal processing of the signal:
-    x = extract_mfcc_run_slice(range_signal, output_matrix, &config, sampling_frequency, matrix_size_out, implementation_version);
+    // for continuous use v2 stack frame calculations
+    speechpy::feature_stream_config_t stream_config = {
+        static_cast<uint32_t>(sampling_frequency), config.frame_length, config.frame_stride,
+        static_cast<uint16_t>(config.num_filters), static_cast<uint16_t>(config.fft_length),
+        static_cast<uint32_t>(config.low_frequency), static_cast<uint32_t>(config.high_frequency),
+        static_cast<uint8_t>(config.num_cepstral), true, config.pre_shift, config.pre_cof, false, 2
+    };
+
+    speechpy::feature_stream *stream;
+    int x = ei_dsp_get_audio_stream(config_ptr, &stream_config, &stream);
     if (x != EIDSP_OK) {
+        ei_printf("ERR: MFCC stream init failed (%d)\n", x);
         EIDSP_ERR(x);
     }
 
-    // Make sure v1 model are reset to the original length;
-    range_signal->total_length = range_signal_orig_length;
-
-    // update offset
-    int length_of_signal_used = speechpy::processing::calculate_signal_used(range_signal->total_length, sampling_frequency,
-        config.frame_length, config.frame_stride, false, implementation_version);
-    offset_in_signal += length_of_signal_used;
-
-    // see what's left?
-    int bytes_left_end_of_frame = signal->total_length - offset_in_signal;
-    bytes_left_end_of_frame += frame_overlap_values;
-
-    if (bytes_left_end_of_frame > 0) {
-        // then read that into the ei_dsp_cont_current_frame buffer
-        x = preemphasized_audio_signal.get_data(
-            (preemphasized_audio_signal.total_length - bytes_left_end_of_frame),
-            bytes_left_end_of_frame,
-            ei_dsp_cont_current_frame);
-        if (x != EIDSP_OK) {
-            EIDSP_ERR(x);
-        }
+    // only the frames completed by this slice are computed and appended
+    x = stream->process(signal, output_matrix, matrix_size_out);
+    if (x != EIDSP_OK) {
+        ei_printf("ERR: MFCC failed (%d)\n", x);
+        EIDSP_ERR(x);
     }
 
-    ei_dsp_cont_current_frame_ix = bytes_left_end_of_frame;
-
-    preemphasis = nullptr;
-
     return EIDSP_OK;
 #endif
 }
@@ -1031,54 +1220,6 @@ __attribute__((unused)) int extract_mfe_features(signal_t *signal, matrix_t *out
     return EIDSP_OK;
 }
 
-static int extract_mfe_run_slice(signal_t *signal, matrix_t *output_matrix, ei_dsp_config_mfe_t *config, const float sampling_frequency, matrix_size_t *matrix_size_out) {
-    uint32_t frequency = (uint32_t)sampling_frequency;
-
-    int x;
-
-    // calculate the size of the spectrogram matrix
-    matrix_size_t out_matrix_size =
-        speechpy::feature::calculate_mfe_buffer_size(
-            signal->total_length, frequency, config->frame_length, config->frame_stride, config->num_filters,
-            config->implementation_version);
-
-    // we roll the output matrix back so we have room at the end...
-    x = numpy::roll(output_matrix->buffer, output_matrix->rows * output_matrix->cols,
-        -(out_matrix_size.rows * out_matrix_size.cols));
-    if (x != EIDSP_OK) {
-        EIDSP_ERR(x);
-    }
-
-    // slice in the output matrix to write to
-    // the offset in the classification matrix here is always at the end
-    size_t output_matrix_offset = (output_matrix->rows * output_matrix->cols) -
-        (out_matrix_size.rows * out_matrix_size.cols);
-
-    matrix_t output_matrix_slice(out_matrix_size.rows, out_matrix_size.cols, output_matrix->buffer + output_matrix_offset);
-
-    // energy matrix
-    EI_DSP_MATRIX(energy_matrix, out_matrix_size.rows, 1);
-    if (!energy_matrix.buffer) {
-        EIDSP_ERR(EIDSP_OUT_OF_MEM);
-    }
-
-    // and run the MFE extraction
-    x = speechpy::feature::mfe(&output_matrix_slice, &energy_matrix, signal,
-        frequency, config->frame_length, config->frame_stride, config->num_filters, config->fft_length,
-        config->low_frequency, config->high_frequency, config->implementation_version);
-    if (x != EIDSP_OK) {
-        ei_printf("ERR: MFE failed (%d)\n", x);
-        EIDSP_ERR(x);
-    }
-
-    matrix_size_out->rows += out_matrix_size.rows;
-    if (out_matrix_size.cols > 0) {
-        matrix_size_out->cols = out_matrix_size.cols;
-    }
-
-    return EIDSP_OK;
-}
-
 __attribute__((unused)) int extract_mfe_per_slice_features(signal_t *signal, matrix_t *output_matrix, void *config_ptr, const float sampling_frequency, matrix_size_t *matrix_size_out) {
 #if defined(__cplusplus) && EI_C_LINKAGE == 1
     ei_printf("ERR: Continuous audio is not supported when EI_C_LINKAGE is defined\n");
@@ -1087,11 +1228,6 @@ __attribute__((unused)) int extract_mfe_per_slice_features(signal_t *signal, mat
 
     ei_dsp_config_mfe_t config = *((ei_dsp_config_mfe_t*)config_ptr);
 
-    // signal is already the right size,
-    // output matrix is not the right size, but we can start writing at offset 0 and then it's OK too
-
-    static bool first_run = false;
-
     if (config.axes != 1) {
         EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
     }
@@ -1100,196 +1236,38 @@ __attribute__((unused)) int extract_mfe_per_slice_features(signal_t *signal, mat
         EIDSP_ERR(EIDSP_PARAMETER_INVALID);
     }
 
-    const uint32_t frequency = static_cast<uint32_t>(sampling_frequency);
-
-    // Fake an extra frame_length for stack frames calculations. There, 1 frame_length is always
-    // subtracted and there for never used. But skip the first slice to fit the feature_matrix
-    // buffer
-    if (config.implementation_version == 1) {
-        if (first_run == true) {
-            signal->total_length += (size_t)(config.frame_length * (float)frequency);
-        }
-
-        first_run = true;
-    }
-
-    // ok all setup, let's construct the signal (with preemphasis for impl version >3)
-    signal_t preemphasized_audio_signal;
-
-   // before version 3 we did not have preemphasis
-    if (config.implementation_version < 3) {
-        preemphasis = nullptr;
-        preemphasized_audio_signal.total_length = signal->total_length;
-        preemphasized_audio_signal.get_data = signal->get_data;
-    }
-    else {
-        // preemphasis class to preprocess the audio...
-        class speechpy::processing::preemphasis *pre = new class speechpy::processing::preemphasis(signal, 1, 0.98f, true);
-        preemphasis = pre;
-        preemphasized_audio_signal.total_length = signal->total_length;
-        preemphasized_audio_signal.get_data = &preemphasized_audio_signal_get_data;
-    }
-
-    // Go from the time (e.g. 0.25 seconds to number of frames based on freq)
-    const size_t frame_length_values = frequency * config.frame_length;
-    const size_t frame_stride_values = frequency * config.frame_stride;
-    const int frame_overlap_values = static_cast<int>(frame_length_values) - static_cast<int>(frame_stride_values);
-
-    if (frame_overlap_values < 0) {
+    if (config.frame_length < config.frame_stride) {
         ei_printf("ERR: frame_length (%f) cannot be lower than frame_stride (%f) for continuous classification\n",
             config.frame_length, config.frame_stride);
-        if (preemphasis) {
-            delete preemphasis;
-        }
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    if (frame_length_values > preemphasized_audio_signal.total_length) {
-        ei_printf("ERR: frame_length (%d) cannot be larger than signal's total length (%d) for continuous classification\n",
-            (int)frame_length_values, (int)preemphasized_audio_signal.total_length);
-        if (preemphasis) {
-            delete preemphasis;
-        }
-        EIDSP_ERR(EIDSP_PARAMETER_INVALID);
-    }
-
-    int x;
-
-    // have current frame, but wrong size? then free
-    if (ei_dsp_cont_current_frame && ei_dsp_cont_current_frame_size != frame_length_values) {
-        ei_free(ei_dsp_cont_current_frame);
-        ei_dsp_cont_current_frame = nullptr;
-    }
-
-    if (!ei_dsp_cont_current_frame) {
-        ei_dsp_cont_current_frame = (float*)ei_calloc(frame_length_values * sizeof(float), 1);
-        if (!ei_dsp_cont_current_frame) {
-            if (preemphasis) {
-                delete preemphasis;
-            }
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
-        }
-        ei_dsp_cont_current_frame_size = frame_length_values;
-        ei_dsp_cont_current_frame_ix = 0;
-    }
-
-    matrix_size_out->rows = 0;
-    matrix_size_out->cols = 0;
-
-    // this is the offset in the signal from which we'll work
-    size_t offset_in_signal = 0;
-
-    if (ei_dsp_cont_current_frame_ix > (int)ei_dsp_cont_current_frame_size) {
-        ei_printf("ERR: ei_dsp_cont_current_frame_ix is larger than frame size\n");
-        if (preemphasis) {
-            delete preemphasis;
-        }
         EIDSP_ERR(EIDSP_PARAMETER_INVALID);
     }
 
-    // if we still have some code from previous run
-    while (ei_dsp_cont_current_frame_ix > 0) {
-        // then from the current frame we need to read `frame_length_values - ei_dsp_cont_current_frame_ix`
-        // starting at offset 0
-        x = preemphasized_audio_signal.get_data(0, frame_length_values - ei_dsp_cont_current_frame_ix, ei_dsp_cont_current_frame + ei_dsp_cont_current_frame_ix);
-        if (x != EIDSP_OK) {
-            if (preemphasis) {
-                delete preemphasis;
-            }
-            EIDSP_ERR(x);
-        }
-
-        // now ei_dsp_cont_current_frame is complete
-        signal_t frame_signal;
-        x = numpy::signal_from_buffer(ei_dsp_cont_current_frame, frame_length_values, &frame_signal);
-        if (x != EIDSP_OK) {
-            if (preemphasis) {
-                delete preemphasis;
-            }
-            EIDSP_ERR(x);
-        }
-
-        x = extract_mfe_run_slice(&frame_signal, output_matrix, &config, sampling_frequency, matrix_size_out);
-        if (x != EIDSP_OK) {
-            if (preemphasis) {
-                delete preemphasis;
-            }
-            EIDSP_ERR(x);
-        }
-
-        // if there's overlap between frames we roll through
-        if (frame_stride_values > 0) {
-            numpy::roll(ei_dsp_cont_current_frame, frame_length_values, -frame_stride_values);
-        }
-
-        ei_dsp_cont_current_frame_ix -= frame_stride_values;
-    }
-
-    if (ei_dsp_cont_current_frame_ix < 0) {
-        offset_in_signal = -ei_dsp_cont_current_frame_ix;
-        ei_dsp_cont_current_frame_ix = 0;
-    }
-
-    if (offset_in_signal >= signal->total_length) {
-        if (preemphasis) {
-            delete preemphasis;
-        }
-        offset_in_signal -= signal->total_length;
-        return EIDSP_OK;
-    }
-
-    // now... we need to discard part of the signal...
-    SignalWithRange signal_with_range(&preemphasized_audio_signal, offset_in_signal, signal->total_length);
-
-    signal_t *range_signal = signal_with_range.get_signal();
-    size_t range_signal_orig_length = range_signal->total_length;
-
-    // then we'll just go through normal processing of the signal:
-    x = extract_mfe_run_slice(range_signal, output_matrix, &config, sampling_frequency, matrix_size_out);
+    // before version 3 we did not have preemphasis
+    const bool use_preemphasis = config.implementation_version >= 3;
+
+    // Version 1 frames the window with round() and leaves out the last frame
+    // (stack_frames always subtracts one frame_length). The stream frames the
+    // same way and emits every frame as it completes, so the rolling matrix
+    // holds the newest frames and no padding of the slice is needed.
+    speechpy::feature_stream_config_t stream_config = {
+        static_cast<uint32_t>(sampling_frequency), config.frame_length, config.frame_stride,
+        static_cast<uint16_t>(config.num_filters), static_cast<uint16_t>(config.fft_length),
+        static_cast<uint32_t>(config.low_frequency), static_cast<uint32_t>(config.high_frequency),
+        0, false, use_preemphasis ? 1 : 0, 0.98f, true, config.implementation_version
+    };
+
+    speechpy::feature_stream *stream;
+    int x = ei_dsp_get_audio_stream(config_ptr, &stream_config, &stream);
     if (x != EIDSP_OK) {
-        if (preemphasis) {
-            delete preemphasis;
-        }
+        ei_printf("ERR: MFE stream init failed (%d)\n", x);
         EIDSP_ERR(x);
     }
 
-    // update offset
-    int length_of_signal_used = speechpy::processing::calculate_signal_used(range_signal->total_length, sampling_frequency,
-        config.frame_length, config.frame_stride, false, config.implementation_version);
-    offset_in_signal += length_of_signal_used;
-
-    // not sure why this is being manipulated...
-    range_signal->total_length = range_signal_orig_length;
-
-    // see what's left?
-    int bytes_left_end_of_frame = signal->total_length - offset_in_signal;
-    bytes_left_end_of_frame += frame_overlap_values;
-
-    if (bytes_left_end_of_frame > 0) {
-        // then read that into the ei_dsp_cont_current_frame buffer
-        x = preemphasized_audio_signal.get_data(
-            (preemphasized_audio_signal.total_length - bytes_left_end_of_frame),
-            bytes_left_end_of_frame,
-            ei_dsp_cont_current_frame);
-        if (x != EIDSP_OK) {
-            if (preemphasis) {
-                delete preemphasis;
-            }
-            EIDSP_ERR(x);
-        }
-    }
-
-    ei_dsp_cont_current_frame_ix = bytes_left_end_of_frame;
-
-
-    if (config.implementation_version == 1) {
-        if (first_run == true) {
-            signal->total_length -= (size_t)(config.frame_length * (float)frequency);
-        }
-    }
-
-    if (preemphasis) {
-        delete preemphasis;
+    // only the frames completed by this slice are computed and appended
+    x = stream->process(signal, output_matrix, matrix_size_out);
+    if (x != EIDSP_OK) {
+        ei_printf("ERR: MFE failed (%d)\n", x);
+        EIDSP_ERR(x);
     }
 
     return EIDSP_OK;
@@ -1471,6 +1449,13 @@ __attribute__((unused)) int ei_dsp_clear_continuous_audio_state() {
     ei_dsp_cont_current_frame_size = 0;
     ei_dsp_cont_current_frame_ix = 0;
 
+#if !defined(__cplusplus) || EI_C_LINKAGE != 1
+    for (size_t ix = 0; ix < EI_DSP_AUDIO_STREAM_COUNT; ix++) {
+        ei_dsp_audio_streams[ix].stream.release();
+        ei_dsp_audio_streams[ix].config_ptr = NULL;
+    }
+#endif
+
     return EIDSP_OK;
 }
 
@@ -0,0 +1,474 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EDGE_IMPULSE_RUN_MULTI_IMPULSE_H_
+#define _EDGE_IMPULSE_RUN_MULTI_IMPULSE_H_
+
+/**
+ * Run several impulses on the same raw signal.
+ *
+ * Every model is described by an ei_impulse_model_t: its DSP blocks, the entry
+ * points of its compiled (EON) model - each generated model has its own arena -,
+ * its labels and an optional anomaly function. Models are registered on an
+ * ei_multi_impulse_t; DSP blocks that have the same extract function, axes,
+ * implementation version and config are only computed once per window and
+ * their features are shared.
+ *
+ * Every compiled model after the first needs its own symbol prefix: compile its
+ * trained_model_compiled.cpp with -DEI_TRAINED_MODEL_PREFIX=<name> and point the
+ * ei_impulse_model_t at <name>_init, <name>_input, ... (see tests/test_multi_impulse.cpp).
+ */
+
+#include "ei_run_classifier.h"
+
+#if (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED == 1)
+
+// clang-format off
+#ifndef EI_MULTI_IMPULSE_MAX_MODELS
+#define EI_MULTI_IMPULSE_MAX_MODELS         4
+#endif
+
+#ifndef EI_MULTI_IMPULSE_MAX_DSP_BLOCKS
+#define EI_MULTI_IMPULSE_MAX_DSP_BLOCKS     8
+#endif
+
+#ifndef EI_MULTI_IMPULSE_MAX_LABELS
+#define EI_MULTI_IMPULSE_MAX_LABELS         16
+#endif
+// clang-format on
+
+typedef struct {
+    const char *name;
+    // DSP front-end
+    const ei_model_dsp_t *dsp_blocks;
+    size_t dsp_blocks_size;
+    size_t raw_samples_per_frame;
+    float frequency;
+    size_t nn_input_frame_size;
+    // compiled model, NULL init for anomaly-only impulses
+    TfLiteStatus (*init)(void*(*alloc_fnc)(size_t, size_t));
+    TfLiteTensor *(*input)(int index);
+    TfLiteTensor *(*output)(int index);
+    TfLiteStatus (*invoke)();
+    TfLiteStatus (*reset)(void (*free_fnc)(void* ptr));
+    const char * const *labels;
+    size_t label_count;
+    // anomaly score from the full feature vector, NULL if the impulse has no anomaly block
+    float (*anomaly)(const float *features);
+} ei_impulse_model_t;
+
+typedef struct {
+    ei_impulse_result_classification_t classification[EI_MULTI_IMPULSE_MAX_LABELS];
+    size_t label_count;
+    float anomaly;
+    ei_impulse_result_timing_t timing;
+} ei_multi_impulse_result_t;
+
+typedef struct {
+    const ei_model_dsp_t *block;
+    size_t features_offset;     // offset in the shared features buffer
+    int64_t dsp_us;             // time of the last run
+} ei_multi_impulse_dsp_t;
+
+typedef struct {
+    const ei_impulse_model_t *models[EI_MULTI_IMPULSE_MAX_MODELS];
+    size_t models_size;
+    // unique DSP blocks over all models, and for every model block the index in there
+    ei_multi_impulse_dsp_t dsp[EI_MULTI_IMPULSE_MAX_DSP_BLOCKS];
+    size_t dsp_size;
+    uint8_t dsp_index[EI_MULTI_IMPULSE_MAX_MODELS][EI_MULTI_IMPULSE_MAX_DSP_BLOCKS];
+    size_t features_size;
+    size_t raw_samples_per_frame;
+    float frequency;
+} ei_multi_impulse_t;
+
+#ifdef __cplusplus
+namespace {
+#endif // __cplusplus
+
+/**
+ * Selects axes from an interleaved signal, like SignalWithAxes but with
+ * the frame size of the model instead of EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME
+ */
+class MultiImpulseSignalWithAxes {
+public:
+    MultiImpulseSignalWithAxes(signal_t *original_signal, uint8_t *axes, size_t axes_count, size_t samples_per_frame):
+        _original_signal(original_signal), _axes(axes), _axes_count(axes_count), _samples_per_frame(samples_per_frame)
+    {
+
+    }
+
+    signal_t * get_signal() {
+        if (this->_axes_count == this->_samples_per_frame) {
+            return this->_original_signal;
+        }
+
+        wrapped_signal.total_length = _original_signal->total_length / _samples_per_frame * _axes_count;
+#ifdef __MBED__
+        wrapped_signal.get_data = mbed::callback(this, &MultiImpulseSignalWithAxes::get_data);
+#else
+        wrapped_signal.get_data = [this](size_t offset, size_t length, float *out_ptr) {
+            return this->get_data(offset, length, out_ptr);
+        };
+#endif
+        return &wrapped_signal;
+    }
+
+    int get_data(size_t offset, size_t length, float *out_ptr) {
+        size_t offset_on_original_signal = offset / _axes_count * _samples_per_frame;
+        size_t length_on_original_signal = length / _axes_count * _samples_per_frame;
+
+        size_t out_ptr_ix = 0;
+
+        for (size_t ix = offset_on_original_signal; ix < offset_on_original_signal + length_on_original_signal; ix += _samples_per_frame) {
+            for (size_t axis_ix = 0; axis_ix < this->_axes_count; axis_ix++) {
+                int r = _original_signal->get_data(ix + _axes[axis_ix], 1, &out_ptr[out_ptr_ix++]);
+                if (r != 0) {
+                    return r;
+                }
+            }
+        }
+
+        return 0;
+    }
+
+private:
+    signal_t *_original_signal;
+    uint8_t *_axes;
+    size_t _axes_count;
+    size_t _samples_per_frame;
+    signal_t wrapped_signal;
+};
+
+/**
+ * Whether two DSP blocks produce the same features from the same signal.
+ * Configs are compared by value for spectral analysis blocks, by pointer otherwise.
+ * Every config struct starts with its implementation_version, blocks of another
+ * version never match.
+ */
+static bool ei_multi_impulse_dsp_equal(const ei_model_dsp_t *a, const ei_model_dsp_t *b) {
+    if (a->extract_fn != b->extract_fn ||
+        a->n_output_features != b->n_output_features ||
+        a->axes_size != b->axes_size ||
+        memcmp(a->axes, b->axes, a->axes_size) != 0) {
+        return false;
+    }
+
+    if (a->config == b->config) {
+        return true;
+    }
+
+    if (*(const uint16_t*)a->config != *(const uint16_t*)b->config) {
+        return false;
+    }
+
+    int (*spectral_fn)(signal_t*, matrix_t*, void*, const float) = &extract_spectral_analysis_features;
+    if (a->extract_fn == spectral_fn) {
+        const ei_dsp_config_spectral_analysis_t *ca = (const ei_dsp_config_spectral_analysis_t*)a->config;
+        const ei_dsp_config_spectral_analysis_t *cb = (const ei_dsp_config_spectral_analysis_t*)b->config;
+        return ca->implementation_version == cb->implementation_version &&
+            ca->axes == cb->axes &&
+            ca->scale_axes == cb->scale_axes &&
+            strcmp(ca->filter_type, cb->filter_type) == 0 &&
+            ca->filter_cutoff == cb->filter_cutoff &&
+            ca->filter_order == cb->filter_order &&
+            ca->fft_length == cb->fft_length &&
+            ca->spectral_peaks_count == cb->spectral_peaks_count &&
+            ca->spectral_peaks_threshold == cb->spectral_peaks_threshold &&
+            strcmp(ca->spectral_power_edges, cb->spectral_power_edges) == 0;
+    }
+
+    return false;
+}
+
+/**
+ * Clear the runtime, all models are unregistered
+ */
+__attribute__((unused)) void ei_multi_impulse_init(ei_multi_impulse_t *runtime) {
+    memset(runtime, 0, sizeof(ei_multi_impulse_t));
+}
+
+/**
+ * Register a model. All models need to use the same raw signal
+ * (same frequency and values per frame).
+ * @param runtime Runtime
+ * @param model Model, needs to stay valid while the runtime is used
+ * @returns EI_IMPULSE_OK if OK
+ */
+__attribute__((unused)) EI_IMPULSE_ERROR ei_multi_impulse_register(ei_multi_impulse_t *runtime, const ei_impulse_model_t *model) {
+    if (runtime->models_size >= EI_MULTI_IMPULSE_MAX_MODELS ||
+        model->dsp_blocks_size > EI_MULTI_IMPULSE_MAX_DSP_BLOCKS ||
+        model->label_count > EI_MULTI_IMPULSE_MAX_LABELS) {
+        ei_printf("ERR: Model '%s' does not fit in the multi-impulse runtime\n", model->name);
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+    if (runtime->models_size > 0 &&
+        (runtime->raw_samples_per_frame != model->raw_samples_per_frame || runtime->frequency != model->frequency)) {
+        ei_printf("ERR: Model '%s' expects a different raw signal\n", model->name);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    size_t model_ix = runtime->models_size;
+    size_t nn_features = 0;
+
+    for (size_t ix = 0; ix < model->dsp_blocks_size; ix++) {
+        const ei_model_dsp_t *block = &model->dsp_blocks[ix];
+        nn_features += block->n_output_features;
+
+        size_t dsp_ix;
+        for (dsp_ix = 0; dsp_ix < runtime->dsp_size; dsp_ix++) {
+            if (ei_multi_impulse_dsp_equal(runtime->dsp[dsp_ix].block, block)) {
+                break;
+            }
+        }
+
+        if (dsp_ix == runtime->dsp_size) {
+            if (runtime->dsp_size >= EI_MULTI_IMPULSE_MAX_DSP_BLOCKS) {
+                ei_printf("ERR: Too many unique DSP blocks, increase EI_MULTI_IMPULSE_MAX_DSP_BLOCKS\n");
+                return EI_IMPULSE_OUT_OF_MEMORY;
+            }
+            runtime->dsp[dsp_ix].block = block;
+            runtime->dsp[dsp_ix].features_offset = runtime->features_size;
+            runtime->features_size += block->n_output_features;
+            runtime->dsp_size++;
+        }
+
+        runtime->dsp_index[model_ix][ix] = (uint8_t)dsp_ix;
+    }
+
+    if (nn_features != model->nn_input_frame_size) {
+        ei_printf("ERR: DSP blocks of model '%s' do not match its input size\n", model->name);
+        return EI_IMPULSE_DSP_ERROR;
+    }
+
+    runtime->models[model_ix] = model;
+    runtime->models_size++;
+    runtime->raw_samples_per_frame = model->raw_samples_per_frame;
+    runtime->frequency = model->frequency;
+
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Run one compiled model on its feature vector
+ */
+static EI_IMPULSE_ERROR ei_multi_impulse_run_nn(const ei_impulse_model_t *model, matrix_t *features,
+    ei_multi_impulse_result_t *result, bool debug)
+{
+    uint64_t ctx_start_us = ei_read_timer_us();
+
+    TfLiteStatus status = model->init(ei_aligned_calloc);
+    if (status != kTfLiteOk) {
+        ei_printf("Failed to allocate TFLite arena for '%s' (error code %d)\n", model->name, status);
+        return EI_IMPULSE_TFLITE_ARENA_ALLOC_FAILED;
+    }
+
+    TfLiteTensor *input = model->input(0);
+    TfLiteTensor *output = model->output(0);
+
+    bool int8_input = input->type == TfLiteType::kTfLiteInt8;
+    for (size_t ix = 0; ix < features->rows * features->cols; ix++) {
+        if (int8_input) {
+            input->data.int8[ix] = static_cast<int8_t>(round(features->buffer[ix] / input->params.scale) + input->params.zero_point);
+        } else {
+            input->data.f[ix] = features->buffer[ix];
+        }
+    }
+
+    status = model->invoke();
+    if (status != kTfLiteOk) {
+        model->reset(ei_aligned_free);
+        return EI_IMPULSE_TFLITE_ERROR;
+    }
+
+    bool int8_output = output->type == TfLiteType::kTfLiteInt8;
+    for (size_t ix = 0; ix < model->label_count; ix++) {
+        float value = int8_output ?
+            static_cast<float>(output->data.int8[ix] - output->params.zero_point) * output->params.scale :
+            output->data.f[ix];
+
+        if (debug) {
+            ei_printf("%s.%s:\t", model->name, model->labels[ix]);
+            ei_printf_float(value);
+            ei_printf("\n");
+        }
+        result->classification[ix].label = model->labels[ix];
+        result->classification[ix].value = value;
+    }
+    result->label_count = model->label_count;
+
+    model->reset(ei_aligned_free);
+
+    result->timing.classification_us = ei_read_timer_us() - ctx_start_us;
+    result->timing.classification = (int)(result->timing.classification_us / 1000);
+
+    return EI_IMPULSE_OK;
+}
+
+/**
+ * Run all registered models on one window of raw data. Shared DSP blocks
+ * are computed once, the DSP time of every result is the sum of the blocks
+ * that model uses.
+ * @param runtime Runtime with registered models
+ * @param signal Raw signal
+ * @param results Array with one result per registered model
+ * @param debug Whether to show debug messages
+ * @returns EI_IMPULSE_OK if OK
+ */
+__attribute__((unused)) EI_IMPULSE_ERROR run_multi_impulse(
+    ei_multi_impulse_t *runtime,
+    signal_t *signal,
+    ei_multi_impulse_result_t *results,
+    bool debug = false)
+{
+    memset(results, 0, sizeof(ei_multi_impulse_result_t) * runtime->models_size);
+
+    ei::matrix_t shared_features(1, runtime->features_size);
+    if (!shared_features.buffer) {
+        return EI_IMPULSE_OUT_OF_MEMORY;
+    }
+
+    for (size_t dsp_ix = 0; dsp_ix < runtime->dsp_size; dsp_ix++) {
+        EI_PROFILE_SCOPE_INDEX("dsp", dsp_ix);
+        ei_multi_impulse_dsp_t *dsp = &runtime->dsp[dsp_ix];
+        const ei_model_dsp_t *block = dsp->block;
+
+        uint64_t dsp_start_us = ei_read_timer_us();
+
+        ei::matrix_t fm(1, block->n_output_features, shared_features.buffer + dsp->features_offset);
+
+        MultiImpulseSignalWithAxes swa(signal, block->axes, block->axes_size, runtime->raw_samples_per_frame);
+        int ret = block->extract_fn(swa.get_signal(), &fm, block->config, runtime->frequency);
+        if (ret != EIDSP_OK) {
+            ei_printf("ERR: Failed to run DSP process (%d)\n", ret);
+            return EI_IMPULSE_DSP_ERROR;
+        }
+
+        dsp->dsp_us = ei_read_timer_us() - dsp_start_us;
+
+        if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+            return EI_IMPULSE_CANCELED;
+        }
+    }
+
+    for (size_t model_ix = 0; model_ix < runtime->models_size; model_ix++) {
+        const ei_impulse_model_t *model = runtime->models[model_ix];
+        ei_multi_impulse_result_t *result = &results[model_ix];
+
+        // gather the features of this model from the shared blocks
+        ei::matrix_t features(1, model->nn_input_frame_size);
+        if (!features.buffer) {
+            return EI_IMPULSE_OUT_OF_MEMORY;
+        }
+
+        size_t out_features_index = 0;
+        for (size_t ix = 0; ix < model->dsp_blocks_size; ix++) {
+            ei_multi_impulse_dsp_t *dsp = &runtime->dsp[runtime->dsp_index[model_ix][ix]];
+            memcpy(features.buffer + out_features_index, shared_features.buffer + dsp->features_offset,
+                model->dsp_blocks[ix].n_output_features * sizeof(float));
+            out_features_index += model->dsp_blocks[ix].n_output_features;
+            result->timing.dsp_us += dsp->dsp_us;
+        }
+        result->timing.dsp = (int)(result->timing.dsp_us / 1000);
+
+        if (model->init) {
+            EI_PROFILE_SCOPE_INDEX("nn", model_ix);
+            EI_IMPULSE_ERROR res = ei_multi_impulse_run_nn(model, &features, result, debug);
+            if (res != EI_IMPULSE_OK) {
+                return res;
+            }
+        }
+
+        if (model->anomaly) {
+            EI_PROFILE_SCOPE_INDEX("anomaly", model_ix);
+            uint64_t anomaly_start_us = ei_read_timer_us();
+
+            result->anomaly = model->anomaly(features.buffer);
+
+            result->timing.anomaly_us = ei_read_timer_us() - anomaly_start_us;
+            result->timing.anomaly = (int)(result->timing.anomaly_us / 1000);
+
+            if (debug) {
+                ei_printf("%s anomaly score: ", model->name);
+                ei_printf_float(result->anomaly);
+                ei_printf("\n");
+            }
+        }
+
+        if (ei_run_impulse_check_canceled() == EI_IMPULSE_CANCELED) {
+            return EI_IMPULSE_CANCELED;
+        }
+    }
+
+    return EI_IMPULSE_OK;
+}
+
+#if EI_CLASSIFIER_HAS_ANOMALY == 1
+/**
+ * Anomaly score of the model in model-parameters/
+ */
+static float ei_multi_impulse_default_anomaly(const float *features) {
+    float input[EI_CLASSIFIER_ANOM_AXIS_SIZE];
+    for (size_t ix = 0; ix < EI_CLASSIFIER_ANOM_AXIS_SIZE; ix++) {
+        input[ix] = features[EI_CLASSIFIER_ANOM_AXIS[ix]];
+    }
+    standard_scaler(input, ei_classifier_anom_scale, ei_classifier_anom_mean, EI_CLASSIFIER_ANOM_AXIS_SIZE);
+    return get_min_distance_to_cluster(
+        input, EI_CLASSIFIER_ANOM_AXIS_SIZE, ei_classifier_anom_clusters, EI_CLASSIFIER_ANOM_CLUSTER_COUNT);
+}
+#endif // EI_CLASSIFIER_HAS_ANOMALY == 1
+
+/**
+ * Model object for the impulse in model-parameters/ and tflite-model/
+ */
+__attribute__((unused)) const ei_impulse_model_t *ei_multi_impulse_default_model(void) {
+    static const ei_impulse_model_t model = {
+        "default",
+        ei_dsp_blocks,
+        ei_dsp_blocks_size,
+        EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,
+        EI_CLASSIFIER_FREQUENCY,
+        EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+        &trained_model_init,
+        &trained_model_input,
+        &trained_model_output,
+        &trained_model_invoke,
+        &trained_model_reset,
+        ei_classifier_inferencing_categories,
+        EI_CLASSIFIER_LABEL_COUNT,
+#if EI_CLASSIFIER_HAS_ANOMALY == 1
+        &ei_multi_impulse_default_anomaly,
+#else
+        NULL,
+#endif
+    };
+    return &model;
+}
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // (EI_CLASSIFIER_INFERENCING_ENGINE == EI_CLASSIFIER_TFLITE) && (EI_CLASSIFIER_COMPILED == 1)
+
+#endif // _EDGE_IMPULSE_RUN_MULTI_IMPULSE_H_
@@ -94,5 +94,17 @@
 #define EIDSP_SIGNAL_C_FN_POINTER    0
 #endif // EIDSP_SIGNAL_C_FN_POINTER
 
+// samples per block in numpy::moments(), the power sums of a block are
+// accumulated around its first sample, so keep this short
+#ifndef EIDSP_MOMENTS_BLOCK
+#define EIDSP_MOMENTS_BLOCK          32
+#endif // EIDSP_MOMENTS_BLOCK
+
+// largest decimation ratio of one FIR stage in spectral::multirate_decimator,
+// larger ratios are split into a cascade of stages
+#ifndef EIDSP_DECIMATOR_MAX_STAGE_RATIO
+#define EIDSP_DECIMATOR_MAX_STAGE_RATIO  8
+#endif // EIDSP_DECIMATOR_MAX_STAGE_RATIO
+
 // clang-format on
 #endif // _EIDSP_CPP_CONFIG_H_
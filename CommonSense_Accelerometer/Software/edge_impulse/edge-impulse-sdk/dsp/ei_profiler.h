@@ -23,8 +23,251 @@
 #ifndef __EIPROFILER__H__
 #define __EIPROFILER__H__
 
+#include <stdint.h>
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
 
+// clang-format off
+// Set to 1 to record scoped timing events (DSP steps, NN layers, anomaly, ...)
+#ifndef EI_PROFILER_ENABLED
+#define EI_PROFILER_ENABLED          0
+#endif // EI_PROFILER_ENABLED
+
+// Number of events kept, oldest events are overwritten when the ring is full
+#ifndef EI_PROFILER_RING_SIZE
+#define EI_PROFILER_RING_SIZE        128
+#endif // EI_PROFILER_RING_SIZE
+
+// Use the DWT cycle counter on ARMv7-M (Cortex-M3/M4/M7), microsecond timer elsewhere
+#ifndef EI_PROFILER_USE_DWT
+#if defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_7M__)
+#define EI_PROFILER_USE_DWT          1
+#else
+#define EI_PROFILER_USE_DWT          0
+#endif
+#endif // EI_PROFILER_USE_DWT
+
+// Core clock, only used to convert DWT cycles to microseconds on targets that cannot
+// read their current clock (the Spresense port reads it, the LowPower clock modes change it)
+#ifndef EI_PROFILER_CPU_FREQ_HZ
+#define EI_PROFILER_CPU_FREQ_HZ      156000000
+#endif // EI_PROFILER_CPU_FREQ_HZ
+// clang-format on
+
+#if EI_PROFILER_USE_DWT && defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+extern uint32_t spresense_get_cpu_freq_hz(void);
+#endif
+
+/**
+ * One completed scope. Names must point to memory with static storage
+ * (string literals), as only the pointer is stored.
+ */
+typedef struct {
+    const char *name;
+    uint32_t start;
+    uint32_t duration;
+    float ticks_per_us;     // clock when the scope ended
+    int16_t index;
+    uint8_t depth;
+} ei_profiler_event_t;
+
+typedef struct {
+    ei_profiler_event_t events[EI_PROFILER_RING_SIZE];
+    uint32_t head;
+    uint32_t count;
+    uint32_t dropped;
+    uint8_t depth;
+} ei_profiler_ring_t;
+
+/**
+ * Single ring shared between all translation units
+ */
+inline ei_profiler_ring_t *ei_profiler_ring()
+{
+    static ei_profiler_ring_t ring;
+    return &ring;
+}
+
+/**
+ * Read the profiler clock, in cycles (DWT) or microseconds
+ */
+inline uint32_t ei_profiler_ticks()
+{
+#if EI_PROFILER_USE_DWT
+    return *((volatile uint32_t *)0xE0001004); // DWT->CYCCNT
+#else
+    return (uint32_t)ei_read_timer_us();
+#endif
+}
+
+/**
+ * Number of profiler clock ticks per microsecond, at the current CPU clock
+ */
+inline float ei_profiler_ticks_per_us()
+{
+#if EI_PROFILER_USE_DWT && defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+    return (float)spresense_get_cpu_freq_hz() / 1000000.0f;
+#elif EI_PROFILER_USE_DWT
+    return (float)EI_PROFILER_CPU_FREQ_HZ / 1000000.0f;
+#else
+    return 1.0f;
+#endif
+}
+
+/**
+ * Start the cycle counter if the profiler clock is DWT, for users of
+ * ei_profiler_ticks() that do not go through ei_profiler_reset()
+ */
+inline void ei_profiler_enable_counter()
+{
+#if EI_PROFILER_USE_DWT
+    *((volatile uint32_t *)0xE000EDFC) |= (1UL << 24);  // CoreDebug->DEMCR |= TRCENA
+    *((volatile uint32_t *)0xE0001000) |= 1UL;          // DWT->CTRL |= CYCCNTENA
+#endif
+}
+
+/**
+ * Clear all recorded events (and start the cycle counter if needed)
+ */
+inline void ei_profiler_reset()
+{
+    ei_profiler_enable_counter();
+    ei_profiler_ring_t *ring = ei_profiler_ring();
+    ring->head = 0;
+    ring->count = 0;
+    ring->dropped = 0;
+    ring->depth = 0;
+}
+
+/**
+ * Times a scope, the event is added to the ring when the scope ends.
+ * Scopes can be nested, the nesting depth is stored with the event.
+ * Cycles are converted with the clock at the end of the scope, so a scope
+ * that spans a clock switch (e.g. sampling with low_clock_when_idle) is
+ * not exact.
+ */
+class EiProfilerScope {
+public:
+    EiProfilerScope(const char *name, int16_t index = -1)
+        : _name(name), _index(index), _running(true)
+    {
+        _depth = ei_profiler_ring()->depth++;
+        _start = ei_profiler_ticks();
+    }
+
+    ~EiProfilerScope()
+    {
+        end();
+    }
+
+    /**
+     * Stop timing before the scope ends, no-op when already stopped
+     */
+    void end()
+    {
+        if (!_running) {
+            return;
+        }
+        uint32_t now = ei_profiler_ticks();
+        _running = false;
+
+        ei_profiler_ring_t *ring = ei_profiler_ring();
+        ring->depth = _depth;
+
+        ei_profiler_event_t *ev = &ring->events[ring->head];
+        ev->name = _name;
+        ev->start = _start;
+        ev->duration = now - _start;
+        ev->ticks_per_us = ei_profiler_ticks_per_us();
+        ev->index = _index;
+        ev->depth = _depth;
+
+        ring->head = (ring->head + 1) % EI_PROFILER_RING_SIZE;
+        if (ring->count < EI_PROFILER_RING_SIZE) {
+            ring->count++;
+        }
+        else {
+            ring->dropped++;
+        }
+    }
+
+private:
+    const char *_name;
+    uint32_t _start;
+    int16_t _index;
+    uint8_t _depth;
+    bool _running;
+};
+
+/**
+ * Print all events in the ring as Chrome trace JSON (load in chrome://tracing or Perfetto).
+ * Timestamps are in microseconds, relative to the oldest event in the ring.
+ */
+inline void ei_profiler_dump_chrome_trace()
+{
+    ei_profiler_ring_t *ring = ei_profiler_ring();
+    uint32_t first = (ring->head + EI_PROFILER_RING_SIZE - ring->count) % EI_PROFILER_RING_SIZE;
+
+    // events are stored on scope exit, so the oldest start is not necessarily the first event
+    uint32_t origin = ring->events[first].start;
+    for (uint32_t ix = 0; ix < ring->count; ix++) {
+        uint32_t start = ring->events[(first + ix) % EI_PROFILER_RING_SIZE].start;
+        if ((int32_t)(start - origin) < 0) {
+            origin = start;
+        }
+    }
+
+    ei_printf("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%lu},\"traceEvents\":[",
+        (unsigned long)ring->dropped);
+    for (uint32_t ix = 0; ix < ring->count; ix++) {
+        ei_profiler_event_t *ev = &ring->events[(first + ix) % EI_PROFILER_RING_SIZE];
+
+        ei_printf("%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":",
+            ix == 0 ? "" : ",", ev->name);
+        ei_printf_float((float)(ev->start - origin) / ev->ticks_per_us);
+        ei_printf(",\"dur\":");
+        ei_printf_float((float)ev->duration / ev->ticks_per_us);
+        ei_printf(",\"args\":{\"index\":%d,\"depth\":%d}}", (int)ev->index, (int)ev->depth);
+    }
+    ei_printf("\n]}\n");
+}
+
+/**
+ * Print one line per event: depth-indented name and duration in microseconds
+ */
+inline void ei_profiler_print_summary()
+{
+    ei_profiler_ring_t *ring = ei_profiler_ring();
+    uint32_t first = (ring->head + EI_PROFILER_RING_SIZE - ring->count) % EI_PROFILER_RING_SIZE;
+
+    for (uint32_t ix = 0; ix < ring->count; ix++) {
+        ei_profiler_event_t *ev = &ring->events[(first + ix) % EI_PROFILER_RING_SIZE];
+        ei_printf("%*s%s", (int)ev->depth * 2, "", ev->name);
+        if (ev->index >= 0) {
+            ei_printf("[%d]", (int)ev->index);
+        }
+        ei_printf(": ");
+        ei_printf_float((float)ev->duration / ev->ticks_per_us);
+        ei_printf(" us\n");
+    }
+}
+
+#define EI_PROFILER_CONCAT_(a, b) a##b
+#define EI_PROFILER_CONCAT(a, b) EI_PROFILER_CONCAT_(a, b)
+
+#if EI_PROFILER_ENABLED == 1
+#define EI_PROFILE_SCOPE(name)                  EiProfilerScope EI_PROFILER_CONCAT(_ei_prof_, __LINE__)(name)
+#define EI_PROFILE_SCOPE_INDEX(name, index)     EiProfilerScope EI_PROFILER_CONCAT(_ei_prof_, __LINE__)(name, index)
+#define EI_PROFILE_START(var, name)             EiProfilerScope var(name)
+#define EI_PROFILE_START_INDEX(var, name, index) EiProfilerScope var(name, index)
+#define EI_PROFILE_STOP(var)                    var.end()
+#else
+#define EI_PROFILE_SCOPE(name)
+#define EI_PROFILE_SCOPE_INDEX(name, index)
+#define EI_PROFILE_START(var, name)
+#define EI_PROFILE_START_INDEX(var, name, index)
+#define EI_PROFILE_STOP(var)
+#endif // EI_PROFILER_ENABLED == 1
+
 class EiProfiler {
 public:
     EiProfiler()
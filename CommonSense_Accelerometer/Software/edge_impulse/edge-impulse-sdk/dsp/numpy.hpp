@@ -1352,6 +1352,143 @@ public:
         return EIDSP_OK;
     }
 
+    /**
+     * Mean, variance, RMS, skewness, kurtosis, min, max and crest factor per row,
+     * in a single pass over the matrix.
+     * The row is processed in blocks of EIDSP_MOMENTS_BLOCK samples. Every block
+     * accumulates power sums around its first sample (short, unrolled and free of
+     * divisions), which are then merged into the running central moments with the
+     * pairwise update of Chan / Pebay. This stays accurate for signals with a large
+     * offset, where sum(x^2) - n * mean^2 would cancel.
+     * @param input_matrix Input matrix (MxN)
+     * @param output Output, M entries
+     * @returns 0 if OK
+     */
+    static int moments(matrix_t *input_matrix, moments_t *output) {
+        if (input_matrix->cols == 0) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        for (size_t row = 0; row < input_matrix->rows; row++) {
+            moments_row(input_matrix->buffer + (row * input_matrix->cols), input_matrix->cols, &output[row]);
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Single pass moments of a buffer, see moments()
+     * @param src Input buffer
+     * @param src_size Number of values, at least 1
+     * @param output Output
+     */
+    static void moments_row(const float *src, size_t src_size, moments_t *output) {
+        float n = 0.0f;
+        float mean = 0.0f;
+        float m_2 = 0.0f;
+        float m_3 = 0.0f;
+        float m_4 = 0.0f;
+        float min = src[0];
+        float max = src[0];
+
+        for (size_t start = 0; start < src_size; start += EIDSP_MOMENTS_BLOCK) {
+            size_t count = src_size - start < EIDSP_MOMENTS_BLOCK ? src_size - start : EIDSP_MOMENTS_BLOCK;
+            const float *block = src + start;
+            const float shift = block[0];
+            float s_1 = 0.0f, s_2 = 0.0f, s_3 = 0.0f, s_4 = 0.0f;
+            size_t ix = 0;
+
+            for (; ix + 4 <= count; ix += 4) {
+                float d0 = block[ix] - shift;
+                float d1 = block[ix + 1] - shift;
+                float d2 = block[ix + 2] - shift;
+                float d3 = block[ix + 3] - shift;
+                float q0 = d0 * d0, q1 = d1 * d1, q2 = d2 * d2, q3 = d3 * d3;
+
+                s_1 += (d0 + d1) + (d2 + d3);
+                s_2 += (q0 + q1) + (q2 + q3);
+                s_3 += (q0 * d0 + q1 * d1) + (q2 * d2 + q3 * d3);
+                s_4 += (q0 * q0 + q1 * q1) + (q2 * q2 + q3 * q3);
+
+                float lo = block[ix] < block[ix + 1] ? block[ix] : block[ix + 1];
+                float hi = block[ix] < block[ix + 1] ? block[ix + 1] : block[ix];
+                float lo2 = block[ix + 2] < block[ix + 3] ? block[ix + 2] : block[ix + 3];
+                float hi2 = block[ix + 2] < block[ix + 3] ? block[ix + 3] : block[ix + 2];
+                if (lo2 < lo) lo = lo2;
+                if (hi2 > hi) hi = hi2;
+                if (lo < min) min = lo;
+                if (hi > max) max = hi;
+            }
+            for (; ix < count; ix++) {
+                float d = block[ix] - shift;
+                float q = d * d;
+                s_1 += d;
+                s_2 += q;
+                s_3 += q * d;
+                s_4 += q * q;
+                if (block[ix] < min) min = block[ix];
+                if (block[ix] > max) max = block[ix];
+            }
+
+            // central moments of the block
+            float n_b = static_cast<float>(count);
+            float d_b = s_1 / n_b;
+            float mean_b = shift + d_b;
+            float m_2b = s_2 - s_1 * d_b;
+            float m_3b = s_3 - 3.0f * d_b * s_2 + 2.0f * s_1 * d_b * d_b;
+            float m_4b = s_4 - 4.0f * d_b * s_3 + 6.0f * d_b * d_b * s_2 - 3.0f * s_1 * d_b * d_b * d_b;
+
+            if (n == 0.0f) {
+                n = n_b;
+                mean = mean_b;
+                m_2 = m_2b;
+                m_3 = m_3b;
+                m_4 = m_4b;
+                continue;
+            }
+
+            // merge the block into the running moments
+            float n_a = n;
+            float n_ab = n_a + n_b;
+            float delta = mean_b - mean;
+            float delta_n = delta / n_ab;
+            float delta_n2 = delta_n * delta_n;
+            float term = delta * delta_n * n_a * n_b;
+
+            m_4 += m_4b + term * delta_n2 * (n_a * n_a - n_a * n_b + n_b * n_b)
+                + 6.0f * delta_n2 * (n_a * n_a * m_2b + n_b * n_b * m_2)
+                + 4.0f * delta_n * (n_a * m_3b - n_b * m_3);
+            m_3 += m_3b + term * delta_n * (n_a - n_b)
+                + 3.0f * delta_n * (n_a * m_2b - n_b * m_2);
+            m_2 += m_2b + term;
+            mean += delta_n * n_b;
+            n = n_ab;
+        }
+
+        float variance = m_2 / n;
+        if (variance < 0.0f) {
+            variance = 0.0f;
+        }
+
+        output->mean = mean;
+        output->variance = variance;
+        output->rms = sqrt(mean * mean + variance);
+        output->min = min;
+        output->max = max;
+
+        if (variance == 0.0f) {
+            output->skewness = 0.0f;
+            output->kurtosis = -3.0f;
+        }
+        else {
+            output->skewness = (m_3 / n) / sqrt(variance * variance * variance);
+            output->kurtosis = (m_4 / n) / (variance * variance) - 3.0f;
+        }
+
+        float peak = -min > max ? -min : max;
+        output->crest_factor = output->rms == 0.0f ? 0.0f : peak / output->rms;
+    }
+
     /**
      * Compute the one-dimensional discrete Fourier Transform for real input.
      * This function computes the one-dimensional n-point discrete Fourier Transform (DFT) of
@@ -1360,9 +1497,13 @@ public:
      * @param src_size Size of the source buffer
      * @param output Output buffer
      * @param output_size Size of the output buffer, should be n_fft / 2 + 1
+     * @param n_fft Length of the FFT
+     * @param scratch rfft_scratch_size(n_fft) values for the FFT, NULL allocates them per call
      * @returns 0 if OK
      */
-    static int rfft(const float *src, size_t src_size, float *output, size_t output_size, size_t n_fft) {
+    static int rfft(const float *src, size_t src_size, float *output, size_t output_size, size_t n_fft,
+        float *scratch = NULL)
+    {
         size_t n_fft_out_features = (n_fft / 2) + 1;
         if (output_size != n_fft_out_features) {
             EIDSP_ERR(EIDSP_BUFFER_SIZE_MISMATCH);
@@ -1373,58 +1514,130 @@ public:
             src_size = n_fft;
         }
 
-        // declare input and output arrays
-        EI_DSP_MATRIX(fft_input, 1, n_fft);
-        if (!fft_input.buffer) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        EI_DSP_MATRIX_B(fft_scratch, 1, rfft_scratch_size(n_fft), scratch);
+        float *fft_input = fft_scratch.buffer;
+        float *fft_output = fft_scratch.buffer + n_fft;
+
+        // copy from src to fft_input, rfft_spectrum pads with zeros
+        memcpy(fft_input, src, src_size * sizeof(float));
+
+        int ret = rfft_spectrum(fft_input, src_size, fft_output, n_fft, rfft_magnitude);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
         }
 
-        // copy from src to fft_input
-        memcpy(fft_input.buffer, src, src_size * sizeof(float));
-        // pad to the rigth with zeros
-        memset(fft_input.buffer + src_size, 0, (n_fft - src_size) * sizeof(kiss_fft_scalar));
+        memcpy(output, fft_output, n_fft_out_features * sizeof(float));
 
-#if EIDSP_USE_CMSIS_DSP
-        if (n_fft != 32 && n_fft != 64 && n_fft != 128 && n_fft != 256 &&
-            n_fft != 512 && n_fft != 1024 && n_fft != 2048 && n_fft != 4096) {
-            int ret = software_rfft(fft_input.buffer, output, n_fft, n_fft_out_features);
-            if (ret != EIDSP_OK) {
-                EIDSP_ERR(ret);
-            }
+        return EIDSP_OK;
+    }
+
+    /**
+     * Size of the scratch buffer of rfft(), processing::periodogram() and
+     * speechpy::processing::power_spectrum(): the FFT input (n_fft values)
+     * followed by the output of rfft_spectrum() (n_fft + 2 values). Callers
+     * that transform many frames allocate it once.
+     * @param n_fft Length of the FFT
+     * @returns Number of float values
+     */
+    static size_t rfft_scratch_size(size_t n_fft) {
+        return 2 * n_fft + 2;
+    }
+
+    /**
+     * Magnitude or power spectrum of a real signal, all bins in one pass
+     * (arm_cmplx_mag_f32 / arm_cmplx_mag_squared_f32 with CMSIS-DSP). Works
+     * on caller buffers, nothing is allocated besides the kissfft config when
+     * CMSIS-DSP is not used or n_fft is not a supported power of two.
+     * @param fft_input Buffer of n_fft values, holds src_size samples. Is zero padded
+     *  and used as scratch, so its contents are lost.
+     * @param src_size Number of samples in fft_input (truncated to n_fft)
+     * @param output Buffer of n_fft + 2 values, scratch for the complex FFT. On return
+     *  the first n_fft / 2 + 1 values are the spectrum.
+     * @param n_fft Length of the FFT
+     * @param type Magnitude (|X|) or power (|X|^2)
+     * @param scale Multiplied with every bin, after squaring for power
+     * @returns 0 if OK
+     */
+    static int rfft_spectrum(float *fft_input, size_t src_size, float *output, size_t n_fft,
+        rfft_spectrum_t type, float scale = 1.0f)
+    {
+        const size_t n_fft_out_features = (n_fft / 2) + 1;
+
+        // truncate if needed
+        if (src_size > n_fft) {
+            src_size = n_fft;
         }
-        else {
-            // hardware acceleration only works for the powers above...
+
+        // pad to the right with zeros
+        memset(fft_input + src_size, 0, (n_fft - src_size) * sizeof(float));
+
+#if EIDSP_USE_CMSIS_DSP
+        // hardware acceleration only works for these powers of two
+        if (n_fft == 32 || n_fft == 64 || n_fft == 128 || n_fft == 256 ||
+            n_fft == 512 || n_fft == 1024 || n_fft == 2048 || n_fft == 4096) {
             arm_rfft_fast_instance_f32 rfft_instance;
             int status = cmsis_rfft_init_f32(&rfft_instance, n_fft);
             if (status != ARM_MATH_SUCCESS) {
                 return status;
             }
 
-            EI_DSP_MATRIX(fft_output, 1, n_fft);
-            if (!fft_output.buffer) {
-                EIDSP_ERR(EIDSP_OUT_OF_MEM);
+            // output is packed: DC, Nyquist (both real), then re / im of bins 1..n_fft/2-1
+            arm_rfft_fast_f32(&rfft_instance, fft_input, output, 0);
+
+            float dc = output[0];
+            float nyquist = output[1];
+
+            // bin k is read from output[2k], output[2k + 1] before output[k] is written
+            if (type == rfft_power) {
+                arm_cmplx_mag_squared_f32(output + 2, output + 1, n_fft_out_features - 2);
+                output[0] = dc * dc;
+                output[n_fft_out_features - 1] = nyquist * nyquist;
+            }
+            else {
+                arm_cmplx_mag_f32(output + 2, output + 1, n_fft_out_features - 2);
+                output[0] = fabsf(dc);
+                output[n_fft_out_features - 1] = fabsf(nyquist);
             }
 
-            arm_rfft_fast_f32(&rfft_instance, fft_input.buffer, fft_output.buffer, 0);
+            if (scale != 1.0f) {
+                arm_scale_f32(output, scale, output, n_fft_out_features);
+            }
 
-            output[0] = fft_output.buffer[0];
-            output[n_fft_out_features - 1] = fft_output.buffer[1];
+            return EIDSP_OK;
+        }
+#endif
 
-            size_t fft_output_buffer_ix = 2;
-            for (size_t ix = 1; ix < n_fft_out_features - 1; ix += 1) {
-                float rms_result;
-                arm_rms_f32(fft_output.buffer + fft_output_buffer_ix, 2, &rms_result);
-                output[ix] = rms_result * sqrt(2);
+        size_t kiss_fftr_mem_length;
 
-                fft_output_buffer_ix += 2;
+        // create fftr context
+        kiss_fftr_cfg cfg = kiss_fftr_alloc(n_fft, 0, NULL, NULL, &kiss_fftr_mem_length);
+        if (!cfg) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        ei_dsp_register_alloc(kiss_fftr_mem_length, cfg);
+
+        // n_fft / 2 + 1 complex values fit in the n_fft + 2 output values
+        kiss_fftr(cfg, fft_input, (kiss_fft_cpx*)output);
+
+        ei_dsp_free(cfg, kiss_fftr_mem_length);
+
+        // bin k is read from output[2k], output[2k + 1] before output[k] is written,
+        // plain loops so the compiler can vectorize them
+        if (type == rfft_power) {
+            for (size_t ix = 0; ix < n_fft_out_features; ix++) {
+                float re = output[2 * ix];
+                float im = output[2 * ix + 1];
+                output[ix] = (re * re + im * im) * scale;
             }
         }
-#else
-        int ret = software_rfft(fft_input.buffer, output, n_fft, n_fft_out_features);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
+        else {
+            for (size_t ix = 0; ix < n_fft_out_features; ix++) {
+                float re = output[2 * ix];
+                float im = output[2 * ix + 1];
+                output[ix] = sqrtf(re * re + im * im) * scale;
+            }
         }
-#endif
 
         return EIDSP_OK;
     }
@@ -2182,37 +2395,6 @@ public:
     }
 
 private:
-    static int software_rfft(float *fft_input, float *output, size_t n_fft, size_t n_fft_out_features) {
-        kiss_fft_cpx *fft_output = (kiss_fft_cpx*)ei_dsp_malloc(n_fft_out_features * sizeof(kiss_fft_cpx));
-        if (!fft_output) {
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
-        }
-
-        size_t kiss_fftr_mem_length;
-
-        // create fftr context
-        kiss_fftr_cfg cfg = kiss_fftr_alloc(n_fft, 0, NULL, NULL, &kiss_fftr_mem_length);
-        if (!cfg) {
-            ei_dsp_free(fft_output, n_fft_out_features * sizeof(kiss_fft_cpx));
-            EIDSP_ERR(EIDSP_OUT_OF_MEM);
-        }
-
-        ei_dsp_register_alloc(kiss_fftr_mem_length, cfg);
-
-        // execute the rfft operation
-        kiss_fftr(cfg, fft_input, fft_output);
-
-        // and write back to the output
-        for (size_t ix = 0; ix < n_fft_out_features; ix++) {
-            output[ix] = sqrt(pow(fft_output[ix].r, 2) + pow(fft_output[ix].i, 2));
-        }
-
-        ei_dsp_free(cfg, kiss_fftr_mem_length);
-        ei_dsp_free(fft_output, n_fft_out_features * sizeof(kiss_fft_cpx));
-
-        return EIDSP_OK;
-    }
-
     static int software_rfft(float *fft_input, fft_complex_t *output, size_t n_fft, size_t n_fft_out_features)
     {
         // create fftr context
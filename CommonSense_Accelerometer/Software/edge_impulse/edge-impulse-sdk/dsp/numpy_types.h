@@ -59,6 +59,32 @@ typedef struct {
     int32_t r;
     int32_t i;
 } fft_complex_i32_t;
+
+/**
+ * What numpy::rfft_spectrum() returns for every bin
+ */
+typedef enum {
+    rfft_magnitude = 0,
+    /** squared magnitude, no square root */
+    rfft_power = 1
+} rfft_spectrum_t;
+
+/**
+ * Time-domain statistics of one row, see numpy::moments().
+ * variance, skewness and kurtosis follow numpy::stdev(), skew() and kurtosis()
+ * (population variance, Fisher kurtosis).
+ */
+typedef struct {
+    float mean;
+    float variance;
+    float rms;
+    float skewness;
+    float kurtosis;
+    float min;
+    float max;
+    /** max(|min|, |max|) / rms */
+    float crest_factor;
+} moments_t;
 /**
  * A matrix structure that allocates a matrix on the **heap**.
  * Freeing happens by calling `delete` on the object or letting the object go out of scope.
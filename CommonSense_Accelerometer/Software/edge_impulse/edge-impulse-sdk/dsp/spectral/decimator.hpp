@@ -0,0 +1,292 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPECTRAL_DECIMATOR_H_
+#define _EIDSP_SPECTRAL_DECIMATOR_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "../numpy.hpp"
+#include "fir_filter.hpp"
+
+namespace ei {
+namespace spectral {
+
+/**
+ * Streaming anti-aliasing decimator for interleaved int16 frames, produces
+ * several lower rate streams from one input stream, e.g. to sample the
+ * accelerometer at its native ODR and feed a 62.5 Hz stream to one DSP block
+ * and a 1.6 kHz stream to another.
+ *
+ * Every output rate is a cascade of fir_filter stages with a ratio of at most
+ * EIDSP_DECIMATOR_MAX_STAGE_RATIO each, so a ratio of 100 runs as 5 x 5 x 4
+ * with short filters instead of one very long filter. A stage only runs its
+ * taps for the samples it keeps (fir_filter::decimate), and a stage only
+ * sees the output of the stage before it, so the cost per input frame is
+ * roughly taps * (1 + 1/M1 + 1/(M1*M2) + ...) per axis and rate.
+ *
+ * The lowpass cutoff of a stage is cutoff_fraction times its output Nyquist
+ * frequency, the band above that up to the Nyquist is the transition band.
+ * A stage with a ratio above EIDSP_DECIMATOR_MAX_STAGE_RATIO (a remaining
+ * prime factor) gets proportionally more taps to keep that transition band,
+ * a ratio that would need more than 255 taps is rejected.
+ */
+class multirate_decimator {
+public:
+    multirate_decimator()
+        : _initialized(false), _axes(0), _sampling_frequency(0.0f)
+    {
+    }
+
+    /**
+     * Design the filters for every output rate
+     * @param sampling_frequency Input sample rate (Hz)
+     * @param axes Values per frame
+     * @param ratios Decimation ratio of every output (1 passes the input through)
+     * @param rate_count Number of outputs
+     * @param filter_size Taps per stage (odd, max. 255), scaled up for a stage above the max. stage ratio
+     * @param cutoff_fraction Lowpass cutoff relative to the output Nyquist (0..1)
+     * @returns EIDSP_OK if OK, EIDSP_PARAMETER_INVALID if a stage would need more than 255 taps
+     */
+    int init(
+        float sampling_frequency,
+        size_t axes,
+        const uint16_t *ratios,
+        size_t rate_count,
+        uint8_t filter_size = 31,
+        float cutoff_fraction = 0.8f)
+    {
+        release();
+
+        if (sampling_frequency <= 0.0f || axes == 0 || rate_count == 0 ||
+            filter_size < 3 || cutoff_fraction <= 0.0f || cutoff_fraction > 1.0f) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        _axes = axes;
+        _sampling_frequency = sampling_frequency;
+        _scratch.resize(axes);
+        _rates.resize(rate_count);
+
+        for (size_t rate_ix = 0; rate_ix < rate_count; rate_ix++) {
+            if (ratios[rate_ix] == 0) {
+                release();
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+            }
+
+            rate_t &rate = _rates[rate_ix];
+            rate.ratio = ratios[rate_ix];
+
+            float stage_frequency = sampling_frequency;
+            uint16_t remaining = ratios[rate_ix];
+            while (remaining > 1) {
+                int stage_ratio = stage_ratio_for(remaining);
+                float cutoff = cutoff_fraction * stage_frequency / (2.0f * stage_ratio);
+                int stage_size = stage_size_for(filter_size, stage_ratio);
+                if (stage_size > 255) {
+                    release();
+                    EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+                }
+
+                rate.stages.push_back(stage_t());
+                stage_t &stage = rate.stages.back();
+                stage.reserve(axes);
+                for (size_t axis = 0; axis < axes; axis++) {
+                    stage.push_back(filter_t(stage_frequency, (uint8_t)stage_size, cutoff, 0, stage_ratio));
+                }
+
+                stage_frequency /= stage_ratio;
+                remaining /= stage_ratio;
+            }
+        }
+
+        _initialized = true;
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Free the filters
+     */
+    void release() {
+        _rates.clear();
+        _scratch.clear();
+        _initialized = false;
+    }
+
+    /**
+     * Clear the filter history of all outputs, e.g. after a gap in the data
+     */
+    void reset() {
+        for (size_t rate_ix = 0; rate_ix < _rates.size(); rate_ix++) {
+            for (size_t stage_ix = 0; stage_ix < _rates[rate_ix].stages.size(); stage_ix++) {
+                stage_t &stage = _rates[rate_ix].stages[stage_ix];
+                for (size_t axis = 0; axis < stage.size(); axis++) {
+                    stage[axis].reset();
+                }
+            }
+        }
+    }
+
+    /**
+     * Filter and decimate a block of frames into every output. Can be called
+     * with any number of frames, the phase of every stage is kept across calls.
+     * @param src Interleaved input, frames * axes values
+     * @param frames Number of input frames
+     * @param dest One buffer per output, room for get_max_output_frames(frames) * axes values.
+     *             NULL skips the output (its filters keep running).
+     * @param out_frames Out parameter, number of frames written to every output
+     * @returns EIDSP_OK if OK
+     */
+    int process(const EIDSP_i16 *src, size_t frames, EIDSP_i16 **dest, size_t *out_frames)
+    {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        for (size_t rate_ix = 0; rate_ix < _rates.size(); rate_ix++) {
+            rate_t &rate = _rates[rate_ix];
+            EIDSP_i16 *out = dest ? dest[rate_ix] : NULL;
+            size_t out_count = 0;
+
+            if (rate.stages.size() == 0) {
+                if (out) {
+                    memcpy(out, src, frames * _axes * sizeof(EIDSP_i16));
+                }
+                out_frames[rate_ix] = frames;
+                continue;
+            }
+
+            stage_t &first = rate.stages[0];
+
+            for (size_t frame = 0; frame < frames; frame++) {
+                // all axes of a stage share the phase, so one count is enough
+                size_t kept = 0;
+                for (size_t axis = 0; axis < _axes; axis++) {
+                    kept = first[axis].decimate(&src[frame * _axes + axis], &_scratch[axis], 1);
+                }
+
+                for (size_t stage_ix = 1; kept && stage_ix < rate.stages.size(); stage_ix++) {
+                    stage_t &stage = rate.stages[stage_ix];
+                    for (size_t axis = 0; axis < _axes; axis++) {
+                        kept = stage[axis].decimate(&_scratch[axis], &_scratch[axis], 1);
+                    }
+                }
+
+                if (kept) {
+                    if (out) {
+                        memcpy(&out[out_count * _axes], _scratch.data(), _axes * sizeof(EIDSP_i16));
+                    }
+                    out_count++;
+                }
+            }
+
+            out_frames[rate_ix] = out_count;
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Upper bound of frames an output produces for a block of input frames
+     */
+    size_t get_max_output_frames(size_t frames, size_t rate_ix) const {
+        if (rate_ix >= _rates.size()) {
+            return 0;
+        }
+        uint16_t ratio = _rates[rate_ix].ratio;
+        return (frames + ratio - 1) / ratio;
+    }
+
+    /**
+     * Sample rate of an output (Hz)
+     */
+    float get_output_frequency(size_t rate_ix) const {
+        if (rate_ix >= _rates.size()) {
+            return 0.0f;
+        }
+        return _sampling_frequency / _rates[rate_ix].ratio;
+    }
+
+    size_t get_rate_count() const {
+        return _rates.size();
+    }
+
+    /**
+     * Number of FIR stages an output runs as
+     */
+    size_t get_stage_count(size_t rate_ix) const {
+        if (rate_ix >= _rates.size()) {
+            return 0;
+        }
+        return _rates[rate_ix].stages.size();
+    }
+
+private:
+    typedef fir_filter<EIDSP_i16, int64_t> filter_t;
+    // one filter per axis
+    typedef std::vector<filter_t> stage_t;
+
+    typedef struct {
+        uint16_t ratio;
+        std::vector<stage_t> stages;
+    } rate_t;
+
+    /**
+     * Ratio of the next stage, largest divisor of the remaining ratio that
+     * fits in one stage. A remaining ratio without such a divisor (a large
+     * prime) runs as a single stage, see stage_size_for.
+     */
+    static int stage_ratio_for(uint16_t remaining) {
+        for (int ratio = EIDSP_DECIMATOR_MAX_STAGE_RATIO; ratio > 1; ratio--) {
+            if (remaining % ratio == 0) {
+                return ratio;
+            }
+        }
+        return remaining;
+    }
+
+    /**
+     * Taps of a stage. The transition band of a windowed sinc narrows with
+     * the number of taps, so a stage above the max. stage ratio scales
+     * filter_size up with its ratio (rounded up to odd).
+     */
+    static int stage_size_for(uint8_t filter_size, int stage_ratio) {
+        if (stage_ratio <= EIDSP_DECIMATOR_MAX_STAGE_RATIO) {
+            return filter_size;
+        }
+        int size = (filter_size * stage_ratio + EIDSP_DECIMATOR_MAX_STAGE_RATIO - 1) / EIDSP_DECIMATOR_MAX_STAGE_RATIO;
+        return size | 1;
+    }
+
+    bool _initialized;
+    size_t _axes;
+    float _sampling_frequency;
+    std::vector<rate_t> _rates;
+    std::vector<EIDSP_i16> _scratch;
+};
+
+} // namespace spectral
+} // namespace ei
+
+#endif // _EIDSP_SPECTRAL_DECIMATOR_H_
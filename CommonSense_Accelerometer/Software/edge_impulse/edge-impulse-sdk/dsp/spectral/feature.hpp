@@ -26,6 +26,8 @@
 #include <vector>
 #include <stdint.h>
 #include "processing.hpp"
+#include "wavelet.hpp"
+#include "../ei_profiler.h"
 
 namespace ei {
 namespace spectral {
@@ -51,6 +53,8 @@ public:
      * @param fft_peaks Number of FFT peaks to find
      * @param fft_peaks_threshold Minimum threshold
      * @param edges_matrix Spectral power edges
+     * @param bands Bin ranges of the edges for this sampling_freq and fft_length
+     *  (processing::spectral_power_bands_init), NULL to calculate them here
      * @returns 0 if OK
      */
     static int spectral_analysis(
@@ -63,7 +67,8 @@ public:
         uint16_t fft_length,
         uint8_t fft_peaks,
         float fft_peaks_threshold,
-        matrix_t *edges_matrix_in
+        matrix_t *edges_matrix_in,
+        const processing::spectral_band_t *bands = NULL
     ) {
         if (out_features->rows != input_matrix->rows) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
@@ -95,6 +100,7 @@ public:
         }
 
         // apply filter
+        EI_PROFILE_START(filter_prof, "dsp.filter");
         if (filter_type == filter_lowpass) {
             ret = spectral::processing::butterworth_lowpass_filter(
                 input_matrix, sampling_freq, filter_cutoff, filter_order);
@@ -109,6 +115,7 @@ public:
                 EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
             }
         }
+        EI_PROFILE_STOP(filter_prof);
 
         // calculate RMS
         EI_DSP_MATRIX(rms_matrix, axes, 1);
@@ -120,6 +127,21 @@ public:
         // find peaks in FFT
         EI_DSP_MATRIX(peaks_matrix, axes, fft_peaks * 2);
 
+        // bins per spectral power band, the same for every axis
+        std::vector<processing::spectral_band_t> local_bands;
+        if (!bands && edges_matrix_in->rows > 1) {
+            local_bands.resize(edges_matrix_in->rows - 1);
+            ret = spectral::processing::spectral_power_bands_init(sampling_freq, fft_length,
+                edges_matrix_in->buffer, edges_matrix_in->rows, local_bands.data());
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+            bands = local_bands.data();
+        }
+
+        // FFT input and output, shared by the FFT and the periodogram of every axis
+        EI_DSP_MATRIX(fft_scratch, 1, numpy::rfft_scratch_size(fft_length));
+
         for (size_t row = 0; row < input_matrix->rows; row++) {
             // per axis code
 
@@ -128,41 +150,50 @@ public:
 
             // calculate FFT
             EI_DSP_MATRIX(fft_matrix, 1, fft_length / 2 + 1);
-            ret = numpy::rfft(axis_matrix.buffer, axis_matrix.cols, fft_matrix.buffer, fft_matrix.cols, fft_length);
+            EI_PROFILE_START(fft_prof, "dsp.fft");
+            ret = numpy::rfft(axis_matrix.buffer, axis_matrix.cols, fft_matrix.buffer, fft_matrix.cols, fft_length,
+                fft_scratch.buffer);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
             }
 
             // multiply by 2/N
             numpy::scale(&fft_matrix, (2.0f / static_cast<float>(fft_length)));
+            EI_PROFILE_STOP(fft_prof);
 
             // we're now using the FFT matrix to calculate peaks etc.
             EI_DSP_MATRIX(peaks_matrix, fft_peaks, 2);
+            EI_PROFILE_START(peaks_prof, "dsp.peaks");
             ret = spectral::processing::find_fft_peaks(&fft_matrix, &peaks_matrix,
                 sampling_freq, fft_peaks_threshold, fft_length);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
             }
+            EI_PROFILE_STOP(peaks_prof);
 
             // calculate periodogram for spectral power buckets
             EI_DSP_MATRIX(period_fft_matrix, 1, fft_length / 2 + 1);
             EI_DSP_MATRIX(period_freq_matrix, 1, fft_length / 2 + 1);
+            EI_PROFILE_START(periodogram_prof, "dsp.periodogram");
             ret = spectral::processing::periodogram(&axis_matrix,
-                &period_fft_matrix, &period_freq_matrix, sampling_freq, fft_length);
+                &period_fft_matrix, &period_freq_matrix, sampling_freq, fft_length, fft_scratch.buffer);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
+            EI_PROFILE_STOP(periodogram_prof);
 
             EI_DSP_MATRIX(edges_matrix_out, edges_matrix_in->rows - 1, 1);
-            ret = spectral::processing::spectral_power_edges(
-                &period_fft_matrix,
-                &period_freq_matrix,
-                edges_matrix_in,
-                &edges_matrix_out,
-                sampling_freq);
+            EI_PROFILE_START(edges_prof, "dsp.edges");
+            ret = spectral::processing::spectral_power_bands(
+                period_fft_matrix.buffer,
+                period_fft_matrix.cols,
+                bands,
+                edges_matrix_out.rows,
+                edges_matrix_out.buffer);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
+            EI_PROFILE_STOP(edges_prof);
 
             float *features_row = out_features->buffer + (row * out_features->cols);
 
@@ -258,6 +289,9 @@ public:
         EI_DSP_i16_MATRIX(period_freq_matrix, 1, fft_length / 2 + 1);
         EI_DSP_i16_MATRIX(edges_matrix_out, edges_matrix_in->rows - 1, 1);
 
+        // bins per spectral power band, mapped on the first axis (q15 frequencies)
+        std::vector<processing::spectral_band_t> bands(edges_matrix_out.rows);
+
         for (size_t row = 0; row < input_matrix->rows; row++) {
             // per axis code
 
@@ -291,13 +325,21 @@ public:
                 EIDSP_ERR(ret);
             }
 
-            // EI_DSP_i16_MATRIX(edges_matrix_out, edges_matrix_in->rows - 1, 1);
-            ret = spectral::processing::spectral_power_edges(
-                &period_fft_matrix,
-                &period_freq_matrix,
-                edges_matrix_in,
-                &edges_matrix_out,
-                sampling_freq);
+            if (row == 0) {
+                ret = spectral::processing::spectral_power_bands_init(
+                    period_freq_matrix.buffer, period_freq_matrix.cols,
+                    edges_matrix_in->buffer, edges_matrix_in->rows, bands.data());
+                if (ret != EIDSP_OK) {
+                    EIDSP_ERR(ret);
+                }
+            }
+
+            ret = spectral::processing::spectral_power_bands(
+                period_fft_matrix.buffer,
+                period_fft_matrix.cols,
+                bands.data(),
+                edges_matrix_out.rows,
+                edges_matrix_out.buffer);
             if (ret != EIDSP_OK) {
                 EIDSP_ERR(ret);
             }
@@ -315,13 +357,284 @@ public:
             }
 
             for (size_t edge_row = 0; edge_row < edges_matrix_out.rows; edge_row++) {
-                features_row[fx] = (EIDSP_i16)(edges_matrix_out.buffer[edge_row * edges_matrix_out.cols] >> 16);
+                // q15 band power, / 10 like the float version
+                features_row[fx++] = edges_matrix_out.buffer[edge_row * edges_matrix_out.cols] / 10;
             }
         }
 
         return EIDSP_OK;
     }
 
+    /**
+     * Envelope (demodulation) spectrum, early bearing faults show up as a
+     * modulation of a high frequency resonance rather than as a line in the
+     * raw spectrum. Per axis: remove the mean, band-pass around the resonance,
+     * full-wave rectify, low-pass and decimate to the envelope rate, then an
+     * FFT of the envelope. The FFT runs at 1 / decimation of the input rate.
+     * This modifies the input matrix in place.
+     * @param out_features Output matrix, one row per axis, fft_length / 2 + 1
+     *  envelope amplitudes (2/N scaled, like spectral_analysis)
+     * @param input_matrix Signal, with one row per axis
+     * @param sampling_freq Sampling frequency of the signal
+     * @param band_low Lower edge of the band-pass (Hz), 0 for none
+     * @param band_high Upper edge of the band-pass (Hz), 0 for none
+     * @param filter_order Order of the band-pass and envelope filters
+     * @param envelope_max_freq Highest fault frequency of interest (Hz),
+     *  the envelope is sampled at ~2.56x this frequency
+     * @param fft_length Length of the envelope FFT
+     * @param envelope_freq Out parameter with the envelope sampling frequency,
+     *  bin k is at k * envelope_freq / fft_length (may be NULL)
+     * @returns 0 if OK
+     */
+    static int envelope_analysis(
+        matrix_t *out_features,
+        matrix_t *input_matrix,
+        float sampling_freq,
+        float band_low,
+        float band_high,
+        uint8_t filter_order,
+        float envelope_max_freq,
+        uint16_t fft_length,
+        float *envelope_freq
+    ) {
+        if (out_features->rows != input_matrix->rows) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (out_features->cols != calculate_envelope_buffer_size(fft_length)) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (envelope_max_freq <= 0.0f || band_high >= sampling_freq / 2.0f ||
+            (band_high > 0.0f && band_low >= band_high)) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        int ret;
+
+        size_t decimation = static_cast<size_t>(sampling_freq / (2.56f * envelope_max_freq));
+        if (decimation < 1) {
+            decimation = 1;
+        }
+        size_t envelope_size = (input_matrix->cols + decimation - 1) / decimation;
+
+        if (envelope_freq) {
+            *envelope_freq = sampling_freq / decimation;
+        }
+
+        // remove the mean, otherwise the band-pass starts with a step
+        EI_DSP_MATRIX(mean_matrix, input_matrix->rows, 1);
+        ret = numpy::mean(input_matrix, &mean_matrix);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        ret = numpy::subtract(input_matrix, &mean_matrix);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        EI_DSP_MATRIX(fft_matrix, 1, fft_length / 2 + 1);
+        EI_DSP_MATRIX(fft_scratch, 1, numpy::rfft_scratch_size(fft_length));
+
+        for (size_t row = 0; row < input_matrix->rows; row++) {
+            float *axis = input_matrix->buffer + (row * input_matrix->cols);
+
+            EI_PROFILE_START(filter_prof, "dsp.envelope.filter");
+            if (band_low > 0.0f) {
+                filters::butterworth_highpass(filter_order, sampling_freq, band_low, axis, axis, input_matrix->cols);
+            }
+            if (band_high > 0.0f) {
+                filters::butterworth_lowpass(filter_order, sampling_freq, band_high, axis, axis, input_matrix->cols);
+            }
+
+            // demodulate
+            for (size_t ix = 0; ix < input_matrix->cols; ix++) {
+                axis[ix] = fabsf(axis[ix]);
+            }
+
+            // anti-alias, then keep every decimation'th sample at the start of the row
+            if (decimation > 1) {
+                filters::butterworth_lowpass(filter_order, sampling_freq, envelope_max_freq,
+                    axis, axis, input_matrix->cols);
+                for (size_t ix = 0; ix < envelope_size; ix++) {
+                    axis[ix] = axis[ix * decimation];
+                }
+            }
+            EI_PROFILE_STOP(filter_prof);
+
+            // the rectified signal has a large DC component
+            EI_DSP_MATRIX_B(envelope_matrix, 1, envelope_size, axis);
+            EI_DSP_MATRIX(envelope_mean, 1, 1);
+            ret = numpy::mean(&envelope_matrix, &envelope_mean);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+            ret = numpy::subtract(&envelope_matrix, &envelope_mean);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+
+            EI_PROFILE_START(fft_prof, "dsp.envelope.fft");
+            ret = numpy::rfft(axis, envelope_size, fft_matrix.buffer, fft_matrix.cols, fft_length, fft_scratch.buffer);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+            EI_PROFILE_STOP(fft_prof);
+
+            float *features_row = out_features->buffer + (row * out_features->cols);
+            float scale = 2.0f / static_cast<float>(fft_length);
+            for (size_t ix = 0; ix < fft_matrix.cols; ix++) {
+                features_row[ix] = fft_matrix.buffer[ix] * scale;
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Wavelet packet energies and entropies. Decomposes every axis into
+     * 2^depth nodes of equal bandwidth with the lifting scheme, in place, so
+     * this modifies the input matrix. Runs in O(N * depth), no FFT.
+     * Only the first multiple of 2^depth samples of every axis is used.
+     * @param out_features Output matrix, one row per axis: 2^depth node
+     *  energies (mean square, adds up to the mean square of the signal),
+     *  then 2^depth node entropies (Shannon, of the normalized coefficient
+     *  energies). Nodes in natural order.
+     * @param input_matrix Signal, with one row per axis
+     * @param type Wavelet
+     * @param depth Depth of the decomposition
+     * @returns 0 if OK
+     */
+    static int wavelet_packet_analysis(
+        matrix_t *out_features,
+        matrix_t *input_matrix,
+        wavelet_t type,
+        int depth
+    ) {
+        if (out_features->rows != input_matrix->rows) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (out_features->cols != calculate_wavelet_packet_buffer_size(depth)) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        const size_t nodes = 1 << depth;
+        const size_t length = (input_matrix->cols >> depth) << depth;
+
+        for (size_t row = 0; row < input_matrix->rows; row++) {
+            float *axis = input_matrix->buffer + (row * input_matrix->cols);
+
+            int ret = wavelet::packet_decompose(axis, length, depth, type);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+
+            float *features_row = out_features->buffer + (row * out_features->cols);
+            for (size_t node = 0; node < nodes; node++) {
+                const float *x = axis + wavelet::node_offset(node, depth);
+                float energy = 0.0f;
+                for (size_t k = 0; k < length / nodes; k++) {
+                    energy += x[k * nodes] * x[k * nodes];
+                }
+
+                features_row[node] = energy / length;
+                features_row[nodes + node] = wavelet::node_entropy(x, length / nodes, nodes, energy);
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Wavelet packet energies and entropies on a fixed point signal, see the
+     * float version. The decomposition runs with the reversible integer
+     * lifting scheme (haar and cdf53 only) on one axis at a time.
+     * @param out_features Output matrix, one row per axis, q15 values
+     * @param input_matrix Signal (q15), with one row per axis
+     * @param type Wavelet
+     * @param depth Depth of the decomposition
+     * @returns 0 if OK
+     */
+    static int wavelet_packet_analysis(
+        matrix_i32_t *out_features,
+        matrix_i16_t *input_matrix,
+        wavelet_t type,
+        int depth
+    ) {
+        if (out_features->rows != input_matrix->rows) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (out_features->cols != calculate_wavelet_packet_buffer_size(depth)) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        if (type == wavelet_db2) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        const size_t nodes = 1 << depth;
+        const size_t length = (input_matrix->cols >> depth) << depth;
+
+        // details grow by up to 2x per level, so the transform runs on 32 bits
+        EI_DSP_i32_MATRIX(axis, 1, input_matrix->cols);
+
+        for (size_t row = 0; row < input_matrix->rows; row++) {
+            const EIDSP_i16 *in = input_matrix->buffer + (row * input_matrix->cols);
+            for (size_t ix = 0; ix < length; ix++) {
+                axis.buffer[ix] = in[ix];
+            }
+
+            int ret = wavelet::packet_decompose(axis.buffer, length, depth, type);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+
+            EIDSP_i32 *features_row = out_features->buffer + (row * out_features->cols);
+            for (size_t node = 0; node < nodes; node++) {
+                const EIDSP_i32 *x = axis.buffer + wavelet::node_offset(node, depth);
+                int64_t energy = 0;
+                for (size_t k = 0; k < length / nodes; k++) {
+                    energy += (int64_t)x[k * nodes] * x[k * nodes];
+                }
+
+                // back to the orthonormal scale: x2 per approximation, /2 per detail step
+                int details = wavelet::node_detail_steps(node, depth);
+                int shift = depth - 2 * details;
+                int64_t scaled = shift >= 0 ? energy << shift : energy >> -shift;
+
+                // q30 sum of squares to q15 mean square
+                scaled = ((scaled / (int64_t)length) + (1 << 14)) >> 15;
+                features_row[node] = scaled > INT32_MAX ? INT32_MAX : (EIDSP_i32)scaled;
+
+                float entropy = wavelet::node_entropy(x, length / nodes, nodes, (float)energy);
+                features_row[nodes + node] = (EIDSP_i32)(entropy * 32768.0f + 0.5f);
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Calculate the buffer size (per axis) for Wavelet Packet Analysis
+     * @param depth: Depth of the decomposition
+     */
+    static size_t calculate_wavelet_packet_buffer_size(int depth)
+    {
+        return 2 << depth;
+    }
+
+    /**
+     * Calculate the buffer size (per axis) for Envelope Analysis
+     * @param fft_length: Length of the envelope FFT
+     */
+    static size_t calculate_envelope_buffer_size(uint16_t fft_length)
+    {
+        return fft_length / 2 + 1;
+    }
+
     /**
      * Calculate the buffer size for Spectral Analysis
      * @param rms: Whether to calculate the RMS as part of the features
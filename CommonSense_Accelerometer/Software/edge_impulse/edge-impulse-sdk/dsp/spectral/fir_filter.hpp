@@ -110,6 +110,7 @@ public:
         int decimation_ratio = 1) :  taps(filter_size) , history(filter_size, 0)
     {
         this->filter_size = filter_size;
+        this->decimation_ratio = decimation_ratio < 1 ? 1 : decimation_ratio;
         std::vector<float> f_taps(filter_size, 0);
         if( highpass_cutoff == 0 && lowpass_cutoff == 0 ) 
         {
@@ -159,40 +160,49 @@ public:
         for (size_t i = 0; i < size; i++)
         {
             history[write_index] = src[i];
-            int read_index = write_index;
-            //minus one b/c of the sign bit
-            int shift = (sizeof(input_t) * 8) - 1;
-            //stuff a 1 into one less than we're going to shift to effectively round
-            //this is essentially resetting the accumulator back to zero otherwise
-            acc_t accumulator = 1 << (shift - 1);
-            for (auto tap : taps)
-            {
-                accumulator += static_cast<acc_t>(tap) * history[read_index];
-                //wrap the read index
-                read_index = read_index == 0 ? filter_size - 1 : read_index - 1;
-            }
-            //wrap the write index
-            write_index++;
-            if (write_index == filter_size)
-            {
-                write_index = 0;
-            }
+            dest[i] = convolve();
+            advance_write_index();
+        }
+    }
 
-            accumulator >>= shift;
-            //saturate if overflow
-            if (accumulator > std::numeric_limits<input_t>::max())
-            {
-                dest[i] = std::numeric_limits<input_t>::max();
-            }
-            else if (accumulator < std::numeric_limits<input_t>::min())
+/**
+ * @brief Filter and downsample by the decimation ratio passed to the constructor.
+ * Every input sample goes into the history, but the taps are only run for
+ * every decimation_ratio-th sample, so the cost is 1/decimation_ratio of
+ * apply_filter followed by dropping samples. Can be called blockwise, the
+ * decimation phase is kept across calls (reset() starts over).
+ *
+ * @param src Source array
+ * @param dest Output array, at least ceil(size / decimation_ratio) values (times stride).
+ * Can be the same as source for in place
+ * @param size Number of input samples to process
+ * @param stride Distance between samples in src and dest, e.g. the number of axes
+ * to filter one axis of interleaved frames
+ * @return size_t Number of samples written to dest
+ */
+    size_t decimate(
+        const input_t *src,
+        input_t *dest,
+        size_t size,
+        size_t stride = 1)
+    {
+        size_t out_count = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            history[write_index] = src[i * stride];
+            if (phase == 0)
             {
-                dest[i] = std::numeric_limits<input_t>::min();
+                dest[out_count * stride] = convolve();
+                out_count++;
             }
-            else
+            advance_write_index();
+            phase++;
+            if (phase == decimation_ratio)
             {
-                dest[i] = accumulator;
+                phase = 0;
             }
         }
+        return out_count;
     }
 
     /**
@@ -203,13 +213,62 @@ public:
     void reset()
     {
         std::fill(history.begin(), history.end(), 0);
+        phase = 0;
+    }
+
+    int get_decimation_ratio() const
+    {
+        return decimation_ratio;
     }
 
 private:
+    /**
+     * @brief Run the taps over the history, newest sample at write_index
+     */
+    input_t convolve()
+    {
+        int read_index = write_index;
+        //minus one b/c of the sign bit
+        int shift = (sizeof(input_t) * 8) - 1;
+        //stuff a 1 into one less than we're going to shift to effectively round
+        //this is essentially resetting the accumulator back to zero otherwise
+        acc_t accumulator = 1 << (shift - 1);
+        for (auto tap : taps)
+        {
+            accumulator += static_cast<acc_t>(tap) * history[read_index];
+            //wrap the read index
+            read_index = read_index == 0 ? filter_size - 1 : read_index - 1;
+        }
+
+        accumulator >>= shift;
+        //saturate if overflow
+        if (accumulator > std::numeric_limits<input_t>::max())
+        {
+            return std::numeric_limits<input_t>::max();
+        }
+        else if (accumulator < std::numeric_limits<input_t>::min())
+        {
+            return std::numeric_limits<input_t>::min();
+        }
+        return accumulator;
+    }
+
+    void advance_write_index()
+    {
+        //wrap the write index
+        write_index++;
+        if (write_index == filter_size)
+        {
+            write_index = 0;
+        }
+    }
+
     std::vector<input_t> taps;
     std::vector<input_t> history;
     int write_index = 0;
     int filter_size;
+    int decimation_ratio = 1;
+    int phase = 0;
 
     friend class AccelerometerQuantizedTestCase;
 
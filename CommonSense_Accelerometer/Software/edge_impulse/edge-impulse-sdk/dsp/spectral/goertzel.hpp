@@ -0,0 +1,233 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPECTRAL_GOERTZEL_H_
+#define _EIDSP_SPECTRAL_GOERTZEL_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../numpy.hpp"
+#include "../memory.hpp"
+
+namespace ei {
+namespace spectral {
+
+/**
+ * Bank of Goertzel filters, evaluates the spectrum of every axis at a few
+ * arbitrary frequencies (e.g. shaft 1x / 2x and bearing fault frequencies).
+ *
+ * Samples are pushed one frame at a time, as they arrive from the sampler,
+ * at a cost of one multiply and two adds per frequency and axis. No sample
+ * or FFT buffers are kept. The frequencies do not need to be aligned to a
+ * bin, the result is the DTFT of the window at that frequency. A Hann window
+ * of window_length samples can be applied on the fly to reduce leakage of
+ * strong neighbouring components.
+ *
+ * magnitudes() returns the amplitude of a sine at the frequency, the same
+ * scale as the FFT peaks of spectral_analysis for a bin-aligned sine.
+ */
+class goertzel_bank {
+public:
+    goertzel_bank()
+        : _initialized(false), _frequency_count(0), _axes(0), _coeffs(NULL), _state(NULL)
+    {
+    }
+
+    ~goertzel_bank() {
+        release();
+    }
+
+    /**
+     * Allocate the filter states and calculate the coefficients
+     * @param frequencies Frequencies to evaluate (Hz)
+     * @param frequency_count Number of frequencies
+     * @param axes Values per frame
+     * @param sampling_freq Sampling frequency (Hz)
+     * @param window_length Samples per window, used for the Hann window
+     * @param hann_window Apply a Hann window, otherwise rectangular
+     * @returns EIDSP_OK if OK
+     */
+    int init(const float *frequencies, size_t frequency_count, size_t axes,
+        float sampling_freq, size_t window_length, bool hann_window)
+    {
+        release();
+
+        if (frequency_count == 0 || axes == 0 || sampling_freq <= 0.0f || window_length == 0) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        for (size_t ix = 0; ix < frequency_count; ix++) {
+            if (frequencies[ix] < 0.0f || frequencies[ix] > sampling_freq / 2.0f) {
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+            }
+        }
+
+        _frequency_count = frequency_count;
+        _axes = axes;
+        _window_length = window_length;
+        _hann_window = hann_window;
+
+        _coeffs = (float*)ei_dsp_calloc(_frequency_count * sizeof(float), 1);
+        _state = (float*)ei_dsp_calloc(_frequency_count * _axes * 2 * sizeof(float), 1);
+        if (!_coeffs || !_state) {
+            release();
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        for (size_t ix = 0; ix < _frequency_count; ix++) {
+            _coeffs[ix] = 2.0f * cosf(2.0f * (float)M_PI * frequencies[ix] / sampling_freq);
+        }
+
+        // window phase step, the window is generated with a rotating phasor
+        _window_cos_step = cosf(2.0f * (float)M_PI / _window_length);
+        _window_sin_step = sinf(2.0f * (float)M_PI / _window_length);
+
+        _initialized = true;
+        reset();
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Free all buffers
+     */
+    void release() {
+        if (_coeffs) {
+            ei_dsp_free(_coeffs, _frequency_count * sizeof(float));
+        }
+        if (_state) {
+            ei_dsp_free(_state, _frequency_count * _axes * 2 * sizeof(float));
+        }
+        _coeffs = NULL;
+        _state = NULL;
+        _initialized = false;
+    }
+
+    /**
+     * Start a new window
+     */
+    void reset() {
+        if (!_initialized) {
+            return;
+        }
+        memset(_state, 0, _frequency_count * _axes * 2 * sizeof(float));
+        _samples = 0;
+        _window_sum = 0.0f;
+        _window_cos = 1.0f;
+        _window_sin = 0.0f;
+    }
+
+    /**
+     * Add one frame
+     * @param frame One value per axis
+     * @param scale Multiplied with every value
+     * @returns EIDSP_OK if OK
+     */
+    int push_frame(const float *frame, float scale = 1.0f) {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        float weight = scale;
+        if (_hann_window) {
+            weight *= 0.5f - 0.5f * _window_cos;
+            _window_sum += 0.5f - 0.5f * _window_cos;
+
+            float next_cos = _window_cos * _window_cos_step - _window_sin * _window_sin_step;
+            _window_sin = _window_sin * _window_cos_step + _window_cos * _window_sin_step;
+            _window_cos = next_cos;
+        }
+        else {
+            _window_sum += 1.0f;
+        }
+
+        float *state = _state;
+        for (size_t axis = 0; axis < _axes; axis++) {
+            float x = frame[axis] * weight;
+            for (size_t ix = 0; ix < _frequency_count; ix++) {
+                float s = x + _coeffs[ix] * state[0] - state[1];
+                state[1] = state[0];
+                state[0] = s;
+                state += 2;
+            }
+        }
+
+        _samples++;
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Amplitude at every frequency, for every axis
+     * @param output Matrix of (axes x frequency_count)
+     * @returns EIDSP_OK if OK
+     */
+    int magnitudes(matrix_t *output) const {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        if (output->rows * output->cols != _axes * _frequency_count) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        // coherent gain of the window, a sine of amplitude A gives A
+        float scale = _window_sum > 0.0f ? 2.0f / _window_sum : 0.0f;
+
+        const float *state = _state;
+        for (size_t ix = 0; ix < _axes * _frequency_count; ix++) {
+            float coeff = _coeffs[ix % _frequency_count];
+            float power = state[0] * state[0] + state[1] * state[1] - coeff * state[0] * state[1];
+            output->buffer[ix] = power > 0.0f ? sqrtf(power) * scale : 0.0f;
+            state += 2;
+        }
+
+        return EIDSP_OK;
+    }
+
+    size_t get_samples() const {
+        return _samples;
+    }
+
+private:
+    bool _initialized;
+    size_t _frequency_count;
+    size_t _axes;
+    size_t _window_length;
+    bool _hann_window;
+    size_t _samples;
+    float _window_sum;
+    float _window_cos;
+    float _window_sin;
+    float _window_cos_step;
+    float _window_sin_step;
+
+    float *_coeffs;
+    /** Two delay elements per frequency and axis, axis major */
+    float *_state;
+};
+
+} // namespace spectral
+} // namespace ei
+
+#endif // _EIDSP_SPECTRAL_GOERTZEL_H_
@@ -0,0 +1,444 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPECTRAL_ORDER_TRACKING_H_
+#define _EIDSP_SPECTRAL_ORDER_TRACKING_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../numpy.hpp"
+#include "../memory.hpp"
+
+namespace ei {
+namespace spectral {
+
+typedef struct {
+    /** Sample rate of the vibration and reference signals (Hz) */
+    float sampling_freq;
+    /** Values per vibration frame */
+    uint16_t axes;
+    /** Output samples per shaft revolution */
+    uint16_t samples_per_revolution;
+    /** Reference cycles per revolution, e.g. 1 for a magnet on the shaft */
+    float pulses_per_revolution;
+    /** Speeds outside this range are rejected, below min_rpm the shaft is stopped */
+    float min_rpm;
+    float max_rpm;
+    /** Weight of a new period in the speed estimate (0..1], 1 disables smoothing */
+    float speed_smoothing;
+    /** Schmitt trigger threshold on the reference, in reference units around its mean */
+    float hysteresis;
+} order_tracker_config_t;
+
+/**
+ * Computed order tracking. Resamples the vibration stream from constant time
+ * to constant angle increments, so a fault at a multiple of the shaft speed
+ * stays in the same bin while the machine speeds up or slows down.
+ *
+ * The shaft speed comes from a tachometer-like reference, e.g. one axis of
+ * the magnetometer next to a magnet on the shaft: push_reference() removes
+ * the mean, finds rising crossings with a Schmitt trigger and turns the
+ * interpolated period into a smoothed speed. Alternatively set_rpm() takes
+ * the speed from elsewhere, e.g. the dominant line of a psd_accumulator.
+ *
+ * push() integrates the shaft angle at the current speed and emits a frame
+ * every 1 / samples_per_revolution revolution, interpolated (Catmull-Rom)
+ * from the last four input frames, which is the only history kept. Output
+ * lags the input by one frame. When the speed is unknown no frames are
+ * emitted.
+ *
+ * The output rate follows the speed, so the input first goes through a
+ * low-pass that follows it too: a Butterworth of ANTI_ALIAS_SECTIONS second
+ * order sections with its cutoff at ANTI_ALIAS_CUTOFF of the output Nyquist
+ * frequency (rps * samples_per_revolution / 2), redesigned whenever the speed
+ * estimate changes. Until the speed is known it is designed for max_rpm.
+ * When the output rate is above the input rate there is nothing to alias
+ * and the filter is bypassed.
+ *
+ * Windows built from the output can go into spectral_analysis with
+ * samples_per_revolution as the sampling frequency, the bins are then in
+ * orders (multiples of the shaft speed) instead of Hz.
+ */
+class order_tracker {
+public:
+    order_tracker()
+        : _initialized(false), _history(NULL), _filter_state(NULL)
+    {
+        memset(&_config, 0, sizeof(_config));
+    }
+
+    ~order_tracker() {
+        release();
+    }
+
+    /**
+     * Allocate the interpolation history and the anti-alias filter state
+     * @param config Configuration, copied
+     * @returns EIDSP_OK if OK
+     */
+    int init(const order_tracker_config_t *config) {
+        release();
+
+        if (config->sampling_freq <= 0.0f || config->axes == 0 ||
+            config->samples_per_revolution == 0 || config->pulses_per_revolution <= 0.0f ||
+            config->min_rpm <= 0.0f || config->max_rpm <= config->min_rpm ||
+            config->speed_smoothing <= 0.0f || config->speed_smoothing > 1.0f ||
+            config->hysteresis < 0.0f) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        _config = *config;
+
+        _history = (float*)ei_dsp_calloc(HISTORY_FRAMES * _config.axes * sizeof(float), 1);
+        _filter_state = (float*)ei_dsp_calloc(FILTER_STATE_SIZE * _config.axes * sizeof(float), 1);
+        if (!_history || !_filter_state) {
+            release();
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        // the mean of the reference is tracked well below its slowest frequency
+        float slowest = _config.min_rpm / 60.0f * _config.pulses_per_revolution;
+        _dc_alpha = 1.0f - expf(-2.0f * (float)M_PI * (slowest / 4.0f) / _config.sampling_freq);
+
+        // longest valid period (in samples) before the shaft counts as stopped
+        _max_period = _config.sampling_freq / slowest;
+        _min_period = _config.sampling_freq / (_config.max_rpm / 60.0f * _config.pulses_per_revolution);
+
+        _initialized = true;
+        reset();
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Free all buffers
+     */
+    void release() {
+        if (_history) {
+            ei_dsp_free(_history, HISTORY_FRAMES * _config.axes * sizeof(float));
+        }
+        if (_filter_state) {
+            ei_dsp_free(_filter_state, FILTER_STATE_SIZE * _config.axes * sizeof(float));
+        }
+        _history = NULL;
+        _filter_state = NULL;
+        _initialized = false;
+    }
+
+    /**
+     * Forget the speed and the history, e.g. after a gap in the data
+     */
+    void reset() {
+        if (!_initialized) {
+            return;
+        }
+        memset(_history, 0, HISTORY_FRAMES * _config.axes * sizeof(float));
+        memset(_position, 0, sizeof(_position));
+        _history_frames = 0;
+        _next_output = 0.0f;
+
+        _rps = 0.0f;
+        _reference_mean = 0.0f;
+        _reference_prev = 0.0f;
+        _reference_samples = 0;
+        _reference_high = false;
+        _last_crossing = -1.0f;
+        _samples_since_crossing = 0.0f;
+
+        design_anti_alias(_config.max_rpm / 60.0f);
+    }
+
+    /**
+     * Add one sample of the reference signal, call once per vibration frame
+     * (before push()) at the same sample rate
+     * @param value Reference sample
+     */
+    void push_reference(float value) {
+        if (!_initialized) {
+            return;
+        }
+
+        if (_reference_samples == 0) {
+            _reference_mean = value;
+        }
+        _reference_samples++;
+        _reference_mean += _dc_alpha * (value - _reference_mean);
+        float v = value - _reference_mean;
+
+        _samples_since_crossing += 1.0f;
+
+        if (!_reference_high && v > _config.hysteresis) {
+            _reference_high = true;
+
+            // interpolate where the threshold was crossed within this sample
+            float frac = 1.0f;
+            if (v != _reference_prev) {
+                frac = (_config.hysteresis - _reference_prev) / (v - _reference_prev);
+                frac = frac < 0.0f ? 0.0f : (frac > 1.0f ? 1.0f : frac);
+            }
+            float crossing = _samples_since_crossing - 1.0f + frac;
+
+            if (_last_crossing >= 0.0f) {
+                float period = crossing - _last_crossing;
+                if (period >= _min_period && period <= _max_period) {
+                    float rps = _config.sampling_freq / period / _config.pulses_per_revolution;
+                    _rps = _rps > 0.0f ? _rps + _config.speed_smoothing * (rps - _rps) : rps;
+                }
+            }
+
+            // crossings are kept relative to the current sample
+            _samples_since_crossing -= crossing;
+            _last_crossing = 0.0f;
+        }
+        else if (_reference_high && v < -_config.hysteresis) {
+            _reference_high = false;
+        }
+
+        if (_samples_since_crossing > _max_period) {
+            // no crossing for longer than a revolution at min_rpm
+            _rps = 0.0f;
+            _last_crossing = -1.0f;
+            _samples_since_crossing = 0.0f;
+        }
+
+        _reference_prev = v;
+    }
+
+    /**
+     * Use a speed from another source instead of push_reference()
+     * @param rpm Shaft speed, 0 when stopped
+     */
+    void set_rpm(float rpm) {
+        if (rpm < _config.min_rpm || rpm > _config.max_rpm) {
+            _rps = 0.0f;
+        }
+        else {
+            _rps = rpm / 60.0f;
+        }
+    }
+
+    /**
+     * Current shaft speed, 0 if unknown
+     */
+    float get_rpm() const {
+        return _rps * 60.0f;
+    }
+
+    /**
+     * Upper bound of frames push() emits for one input frame (at max_rpm)
+     */
+    size_t get_max_output_frames() const {
+        float per_frame = _config.max_rpm / 60.0f * _config.samples_per_revolution / _config.sampling_freq;
+        return (size_t)ceilf(per_frame) + 1;
+    }
+
+    /**
+     * Add one vibration frame and emit the angular samples that are now due
+     * @param frame One value per axis
+     * @param output Room for get_max_output_frames() frames of axes values
+     * @param output_frames Out parameter, number of frames written to output
+     * @returns EIDSP_OK if OK
+     */
+    int push(const float *frame, float *output, size_t *output_frames) {
+        *output_frames = 0;
+
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        const size_t axes = _config.axes;
+
+        if (_rps > 0.0f && _rps != _filter_rps) {
+            design_anti_alias(_rps);
+        }
+        if (_history_frames == 0) {
+            prime_anti_alias(frame);
+        }
+
+        // shift the history, oldest frame first
+        memmove(_history, _history + axes, (HISTORY_FRAMES - 1) * axes * sizeof(float));
+        anti_alias(frame, _history + (HISTORY_FRAMES - 1) * axes);
+        for (size_t ix = 0; ix < HISTORY_FRAMES - 1; ix++) {
+            _position[ix] = _position[ix + 1];
+        }
+        _position[HISTORY_FRAMES - 1] = _position[HISTORY_FRAMES - 2] +
+            _rps * _config.samples_per_revolution / _config.sampling_freq;
+
+        // keep the positions small, only differences matter
+        float base = floorf(_position[0]);
+        for (size_t ix = 0; ix < HISTORY_FRAMES; ix++) {
+            _position[ix] -= base;
+        }
+        _next_output -= base;
+
+        if (_history_frames < HISTORY_FRAMES) {
+            _history_frames++;
+            if (_history_frames < HISTORY_FRAMES) {
+                return EIDSP_OK;
+            }
+            _next_output = ceilf(_position[1]);
+        }
+
+        // emit between the two middle frames
+        const float p1 = _position[1];
+        const float p2 = _position[2];
+        if (p2 <= p1) {
+            return EIDSP_OK;
+        }
+
+        if (_next_output < p1) {
+            // the speed was unknown for a while, restart on the next angle step
+            _next_output = ceilf(p1);
+        }
+
+        const size_t max_frames = get_max_output_frames();
+        const float *h0 = _history;
+        const float *h1 = _history + axes;
+        const float *h2 = _history + 2 * axes;
+        const float *h3 = _history + 3 * axes;
+
+        while (_next_output <= p2 && *output_frames < max_frames) {
+            float t = (_next_output - p1) / (p2 - p1);
+            float *out = output + *output_frames * axes;
+            for (size_t axis = 0; axis < axes; axis++) {
+                float a = h0[axis], b = h1[axis], c = h2[axis], d = h3[axis];
+                out[axis] = b + 0.5f * t * (c - a + t * (2.0f * a - 5.0f * b + 4.0f * c - d +
+                    t * (3.0f * (b - c) + d - a)));
+            }
+            (*output_frames)++;
+            _next_output += 1.0f;
+        }
+
+        return EIDSP_OK;
+    }
+
+private:
+    static const size_t HISTORY_FRAMES = 4;
+    /** 8th order anti-alias low-pass, cutoff relative to the output Nyquist */
+    static const size_t ANTI_ALIAS_SECTIONS = 4;
+    static constexpr float ANTI_ALIAS_CUTOFF = 0.8f;
+    /** Last two inputs and outputs of every section, per axis */
+    static const size_t FILTER_STATE_SIZE = ANTI_ALIAS_SECTIONS * 4;
+
+    /**
+     * Design the anti-alias low-pass for a shaft speed, with the sections of
+     * filters::butterworth_lowpass
+     * @param rps Shaft speed in revolutions per second
+     */
+    void design_anti_alias(float rps) {
+        float cutoff = ANTI_ALIAS_CUTOFF * rps * _config.samples_per_revolution / 2.0f;
+
+        _filter_rps = rps;
+        _filter_enabled = cutoff < 0.45f * _config.sampling_freq;
+        if (!_filter_enabled) {
+            return;
+        }
+
+        float a = tanf((float)M_PI * cutoff / _config.sampling_freq);
+        float a2 = a * a;
+        for (size_t ix = 0; ix < ANTI_ALIAS_SECTIONS; ix++) {
+            float r = sinf((float)M_PI * (2.0f * ix + 1.0f) / (4.0f * ANTI_ALIAS_SECTIONS));
+            float s = a2 + 2.0f * a * r + 1.0f;
+            _filter_a[ix] = a2 / s;
+            _filter_d1[ix] = 2.0f * (1.0f - a2) / s;
+            _filter_d2[ix] = -(a2 - 2.0f * a * r + 1.0f) / s;
+        }
+    }
+
+    /**
+     * Start the filter as if the first frame had always been there, so an
+     * offset (e.g. gravity) does not ring through the first revolutions
+     */
+    void prime_anti_alias(const float *frame) {
+        for (size_t axis = 0; axis < _config.axes; axis++) {
+            float *state = _filter_state + axis * FILTER_STATE_SIZE;
+            for (size_t ix = 0; ix < FILTER_STATE_SIZE; ix++) {
+                state[ix] = frame[axis];
+            }
+        }
+    }
+
+    /**
+     * Filter one frame. Direct form I, the state holds signal values and
+     * stays valid when the coefficients follow the speed.
+     */
+    void anti_alias(const float *frame, float *dest) {
+        if (!_filter_enabled) {
+            // the state follows the input, the filter can take over at any time
+            prime_anti_alias(frame);
+            memcpy(dest, frame, _config.axes * sizeof(float));
+            return;
+        }
+
+        for (size_t axis = 0; axis < _config.axes; axis++) {
+            float *state = _filter_state + axis * FILTER_STATE_SIZE;
+            float x = frame[axis];
+
+            for (size_t ix = 0; ix < ANTI_ALIAS_SECTIONS; ix++, state += 4) {
+                float y = _filter_a[ix] * (x + 2.0f * state[0] + state[1]) +
+                    _filter_d1[ix] * state[2] + _filter_d2[ix] * state[3];
+                state[1] = state[0];
+                state[0] = x;
+                state[3] = state[2];
+                state[2] = y;
+                x = y;
+            }
+
+            dest[axis] = x;
+        }
+    }
+
+    bool _initialized;
+    order_tracker_config_t _config;
+
+    /** Last four frames after the anti-alias filter, oldest first */
+    float *_history;
+    /** Anti-alias low-pass, coefficients for the speed _filter_rps */
+    float *_filter_state;
+    float _filter_a[ANTI_ALIAS_SECTIONS];
+    float _filter_d1[ANTI_ALIAS_SECTIONS];
+    float _filter_d2[ANTI_ALIAS_SECTIONS];
+    float _filter_rps;
+    bool _filter_enabled;
+    /** Shaft angle of every history frame, in output samples */
+    float _position[HISTORY_FRAMES];
+    size_t _history_frames;
+    float _next_output;
+
+    /** Shaft speed in revolutions per second, 0 if unknown */
+    float _rps;
+    float _dc_alpha;
+    float _min_period;
+    float _max_period;
+    float _reference_mean;
+    float _reference_prev;
+    size_t _reference_samples;
+    bool _reference_high;
+    float _last_crossing;
+    float _samples_since_crossing;
+};
+
+} // namespace spectral
+} // namespace ei
+
+#endif // _EIDSP_SPECTRAL_ORDER_TRACKING_H_
@@ -349,12 +349,133 @@ namespace processing {
         return EIDSP_OK;
     }
 
+    /**
+     * Sub-bin refinement of a spectral peak
+     */
+    typedef enum {
+        /** Bin frequency and amplitude, same as the Edge Impulse studio */
+        fft_peak_interpolation_none = 0,
+        /** Parabola through the peak bin and its neighbours */
+        fft_peak_interpolation_parabolic,
+        /** Parabola through the log of the bins, exact for a Gaussian peak */
+        fft_peak_interpolation_gaussian
+    } fft_peak_interpolation_t;
+
+    /**
+     * Restore the min-heap order of find_top_peaks() below position ix
+     */
+    template<typename T>
+    static void sift_down_peak(T *heap, size_t ix, size_t count)
+    {
+        while (true) {
+            size_t smallest = ix;
+            size_t left = 2 * ix + 1;
+            size_t right = left + 1;
+
+            if (left < count && heap[left * 2 + 1] < heap[smallest * 2 + 1]) {
+                smallest = left;
+            }
+            if (right < count && heap[right * 2 + 1] < heap[smallest * 2 + 1]) {
+                smallest = right;
+            }
+            if (smallest == ix) {
+                return;
+            }
+
+            T bin = heap[ix * 2];
+            T amplitude = heap[ix * 2 + 1];
+            heap[ix * 2] = heap[smallest * 2];
+            heap[ix * 2 + 1] = heap[smallest * 2 + 1];
+            heap[smallest * 2] = bin;
+            heap[smallest * 2 + 1] = amplitude;
+            ix = smallest;
+        }
+    }
+
+    /**
+     * Keep the k strongest local maxima of a spectrum, without allocating.
+     * The peaks are kept in a min-heap of (bin, amplitude) pairs, so every
+     * candidate costs at most log(k) compares, and are sorted strongest first
+     * at the end. Candidates are taken in bin order, as in find_peak_indexes().
+     * @param in Spectrum
+     * @param in_size Number of bins
+     * @param max_candidates Stop after this many local maxima
+     * @param heap Output, k rows of (bin, amplitude)
+     * @param k Number of peaks to keep
+     * @returns Number of peaks found (<= k)
+     */
+    template<typename T>
+    static size_t find_top_peaks(const T *in, size_t in_size, size_t max_candidates, T *heap, size_t k)
+    {
+        size_t count = 0;
+        size_t candidates = 0;
+
+        if (k == 0 || in_size < 3) {
+            return 0;
+        }
+
+        T prev = in[0];
+
+        for (size_t ix = 1; ix < in_size - 1 && candidates < max_candidates; ix++) {
+            T v = in[ix];
+
+            if (v > prev && v > in[ix + 1] && static_cast<T>((v - prev) + (v - in[ix + 1])) > 0) {
+                candidates++;
+
+                if (count < k) {
+                    // grow the heap, sift the new entry up
+                    size_t child = count++;
+                    heap[child * 2] = static_cast<T>(ix);
+                    heap[child * 2 + 1] = v;
+                    while (child > 0) {
+                        size_t parent = (child - 1) / 2;
+                        if (heap[parent * 2 + 1] <= heap[child * 2 + 1]) {
+                            break;
+                        }
+                        T bin = heap[parent * 2];
+                        T amplitude = heap[parent * 2 + 1];
+                        heap[parent * 2] = heap[child * 2];
+                        heap[parent * 2 + 1] = heap[child * 2 + 1];
+                        heap[child * 2] = bin;
+                        heap[child * 2 + 1] = amplitude;
+                        child = parent;
+                    }
+                }
+                else if (v > heap[1]) {
+                    // replace the weakest peak kept
+                    heap[0] = static_cast<T>(ix);
+                    heap[1] = v;
+                    sift_down_peak(heap, 0, count);
+                }
+            }
+
+            prev = v;
+        }
+
+        // heap sort, the weakest peak moves to the end
+        for (size_t end = count; end > 1; end--) {
+            T bin = heap[0];
+            T amplitude = heap[1];
+            heap[0] = heap[(end - 1) * 2];
+            heap[1] = heap[(end - 1) * 2 + 1];
+            heap[(end - 1) * 2] = bin;
+            heap[(end - 1) * 2 + 1] = amplitude;
+            sift_down_peak(heap, 0, end - 1);
+        }
+
+        return count;
+    }
+
     /**
      * Find peaks in FFT
+     * With fft_peak_interpolation_none the output matches the studio: the
+     * frequency of a bin follows linspace(0, fs / 2, fft_length / 2). With
+     * interpolation the frequency is (bin + offset) * fs / fft_length.
      * @param fft_matrix Matrix of FFT numbers (1xN)
      * @param output_matrix Matrix for the output (Mx2), one row per output you want and two colums per row
      * @param sampling_freq How often we sample (in Hz)
      * @param threshold Minimum threshold (default: 0.1)
+     * @param interpolation Sub-bin refinement of frequency and amplitude
      * @returns
      */
     static int find_fft_peaks(
@@ -362,7 +483,8 @@ namespace processing {
         matrix_t *output_matrix,
         float sampling_freq,
         float threshold,
-        uint16_t fft_length)
+        uint16_t fft_length,
+        fft_peak_interpolation_t interpolation = fft_peak_interpolation_none)
     {
         if (fft_matrix->rows != 1) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
@@ -376,57 +498,63 @@ namespace processing {
             return EIDSP_OK;
         }
 
-        int ret;
+        float *in = fft_matrix->buffer;
+        float *out = output_matrix->buffer;
 
-        int N = static_cast<int>(fft_length);
-        float T = 1.0f / sampling_freq;
+        // the output matrix holds the heap
+        size_t peak_count = find_top_peaks(in, fft_matrix->cols, output_matrix->rows * 10,
+            out, output_matrix->rows);
 
-        EI_DSP_MATRIX(freq_space, 1, fft_matrix->cols);
-        ret = numpy::linspace(0.0f, 1.0f / (2.0f * T), floor(N / 2), freq_space.buffer);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+        uint32_t freq_count = fft_length / 2;
+        float stop = sampling_freq / 2.0f;
+        float step = freq_count > 1 ? stop / (freq_count - 1) : 0.0f;
 
-        EI_DSP_MATRIX(peaks_matrix, output_matrix->rows * 10, 1);
+        for (size_t row = 0; row < peak_count; row++) {
+            uint32_t bin = static_cast<uint32_t>(out[row * 2]);
+            float amplitude = out[row * 2 + 1];
+            float freq;
 
-        uint16_t peak_count;
-        ret = find_peak_indexes(fft_matrix, &peaks_matrix, 0.0f, &peak_count);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+            if (interpolation == fft_peak_interpolation_none) {
+                freq = bin == freq_count - 1 ? stop : bin * step;
+            }
+            else {
+                // a peak always has two neighbours
+                float a = in[bin - 1];
+                float b = in[bin];
+                float c = in[bin + 1];
+                float offset = 0.0f;
+                bool log_domain = interpolation == fft_peak_interpolation_gaussian && a > 0.0f && c > 0.0f;
+
+                if (log_domain) {
+                    a = logf(a);
+                    b = logf(b);
+                    c = logf(c);
+                }
 
-        // turn this into C++ vector and sort it based on amplitude
-        std::vector<freq_peak_t> peaks;
-        for (uint8_t ix = 0; ix < peak_count; ix++) {
-            freq_peak_t d;
+                float denominator = a - 2.0f * b + c;
+                if (denominator < 0.0f) {
+                    offset = 0.5f * (a - c) / denominator;
+                    b -= 0.25f * (a - c) * offset;
+                }
 
-            d.freq = freq_space.buffer[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
-            d.amplitude = fft_matrix->buffer[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
-            // printf("freq %f : %f amp: %f\r\n", peaks_matrix.buffer[ix], d.freq, d.amplitude);
-            if (d.amplitude < threshold) {
-                d.freq = 0.0f;
-                d.amplitude = 0.0f;
+                freq = (bin + offset) * sampling_freq / fft_length;
+                amplitude = log_domain ? expf(b) : b;
             }
-            peaks.push_back(d);
-        }
-        sort(peaks.begin(), peaks.end(),
-            [](const freq_peak_t & a, const freq_peak_t & b) -> bool
-        {
-            return a.amplitude > b.amplitude;
-        });
 
-        // fill with zeros at the end (if needed)
-        for (size_t ix = peaks.size(); ix < output_matrix->rows; ix++) {
-            freq_peak_t d;
-            d.freq = 0;
-            d.amplitude = 0;
-            peaks.push_back(d);
-        }
+            if (amplitude < threshold) {
+                freq = 0.0f;
+                amplitude = 0.0f;
+            }
 
-        for (size_t row = 0; row < output_matrix->rows; row++) {
             // col 0 is freq, col 1 is ampl
-            output_matrix->buffer[row * output_matrix->cols + 0] = peaks[row].freq;
-            output_matrix->buffer[row * output_matrix->cols + 1] = peaks[row].amplitude;
+            out[row * 2 + 0] = freq;
+            out[row * 2 + 1] = amplitude;
+        }
+
+        // fill with zeros at the end (if needed)
+        for (size_t row = peak_count; row < output_matrix->rows; row++) {
+            out[row * 2 + 0] = 0.0f;
+            out[row * 2 + 1] = 0.0f;
         }
 
         return EIDSP_OK;
@@ -447,8 +575,6 @@ namespace processing {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
-        int ret;
-
         int N = static_cast<int>(fft_length);
         float T = 1.0f / sampling_freq;
 
@@ -456,57 +582,39 @@ namespace processing {
         float stop = (((1.0f / (2.0f * T)))/N);
         numpy::float_to_int16(&stop, &stop_point, 1);
 
-        EI_DSP_i16_MATRIX(freq_space, 1, fft_matrix->cols);
-        ret = numpy::linspace(0, stop_point, (N >> 1), freq_space.buffer);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
-
-        EI_DSP_i16_MATRIX(peaks_matrix, output_matrix->rows * 4, 1);
+        // same steps as numpy::linspace(0, stop_point, N / 2)
+        uint32_t freq_count = N >> 1;
+        EIDSP_i16 step = freq_count > 1 ? stop_point / static_cast<EIDSP_i16>(freq_count - 1) : 0;
 
-        uint16_t peak_count;
-        ret = find_peak_indexes(fft_matrix, &peaks_matrix, 0, &peak_count);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+        EIDSP_i16 *out = output_matrix->buffer;
+        size_t peak_count = find_top_peaks(fft_matrix->buffer, fft_matrix->cols, output_matrix->rows * 4,
+            out, output_matrix->rows);
 
         EIDSP_i16 i16_threshold;
         threshold /= fft_length;
         numpy::float_to_int16(&threshold, &i16_threshold, 1);
 
-        // turn this into C++ vector and sort it based on amplitude
-        std::vector<freq_peak_i16_t> peaks;
-        for (uint8_t ix = 0; ix < peak_count; ix++) {
-            freq_peak_i16_t d;
+        for (size_t row = 0; row < peak_count; row++) {
             // @todo: something somewhere does not go OK... and these numbers are dependent on
             // the FFT length I think... But they are an OK approximation for now.
-            d.freq = freq_space.buffer[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
-            d.amplitude = fft_matrix->buffer[peaks_matrix.buffer[ix]];
+            uint32_t bin = static_cast<uint32_t>(out[row * 2]);
+            EIDSP_i16 freq = bin == freq_count - 1 ? stop_point : static_cast<EIDSP_i16>(bin * step);
+            EIDSP_i16 amplitude = out[row * 2 + 1];
 
-            if (d.amplitude < i16_threshold) {
-                d.freq = 0.0f;
-                d.amplitude = 0.0f;
+            if (amplitude < i16_threshold) {
+                freq = 0;
+                amplitude = 0;
             }
-            peaks.push_back(d);
-        }
-        sort(peaks.begin(), peaks.end(),
-            [](const freq_peak_i16_t & a, const freq_peak_i16_t & b) -> bool
-        {
-            return a.amplitude > b.amplitude;
-        });
 
-        // fill with zeros at the end (if needed)
-        for (size_t ix = peaks.size(); ix < output_matrix->rows; ix++) {
-            freq_peak_i16_t d;
-            d.freq = 0;
-            d.amplitude = 0;
-            peaks.push_back(d);
+            // col 0 is freq, col 1 is ampl
+            out[row * 2 + 0] = freq;
+            out[row * 2 + 1] = amplitude;
         }
 
-        for (size_t row = 0; row < output_matrix->rows; row++) {
-            // col 0 is freq, col 1 is ampl
-            output_matrix->buffer[row * output_matrix->cols + 0] = (peaks[row].freq);
-            output_matrix->buffer[row * output_matrix->cols + 1] = (peaks[row].amplitude);
+        // fill with zeros at the end (if needed)
+        for (size_t row = peak_count; row < output_matrix->rows; row++) {
+            out[row * 2 + 0] = 0;
+            out[row * 2 + 1] = 0;
         }
 
         return EIDSP_OK;
@@ -532,8 +640,6 @@ namespace processing {
             return EIDSP_OK;
         }
 
-        int ret;
-
         int N = static_cast<int>(fft_length);
         float T = 1.0f / sampling_freq;
 
@@ -541,57 +647,202 @@ namespace processing {
         float stop = (((1.0f / (2.0f * T)))/N);
         numpy::float_to_int32(&stop, &stop_point, 1);
 
-        EI_DSP_i32_MATRIX(freq_space, 1, fft_matrix->cols);
-        ret = numpy::linspace(0, stop_point, (N >> 1), freq_space.buffer);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+        // same steps as numpy::linspace(0, stop_point, N / 2)
+        uint32_t freq_count = N >> 1;
+        EIDSP_i32 step = freq_count > 1 ? stop_point / static_cast<EIDSP_i32>(freq_count - 1) : 0;
 
-        EI_DSP_i32_MATRIX(peaks_matrix, output_matrix->rows * 4, 1);
-
-        uint16_t peak_count;
-        ret = find_peak_indexes(fft_matrix, &peaks_matrix, 0, &peak_count);
-        if (ret != EIDSP_OK) {
-            EIDSP_ERR(ret);
-        }
+        EIDSP_i32 *out = output_matrix->buffer;
+        size_t peak_count = find_top_peaks(fft_matrix->buffer, fft_matrix->cols, output_matrix->rows * 4,
+            out, output_matrix->rows);
 
         EIDSP_i32 i32_threshold;
         threshold /= fft_length;
         numpy::float_to_int32(&threshold, &i32_threshold, 1);
 
-        // turn this into C++ vector and sort it based on amplitude
-        std::vector<freq_peak_i32_t> peaks;
-        for (uint8_t ix = 0; ix < peak_count; ix++) {
-            freq_peak_i32_t d;
+        for (size_t row = 0; row < peak_count; row++) {
             // @todo: something somewhere does not go OK... and these numbers are dependent on
             // the FFT length I think... But they are an OK approximation for now.
-            d.freq = freq_space.buffer[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
-            d.amplitude = fft_matrix->buffer[peaks_matrix.buffer[ix]];
+            uint32_t bin = static_cast<uint32_t>(out[row * 2]);
+            EIDSP_i32 freq = bin == freq_count - 1 ? stop_point : static_cast<EIDSP_i32>(bin * step);
+            EIDSP_i32 amplitude = out[row * 2 + 1];
 
-            if (d.amplitude < i32_threshold) {
-                d.freq = 0.0f;
-                d.amplitude = 0.0f;
+            if (amplitude < i32_threshold) {
+                freq = 0;
+                amplitude = 0;
             }
-            peaks.push_back(d);
+
+            // col 0 is freq, col 1 is ampl
+            out[row * 2 + 0] = freq;
+            out[row * 2 + 1] = amplitude;
         }
-        sort(peaks.begin(), peaks.end(),
-            [](const freq_peak_i32_t & a, const freq_peak_i32_t & b) -> bool
-        {
-            return a.amplitude > b.amplitude;
-        });
 
         // fill with zeros at the end (if needed)
-        for (size_t ix = peaks.size(); ix < output_matrix->rows; ix++) {
-            freq_peak_i32_t d;
-            d.freq = 0;
-            d.amplitude = 0;
-            peaks.push_back(d);
+        for (size_t row = peak_count; row < output_matrix->rows; row++) {
+            out[row * 2 + 0] = 0;
+            out[row * 2 + 1] = 0;
         }
 
-        for (size_t row = 0; row < output_matrix->rows; row++) {
-            // col 0 is freq, col 1 is ampl
-            output_matrix->buffer[row * output_matrix->cols + 0] = (peaks[row].freq);
-            output_matrix->buffer[row * output_matrix->cols + 1] = (peaks[row].amplitude);
+        return EIDSP_OK;
+    }
+
+    /**
+     * Bin range of one spectral power band, see spectral_power_bands_init()
+     */
+    typedef struct {
+        uint16_t start;
+        uint16_t count;
+    } spectral_band_t;
+
+    /**
+     * Map the spectral power edges to ranges of FFT bins. A bin belongs to a
+     * band when edge[ex] <= freq < edge[ex + 1], edges must be ascending.
+     * The mapping only depends on the sampling frequency, FFT length and
+     * edges, so it can be calculated once and reused for every window / axis.
+     * @param freqs Frequency of every bin, ascending (e.g. from periodogram)
+     * @param freq_count Number of bins
+     * @param edges Band edges (same unit as freqs)
+     * @param edges_count Number of edges
+     * @param bands Out parameter, edges_count - 1 bands
+     * @returns 0 if OK
+     */
+    template<typename T>
+    static int spectral_power_bands_init(
+        const T *freqs,
+        size_t freq_count,
+        const T *edges,
+        size_t edges_count,
+        spectral_band_t *bands
+    ) {
+        if (freq_count > UINT16_MAX) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        if (edges_count < 2) {
+            return EIDSP_OK;
+        }
+
+        // first bin at or above the edge
+        size_t start = std::lower_bound(freqs, freqs + freq_count, edges[0]) - freqs;
+        for (size_t ex = 0; ex < edges_count - 1; ex++) {
+            size_t end = std::lower_bound(freqs, freqs + freq_count, edges[ex + 1]) - freqs;
+            bands[ex].start = static_cast<uint16_t>(start);
+            bands[ex].count = end > start ? static_cast<uint16_t>(end - start) : 0;
+            start = end;
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Bin to band mapping for the frequencies periodogram() returns
+     * @param sampling_freq Sampling frequency
+     * @param n_fft Length of the FFT
+     * @param edges Band edges (Hz)
+     * @param edges_count Number of edges
+     * @param bands Out parameter, edges_count - 1 bands
+     * @returns 0 if OK
+     */
+    static int spectral_power_bands_init(
+        float sampling_freq,
+        uint16_t n_fft,
+        const float *edges,
+        size_t edges_count,
+        spectral_band_t *bands
+    ) {
+        EI_DSP_MATRIX(freq_matrix, 1, n_fft / 2 + 1);
+
+        // same expression as periodogram(), so the bins fall in the same bands
+        for (uint16_t ix = 0; ix < n_fft / 2 + 1; ix++) {
+            freq_matrix.buffer[ix] = static_cast<float>(ix) * (1.0f / (n_fft * (1.0f / sampling_freq)));
+        }
+
+        return spectral_power_bands_init(freq_matrix.buffer, freq_matrix.cols, edges, edges_count, bands);
+    }
+
+    /**
+     * Mean power of every band, one contiguous reduction per band
+     * @param power Power spectrum (e.g. from periodogram)
+     * @param power_size Number of bins
+     * @param bands Bin ranges from spectral_power_bands_init()
+     * @param band_count Number of bands
+     * @param output Out parameter, band_count values, 0 for an empty band
+     * @param log_power Return log10 of the mean power (clamped at 1e-10) instead
+     * @returns 0 if OK
+     */
+    static int spectral_power_bands(
+        const float *power,
+        size_t power_size,
+        const spectral_band_t *bands,
+        size_t band_count,
+        float *output,
+        bool log_power = false
+    ) {
+        for (size_t ex = 0; ex < band_count; ex++) {
+            if (bands[ex].start + bands[ex].count > power_size) {
+                EIDSP_ERR(EIDSP_BUFFER_SIZE_MISMATCH);
+            }
+
+            float mean = 0.0f;
+            if (bands[ex].count > 0) {
+#if EIDSP_USE_CMSIS_DSP
+                arm_mean_f32(power + bands[ex].start, bands[ex].count, &mean);
+#else
+                const float *v = power + bands[ex].start;
+                for (uint16_t ix = 0; ix < bands[ex].count; ix++) {
+                    mean += v[ix];
+                }
+                mean /= bands[ex].count;
+#endif
+            }
+
+            if (log_power) {
+                output[ex] = log10f(mean < 1e-10f ? 1e-10f : mean);
+            }
+            else {
+                output[ex] = mean;
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Mean power of every band on a q15 spectrum (signed 32 bit sum divided
+     * by the bin count, truncated toward zero like arm_mean_q15)
+     * @param power Power spectrum (e.g. from periodogram)
+     * @param power_size Number of bins
+     * @param bands Bin ranges from spectral_power_bands_init()
+     * @param band_count Number of bands
+     * @param output Out parameter, band_count values, 0 for an empty band
+     * @returns 0 if OK
+     */
+    static int spectral_power_bands(
+        const EIDSP_i16 *power,
+        size_t power_size,
+        const spectral_band_t *bands,
+        size_t band_count,
+        EIDSP_i16 *output
+    ) {
+        for (size_t ex = 0; ex < band_count; ex++) {
+            if (bands[ex].start + bands[ex].count > power_size) {
+                EIDSP_ERR(EIDSP_BUFFER_SIZE_MISMATCH);
+            }
+
+            if (bands[ex].count == 0) {
+                output[ex] = 0;
+                continue;
+            }
+
+#if EIDSP_USE_CMSIS_DSP
+            arm_mean_q15((q15_t *)(power + bands[ex].start), bands[ex].count, &output[ex]);
+#else
+            const EIDSP_i16 *v = power + bands[ex].start;
+            int32_t sum = 0;
+            for (uint16_t ix = 0; ix < bands[ex].count; ix++) {
+                sum += v[ix];
+            }
+            output[ex] = static_cast<EIDSP_i16>(sum / static_cast<int32_t>(bands[ex].count));
+#endif
         }
 
         return EIDSP_OK;
@@ -630,34 +881,25 @@ namespace processing {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
-        EI_DSP_MATRIX(buckets, 1, edges_matrix->rows - 1);
-        EI_DSP_MATRIX(bucket_count, 1, edges_matrix->rows - 1);
-
-        for (uint16_t ix = 0; ix < freq_matrix->cols; ix++) {
-            float t = freq_matrix->buffer[ix];
-            float v = fft_matrix->buffer[ix];
+        if (output_matrix->rows == 0) {
+            return EIDSP_OK;
+        }
 
-            // does this fit between any edges?
-            for (uint16_t ex = 0; ex < edges_matrix->rows - 1; ex++) {
-                if (t >= edges_matrix->buffer[ex] && t < edges_matrix->buffer[ex + 1]) {
-                    buckets.buffer[ex] += v;
-                    bucket_count.buffer[ex]++;
-                    break;
-                }
-            }
+        spectral_band_t *bands = (spectral_band_t*)ei_dsp_malloc(output_matrix->rows * sizeof(spectral_band_t));
+        if (!bands) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
         }
 
-        // average out and push to vector
-        for (uint16_t ex = 0; ex < edges_matrix->rows - 1; ex++) {
-            if (bucket_count.buffer[ex] == 0.0f) {
-                output_matrix->buffer[ex] = 0.0f;
-            }
-            else {
-                output_matrix->buffer[ex] = buckets.buffer[ex] / bucket_count.buffer[ex];
-            }
+        int ret = spectral_power_bands_init(freq_matrix->buffer, freq_matrix->cols,
+            edges_matrix->buffer, edges_matrix->rows, bands);
+        if (ret == EIDSP_OK) {
+            ret = spectral_power_bands(fft_matrix->buffer, fft_matrix->cols,
+                bands, output_matrix->rows, output_matrix->buffer);
         }
 
-        return EIDSP_OK;
+        ei_dsp_free(bands, output_matrix->rows * sizeof(spectral_band_t));
+
+        return ret;
     }
 
     int spectral_power_edges(
@@ -683,44 +925,25 @@ namespace processing {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
-        EI_DSP_i16_MATRIX(buckets, 1, edges_matrix->rows - 1);
-        EI_DSP_i16_MATRIX(bucket_count, 1, edges_matrix->rows - 1);
-
-        for (uint16_t ix = 0; ix < freq_matrix->cols; ix++) {
-            int16_t t = freq_matrix->buffer[ix];
-            int16_t v = fft_matrix->buffer[ix];
-
-            // does this fit between any edges?
-            for (uint16_t ex = 0; ex < edges_matrix->rows - 1; ex++) {
-                if (t >= edges_matrix->buffer[ex] && t < edges_matrix->buffer[ex + 1]) {
-                    buckets.buffer[ex] += v;
-                    bucket_count.buffer[ex]++;
-                    break;
-                }
-            }
+        if (output_matrix->rows == 0) {
+            return EIDSP_OK;
         }
 
-        // average out and push to vector
-        for (uint16_t ex = 0; ex < edges_matrix->rows - 1; ex++) {
-            if (bucket_count.buffer[ex] == 0) {
-                output_matrix->buffer[ex] = 0;
-            }
-            else {
-                int neg = 0;
-
-                if(buckets.buffer[ex] & 0x8000) {
-                    buckets.buffer[ex] &= ~0x8000;
-                    neg = 1;
-                }
-                output_matrix->buffer[ex] = buckets.buffer[ex] / bucket_count.buffer[ex];
+        spectral_band_t *bands = (spectral_band_t*)ei_dsp_malloc(output_matrix->rows * sizeof(spectral_band_t));
+        if (!bands) {
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
 
-                if(neg) {
-                    output_matrix->buffer[ex] |= 0x8000;
-                }
-            }
+        int ret = spectral_power_bands_init(freq_matrix->buffer, freq_matrix->cols,
+            edges_matrix->buffer, edges_matrix->rows, bands);
+        if (ret == EIDSP_OK) {
+            ret = spectral_power_bands(fft_matrix->buffer, fft_matrix->cols,
+                bands, output_matrix->rows, output_matrix->buffer);
         }
 
-        return EIDSP_OK;
+        ei_dsp_free(bands, output_matrix->rows * sizeof(spectral_band_t));
+
+        return ret;
     }
 
     /**
@@ -730,9 +953,11 @@ namespace processing {
      * @param out_freq_matrix Output matrix of size 1x(n_fft/2+1) with frequency data
      * @param sampling_freq The sampling frequency
      * @param n_fft Number of FFT buckets
+     * @param scratch numpy::rfft_scratch_size(n_fft) values for the FFT, NULL allocates them per call
      * @returns 0 if OK
      */
-    int periodogram(matrix_t *input_matrix, matrix_t *out_fft_matrix, matrix_t *out_freq_matrix, float sampling_freq, uint16_t n_fft)
+    int periodogram(matrix_t *input_matrix, matrix_t *out_fft_matrix, matrix_t *out_freq_matrix, float sampling_freq, uint16_t n_fft,
+        float *scratch = NULL)
     {
         if (input_matrix->rows != 1) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
@@ -796,31 +1021,28 @@ namespace processing {
             EIDSP_ERR(ret);
         }
 
-        fft_complex_t *fft_output = (fft_complex_t*)ei_dsp_calloc((n_fft / 2 + 1) * sizeof(fft_complex_t), 1);
-        ret = numpy::rfft(welch_matrix.buffer, welch_matrix.cols, fft_output, n_fft / 2 + 1, n_fft);
+        EI_DSP_MATRIX_B(fft_scratch, 1, numpy::rfft_scratch_size(n_fft), scratch);
+        float *fft_input = fft_scratch.buffer;
+        float *fft_output = fft_scratch.buffer + n_fft;
+
+        size_t fft_input_size = welch_matrix.cols < n_fft ? welch_matrix.cols : n_fft;
+        memcpy(fft_input, welch_matrix.buffer, fft_input_size * sizeof(float));
+
+        // power of every bin, already scaled
+        ret = numpy::rfft_spectrum(fft_input, fft_input_size, fft_output, n_fft,
+            rfft_power, scale);
         if (ret != EIDSP_OK) {
-            ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
             EIDSP_ERR(ret);
         }
 
-        // conjugate and then multiply with itself and scale
         for (uint16_t ix = 0; ix < n_fft / 2 + 1; ix++) {
-            fft_output[ix].r = (fft_output[ix].r * fft_output[ix].r) +
-                (abs(fft_output[ix].i * fft_output[ix].i));
-            fft_output[ix].i = 0.0f;
-
-            fft_output[ix].r *= scale;
+            out_fft_matrix->buffer[ix] = fft_output[ix];
 
             if (ix != n_fft / 2) {
-                fft_output[ix].r *= 2;
+                out_fft_matrix->buffer[ix] *= 2;
             }
-
-            // then multiply by itself...
-            out_fft_matrix->buffer[ix] = fft_output[ix].r;
         }
 
-        ei_dsp_free(fft_output, (n_fft / 2 + 1) * sizeof(fft_complex_t));
-
         return EIDSP_OK;
     }
 
@@ -874,7 +1096,9 @@ namespace processing {
         /* Create frequency buffer, scale to 0 - 1 for q15 */
         for (uint16_t ix = 0; ix < n_fft / 2 + 1; ix++) {
             float scaled_freq_in_fft = freq_in_fft / (sampling_freq / 2.f);
-            out_freq_matrix->buffer[ix] = static_cast<int16_t>((static_cast<float>(ix) * scaled_freq_in_fft) * (1<<15));
+            // saturate, the Nyquist bin (1.0) would wrap to -1
+            out_freq_matrix->buffer[ix] = static_cast<int16_t>(numpy::saturate(
+                static_cast<int32_t>((static_cast<float>(ix) * scaled_freq_in_fft) * (1<<15)), 16));
         }
 
         int ret;
@@ -0,0 +1,470 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPECTRAL_PSD_ACCUMULATOR_H_
+#define _EIDSP_SPECTRAL_PSD_ACCUMULATOR_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "../numpy.hpp"
+#include "../memory.hpp"
+
+namespace ei {
+namespace spectral {
+
+typedef struct {
+    float sampling_freq;
+    /** Welch segment length, power of two */
+    uint16_t n_fft;
+    /** Samples shared by two consecutive segments (n_fft / 2 for Welch) */
+    uint16_t overlap;
+    /** Weight of a new window, the PSD remembers roughly 1 / alpha windows */
+    float alpha;
+    /** Number of trend points kept, 0 disables the trend */
+    uint16_t trend_length;
+    /** Windows between two trend points */
+    uint32_t trend_interval;
+    /** Band of the trend, power and peak. Both 0 is the whole spectrum */
+    float trend_low_freq;
+    float trend_high_freq;
+} psd_accumulator_config_t;
+
+typedef struct {
+    /** Windows accumulated when the point was taken */
+    uint32_t window;
+    float band_power;
+    float peak_freq;
+    float peak_power;
+} psd_trend_point_t;
+
+/**
+ * Long-horizon power spectral density.
+ *
+ * Every window is turned into a Welch estimate (Hann windowed, overlapping
+ * segments, one-sided, same scaling as scipy.signal.welch) which is averaged
+ * into one exponentially weighted PSD. Until 1 / alpha windows have been
+ * seen the plain mean is used, so the estimate is not biased towards zero
+ * after init.
+ *
+ * Every trend_interval windows the band power and the interpolated peak of
+ * the PSD are stored in a ring of trend_length points, so drift over hours or
+ * days is queried without keeping raw data or full spectra. All memory is
+ * allocated in init().
+ */
+class psd_accumulator {
+public:
+    psd_accumulator()
+        : _initialized(false), _window(NULL), _segment(NULL), _fft(NULL),
+          _welch(NULL), _psd(NULL), _trend(NULL)
+    {
+        memset(&_config, 0, sizeof(_config));
+    }
+
+    ~psd_accumulator() {
+        release();
+    }
+
+    /**
+     * Allocate the buffers and calculate the segment window
+     * @param config Accumulator configuration
+     * @returns EIDSP_OK if OK
+     */
+    int init(const psd_accumulator_config_t *config) {
+        release();
+
+        _config = *config;
+
+        if (_config.n_fft < 4 || (_config.n_fft & (_config.n_fft - 1)) != 0 ||
+            _config.overlap >= _config.n_fft || _config.sampling_freq <= 0.0f ||
+            _config.alpha <= 0.0f || _config.alpha > 1.0f) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        if (_config.trend_interval == 0) {
+            _config.trend_interval = 1;
+        }
+
+        _bins = _config.n_fft / 2 + 1;
+        _df = _config.sampling_freq / _config.n_fft;
+
+        _window = (float*)ei_dsp_calloc(_config.n_fft * sizeof(float), 1);
+        _segment = (float*)ei_dsp_calloc(_config.n_fft * sizeof(float), 1);
+        _fft = (fft_complex_t*)ei_dsp_calloc(_bins * sizeof(fft_complex_t), 1);
+        _welch = (float*)ei_dsp_calloc(_bins * sizeof(float), 1);
+        _psd = (float*)ei_dsp_calloc(_bins * sizeof(float), 1);
+        if (_config.trend_length > 0) {
+            _trend = (psd_trend_point_t*)ei_dsp_calloc(_config.trend_length * sizeof(psd_trend_point_t), 1);
+        }
+
+        if (!_window || !_segment || !_fft || !_welch || !_psd ||
+            (_config.trend_length > 0 && !_trend)) {
+            release();
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        // periodic Hann window, the scale makes the PSD density in unit^2 / Hz
+        float window_power = 0.0f;
+        for (uint16_t ix = 0; ix < _config.n_fft; ix++) {
+            _window[ix] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * ix / _config.n_fft);
+            window_power += _window[ix] * _window[ix];
+        }
+        _scale = 1.0f / (_config.sampling_freq * window_power);
+
+        _initialized = true;
+        reset();
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Free all buffers
+     */
+    void release() {
+        if (_window) {
+            ei_dsp_free(_window, _config.n_fft * sizeof(float));
+        }
+        if (_segment) {
+            ei_dsp_free(_segment, _config.n_fft * sizeof(float));
+        }
+        if (_fft) {
+            ei_dsp_free(_fft, _bins * sizeof(fft_complex_t));
+        }
+        if (_welch) {
+            ei_dsp_free(_welch, _bins * sizeof(float));
+        }
+        if (_psd) {
+            ei_dsp_free(_psd, _bins * sizeof(float));
+        }
+        if (_trend) {
+            ei_dsp_free(_trend, _config.trend_length * sizeof(psd_trend_point_t));
+        }
+        _window = NULL;
+        _segment = NULL;
+        _fft = NULL;
+        _welch = NULL;
+        _psd = NULL;
+        _trend = NULL;
+        _initialized = false;
+    }
+
+    /**
+     * Forget the PSD and the trend, the configuration is kept
+     */
+    void reset() {
+        if (!_initialized) {
+            return;
+        }
+        memset(_psd, 0, _bins * sizeof(float));
+        _windows = 0;
+        _trend_head = 0;
+        _trend_count = 0;
+    }
+
+    /**
+     * Add a window of raw samples. It is split in segments of n_fft samples,
+     * a trailing part that does not fill a segment is not used.
+     * @param input Samples of one axis
+     * @param input_size Number of samples, at least n_fft
+     * @returns EIDSP_OK if OK
+     */
+    int add_window(const float *input, size_t input_size) {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        if (input_size < _config.n_fft) {
+            EIDSP_ERR(EIDSP_BUFFER_SIZE_MISMATCH);
+        }
+
+        size_t step = _config.n_fft - _config.overlap;
+        size_t segments = 0;
+
+        memset(_welch, 0, _bins * sizeof(float));
+
+        for (size_t start = 0; start + _config.n_fft <= input_size; start += step) {
+            // constant detrend, like the periodogram in processing.hpp
+            float mean = 0.0f;
+            for (uint16_t ix = 0; ix < _config.n_fft; ix++) {
+                mean += input[start + ix];
+            }
+            mean /= _config.n_fft;
+
+            for (uint16_t ix = 0; ix < _config.n_fft; ix++) {
+                _segment[ix] = (input[start + ix] - mean) * _window[ix];
+            }
+
+            int ret = numpy::rfft(_segment, _config.n_fft, _fft, _bins, _config.n_fft);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+
+            for (uint16_t ix = 0; ix < _bins; ix++) {
+                _welch[ix] += _fft[ix].r * _fft[ix].r + _fft[ix].i * _fft[ix].i;
+            }
+            segments++;
+        }
+
+        // one-sided, DC and Nyquist are not doubled
+        float scale = _scale / segments;
+        for (uint16_t ix = 0; ix < _bins; ix++) {
+            _welch[ix] *= (ix == 0 || ix == _bins - 1) ? scale : 2.0f * scale;
+        }
+
+        return add_psd(_welch, _bins);
+    }
+
+    /**
+     * Add a one-sided PSD that was already calculated for this window, e.g. by
+     * processing::periodogram() with the same n_fft and sampling frequency
+     * @param psd PSD (n_fft / 2 + 1 bins)
+     * @param psd_size Number of bins
+     * @returns EIDSP_OK if OK
+     */
+    int add_psd(const float *psd, size_t psd_size) {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        if (psd_size != _bins) {
+            EIDSP_ERR(EIDSP_BUFFER_SIZE_MISMATCH);
+        }
+
+        _windows++;
+
+        float weight = 1.0f / _windows;
+        if (weight < _config.alpha) {
+            weight = _config.alpha;
+        }
+
+        for (uint16_t ix = 0; ix < _bins; ix++) {
+            _psd[ix] += weight * (psd[ix] - _psd[ix]);
+        }
+
+        if (_trend && _windows % _config.trend_interval == 0) {
+            add_trend_point();
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Power in a band, the PSD integrated over the bins in [low_freq, high_freq)
+     * @param low_freq Lower edge (Hz)
+     * @param high_freq Upper edge (Hz), 0 is up to Nyquist
+     * @returns Band power (unit^2)
+     */
+    float band_power(float low_freq, float high_freq) const {
+        if (!_initialized) {
+            return 0.0f;
+        }
+
+        uint16_t start, end;
+        band_bins(low_freq, high_freq, &start, &end);
+
+        float power = 0.0f;
+        for (uint16_t ix = start; ix < end; ix++) {
+            power += _psd[ix];
+        }
+
+        return power * _df;
+    }
+
+    /**
+     * Strongest bin in a band, refined with Gaussian interpolation (a parabola
+     * through the log of the bin and its neighbours)
+     * @param low_freq Lower edge (Hz)
+     * @param high_freq Upper edge (Hz), 0 is up to Nyquist
+     * @param freq Peak frequency (Hz)
+     * @param power Peak PSD (unit^2 / Hz)
+     * @returns EIDSP_OK if OK
+     */
+    int find_peak(float low_freq, float high_freq, float *freq, float *power) const {
+        if (!_initialized || _windows == 0) {
+            EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+        uint16_t start, end;
+        band_bins(low_freq, high_freq, &start, &end);
+        if (start >= end) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        uint16_t peak = start;
+        for (uint16_t ix = start + 1; ix < end; ix++) {
+            if (_psd[ix] > _psd[peak]) {
+                peak = ix;
+            }
+        }
+
+        float offset = 0.0f;
+        float value = _psd[peak];
+
+        if (peak > 0 && peak < _bins - 1 &&
+            _psd[peak - 1] > 0.0f && _psd[peak] > 0.0f && _psd[peak + 1] > 0.0f) {
+            float a = logf(_psd[peak - 1]);
+            float b = logf(_psd[peak]);
+            float c = logf(_psd[peak + 1]);
+            float denominator = a - 2.0f * b + c;
+            if (denominator < 0.0f) {
+                offset = 0.5f * (a - c) / denominator;
+                value = expf(b - 0.25f * (a - c) * offset);
+            }
+        }
+
+        *freq = (peak + offset) * _df;
+        *power = value;
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Copy the trend, oldest point first
+     * @param points Output
+     * @param max_points Size of points
+     * @returns Number of points copied
+     */
+    size_t get_trend(psd_trend_point_t *points, size_t max_points) const {
+        size_t count = _trend_count < max_points ? _trend_count : max_points;
+        size_t ix = _trend_count - count;
+
+        for (size_t out = 0; out < count; out++, ix++) {
+            points[out] = _trend[(_trend_head + _config.trend_length - _trend_count + ix) % _config.trend_length];
+        }
+
+        return count;
+    }
+
+    /**
+     * Least-squares slope of the trend peak frequency
+     * @returns Drift in Hz per window, 0 with less than 2 trend points
+     */
+    float peak_drift() const {
+        return trend_slope(&psd_trend_point_t::peak_freq);
+    }
+
+    /**
+     * Least-squares slope of the trend band power
+     * @returns Drift in unit^2 per window, 0 with less than 2 trend points
+     */
+    float band_power_drift() const {
+        return trend_slope(&psd_trend_point_t::band_power);
+    }
+
+    /**
+     * Averaged PSD, n_fft / 2 + 1 bins at sampling_freq / n_fft Hz apart
+     */
+    const float *get_psd() const {
+        return _psd;
+    }
+
+    size_t get_bins() const {
+        return _bins;
+    }
+
+    uint32_t get_windows() const {
+        return _windows;
+    }
+
+private:
+    void band_bins(float low_freq, float high_freq, uint16_t *start, uint16_t *end) const {
+        if (high_freq <= 0.0f || high_freq > _config.sampling_freq / 2.0f) {
+            high_freq = _config.sampling_freq / 2.0f + _df;
+        }
+        if (low_freq < 0.0f) {
+            low_freq = 0.0f;
+        }
+
+        *start = static_cast<uint16_t>(ceilf(low_freq / _df));
+        *end = static_cast<uint16_t>(ceilf(high_freq / _df));
+        if (*end > _bins) {
+            *end = _bins;
+        }
+    }
+
+    void add_trend_point() {
+        psd_trend_point_t *point = &_trend[_trend_head];
+
+        point->window = _windows;
+        point->band_power = band_power(_config.trend_low_freq, _config.trend_high_freq);
+        if (find_peak(_config.trend_low_freq, _config.trend_high_freq,
+                &point->peak_freq, &point->peak_power) != EIDSP_OK) {
+            point->peak_freq = 0.0f;
+            point->peak_power = 0.0f;
+        }
+
+        _trend_head = (_trend_head + 1) % _config.trend_length;
+        if (_trend_count < _config.trend_length) {
+            _trend_count++;
+        }
+    }
+
+    float trend_slope(float psd_trend_point_t::*field) const {
+        if (_trend_count < 2) {
+            return 0.0f;
+        }
+
+        // relative to the oldest point, so the window counts do not lose precision
+        size_t first = (_trend_head + _config.trend_length - _trend_count) % _config.trend_length;
+        uint32_t origin = _trend[first].window;
+        float sum_x = 0.0f, sum_y = 0.0f, sum_xx = 0.0f, sum_xy = 0.0f;
+
+        for (size_t ix = 0; ix < _trend_count; ix++) {
+            const psd_trend_point_t *point = &_trend[(first + ix) % _config.trend_length];
+            float x = static_cast<float>(point->window - origin);
+            float y = point->*field;
+            sum_x += x;
+            sum_y += y;
+            sum_xx += x * x;
+            sum_xy += x * y;
+        }
+
+        float n = static_cast<float>(_trend_count);
+        float denominator = n * sum_xx - sum_x * sum_x;
+        if (denominator == 0.0f) {
+            return 0.0f;
+        }
+
+        return (n * sum_xy - sum_x * sum_y) / denominator;
+    }
+
+    psd_accumulator_config_t _config;
+    bool _initialized;
+    uint16_t _bins;
+    float _df;
+    float _scale;
+    uint32_t _windows;
+    size_t _trend_head;
+    size_t _trend_count;
+
+    float *_window;
+    float *_segment;
+    fft_complex_t *_fft;
+    float *_welch;
+    float *_psd;
+    psd_trend_point_t *_trend;
+};
+
+} // namespace spectral
+} // namespace ei
+
+#endif // _EIDSP_SPECTRAL_PSD_ACCUMULATOR_H_
@@ -26,5 +26,9 @@
 #include "../config.hpp"
 #include "processing.hpp"
 #include "feature.hpp"
+#include "psd_accumulator.hpp"
+#include "goertzel.hpp"
+#include "decimator.hpp"
+#include "order_tracking.hpp"
 
 #endif // _EIDSP_SPECTRAL_SPECTRAL_H_
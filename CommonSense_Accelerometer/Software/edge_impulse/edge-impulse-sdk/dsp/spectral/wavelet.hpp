@@ -0,0 +1,245 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPECTRAL_WAVELET_H_
+#define _EIDSP_SPECTRAL_WAVELET_H_
+
+#include <stdint.h>
+#include <math.h>
+#include "../numpy.hpp"
+
+#define EI_WAVELET_SQRT2    1.4142135623730951f
+
+namespace ei {
+namespace spectral {
+
+typedef enum {
+    wavelet_haar = 0,
+    /** Daubechies 2 (4 taps), float only */
+    wavelet_db2 = 1,
+    /** CDF 5/3 (LeGall), biorthogonal */
+    wavelet_cdf53 = 2
+} wavelet_t;
+
+/**
+ * Wavelet packet decomposition with the lifting scheme.
+ *
+ * Every level splits every node into an approximation and a detail half,
+ * in place: a node at depth D is the set of samples offset + k * 2^D, so
+ * the full tree needs no memory besides the signal. The signal is extended
+ * periodically at the edges. Nodes are numbered in natural (Paley) order,
+ * node n is reached by taking the detail half where bit (D - 1 - level) of n
+ * is set.
+ *
+ * The float transform is scaled to be orthonormal (exactly for haar and db2,
+ * approximately for cdf53), so the node energies add up to the signal
+ * energy. The integer transform keeps approximations at the input scale and
+ * is corrected with a power of two per node when the energy is taken.
+ */
+namespace wavelet {
+    /**
+     * Offset of a node at a depth in the in place layout
+     * @param node Node index, natural order
+     * @param depth Depth of the tree
+     */
+    static size_t node_offset(size_t node, int depth) {
+        size_t offset = 0;
+        for (int level = 0; level < depth; level++) {
+            if (node & (1 << (depth - 1 - level))) {
+                offset |= (1 << level);
+            }
+        }
+        return offset;
+    }
+
+    /**
+     * Number of detail steps on the way to a node
+     */
+    static int node_detail_steps(size_t node, int depth) {
+        int steps = 0;
+        for (int level = 0; level < depth; level++) {
+            if (node & (1 << level)) {
+                steps++;
+            }
+        }
+        return steps;
+    }
+
+    /**
+     * One lifting step on a node, approximation goes to the even samples and
+     * detail to the odd samples
+     * @param x First sample of the node
+     * @param count Samples in the node (even)
+     * @param stride Distance between the samples of the node
+     * @param type Wavelet
+     */
+    static int lift(float *x, size_t count, size_t stride, wavelet_t type) {
+        const size_t half = count / 2;
+        const size_t step = 2 * stride;
+        float *even = x;
+        float *odd = x + stride;
+
+#define EI_WAVELET_E(k) even[(k) * step]
+#define EI_WAVELET_O(k) odd[(k) * step]
+
+        switch (type) {
+            case wavelet_haar: {
+                for (size_t k = 0; k < half; k++) {
+                    float d = EI_WAVELET_O(k) - EI_WAVELET_E(k);
+                    float s = EI_WAVELET_E(k) + d * 0.5f;
+                    EI_WAVELET_E(k) = s * EI_WAVELET_SQRT2;
+                    EI_WAVELET_O(k) = d * (1.0f / EI_WAVELET_SQRT2);
+                }
+                break;
+            }
+            case wavelet_cdf53: {
+                for (size_t k = 0; k < half; k++) {
+                    size_t next = k + 1 == half ? 0 : k + 1;
+                    EI_WAVELET_O(k) -= 0.5f * (EI_WAVELET_E(k) + EI_WAVELET_E(next));
+                }
+                for (size_t k = 0; k < half; k++) {
+                    size_t prev = k == 0 ? half - 1 : k - 1;
+                    EI_WAVELET_E(k) += 0.25f * (EI_WAVELET_O(prev) + EI_WAVELET_O(k));
+                }
+                for (size_t k = 0; k < half; k++) {
+                    EI_WAVELET_E(k) *= EI_WAVELET_SQRT2;
+                    EI_WAVELET_O(k) *= (1.0f / EI_WAVELET_SQRT2);
+                }
+                break;
+            }
+            case wavelet_db2: {
+                const float sqrt3 = 1.7320508075688772f;
+                for (size_t k = 0; k < half; k++) {
+                    EI_WAVELET_E(k) += sqrt3 * EI_WAVELET_O(k);
+                }
+                for (size_t k = 0; k < half; k++) {
+                    size_t prev = k == 0 ? half - 1 : k - 1;
+                    EI_WAVELET_O(k) -= (sqrt3 / 4.0f) * EI_WAVELET_E(k) + ((sqrt3 - 2.0f) / 4.0f) * EI_WAVELET_E(prev);
+                }
+                for (size_t k = 0; k < half; k++) {
+                    size_t next = k + 1 == half ? 0 : k + 1;
+                    EI_WAVELET_E(k) -= EI_WAVELET_O(next);
+                }
+                for (size_t k = 0; k < half; k++) {
+                    EI_WAVELET_E(k) *= (sqrt3 - 1.0f) / EI_WAVELET_SQRT2;
+                    EI_WAVELET_O(k) *= (sqrt3 + 1.0f) / EI_WAVELET_SQRT2;
+                }
+                break;
+            }
+            default:
+                EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Integer lifting step (reversible), see lift(). Approximations are at
+     * the input scale, details at sqrt(2) times the orthonormal scale.
+     */
+    static int lift(EIDSP_i32 *x, size_t count, size_t stride, wavelet_t type) {
+        const size_t half = count / 2;
+        const size_t step = 2 * stride;
+        EIDSP_i32 *even = x;
+        EIDSP_i32 *odd = x + stride;
+
+        switch (type) {
+            case wavelet_haar: {
+                for (size_t k = 0; k < half; k++) {
+                    EI_WAVELET_O(k) -= EI_WAVELET_E(k);
+                    EI_WAVELET_E(k) += EI_WAVELET_O(k) >> 1;
+                }
+                break;
+            }
+            case wavelet_cdf53: {
+                for (size_t k = 0; k < half; k++) {
+                    size_t next = k + 1 == half ? 0 : k + 1;
+                    EI_WAVELET_O(k) -= (EI_WAVELET_E(k) + EI_WAVELET_E(next)) >> 1;
+                }
+                for (size_t k = 0; k < half; k++) {
+                    size_t prev = k == 0 ? half - 1 : k - 1;
+                    EI_WAVELET_E(k) += (EI_WAVELET_O(prev) + EI_WAVELET_O(k) + 2) >> 2;
+                }
+                break;
+            }
+            default:
+                EIDSP_ERR(EIDSP_NOT_SUPPORTED);
+        }
+
+#undef EI_WAVELET_E
+#undef EI_WAVELET_O
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Full wavelet packet tree of one signal, in place
+     * @param x Signal, length must be a multiple of 2^depth
+     * @param length Number of samples
+     * @param depth Depth of the tree
+     * @param type Wavelet
+     */
+    template<typename T>
+    static int packet_decompose(T *x, size_t length, int depth, wavelet_t type) {
+        if (depth < 1 || (length >> depth) == 0 || (length & ((1 << depth) - 1)) != 0) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        for (int level = 0; level < depth; level++) {
+            size_t stride = 1 << level;
+            for (size_t offset = 0; offset < stride; offset++) {
+                int ret = lift(x + offset, length / stride, stride, type);
+                if (ret != EIDSP_OK) {
+                    EIDSP_ERR(ret);
+                }
+            }
+        }
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Shannon entropy of the normalized energy of a node's coefficients,
+     * -sum(p * ln(p)) with p = c^2 / sum(c^2). 0 for an empty node.
+     */
+    template<typename T>
+    static float node_entropy(const T *x, size_t count, size_t stride, float energy) {
+        if (energy <= 0.0f) {
+            return 0.0f;
+        }
+
+        float entropy = 0.0f;
+        for (size_t k = 0; k < count; k++) {
+            float c = (float)x[k * stride];
+            float p = c * c / energy;
+            if (p > 0.0f) {
+                entropy -= p * logf(p);
+            }
+        }
+        return entropy;
+    }
+} // namespace wavelet
+
+} // namespace spectral
+} // namespace ei
+
+#endif // _EIDSP_SPECTRAL_WAVELET_H_
@@ -256,6 +256,10 @@ public:
         if (ret != 0) {
             EIDSP_ERR(ret);
         }
+
+        // FFT input and output, shared by all frames
+        EI_DSP_MATRIX(fft_scratch, 1, numpy::rfft_scratch_size(fft_length));
+
         for (size_t ix = 0; ix < stack_frame_info.frame_ixs->size(); ix++) {
             size_t power_spectrum_frame_size = (fft_length / 2 + 1);
 
@@ -289,7 +293,8 @@ public:
                 stack_frame_info.frame_length,
                 power_spectrum_frame.buffer,
                 power_spectrum_frame_size,
-                fft_length
+                fft_length,
+                fft_scratch.buffer
             );
 
             if (ret != 0) {
@@ -372,6 +377,9 @@ public:
             *(out_features->buffer + i) = 0;
         }
 
+        // FFT input and output, shared by all frames
+        EI_DSP_MATRIX(fft_scratch, 1, numpy::rfft_scratch_size(fft_length));
+
         for (size_t ix = 0; ix < stack_frame_info.frame_ixs->size(); ix++) {
             // get signal data from the audio file
             EI_DSP_MATRIX(signal_frame, 1, stack_frame_info.frame_length);
@@ -417,7 +425,8 @@ public:
                 stack_frame_info.frame_length,
                 out_features->buffer + (ix * coefficients),
                 coefficients,
-                fft_length
+                fft_length,
+                fft_scratch.buffer
             );
 
             if (ret != 0) {
@@ -0,0 +1,405 @@
+/* Edge Impulse inferencing library
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _EIDSP_SPEECHPY_FEATURE_STREAM_H_
+#define _EIDSP_SPEECHPY_FEATURE_STREAM_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "../numpy.hpp"
+#include "../memory.hpp"
+#include "functions.hpp"
+#include "processing.hpp"
+#include "feature.hpp"
+
+namespace ei {
+namespace speechpy {
+
+typedef struct {
+    uint32_t sampling_frequency;
+    float frame_length;
+    float frame_stride;
+    uint16_t num_filters;
+    uint16_t fft_length;
+    uint32_t low_frequency;
+    uint32_t high_frequency;
+    /** 0 for MFE output, otherwise the number of MFCC coefficients */
+    uint8_t num_cepstral;
+    /** MFCC only, replace the first coefficient with the log frame energy */
+    bool dc_elimination;
+    /** 0 disables preemphasis */
+    int pre_shift;
+    float pre_cof;
+    bool pre_rescale;
+    uint16_t version;
+} feature_stream_config_t;
+
+/**
+ * Streaming MFE / MFCC extraction for continuous audio.
+ *
+ * The preemphasis history and the samples of the frame that is not complete
+ * yet are carried over between calls, so every frame is computed exactly
+ * once, frames that straddle two slices included, and only the rows of the
+ * new frames are produced. The work per call is proportional to the number
+ * of new samples. The filterbank is only calculated on init.
+ *
+ * Every frame runs through the same operations as feature::mfe() and
+ * feature::mfcc(), so the rows are bit-exact with a full window extraction
+ * of the same preemphasized audio.
+ */
+class feature_stream {
+public:
+    feature_stream()
+        : _initialized(false), _frame(NULL), _scaled_frame(NULL), _power(NULL),
+          _fft_scratch(NULL), _mfe_row(NULL), _history(NULL), _filterbanks(NULL)
+    {
+        memset(&_config, 0, sizeof(_config));
+    }
+
+    ~feature_stream() {
+        release();
+    }
+
+    /**
+     * Allocate the buffers and calculate the filterbank
+     * @param config Stream configuration
+     * @returns EIDSP_OK if OK
+     */
+    int init(const feature_stream_config_t *config) {
+        release();
+
+        _config = *config;
+
+        if (_config.high_frequency == 0) {
+            _config.high_frequency = _config.sampling_frequency / 2;
+        }
+        if (_config.low_frequency == 0) {
+            _config.low_frequency = 300;
+        }
+
+        // same frame sizes as processing::stack_frames()
+        float frequency = static_cast<float>(_config.sampling_frequency);
+        if (_config.version == 1) {
+            _frame_length = static_cast<size_t>(round(frequency * _config.frame_length));
+            _frame_stride = static_cast<size_t>(round(frequency * _config.frame_stride));
+        }
+        else {
+            _frame_length = static_cast<size_t>(
+                processing::ceil_unless_very_close_to_floor(frequency * _config.frame_length));
+            _frame_stride = static_cast<size_t>(
+                processing::ceil_unless_very_close_to_floor(frequency * _config.frame_stride));
+        }
+
+        if (_frame_length == 0 || _frame_stride == 0 || _frame_stride > _frame_length) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        if (_config.num_cepstral > _config.num_filters) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        _coefficients = _config.fft_length / 2 + 1;
+
+        _frame = (float*)ei_dsp_calloc(_frame_length * sizeof(float), 1);
+        _scaled_frame = (float*)ei_dsp_calloc(_frame_length * sizeof(float), 1);
+        _power = (float*)ei_dsp_calloc(_coefficients * sizeof(float), 1);
+        _fft_scratch = (float*)ei_dsp_calloc(numpy::rfft_scratch_size(_config.fft_length) * sizeof(float), 1);
+        _mfe_row = (float*)ei_dsp_calloc(_config.num_filters * sizeof(float), 1);
+        if (_config.pre_shift > 0) {
+            _history = (float*)ei_dsp_calloc(_config.pre_shift * sizeof(float), 1);
+        }
+
+#if EIDSP_QUANTIZE_FILTERBANK
+        _filterbanks = new quantized_matrix_t(_config.num_filters, _coefficients, &numpy::dequantize_zero_one);
+#else
+        _filterbanks = new matrix_t(_config.num_filters, _coefficients);
+#endif
+
+        if (!_frame || !_scaled_frame || !_power || !_fft_scratch || !_mfe_row ||
+            (_config.pre_shift > 0 && !_history) || !_filterbanks || !_filterbanks->buffer) {
+            release();
+            EIDSP_ERR(EIDSP_OUT_OF_MEM);
+        }
+
+        int ret = feature::filterbanks(_filterbanks, _config.num_filters, _coefficients,
+            _config.sampling_frequency, _config.low_frequency, _config.high_frequency, true);
+        if (ret != EIDSP_OK) {
+            release();
+            EIDSP_ERR(ret);
+        }
+
+        _initialized = true;
+        reset();
+
+        return EIDSP_OK;
+    }
+
+    /**
+     * Drop the carried over samples, the next call starts a new stream
+     */
+    void reset() {
+        _frame_ix = 0;
+        if (_history) {
+            memset(_history, 0, _config.pre_shift * sizeof(float));
+        }
+    }
+
+    /**
+     * Free all buffers
+     */
+    void release() {
+        if (_frame) {
+            ei_dsp_free(_frame, _frame_length * sizeof(float));
+        }
+        if (_scaled_frame) {
+            ei_dsp_free(_scaled_frame, _frame_length * sizeof(float));
+        }
+        if (_power) {
+            ei_dsp_free(_power, _coefficients * sizeof(float));
+        }
+        if (_fft_scratch) {
+            ei_dsp_free(_fft_scratch, numpy::rfft_scratch_size(_config.fft_length) * sizeof(float));
+        }
+        if (_mfe_row) {
+            ei_dsp_free(_mfe_row, _config.num_filters * sizeof(float));
+        }
+        if (_history) {
+            ei_dsp_free(_history, _config.pre_shift * sizeof(float));
+        }
+        if (_filterbanks) {
+            delete _filterbanks;
+        }
+
+        _frame = NULL;
+        _scaled_frame = NULL;
+        _power = NULL;
+        _fft_scratch = NULL;
+        _mfe_row = NULL;
+        _history = NULL;
+        _filterbanks = NULL;
+        _initialized = false;
+    }
+
+    bool is_initialized() const {
+        return _initialized;
+    }
+
+    /**
+     * Number of values in one output row
+     */
+    size_t cols() const {
+        return _config.num_cepstral > 0 ? _config.num_cepstral : _config.num_filters;
+    }
+
+    /**
+     * Number of frames that complete when this many samples are added
+     */
+    size_t frames_for(size_t new_samples) const {
+        size_t available = _frame_ix + new_samples;
+        if (available < _frame_length) {
+            return 0;
+        }
+        return ((available - _frame_length) / _frame_stride) + 1;
+    }
+
+    /**
+     * Add a slice of audio. The output matrix is rolled back by the number
+     * of new values and the rows of the new frames are written at the end.
+     * @param signal New audio samples
+     * @param output_matrix Feature buffer of the whole window
+     * @param matrix_size_out Number of rows and columns written
+     * @returns EIDSP_OK if OK
+     */
+    int process(signal_t *signal, matrix_t *output_matrix, matrix_size_t *matrix_size_out) {
+        if (!_initialized) {
+            EIDSP_ERR(EIDSP_PARAMETER_INVALID);
+        }
+
+        const size_t row_size = cols();
+        const size_t n_frames = frames_for(signal->total_length);
+        const size_t output_size = output_matrix->rows * output_matrix->cols;
+
+        if (n_frames * row_size > output_size) {
+            EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
+        }
+
+        int ret = numpy::roll(output_matrix->buffer, output_size, -(int)(n_frames * row_size));
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        float *out = output_matrix->buffer + output_size - (n_frames * row_size);
+        size_t offset = 0;
+
+        while (offset < signal->total_length) {
+            size_t length = _frame_length - _frame_ix;
+            if (length > signal->total_length - offset) {
+                length = signal->total_length - offset;
+            }
+
+            ret = signal->get_data(offset, length, _frame + _frame_ix);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+            preemphasize(_frame + _frame_ix, length);
+
+            _frame_ix += length;
+            offset += length;
+
+            if (_frame_ix < _frame_length) {
+                break;
+            }
+
+            ret = compute_frame(out);
+            if (ret != EIDSP_OK) {
+                EIDSP_ERR(ret);
+            }
+            out += row_size;
+
+            // keep the overlap for the next frame
+            memmove(_frame, _frame + _frame_stride, (_frame_length - _frame_stride) * sizeof(float));
+            _frame_ix = _frame_length - _frame_stride;
+        }
+
+        matrix_size_out->rows = n_frames;
+        matrix_size_out->cols = row_size;
+
+        return EIDSP_OK;
+    }
+
+private:
+    /**
+     * Preemphasis with the history carried over from the previous call,
+     * same arithmetic as processing::preemphasis::get_data()
+     */
+    void preemphasize(float *buffer, size_t length) {
+        if (_config.pre_shift <= 0) {
+            return;
+        }
+
+        for (size_t ix = 0; ix < length; ix++) {
+            float now = buffer[ix];
+            buffer[ix] = now - (_config.pre_cof * _history[0]);
+
+            if (_config.pre_shift != 1) {
+                numpy::roll(_history, _config.pre_shift, -1);
+            }
+            _history[_config.pre_shift - 1] = now;
+        }
+    }
+
+    /**
+     * Compute one output row from the complete frame
+     */
+    int compute_frame(float *out) {
+        float *frame = _frame;
+
+        // the full window rescales per frame read, so decide per frame here too
+        if (_config.pre_shift > 0 && _config.pre_rescale) {
+            bool all_between_min_1_and_1 = true;
+            for (size_t ix = 0; ix < _frame_length; ix++) {
+                if (_frame[ix] < -1.0f || _frame[ix] > 1.0f) {
+                    all_between_min_1_and_1 = false;
+                    break;
+                }
+            }
+
+            if (!all_between_min_1_and_1) {
+                memcpy(_scaled_frame, _frame, _frame_length * sizeof(float));
+                matrix_t scale_matrix(_frame_length, 1, _scaled_frame);
+                int ret = numpy::scale(&scale_matrix, 1.0f / 32768.0f);
+                if (ret != EIDSP_OK) {
+                    EIDSP_ERR(ret);
+                }
+                frame = _scaled_frame;
+            }
+        }
+
+        int ret = processing::power_spectrum(frame, _frame_length, _power, _coefficients, _config.fft_length,
+            _fft_scratch);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        float energy = numpy::sum(_power, _coefficients);
+        if (energy == 0) {
+            energy = 1e-10;
+        }
+
+        matrix_t mfe_row(1, _config.num_filters, _mfe_row);
+        memset(_mfe_row, 0, _config.num_filters * sizeof(float));
+
+        ret = numpy::dot_by_row(0, _power, _coefficients, _filterbanks, &mfe_row);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        functions::zero_handling(&mfe_row);
+
+        if (_config.num_cepstral == 0) {
+            memcpy(out, _mfe_row, _config.num_filters * sizeof(float));
+            return EIDSP_OK;
+        }
+
+        ret = numpy::log(&mfe_row);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        ret = numpy::dct2(&mfe_row, DCT_NORMALIZATION_ORTHO);
+        if (ret != EIDSP_OK) {
+            EIDSP_ERR(ret);
+        }
+
+        if (_config.dc_elimination) {
+            _mfe_row[0] = numpy::log(energy);
+        }
+
+        memcpy(out, _mfe_row, _config.num_cepstral * sizeof(float));
+
+        return EIDSP_OK;
+    }
+
+    feature_stream_config_t _config;
+    bool _initialized;
+    size_t _frame_length;
+    size_t _frame_stride;
+    size_t _frame_ix;
+    uint16_t _coefficients;
+    float *_frame;
+    float *_scaled_frame;
+    float *_power;
+    /** FFT input and output of power_spectrum() */
+    float *_fft_scratch;
+    float *_mfe_row;
+    float *_history;
+#if EIDSP_QUANTIZE_FILTERBANK
+    quantized_matrix_t *_filterbanks;
+#else
+    matrix_t *_filterbanks;
+#endif
+};
+
+} // namespace speechpy
+} // namespace ei
+
+#endif // _EIDSP_SPEECHPY_FEATURE_STREAM_H_
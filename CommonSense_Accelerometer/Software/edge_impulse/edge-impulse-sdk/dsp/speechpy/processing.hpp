@@ -400,23 +400,31 @@ namespace processing {
      * @param out_buffer Out buffer, size should be fft_points
      * @param out_buffer_size Buffer size
      * @param fft_points (int): The length of FFT. If fft_length is greater than frame_len, the frames will be zero-padded.
+     * @param scratch numpy::rfft_scratch_size(fft_points) values for the FFT, NULL allocates them per call
      * @returns EIDSP_OK if OK
      */
-    static int power_spectrum(float *frame, size_t frame_size, float *out_buffer, size_t out_buffer_size, uint16_t fft_points)
+    static int power_spectrum(float *frame, size_t frame_size, float *out_buffer, size_t out_buffer_size, uint16_t fft_points,
+        float *scratch = NULL)
     {
         if (out_buffer_size != static_cast<size_t>(fft_points / 2 + 1)) {
             EIDSP_ERR(EIDSP_MATRIX_SIZE_MISMATCH);
         }
 
-        int r = numpy::rfft(frame, frame_size, out_buffer, out_buffer_size, fft_points);
+        EI_DSP_MATRIX_B(fft_scratch, 1, numpy::rfft_scratch_size(fft_points), scratch);
+        float *fft_input = fft_scratch.buffer;
+        float *fft_output = fft_scratch.buffer + fft_points;
+
+        size_t fft_input_size = frame_size < fft_points ? frame_size : fft_points;
+        memcpy(fft_input, frame, fft_input_size * sizeof(float));
+
+        // power straight from the FFT, no square root and square per bin
+        int r = numpy::rfft_spectrum(fft_input, fft_input_size, fft_output, fft_points,
+            rfft_power, 1.0f / static_cast<float>(fft_points));
         if (r != EIDSP_OK) {
             return r;
         }
 
-        for (size_t ix = 0; ix < out_buffer_size; ix++) {
-            out_buffer[ix] = (1.0 / static_cast<float>(fft_points)) *
-                (out_buffer[ix] * out_buffer[ix]);
-        }
+        memcpy(out_buffer, fft_output, out_buffer_size * sizeof(float));
 
         return EIDSP_OK;
     }
@@ -27,5 +27,6 @@
 #include "feature.hpp"
 #include "functions.hpp"
 #include "processing.hpp"
+#include "feature_stream.hpp"
 
 #endif // _EIDSP_SPEECHPY_SPEECHPY_H_
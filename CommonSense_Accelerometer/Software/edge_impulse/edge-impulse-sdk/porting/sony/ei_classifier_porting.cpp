@@ -52,7 +52,7 @@ uint64_t ei_read_timer_ms() {
 
     spresense_time_cb(&seconds, &nano_seconds);
 
-    time_ms = (seconds * 1000) + (nano_seconds / 1000000);
+    time_ms = ((uint64_t)seconds * 1000) + (nano_seconds / 1000000);
     return time_ms;
 }
 
@@ -63,7 +63,7 @@ uint64_t ei_read_timer_us() {
 
     spresense_time_cb(&seconds, &nano_seconds);
 
-    time_us = (seconds * 1000000) + (nano_seconds / 1000);
+    time_us = ((uint64_t)seconds * 1000000) + (nano_seconds / 1000);
     return time_us;
 }
 
@@ -27,6 +27,8 @@
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 #include "edge-impulse-sdk/tensorflow/lite/micro/micro_mutable_op_resolver.h"
 #include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "edge-impulse-sdk/dsp/ei_profiler.h"
+#include "trained_model_compiled.h"
 
 #if EI_CLASSIFIER_PRINT_STATE
 #if defined(__cplusplus) && EI_C_LINKAGE == 1
@@ -67,15 +69,15 @@ uint8_t tensor_arena[kTensorArenaSize] ALIGN(16) __attribute__((section(".tensor
 uint8_t* tensor_arena = NULL;
 #endif
 
-static uint8_t* tensor_boundary;
-static uint8_t* current_location;
-
 template <int SZ, class T> struct TfArray {
   int sz; T elem[SZ];
 };
 enum used_operators_e {
   OP_FULLY_CONNECTED, OP_SOFTMAX,  OP_LAST
 };
+const char * const used_operators_names[OP_LAST] = {
+  "FULLY_CONNECTED", "SOFTMAX",
+};
 struct TensorInfo_t { // subset of TfLiteTensor used for initialization from constant memory
   TfLiteAllocationType allocation_type;
   TfLiteType type;
@@ -91,11 +93,11 @@ struct NodeInfo_t { // subset of TfLiteNode used for initialization from constan
   used_operators_e used_op_index;
 };
 
-TfLiteContext ctx{};
-TfLiteTensor tflTensors[11];
-TfLiteEvalTensor tflEvalTensors[11];
-TfLiteRegistration registrations[OP_LAST];
-TfLiteNode tflNodes[4];
+// Per-instance state lives in trained_model_ctx_t, everything here is shared and read-only
+const TfLiteRegistration registrations[OP_LAST] = {
+  Register_FULLY_CONNECTED(),
+  Register_SOFTMAX(),
+};
 
 const TfArray<2, int> tensor_dimension0 = { 2, { 1,33 } };
 const TfArray<1, float> quant0_scale = { 1, { 0.11322642862796783, } };
@@ -214,11 +216,17 @@ const TensorInfo_t tensorData[] = {
   { (TfLiteIntArray*)&inputs2, (TfLiteIntArray*)&outputs2, const_cast<void*>(static_cast<const void*>(&opdata2)), OP_FULLY_CONNECTED, },
   { (TfLiteIntArray*)&inputs3, (TfLiteIntArray*)&outputs3, const_cast<void*>(static_cast<const void*>(&opdata3)), OP_SOFTMAX, },
 };
-static std::vector<void*> overflow_buffers;
+trained_model_ctx_t default_model;
+
+static inline trained_model_ctx_t *GetModel(const struct TfLiteContext* ctx) {
+  return (trained_model_ctx_t*)ctx->impl_;
+}
+
 static void * AllocatePersistentBuffer(struct TfLiteContext* ctx,
                                        size_t bytes) {
+  trained_model_ctx_t *model = GetModel(ctx);
   void *ptr;
-  if (current_location - bytes < tensor_boundary) {
+  if (model->current_location - bytes < model->tensor_boundary) {
     // OK, this will look super weird, but.... we have CMSIS-NN buffers which
     // we cannot calculate beforehand easily.
     ptr = ei_calloc(bytes, 1);
@@ -226,26 +234,23 @@ static void * AllocatePersistentBuffer(struct TfLiteContext* ctx,
       printf("ERR: Failed to allocate persistent buffer of size %d\n", (int)bytes);
       return NULL;
     }
-    overflow_buffers.push_back(ptr);
+    model->overflow_buffers.push_back(ptr);
+    model->overflow_bytes += bytes;
     return ptr;
   }
 
-  current_location -= bytes;
+  model->current_location -= bytes;
 
-  ptr = current_location;
+  ptr = model->current_location;
   memset(ptr, 0, bytes);
 
   return ptr;
 }
-typedef struct {
-  size_t bytes;
-  void *ptr;
-} scratch_buffer_t;
-static std::vector<scratch_buffer_t> scratch_buffers;
 
 static TfLiteStatus RequestScratchBufferInArena(struct TfLiteContext* ctx, size_t bytes,
                                                 int* buffer_idx) {
-  scratch_buffer_t b;
+  trained_model_ctx_t *model = GetModel(ctx);
+  trained_model_scratch_buffer_t b;
   b.bytes = bytes;
 
   b.ptr = AllocatePersistentBuffer(ctx, b.bytes);
@@ -253,113 +258,117 @@ static TfLiteStatus RequestScratchBufferInArena(struct TfLiteContext* ctx, size_
     return kTfLiteError;
   }
 
-  scratch_buffers.push_back(b);
+  model->scratch_buffers.push_back(b);
 
-  *buffer_idx = scratch_buffers.size() - 1;
+  *buffer_idx = model->scratch_buffers.size() - 1;
 
   return kTfLiteOk;
 }
 
 static void* GetScratchBuffer(struct TfLiteContext* ctx, int buffer_idx) {
-  if (buffer_idx > static_cast<int>(scratch_buffers.size()) - 1) {
+  trained_model_ctx_t *model = GetModel(ctx);
+  if (buffer_idx > static_cast<int>(model->scratch_buffers.size()) - 1) {
     return NULL;
   }
-  return scratch_buffers[buffer_idx].ptr;
+  return model->scratch_buffers[buffer_idx].ptr;
 }
 
 static TfLiteTensor* GetTensor(const struct TfLiteContext* context,
                                int tensor_idx) {
-  return &tflTensors[tensor_idx];
+  return &GetModel(context)->tflTensors[tensor_idx];
 }
 
 static TfLiteEvalTensor* GetEvalTensor(const struct TfLiteContext* context,
                                        int tensor_idx) {
-  return &tflEvalTensors[tensor_idx];
+  return &GetModel(context)->tflEvalTensors[tensor_idx];
 }
 
-} // namespace
-
-TfLiteStatus trained_model_init( void*(*alloc_fnc)(size_t,size_t) ) {
-#ifdef EI_CLASSIFIER_ALLOCATION_HEAP
-  tensor_arena = (uint8_t*) alloc_fnc(16, kTensorArenaSize);
-  if (!tensor_arena) {
-    printf("ERR: failed to allocate tensor arena\n");
-    return kTfLiteError;
-  }
-#else
-  memset(tensor_arena, 0, kTensorArenaSize);
+// Points the tensors of an instance into its arena and runs init and prepare of every node.
+static TfLiteStatus PrepareModel(trained_model_ctx_t *model) {
+#if EI_CLASSIFIER_NODE_TIMING
+  // node latencies read the cycle counter, also when the profiler is off
+  ei_profiler_enable_counter();
 #endif
-  tensor_boundary = tensor_arena;
-  current_location = tensor_arena + kTensorArenaSize;
-  ctx.AllocatePersistentBuffer = &AllocatePersistentBuffer;
-  ctx.RequestScratchBufferInArena = &RequestScratchBufferInArena;
-  ctx.GetScratchBuffer = &GetScratchBuffer;
-  ctx.GetTensor = &GetTensor;
-  ctx.GetEvalTensor = &GetEvalTensor;
-  ctx.tensors = tflTensors;
-  ctx.tensors_size = 11;
+  model->tensor_boundary = model->tensor_arena;
+  model->current_location = model->tensor_arena + kTensorArenaSize;
+  model->overflow_bytes = 0;
+  model->scratch_buffers.clear();
+  model->overflow_buffers.clear();
+
+  TfLiteContext *ctx = &model->ctx;
+  memset(ctx, 0, sizeof(TfLiteContext));
+  ctx->impl_ = model;
+  ctx->AllocatePersistentBuffer = &AllocatePersistentBuffer;
+  ctx->RequestScratchBufferInArena = &RequestScratchBufferInArena;
+  ctx->GetScratchBuffer = &GetScratchBuffer;
+  ctx->GetTensor = &GetTensor;
+  ctx->GetEvalTensor = &GetEvalTensor;
+  ctx->tensors = model->tflTensors;
+  ctx->tensors_size = 11;
   for(size_t i = 0; i < 11; ++i) {
-    tflTensors[i].type = tensorData[i].type;
-    tflEvalTensors[i].type = tensorData[i].type;
-    tflTensors[i].is_variable = 0;
-
+    TfLiteTensor *tensor = &model->tflTensors[i];
+    TfLiteEvalTensor *eval_tensor = &model->tflEvalTensors[i];
+    memset(tensor, 0, sizeof(TfLiteTensor));
+    tensor->type = tensorData[i].type;
+    eval_tensor->type = tensorData[i].type;
+    tensor->is_variable = 0;
+
+    // arena tensors are stored as offsets into the arena, every instance maps them into its own one
 #if defined(EI_CLASSIFIER_ALLOCATION_HEAP)
-    tflTensors[i].allocation_type = tensorData[i].allocation_type;
+    bool in_arena = tensorData[i].allocation_type == kTfLiteArenaRw;
+    uintptr_t arena_offset = (uintptr_t)tensorData[i].data;
 #else
-    tflTensors[i].allocation_type = (tensor_arena <= tensorData[i].data && tensorData[i].data < tensor_arena + kTensorArenaSize) ? kTfLiteArenaRw : kTfLiteMmapRo;
+    bool in_arena = tensor_arena <= tensorData[i].data && tensorData[i].data < tensor_arena + kTensorArenaSize;
+    uintptr_t arena_offset = (uintptr_t)((uint8_t*)tensorData[i].data - tensor_arena);
 #endif
-    tflTensors[i].bytes = tensorData[i].bytes;
-    tflTensors[i].dims = tensorData[i].dims;
-    tflEvalTensors[i].dims = tensorData[i].dims;
+    tensor->allocation_type = in_arena ? kTfLiteArenaRw : kTfLiteMmapRo;
+    tensor->bytes = tensorData[i].bytes;
+    tensor->dims = tensorData[i].dims;
+    eval_tensor->dims = tensorData[i].dims;
 
-#if defined(EI_CLASSIFIER_ALLOCATION_HEAP)
-    if(tflTensors[i].allocation_type == kTfLiteArenaRw){
-      uint8_t* start = (uint8_t*) ((uintptr_t)tensorData[i].data + (uintptr_t) tensor_arena);
+    if (in_arena) {
+      uint8_t* start = model->tensor_arena + arena_offset;
 
-     tflTensors[i].data.data =  start;
-     tflEvalTensors[i].data.data =  start;
+      tensor->data.data = start;
+      eval_tensor->data.data = start;
     }
-    else{
-       tflTensors[i].data.data = tensorData[i].data;
-       tflEvalTensors[i].data.data = tensorData[i].data;
+    else {
+      tensor->data.data = tensorData[i].data;
+      eval_tensor->data.data = tensorData[i].data;
     }
-#else
-    tflTensors[i].data.data = tensorData[i].data;
-    tflEvalTensors[i].data.data = tensorData[i].data;
-#endif // EI_CLASSIFIER_ALLOCATION_HEAP
-    tflTensors[i].quantization = tensorData[i].quantization;
-    if (tflTensors[i].quantization.type == kTfLiteAffineQuantization) {
+    tensor->quantization = tensorData[i].quantization;
+    if (tensor->quantization.type == kTfLiteAffineQuantization) {
       TfLiteAffineQuantization const* quant = ((TfLiteAffineQuantization const*)(tensorData[i].quantization.params));
-      tflTensors[i].params.scale = quant->scale->data[0];
-      tflTensors[i].params.zero_point = quant->zero_point->data[0];
+      tensor->params.scale = quant->scale->data[0];
+      tensor->params.zero_point = quant->zero_point->data[0];
     }
-    if (tflTensors[i].allocation_type == kTfLiteArenaRw) {
-      auto data_end_ptr = (uint8_t*)tflTensors[i].data.data + tensorData[i].bytes;
-      if (data_end_ptr > tensor_boundary) {
-        tensor_boundary = data_end_ptr;
+    if (tensor->allocation_type == kTfLiteArenaRw) {
+      auto data_end_ptr = (uint8_t*)tensor->data.data + tensorData[i].bytes;
+      if (data_end_ptr > model->tensor_boundary) {
+        model->tensor_boundary = data_end_ptr;
       }
     }
   }
-  if (tensor_boundary > current_location /* end of arena size */) {
+  if (model->tensor_boundary > model->current_location /* end of arena size */) {
     printf("ERR: tensor arena is too small, does not fit model - even without scratch buffers\n");
     return kTfLiteError;
   }
-  registrations[OP_FULLY_CONNECTED] = Register_FULLY_CONNECTED();
-  registrations[OP_SOFTMAX] = Register_SOFTMAX();
 
   for(size_t i = 0; i < 4; ++i) {
-    tflNodes[i].inputs = nodeData[i].inputs;
-    tflNodes[i].outputs = nodeData[i].outputs;
-    tflNodes[i].builtin_data = nodeData[i].builtin_data;
-    tflNodes[i].custom_initial_data = nullptr;
-    tflNodes[i].custom_initial_data_size = 0;
+    TfLiteNode *node = &model->tflNodes[i];
+    memset(node, 0, sizeof(TfLiteNode));
+    node->inputs = nodeData[i].inputs;
+    node->outputs = nodeData[i].outputs;
+    node->builtin_data = nodeData[i].builtin_data;
+    node->custom_initial_data = nullptr;
+    node->custom_initial_data_size = 0;
     if (registrations[nodeData[i].used_op_index].init) {
-      tflNodes[i].user_data = registrations[nodeData[i].used_op_index].init(&ctx, (const char*)tflNodes[i].builtin_data, 0);
+      node->user_data = registrations[nodeData[i].used_op_index].init(ctx, (const char*)node->builtin_data, 0);
     }
   }
   for(size_t i = 0; i < 4; ++i) {
     if (registrations[nodeData[i].used_op_index].prepare) {
-      TfLiteStatus status = registrations[nodeData[i].used_op_index].prepare(&ctx, &tflNodes[i]);
+      TfLiteStatus status = registrations[nodeData[i].used_op_index].prepare(ctx, &model->tflNodes[i]);
       if (status != kTfLiteOk) {
         return status;
       }
@@ -368,47 +377,81 @@ TfLiteStatus trained_model_init( void*(*alloc_fnc)(size_t,size_t) ) {
   return kTfLiteOk;
 }
 
+} // namespace
+
+TfLiteStatus trained_model_ctx_init(trained_model_ctx_t *model, void*(*alloc_fnc)(size_t,size_t)) {
+  model->tensor_arena = (uint8_t*) alloc_fnc(16, kTensorArenaSize);
+  if (!model->tensor_arena) {
+    printf("ERR: failed to allocate tensor arena\n");
+    return kTfLiteError;
+  }
+  memset(model->tensor_arena, 0, kTensorArenaSize);
+  model->owns_arena = true;
+  return PrepareModel(model);
+}
+
+TfLiteStatus trained_model_init( void*(*alloc_fnc)(size_t,size_t) ) {
+#ifdef EI_CLASSIFIER_ALLOCATION_HEAP
+  return trained_model_ctx_init(&default_model, alloc_fnc);
+#else
+  memset(tensor_arena, 0, kTensorArenaSize);
+  default_model.tensor_arena = tensor_arena;
+  default_model.owns_arena = false;
+  return PrepareModel(&default_model);
+#endif
+}
+
 static const int inTensorIndices[] = {
   0, 
 };
+TfLiteTensor* trained_model_ctx_input(trained_model_ctx_t *model, int index) {
+  return &model->tflTensors[inTensorIndices[index]];
+}
+
 TfLiteTensor* trained_model_input(int index) {
-  return &ctx.tensors[inTensorIndices[index]];
+  return trained_model_ctx_input(&default_model, index);
 }
 
 static const int outTensorIndices[] = {
   10, 
 };
+TfLiteTensor* trained_model_ctx_output(trained_model_ctx_t *model, int index) {
+  return &model->tflTensors[outTensorIndices[index]];
+}
+
 TfLiteTensor* trained_model_output(int index) {
-  return &ctx.tensors[outTensorIndices[index]];
+  return trained_model_ctx_output(&default_model, index);
 }
 
-TfLiteStatus trained_model_invoke() {
+TfLiteStatus trained_model_ctx_invoke(trained_model_ctx_t *model) {
   for(size_t i = 0; i < 4; ++i) {
-    TfLiteStatus status = registrations[nodeData[i].used_op_index].invoke(&ctx, &tflNodes[i]);
+    EI_PROFILE_START_INDEX(node_prof, used_operators_names[nodeData[i].used_op_index], i);
+#if EI_CLASSIFIER_NODE_TIMING
+    uint32_t node_start = ei_profiler_ticks();
+#endif
+    TfLiteStatus status = registrations[nodeData[i].used_op_index].invoke(&model->ctx, &model->tflNodes[i]);
+#if EI_CLASSIFIER_NODE_TIMING
+    model->node_ticks[i] = ei_profiler_ticks() - node_start;
+#endif
+    EI_PROFILE_STOP(node_prof);
 
 #if EI_CLASSIFIER_PRINT_STATE
     ei_printf("layer %lu\n", i);
     ei_printf("    inputs:\n");
-    for (size_t ix = 0; ix < tflNodes[i].inputs->size; ix++) {
-      auto d = tensorData[tflNodes[i].inputs->data[ix]];
+    for (size_t ix = 0; ix < model->tflNodes[i].inputs->size; ix++) {
+      const TfLiteTensor *d = &model->tflTensors[model->tflNodes[i].inputs->data[ix]];
 
-      size_t data_ptr = (size_t)d.data;
-
-      if (d.allocation_type == kTfLiteArenaRw) {
-        data_ptr = (size_t)tensor_arena + data_ptr;
-      }
-
-      if (d.type == TfLiteType::kTfLiteInt8) {
-        int8_t* data = (int8_t*)data_ptr;
-        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d.bytes, data, (int)d.allocation_type, (int)d.type);
-        for (size_t jx = 0; jx < d.bytes; jx++) {
+      if (d->type == TfLiteType::kTfLiteInt8) {
+        int8_t* data = d->data.int8;
+        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d->bytes, data, (int)d->allocation_type, (int)d->type);
+        for (size_t jx = 0; jx < d->bytes; jx++) {
           ei_printf("%d ", data[jx]);
         }
       }
       else {
-        float* data = (float*)data_ptr;
-        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d.bytes, data, (int)d.allocation_type, (int)d.type);
-        for (size_t jx = 0; jx < d.bytes / 4; jx++) {
+        float* data = d->data.f;
+        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d->bytes, data, (int)d->allocation_type, (int)d->type);
+        for (size_t jx = 0; jx < d->bytes / 4; jx++) {
           ei_printf("%f ", data[jx]);
         }
       }
@@ -417,26 +460,20 @@ TfLiteStatus trained_model_invoke() {
     ei_printf("\n");
 
     ei_printf("    outputs:\n");
-    for (size_t ix = 0; ix < tflNodes[i].outputs->size; ix++) {
-      auto d = tensorData[tflNodes[i].outputs->data[ix]];
-
-      size_t data_ptr = (size_t)d.data;
-
-      if (d.allocation_type == kTfLiteArenaRw) {
-        data_ptr = (size_t)tensor_arena + data_ptr;
-      }
+    for (size_t ix = 0; ix < model->tflNodes[i].outputs->size; ix++) {
+      const TfLiteTensor *d = &model->tflTensors[model->tflNodes[i].outputs->data[ix]];
 
-      if (d.type == TfLiteType::kTfLiteInt8) {
-        int8_t* data = (int8_t*)data_ptr;
-        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d.bytes, data, (int)d.allocation_type, (int)d.type);
-        for (size_t jx = 0; jx < d.bytes; jx++) {
+      if (d->type == TfLiteType::kTfLiteInt8) {
+        int8_t* data = d->data.int8;
+        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d->bytes, data, (int)d->allocation_type, (int)d->type);
+        for (size_t jx = 0; jx < d->bytes; jx++) {
           ei_printf("%d ", data[jx]);
         }
       }
       else {
-        float* data = (float*)data_ptr;
-        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d.bytes, data, (int)d.allocation_type, (int)d.type);
-        for (size_t jx = 0; jx < d.bytes / 4; jx++) {
+        float* data = d->data.f;
+        ei_printf("        %lu (%zu bytes, ptr=%p, alloc_type=%d, type=%d): ", ix, d->bytes, data, (int)d->allocation_type, (int)d->type);
+        for (size_t jx = 0; jx < d->bytes / 4; jx++) {
           ei_printf("%f ", data[jx]);
         }
       }
@@ -452,14 +489,91 @@ TfLiteStatus trained_model_invoke() {
   return kTfLiteOk;
 }
 
+TfLiteStatus trained_model_invoke() {
+  return trained_model_ctx_invoke(&default_model);
+}
+
+TfLiteStatus trained_model_ctx_reset(trained_model_ctx_t *model, void (*free_fnc)(void* ptr)) {
+  if (model->owns_arena && model->tensor_arena) {
+    free_fnc(model->tensor_arena);
+  }
+  model->tensor_arena = NULL;
+  model->owns_arena = false;
+  model->scratch_buffers.clear();
+  for (size_t ix = 0; ix < model->overflow_buffers.size(); ix++) {
+    free(model->overflow_buffers[ix]);
+  }
+  model->overflow_buffers.clear();
+  return kTfLiteOk;
+}
+
 TfLiteStatus trained_model_reset( void (*free_fnc)(void* ptr) ) {
-#ifdef EI_CLASSIFIER_ALLOCATION_HEAP
-  free_fnc(tensor_arena);
+  return trained_model_ctx_reset(&default_model, free_fnc);
+}
+
+size_t trained_model_nodes() {
+  return 4;
+}
+
+float trained_model_ctx_node_time_us(const trained_model_ctx_t *model, size_t node) {
+#if EI_CLASSIFIER_NODE_TIMING
+  if (node < 4) {
+    return (float)model->node_ticks[node] / ei_profiler_ticks_per_us();
+  }
 #endif
-  scratch_buffers.clear();
-  for (size_t ix = 0; ix < overflow_buffers.size(); ix++) {
-    free(overflow_buffers[ix]);
+  return 0.0f;
+}
+
+float trained_model_node_time_us(size_t node) {
+  return trained_model_ctx_node_time_us(&default_model, node);
+}
+
+size_t trained_model_ctx_arena_used(const trained_model_ctx_t *model) {
+  return (size_t)(model->tensor_boundary - model->tensor_arena) + (size_t)(model->tensor_arena + kTensorArenaSize - model->current_location);
+}
+
+size_t trained_model_arena_used() {
+  return trained_model_ctx_arena_used(&default_model);
+}
+
+static void print_tensor_shapes(const TfLiteIntArray *tensors) {
+  for (int ix = 0; ix < tensors->size; ix++) {
+    const TfLiteIntArray *dims = tensorData[tensors->data[ix]].dims;
+    ei_printf(" [");
+    for (int jx = 0; jx < dims->size; jx++) {
+      ei_printf(jx == 0 ? "%d" : ",%d", dims->data[jx]);
+    }
+    ei_printf("]");
   }
-  overflow_buffers.clear();
-  return kTfLiteOk;
+}
+
+void trained_model_ctx_print_nodes(const trained_model_ctx_t *model) {
+#if EI_CLASSIFIER_NODE_TIMING
+  float total_us = 0.0f;
+  for (size_t i = 0; i < 4; ++i) {
+    total_us += trained_model_ctx_node_time_us(model, i);
+  }
+#endif
+  for (size_t i = 0; i < 4; ++i) {
+    ei_printf("node %d %s, in:", (int)i, used_operators_names[nodeData[i].used_op_index]);
+    print_tensor_shapes(nodeData[i].inputs);
+    ei_printf(", out:");
+    print_tensor_shapes(nodeData[i].outputs);
+#if EI_CLASSIFIER_NODE_TIMING
+    float time_us = trained_model_ctx_node_time_us(model, i);
+    ei_printf(", time: ");
+    ei_printf_float(time_us);
+    ei_printf(" us (%d%%)", total_us > 0.0f ? (int)(100.0f * time_us / total_us) : 0);
+#endif
+    ei_printf("\n");
+  }
+  ei_printf("arena: %d of %d bytes used", (int)trained_model_ctx_arena_used(model), kTensorArenaSize);
+  if (model->overflow_bytes > 0) {
+    ei_printf(", %d bytes overflowed to heap", (int)model->overflow_bytes);
+  }
+  ei_printf("\n");
+}
+
+void trained_model_print_nodes() {
+  trained_model_ctx_print_nodes(&default_model);
 }
@@ -23,8 +23,98 @@
 #ifndef trained_model_GEN_H
 #define trained_model_GEN_H
 
+#include <stdint.h>
+#include <vector>
 #include "edge-impulse-sdk/tensorflow/lite/c/common.h"
 
+// Compile the model with -DEI_TRAINED_MODEL_PREFIX=<name> to export it as <name>_init,
+// <name>_invoke, ... instead of trained_model_*, so several compiled models can be
+// linked into one application (see ei_run_multi_impulse.h).
+#ifdef EI_TRAINED_MODEL_PREFIX
+#define EI_TRAINED_MODEL_CONCAT_(prefix, name) prefix##_##name
+#define EI_TRAINED_MODEL_CONCAT(prefix, name) EI_TRAINED_MODEL_CONCAT_(prefix, name)
+#define EI_TRAINED_MODEL_NAME(name) EI_TRAINED_MODEL_CONCAT(EI_TRAINED_MODEL_PREFIX, name)
+#define trained_model_scratch_buffer_t EI_TRAINED_MODEL_NAME(scratch_buffer_t)
+#define trained_model_ctx_t EI_TRAINED_MODEL_NAME(ctx_t)
+#define trained_model_ctx_init EI_TRAINED_MODEL_NAME(ctx_init)
+#define trained_model_ctx_input EI_TRAINED_MODEL_NAME(ctx_input)
+#define trained_model_ctx_output EI_TRAINED_MODEL_NAME(ctx_output)
+#define trained_model_ctx_invoke EI_TRAINED_MODEL_NAME(ctx_invoke)
+#define trained_model_ctx_reset EI_TRAINED_MODEL_NAME(ctx_reset)
+#define trained_model_ctx_node_time_us EI_TRAINED_MODEL_NAME(ctx_node_time_us)
+#define trained_model_ctx_arena_used EI_TRAINED_MODEL_NAME(ctx_arena_used)
+#define trained_model_ctx_print_nodes EI_TRAINED_MODEL_NAME(ctx_print_nodes)
+#define trained_model_init EI_TRAINED_MODEL_NAME(init)
+#define trained_model_input EI_TRAINED_MODEL_NAME(input)
+#define trained_model_output EI_TRAINED_MODEL_NAME(output)
+#define trained_model_invoke EI_TRAINED_MODEL_NAME(invoke)
+#define trained_model_reset EI_TRAINED_MODEL_NAME(reset)
+#define trained_model_nodes EI_TRAINED_MODEL_NAME(nodes)
+#define trained_model_node_time_us EI_TRAINED_MODEL_NAME(node_time_us)
+#define trained_model_arena_used EI_TRAINED_MODEL_NAME(arena_used)
+#define trained_model_print_nodes EI_TRAINED_MODEL_NAME(print_nodes)
+#define trained_model_inputs EI_TRAINED_MODEL_NAME(inputs)
+#define trained_model_outputs EI_TRAINED_MODEL_NAME(outputs)
+#define trained_model_input_ptr EI_TRAINED_MODEL_NAME(input_ptr)
+#define trained_model_input_size EI_TRAINED_MODEL_NAME(input_size)
+#define trained_model_input_dims_len EI_TRAINED_MODEL_NAME(input_dims_len)
+#define trained_model_input_dims EI_TRAINED_MODEL_NAME(input_dims)
+#define trained_model_output_ptr EI_TRAINED_MODEL_NAME(output_ptr)
+#define trained_model_output_size EI_TRAINED_MODEL_NAME(output_size)
+#define trained_model_output_dims_len EI_TRAINED_MODEL_NAME(output_dims_len)
+#define trained_model_output_dims EI_TRAINED_MODEL_NAME(output_dims)
+#endif // EI_TRAINED_MODEL_PREFIX
+
+// Set to 1 to time every node in trained_model_invoke(), see trained_model_print_nodes()
+#ifndef EI_CLASSIFIER_NODE_TIMING
+#define EI_CLASSIFIER_NODE_TIMING 0
+#endif
+
+typedef struct {
+  size_t bytes;
+  void *ptr;
+} trained_model_scratch_buffer_t;
+
+// State of one model instance: arena, tensors and nodes. The weights and the
+// graph are read-only and shared, so instances can run concurrently (e.g. one
+// per thread on the host, or one per core), as long as each instance is only
+// used by one thread at a time.
+struct trained_model_ctx_t {
+  TfLiteContext ctx;
+  uint8_t *tensor_arena;
+  bool owns_arena;
+  uint8_t *tensor_boundary;
+  uint8_t *current_location;
+  TfLiteTensor tflTensors[11];
+  TfLiteEvalTensor tflEvalTensors[11];
+  TfLiteNode tflNodes[4];
+#if EI_CLASSIFIER_NODE_TIMING
+  uint32_t node_ticks[4];
+#endif
+  size_t overflow_bytes;
+  std::vector<void*> overflow_buffers;
+  std::vector<trained_model_scratch_buffer_t> scratch_buffers;
+};
+
+// Sets up a model instance, its tensor arena is allocated with alloc_fnc.
+TfLiteStatus trained_model_ctx_init(trained_model_ctx_t *model, void*(*alloc_fnc)(size_t,size_t));
+// Returns the input tensor with the given index of a model instance.
+TfLiteTensor *trained_model_ctx_input(trained_model_ctx_t *model, int index);
+// Returns the output tensor with the given index of a model instance.
+TfLiteTensor *trained_model_ctx_output(trained_model_ctx_t *model, int index);
+// Runs inference on a model instance.
+TfLiteStatus trained_model_ctx_invoke(trained_model_ctx_t *model);
+// Frees the arena and buffers of a model instance.
+TfLiteStatus trained_model_ctx_reset(trained_model_ctx_t *model, void (*free_fnc)(void* ptr));
+// Returns the time the node took in the last invoke of a model instance, in microseconds.
+float trained_model_ctx_node_time_us(const trained_model_ctx_t *model, size_t node);
+// Returns the number of tensor arena bytes in use by a model instance.
+size_t trained_model_ctx_arena_used(const trained_model_ctx_t *model);
+// Prints op type, tensor shapes and time of every node of a model instance.
+void trained_model_ctx_print_nodes(const trained_model_ctx_t *model);
+
+// The functions below run the default instance of the model.
+
 // Sets up the model with init and prepare steps.
 TfLiteStatus trained_model_init( void*(*alloc_fnc)(size_t,size_t) );
 // Returns the input tensor with the given index.
@@ -35,6 +125,14 @@ TfLiteTensor *trained_model_output(int index);
 TfLiteStatus trained_model_invoke();
 //Frees memory allocated
 TfLiteStatus trained_model_reset( void (*free)(void* ptr) );
+// Returns the number of nodes (operators) in the model.
+size_t trained_model_nodes();
+// Returns the time the node took in the last invoke, in microseconds (0 without EI_CLASSIFIER_NODE_TIMING).
+float trained_model_node_time_us(size_t node);
+// Returns the number of tensor arena bytes in use (tensors, persistent and scratch buffers).
+size_t trained_model_arena_used();
+// Prints op type, tensor shapes and time of every node, plus the arena watermark.
+void trained_model_print_nodes();
 
 
 // Returns the number of input tensors.
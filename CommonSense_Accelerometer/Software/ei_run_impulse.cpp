@@ -26,12 +26,42 @@
 #include "edge-impulse-sdk/dsp/numpy.hpp"
 #include "ei_microphone.h"
 #include "ei_inertialsensor.h"
+#include "ei_scheduler.h"
+#include "ei_fusion_sampler.h"
 // #include "ei_camera.h"
 
-/* Extern defined spresense library function */
-extern void spresense_pauseAudio(bool pause);
+#if defined(EI_CLASSIFIER_SENSOR) && (EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ACCELEROMETER \
+    || EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_9DOF || EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ENVIRONMENTAL)
 
-#if defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ACCELEROMETER
+/* Constant defines -------------------------------------------------------- */
+/** Sample through the fusion sampler (all sensors at their own rate) instead of the inertial sampler */
+#ifndef EI_RUN_FUSION
+#if EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ACCELEROMETER
+#define EI_RUN_FUSION               0
+#else
+#define EI_RUN_FUSION               1
+#endif
+#endif
+/** Time between the start of two inference windows, 0 runs them back to back */
+#ifndef EI_RUN_WINDOW_INTERVAL_MS
+#define EI_RUN_WINDOW_INTERVAL_MS   0
+#endif
+/** Only classify windows where an axis moves more than this (m/s2 peak to peak), 0 disables */
+#ifndef EI_RUN_MOTION_THRESHOLD
+#define EI_RUN_MOTION_THRESHOLD     0.0f
+#endif
+/** Sleep granularity: usleep() wakes on a tick, so one OS tick plus a margin for the wake-up */
+#ifndef EI_RUN_SLEEP_GUARD_US
+#ifdef CONFIG_USEC_PER_TICK
+#define EI_RUN_SLEEP_GUARD_US       (CONFIG_USEC_PER_TICK + 2000)
+#else
+#define EI_RUN_SLEEP_GUARD_US       2000
+#endif
+#endif
+/** Drop the CPU clock while waiting for samples, off until the switch cost is measured on the board */
+#ifndef EI_RUN_LOW_CLOCK_WHEN_IDLE
+#define EI_RUN_LOW_CLOCK_WHEN_IDLE  0
+#endif
 
 /* Private variables ------------------------------------------------------- */
 static float acc_buf[EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE];
@@ -39,6 +69,7 @@ static int acc_sample_count = 0;
 
 extern int base64_encode(const char *input, size_t input_size, char *output, size_t output_size);
 
+#if EI_RUN_FUSION == 0
 /**
  * @brief      Called by the inertial sensor module when a sample is received.
  *             Stores sample data in acc_buf
@@ -56,6 +87,7 @@ static bool acc_data_callback(const void *sample_buf, uint32_t byteLength)
 
     return true;
 }
+#endif
 
 /**
  * @brief      Sample data and run inferencing. Prints results to terminal
@@ -76,22 +108,81 @@ void run_nn(bool debug) {
 
     ei_printf("Starting inferencing, press 'b' to break\n");
 
+#if EI_RUN_FUSION == 1
+    size_t n_axes;
+    const ei_fusion_axis_t *axes = ei_fusion_default_axes(&n_axes);
+    if (n_axes != EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) {
+        ei_printf("ERR: fusion layout has %d axes, model expects %d\n", (int)n_axes, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME);
+        EiDevice.set_state(eiStateIdle);
+        return;
+    }
+    if (!ei_fusion_init(axes, n_axes, (float)EI_CLASSIFIER_INTERVAL_MS, EI_CLASSIFIER_RAW_SAMPLE_COUNT)) {
+        ei_printf("ERR: failed to start fusion sampler\n");
+        EiDevice.set_state(eiStateIdle);
+        return;
+    }
+#else
     ei_inertial_sample_start(&acc_data_callback, EI_CLASSIFIER_INTERVAL_MS);
+#endif
+
+    ei_scheduler_config_t sched_config = { 0 };
+    sched_config.window_interval_ms = EI_RUN_WINDOW_INTERVAL_MS;
+    sched_config.sample_interval_us = (uint32_t)(EI_CLASSIFIER_INTERVAL_MS * 1000.0f);
+    sched_config.sleep_guard_us = EI_RUN_SLEEP_GUARD_US;
+    sched_config.low_clock_when_idle = EI_RUN_LOW_CLOCK_WHEN_IDLE;
+    sched_config.motion_threshold = EI_RUN_MOTION_THRESHOLD;
+    ei_scheduler_init(&sched_config, NULL);
 
     while (stop_inferencing == false) {
 
-        ei_printf("Sampling...\n");
+        // sleeps until the next window is due
+        if (!ei_scheduler_wait_window()) {
+            break;
+        }
+
+        if (debug) {
+            ei_printf("Sampling...\n");
+        }
+
+#if EI_PROFILER_ENABLED == 1
+        ei_profiler_reset();
+#endif
 
-        /* Run sampler */
+        /* Run sampler, the CPU sleeps between samples */
+        EI_PROFILE_START(acquisition_prof, "acquisition");
         acc_sample_count = 0;
+#if EI_RUN_FUSION == 1
+        ei_fusion_window_start(acc_buf, EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+#endif
         for(int i = 0; i < EI_CLASSIFIER_RAW_SAMPLE_COUNT; i++) {
-            if(ei_inertial_read_data()) {
+            if (!ei_scheduler_wait_sample()) {
+                stop_inferencing = true;
+                break;
+            }
+#if EI_RUN_FUSION == 1
+            if(ei_fusion_read_sample()) {
+#else
+            if(ei_inertial_read_sample()) {
+#endif
                 ei_printf("Err: failed to get sensor data\r\n");
                 stop_inferencing = true;
                 break;
             }
             acc_sample_count += EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME;
         }
+#if EI_RUN_FUSION == 1
+        // slow sensors are interpolated onto the sample timestamps
+        ei_fusion_window_end();
+#endif
+        EI_PROFILE_STOP(acquisition_prof);
+
+        if (stop_inferencing) {
+            break;
+        }
+
+        if (!ei_scheduler_should_infer(acc_buf, EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)) {
+            continue;
+        }
 
         // Create a data structure to represent this window of data
         signal_t signal;
@@ -117,19 +208,23 @@ void run_nn(bool debug) {
 #if EI_CLASSIFIER_HAS_ANOMALY == 1
         ei_printf("    anomaly score: %f\r\n", result.anomaly);
 #endif
-        ei_printf("Starting inferencing in 2 seconds...\n");
-
-        // instead of wait_ms, we'll wait on the signal, this allows threads to cancel us...
-        uint64_t end_ms = ei_read_timer_ms() + 2000;
-        while(end_ms > ei_read_timer_ms()){
-            if(ei_user_invoke_stop_lib()) {
-                ei_printf("Inferencing stopped by user\r\n");
-                EiDevice.set_state(eiStateIdle);
-                stop_inferencing = true;
-                break;
-            }
-        };
+#if EI_PROFILER_ENABLED == 1
+        if (debug) {
+            ei_printf("Profile (chrome://tracing):\n");
+            ei_profiler_dump_chrome_trace();
+        }
+#endif
+        if (debug) {
+            ei_scheduler_print_stats();
+        }
     }
+
+    ei_printf("Inferencing stopped\r\n");
+    ei_scheduler_print_stats();
+#if EI_RUN_FUSION == 1
+    ei_fusion_deinit();
+#endif
+    EiDevice.set_state(eiStateIdle);
 }
 
 #elif defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_MICROPHONE
@@ -148,7 +243,7 @@ void run_nn(bool debug) {
     ei_printf("\tSample length: %d ms.\n", EI_CLASSIFIER_RAW_SAMPLE_COUNT / 16);
     ei_printf("\tNo. of classes: %d\n", sizeof(ei_classifier_inferencing_categories) / sizeof(ei_classifier_inferencing_categories[0]));
 
-    if(ei_microphone_inference_start(EI_CLASSIFIER_RAW_SAMPLE_COUNT) == false) {
+    if(ei_microphone_inference_start(EI_CLASSIFIER_RAW_SAMPLE_COUNT, 2) == false) {
         ei_printf("ERR: Failed to setup audio sampling\r\n");
         return;
     }
@@ -166,7 +261,6 @@ void run_nn(bool debug) {
             break;
         }
 
-        spresense_pauseAudio(true);
         ei_printf("Recording done\n");
 
         signal_t signal;
@@ -202,7 +296,6 @@ void run_nn(bool debug) {
                 break;
             }
         };
-        spresense_pauseAudio(false);
     }
 
     ei_microphone_inference_end();
@@ -217,6 +310,7 @@ void run_nn_continuous(bool debug)
 
     bool stop_inferencing = false;
     int print_results = -(EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW);
+    uint32_t dropped_slices = 0;
     // summary of inferencing settings (from model_metadata.h)
     ei_printf("Inferencing settings:\n");
     ei_printf("\tInterval: ");
@@ -230,7 +324,10 @@ void run_nn_continuous(bool debug)
     ei_printf("Starting inferencing, press 'b' to break\n");
 
     run_classifier_init();
-    ei_microphone_inference_start(EI_CLASSIFIER_SLICE_SIZE);
+    if(ei_microphone_inference_start(EI_CLASSIFIER_SLICE_SIZE) == false) {
+        ei_printf("ERR: Failed to setup audio sampling\r\n");
+        return;
+    }
 
     while (stop_inferencing == false) {
 
@@ -269,12 +366,20 @@ void run_nn_continuous(bool debug)
             print_results = 0;
         }
 
+        if (ei_microphone_inference_get_dropped_slices() != dropped_slices) {
+            uint32_t dropped = ei_microphone_inference_get_dropped_slices();
+            ei_printf("WARN: %lu slice(s) dropped, inference does not keep up\r\n",
+                (unsigned long)(dropped - dropped_slices));
+            dropped_slices = dropped;
+        }
+
         if(ei_user_invoke_stop_lib()) {
             ei_printf("Inferencing stopped by user\r\n");
             break;
         }
     }
 
+    ei_printf("Dropped slices: %lu\r\n", (unsigned long)ei_microphone_inference_get_dropped_slices());
     ei_microphone_inference_end();
 }
 
@@ -0,0 +1,374 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "ei_scheduler.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+/* Constant defines -------------------------------------------------------- */
+/** Longest single sleep, so a stop request is noticed in time */
+#define MAX_SLEEP_CHUNK_US  100000
+
+#if defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+extern void spresense_sleep_us(uint32_t us);
+extern void spresense_set_low_clock(bool low);
+extern bool ei_user_invoke_stop_lib(void);
+#endif
+
+/* Private variables ------------------------------------------------------- */
+static ei_scheduler_config_t sched_config;
+static ei_scheduler_hal_t sched_hal;
+static ei_scheduler_stats_t sched_stats;
+static uint64_t start_us;
+static uint64_t next_window_us;
+static uint64_t next_sample_us;
+static uint32_t window_samples;
+
+static void default_sleep_us(uint32_t us)
+{
+#if defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+    spresense_sleep_us(us);
+#else
+    uint64_t end_us = ei_read_timer_us() + us;
+    while (end_us > ei_read_timer_us()) {};
+#endif
+}
+
+static void default_set_low_clock(bool low)
+{
+#if defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+    spresense_set_low_clock(low);
+#endif
+}
+
+static bool default_stop_requested(void)
+{
+#if defined(EI_PORTING_SONY_SPRESENSE) && EI_PORTING_SONY_SPRESENSE == 1
+    return ei_user_invoke_stop_lib();
+#else
+    return false;
+#endif
+}
+
+static uint64_t default_now_us(void)
+{
+    return ei_read_timer_us();
+}
+
+/**
+ * @brief      Sleep until (just before) the deadline, busy-wait the remainder
+ *
+ * @param[in]  deadline_us  Absolute time to wait for
+ * @param[in]  count_late   false if the deadline is "now" (back to back windows,
+ *                          first sample of a window) and cannot be missed
+ *
+ * @return     false if a stop was requested while waiting
+ */
+static bool wait_until(uint64_t deadline_us, bool count_late)
+{
+    uint64_t now = sched_hal.now_us();
+
+    if (now >= deadline_us) {
+        if (count_late) {
+            sched_stats.late++;
+        }
+        return !sched_hal.stop_requested();
+    }
+
+    if (deadline_us - now > sched_config.sleep_guard_us) {
+        if (sched_config.low_clock_when_idle) {
+            sched_hal.set_low_clock(true);
+        }
+
+        // a sleep can overshoot the deadline, compare before subtracting
+        while (now < deadline_us && deadline_us - now > sched_config.sleep_guard_us) {
+            uint64_t chunk = deadline_us - now - sched_config.sleep_guard_us;
+            if (chunk > MAX_SLEEP_CHUNK_US) {
+                chunk = MAX_SLEEP_CHUNK_US;
+            }
+
+            sched_hal.sleep_us((uint32_t)chunk);
+
+            uint64_t after = sched_hal.now_us();
+            sched_stats.sleep_us += after - now;
+            now = after;
+
+            if (sched_hal.stop_requested()) {
+                if (sched_config.low_clock_when_idle) {
+                    sched_hal.set_low_clock(false);
+                }
+                return false;
+            }
+        }
+
+        if (sched_config.low_clock_when_idle) {
+            sched_hal.set_low_clock(false);
+        }
+
+        // the sleep overshot, the guard is shorter than the sleep granularity
+        if (now > deadline_us && count_late) {
+            sched_stats.late++;
+        }
+    }
+
+    while (sched_hal.now_us() < deadline_us) {};
+
+    return true;
+}
+
+/**
+ * @brief      Set cadence, wake conditions and platform hooks
+ *
+ * @param[in]  config  Scheduler configuration
+ * @param[in]  hal     Platform hooks, NULL for the defaults
+ */
+void ei_scheduler_init(const ei_scheduler_config_t *config, const ei_scheduler_hal_t *hal)
+{
+    sched_config = *config;
+
+    if (hal) {
+        sched_hal = *hal;
+    }
+    else {
+        sched_hal.now_us = &default_now_us;
+        sched_hal.sleep_us = &default_sleep_us;
+        sched_hal.set_low_clock = &default_set_low_clock;
+        sched_hal.stop_requested = &default_stop_requested;
+    }
+
+    ei_scheduler_start();
+}
+
+/**
+ * @brief      Reset the statistics, the first window starts now
+ */
+void ei_scheduler_start(void)
+{
+    memset(&sched_stats, 0, sizeof(sched_stats));
+    start_us = sched_hal.now_us();
+    next_window_us = start_us;
+    next_sample_us = start_us;
+    window_samples = 0;
+}
+
+/**
+ * @brief      Sleep until the next window is due
+ *
+ * @return     false if a stop was requested while waiting
+ */
+bool ei_scheduler_wait_window(void)
+{
+    bool count_late = sched_config.window_interval_ms > 0 && sched_stats.windows > 0;
+    if (!wait_until(next_window_us, count_late)) {
+        return false;
+    }
+
+    uint64_t now = sched_hal.now_us();
+
+    // windows that were missed are dropped, the cadence stays aligned
+    next_window_us += (uint64_t)sched_config.window_interval_ms * 1000;
+    while (sched_config.window_interval_ms > 0 && next_window_us <= now) {
+        next_window_us += (uint64_t)sched_config.window_interval_ms * 1000;
+    }
+
+    next_sample_us = now;
+    window_samples = 0;
+    sched_stats.windows++;
+
+    return true;
+}
+
+/**
+ * @brief      Sleep until the next sample within the window is due
+ *
+ * @return     false if a stop was requested while waiting
+ */
+bool ei_scheduler_wait_sample(void)
+{
+    if (!wait_until(next_sample_us, window_samples > 0)) {
+        return false;
+    }
+
+    next_sample_us += sched_config.sample_interval_us;
+    window_samples++;
+
+    return true;
+}
+
+/**
+ * @brief      Evaluate the wake conditions on a sampled window
+ *
+ * @param[in]  window       Interleaved samples
+ * @param[in]  window_size  Number of values in window
+ * @param[in]  axes         Values per sample
+ *
+ * @return     true if the window should be classified
+ */
+bool ei_scheduler_should_infer(const float *window, size_t window_size, size_t axes)
+{
+    bool wake = true;
+
+    if (sched_config.motion_threshold > 0.0f && axes > 0) {
+        wake = false;
+        for (size_t axis = 0; axis < axes && !wake; axis++) {
+            float min = window[axis];
+            float max = window[axis];
+            for (size_t ix = axis; ix < window_size; ix += axes) {
+                if (window[ix] < min) min = window[ix];
+                if (window[ix] > max) max = window[ix];
+            }
+            wake = (max - min) > sched_config.motion_threshold;
+        }
+    }
+
+    if (wake && sched_config.wake_condition) {
+        wake = sched_config.wake_condition(window, window_size, axes);
+    }
+
+    if (wake) {
+        sched_stats.inferences++;
+    }
+    else {
+        sched_stats.skipped++;
+    }
+
+    return wake;
+}
+
+/**
+ * @brief      Get statistics since ei_scheduler_start()
+ *
+ * @param[out] stats  Statistics, active_us is all time not spent sleeping
+ */
+void ei_scheduler_get_stats(ei_scheduler_stats_t *stats)
+{
+    *stats = sched_stats;
+    uint64_t elapsed = sched_hal.now_us() - start_us;
+    stats->active_us = elapsed > sched_stats.sleep_us ? elapsed - sched_stats.sleep_us : 0;
+}
+
+/**
+ * @brief      Fraction of time the CPU was awake since ei_scheduler_start()
+ *
+ * @return     Duty cycle (0..1)
+ */
+float ei_scheduler_duty_cycle(void)
+{
+    ei_scheduler_stats_t stats;
+    ei_scheduler_get_stats(&stats);
+
+    uint64_t total = stats.active_us + stats.sleep_us;
+    if (total == 0) {
+        return 1.0f;
+    }
+    return (float)stats.active_us / (float)total;
+}
+
+/**
+ * @brief      Print the statistics
+ */
+void ei_scheduler_print_stats(void)
+{
+    ei_scheduler_stats_t stats;
+    ei_scheduler_get_stats(&stats);
+
+    ei_printf("Scheduler: %lu windows, %lu inferences, %lu skipped, %lu late, duty cycle ",
+        (unsigned long)stats.windows, (unsigned long)stats.inferences,
+        (unsigned long)stats.skipped, (unsigned long)stats.late);
+    ei_printf_float(ei_scheduler_duty_cycle() * 100.0f);
+    ei_printf("%%\n");
+}
+
+/* Host simulation --------------------------------------------------------- */
+static uint64_t sim_now;
+
+static uint64_t sim_now_us(void)
+{
+    return sim_now++;
+}
+
+static void sim_sleep_us(uint32_t us)
+{
+    sim_now += us;
+}
+
+static void sim_set_low_clock(bool low)
+{
+    (void)low;
+}
+
+static bool sim_stop_requested(void)
+{
+    return false;
+}
+
+/**
+ * @brief      Run the scheduler on a virtual clock, e.g. on the host, to see the
+ *             duty cycle a configuration reaches. Busy-waiting advances the clock
+ *             with 1 us per poll. The state of a running schedule is kept.
+ *
+ * @param[in]  config              Scheduler configuration
+ * @param[in]  windows             Number of windows to run
+ * @param[in]  samples_per_window  Samples in every window
+ * @param[in]  sample_read_us      Time to read one sample
+ * @param[in]  inference_us        Time of DSP + classification of one window
+ *
+ * @return     Achieved duty cycle (0..1)
+ */
+float ei_scheduler_simulate(const ei_scheduler_config_t *config, uint32_t windows,
+    uint32_t samples_per_window, uint32_t sample_read_us, uint32_t inference_us)
+{
+    ei_scheduler_config_t saved_config = sched_config;
+    ei_scheduler_hal_t saved_hal = sched_hal;
+    ei_scheduler_stats_t saved_stats = sched_stats;
+    uint64_t saved_start_us = start_us;
+    uint64_t saved_next_window_us = next_window_us;
+    uint64_t saved_next_sample_us = next_sample_us;
+    uint32_t saved_window_samples = window_samples;
+    ei_scheduler_hal_t sim_hal = { &sim_now_us, &sim_sleep_us, &sim_set_low_clock, &sim_stop_requested };
+
+    sim_now = 0;
+    ei_scheduler_init(config, &sim_hal);
+
+    for (uint32_t w = 0; w < windows; w++) {
+        ei_scheduler_wait_window();
+        for (uint32_t s = 0; s < samples_per_window; s++) {
+            ei_scheduler_wait_sample();
+            sim_now += sample_read_us;
+        }
+        sched_stats.inferences++;
+        sim_now += inference_us;
+    }
+
+    float duty_cycle = ei_scheduler_duty_cycle();
+
+    sched_config = saved_config;
+    sched_hal = saved_hal;
+    sched_stats = saved_stats;
+    start_us = saved_start_us;
+    next_window_us = saved_next_window_us;
+    next_sample_us = saved_next_sample_us;
+    window_samples = saved_window_samples;
+
+    return duty_cycle;
+}
@@ -0,0 +1,74 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_SCHEDULER_H
+#define EI_SCHEDULER_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+
+/** Platform hooks, the defaults use the Spresense timer, usleep and LowPower clock modes */
+typedef struct {
+    uint64_t (*now_us)(void);
+    void (*sleep_us)(uint32_t us);
+    void (*set_low_clock)(bool low);
+    bool (*stop_requested)(void);
+} ei_scheduler_hal_t;
+
+typedef struct {
+    /** Time between the start of two windows, 0 samples windows back to back */
+    uint32_t window_interval_ms;
+    /** Time between two samples within a window */
+    uint32_t sample_interval_us;
+    /** Wake up this long before a deadline and busy-wait the rest (sleep granularity) */
+    uint32_t sleep_guard_us;
+    /** Drop the CPU clock while sleeping */
+    bool low_clock_when_idle;
+    /** Skip inference if no axis moves more than this (peak to peak), 0 disables */
+    float motion_threshold;
+    /** Optional extra wake condition, inference only runs when it returns true */
+    bool (*wake_condition)(const float *window, size_t window_size, size_t axes);
+} ei_scheduler_config_t;
+
+typedef struct {
+    uint64_t active_us;
+    uint64_t sleep_us;
+    uint32_t windows;
+    uint32_t inferences;
+    uint32_t skipped;
+    uint32_t late;
+} ei_scheduler_stats_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void ei_scheduler_init(const ei_scheduler_config_t *config, const ei_scheduler_hal_t *hal);
+void ei_scheduler_start(void);
+bool ei_scheduler_wait_window(void);
+bool ei_scheduler_wait_sample(void);
+bool ei_scheduler_should_infer(const float *window, size_t window_size, size_t axes);
+void ei_scheduler_get_stats(ei_scheduler_stats_t *stats);
+float ei_scheduler_duty_cycle(void);
+void ei_scheduler_print_stats(void);
+float ei_scheduler_simulate(const ei_scheduler_config_t *config, uint32_t windows,
+    uint32_t samples_per_window, uint32_t sample_read_us, uint32_t inference_us);
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ * @file    GasCompensation.h
+ * @date    19 October 2026
+ * @brief   HTS221 humidity and temperature compensation of SGP41 measurements
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+#ifndef GAS_COMPENSATION_H
+#define GAS_COMPENSATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// SGP41 ticks without humidity compensation (50 %RH, 25 degC)
+#define GAS_COMPENSATION_DEFAULT_RH (0x8000)
+#define GAS_COMPENSATION_DEFAULT_T  (0x6666)
+
+/**
+ * Two point HTS221 calibration, output x0/x1 [LSB] at y0/y1 [%RH or degC]
+ */
+typedef struct {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+} lin_t;
+
+/**
+ * HTS221 output to SGP41 ticks, ticks = (gain * x >> 16) + offset.
+ * The ticks hold the last compensation values.
+ */
+typedef struct {
+    int32_t rh_gain;
+    int32_t rh_offset;
+    int32_t t_gain;
+    int32_t t_offset;
+    uint16_t rh_ticks;
+    uint16_t t_ticks;
+} gas_compensation_t;
+
+/**
+ * @brief  Read the HTS221 factory calibration
+ * @param  [out] lin_hum Humidity calibration
+ * @param  [out] lin_temp Temperature calibration
+ * @retval true if the calibration is usable
+ */
+bool GasCompensationReadCalibration(lin_t *lin_hum, lin_t *lin_temp);
+
+/**
+ * @brief  Precompute the conversion of HTS221 output to SGP41 ticks, the only
+ *         place that uses floating point
+ * @param  [out] comp Compensation state
+ * @param  [in] lin_hum Humidity calibration, NULL keeps the default ticks
+ * @param  [in] lin_temp Temperature calibration, NULL keeps the default ticks
+ */
+void GasCompensationInit(gas_compensation_t *comp, const lin_t *lin_hum, const lin_t *lin_temp);
+
+/**
+ * @brief  Update the ticks from a HTS221 burst (status, humidity, temperature)
+ * @param  [in,out] comp Compensation state
+ * @param  [in] burst HTS221_DATA_BURST_LEN bytes read by hts221_(queue_)data_get
+ * @retval true if the burst had new data
+ */
+bool GasCompensationUpdate(gas_compensation_t *comp, const uint8_t *burst);
+
+/**
+ * @brief  Read the HTS221 in one transaction and update the ticks
+ * @param  [in,out] comp Compensation state, kept on a bus error
+ * @retval true if the ticks were updated
+ */
+bool GasCompensationRead(gas_compensation_t *comp);
+
+#endif // GAS_COMPENSATION_H
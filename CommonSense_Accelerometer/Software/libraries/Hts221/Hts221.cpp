@@ -398,8 +398,7 @@ int32_t hts221_hum_data_ready_get(stmdev_ctx_t *ctx, uint8_t *val) {
 int32_t hts221_humidity_raw_get(stmdev_ctx_t *ctx, uint8_t *buff) {
     int32_t ret;
     uint8_t * pnt = (uint8_t *) buff;
-    ret = hts221_read_reg(ctx, HTS221_HUMIDITY_OUT_L, &pnt[0], 1);
-    ret = hts221_read_reg(ctx, HTS221_HUMIDITY_OUT_H, &pnt[1], 1);
+    ret = hts221_read_reg(ctx, HTS221_HUMIDITY_OUT_L | HTS221_AUTO_INCREMENT, &pnt[0], 2);
     return ret;
 }
 
@@ -414,11 +413,36 @@ int32_t hts221_humidity_raw_get(stmdev_ctx_t *ctx, uint8_t *buff) {
 int32_t hts221_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff) {
     int32_t ret;
     uint8_t * pnt = (uint8_t *) buff;
-    ret = hts221_read_reg(ctx, HTS221_TEMP_OUT_L, &pnt[0], 1);
-    ret = hts221_read_reg(ctx, HTS221_TEMP_OUT_H, &pnt[1], 1);
+    ret = hts221_read_reg(ctx, HTS221_TEMP_OUT_L | HTS221_AUTO_INCREMENT, &pnt[0], 2);
     return ret;
 }
 
+/**
+  * @brief  Burst read of status, humidity and temperature in one transaction.[get]
+  *
+  * @param  ctx     read / write interface definitions
+  * @param  buff    HTS221_DATA_BURST_LEN bytes: status, humidity, temperature
+  * @retval         interface status (MANDATORY: return 0 -> no Error)
+  *
+  */
+int32_t hts221_data_get(stmdev_ctx_t *ctx, uint8_t *buff) {
+    return hts221_read_reg(ctx, HTS221_STATUS_REG | HTS221_AUTO_INCREMENT, buff, HTS221_DATA_BURST_LEN);
+}
+
+/**
+  * @brief  Queue a burst read of status, humidity and temperature so it runs
+  *         in the same bus cycle as other sensors.[get]
+  *
+  * @param  queue   I2C transaction queue
+  * @param  buff    HTS221_DATA_BURST_LEN bytes: status, humidity, temperature
+  * @retval         queued transaction, nullptr if the queue is full
+  *
+  */
+i2c_xfer_t* hts221_queue_data_get(i2c_queue_t *queue, uint8_t *buff) {
+    return i2c_queue_read_regs(queue, HTS221_I2C_ADDRESS, HTS221_STATUS_REG | HTS221_AUTO_INCREMENT,
+        buff, HTS221_DATA_BURST_LEN);
+}
+
 /**
   * @}
   *
@@ -840,7 +864,7 @@ int32_t hts221_hum_adc_point_0_get(stmdev_ctx_t *ctx, float_t *val) {
     uint8_t coeff_p[2];
     int16_t coeff;
     int32_t ret;
-    ret = hts221_read_reg(ctx, HTS221_H0_T0_OUT_L, coeff_p, 2);
+    ret = hts221_read_reg(ctx, HTS221_H0_T0_OUT_L | HTS221_AUTO_INCREMENT, coeff_p, 2);
     coeff = (coeff_p[1] * 256) + coeff_p[0];
     *val = coeff * 1.0f;
     return ret;
@@ -858,7 +882,7 @@ int32_t hts221_hum_adc_point_1_get(stmdev_ctx_t *ctx, float_t *val) {
     uint8_t coeff_p[2];
     int16_t coeff;
     int32_t ret;
-    ret = hts221_read_reg(ctx, HTS221_H1_T0_OUT_L, coeff_p, 2);
+    ret = hts221_read_reg(ctx, HTS221_H1_T0_OUT_L | HTS221_AUTO_INCREMENT, coeff_p, 2);
     coeff = (coeff_p[1] * 256) + coeff_p[0];
     *val = coeff * 1.0f;
     return ret;
@@ -876,7 +900,7 @@ int32_t hts221_temp_adc_point_0_get(stmdev_ctx_t *ctx, float_t *val) {
     uint8_t coeff_p[2];
     int16_t coeff;
     int32_t ret;
-    ret = hts221_read_reg(ctx, HTS221_T0_OUT_L, coeff_p, 2);
+    ret = hts221_read_reg(ctx, HTS221_T0_OUT_L | HTS221_AUTO_INCREMENT, coeff_p, 2);
     coeff = (coeff_p[1] * 256) + coeff_p[0];
     *val = coeff * 1.0f;
     return ret;
@@ -894,7 +918,7 @@ int32_t hts221_temp_adc_point_1_get(stmdev_ctx_t *ctx, float_t *val) {
     uint8_t coeff_p[2];
     int16_t coeff;
     int32_t ret;
-    ret = hts221_read_reg(ctx, HTS221_T1_OUT_L, coeff_p, 2);
+    ret = hts221_read_reg(ctx, HTS221_T1_OUT_L | HTS221_AUTO_INCREMENT, coeff_p, 2);
     coeff = (coeff_p[1] * 256) + coeff_p[0];
     *val = coeff * 1.0f;
     return ret;
@@ -32,6 +32,7 @@
  ******************************************************************************
  */
 
+
 #include "I2c.h"
 #include <sdk/config.h>
 
@@ -46,15 +47,15 @@ extern "C" {
 // buffer
 #define BUFFER_LENGTH       (32)
 #define TWI_TX_BUF_LEN      BUFFER_LENGTH
-#define TWI_RX_BUF_LEN      BUFFER_LENGTH
+
+// two messages (register address + data) per queued transaction
+#define TWI_QUEUE_MAX_MSGS  (TWI_QUEUE_MAX_XFERS * 2)
 
 uint8_t _tx_buf[TWI_TX_BUF_LEN];
-uint8_t _tx_buf_index = 0;
 uint8_t _tx_buf_len = 0;
-uint8_t _rx_buf[TWI_RX_BUF_LEN];
-uint8_t _rx_buf_index = 0;
-uint8_t _rx_buf_len = 0;
 uint32_t _freq = TWI_FREQ_100KHZ;
+uint32_t _err_count = 0;
+int _last_errno = 0;
 
 FAR struct i2c_master_s* _dev;
 
@@ -65,7 +66,6 @@ void i2c_init(void) {
     if (isInit == false) {
         isInit = true;
         memset(_tx_buf, 0, sizeof(_tx_buf));
-        memset(_rx_buf, 0, sizeof(_rx_buf));
 
         _dev = cxd56_i2cbus_initialize(0);
         if (_dev == 0){
@@ -80,69 +80,70 @@ void i2c_set_freq(uint32_t freq) {
     _freq = freq;
 }
 
-static uint8_t I2cRequest(uint8_t address, uint8_t quantity, uint8_t sendStop) {
-    struct i2c_msg_s msg;
-    unsigned int flags = 0;
-    int ret;
-
-    if (!_dev) return 0;
+uint32_t i2c_get_error_count(void) {
+    return _err_count;
+}
 
-    // clamp to buffer length
-    if (quantity > TWI_RX_BUF_LEN) {
-        quantity = TWI_RX_BUF_LEN;
-    }
+int i2c_get_last_errno(void) {
+    return _last_errno;
+}
 
+static inline void I2cSetupMsg(struct i2c_msg_s *msg, uint8_t address, unsigned int flags,
+                               uint8_t *buffer, uint16_t length) {
+    msg->frequency = _freq;
+    msg->addr      = address;
+    msg->flags     = flags;
+    msg->buffer    = buffer;
+    msg->length    = length;
+}
 
-    if (!sendStop) {
-        flags |= I2C_M_NOSTOP;
+/**
+ * @brief  Run one I2C_TRANSFER and map the result, errors are counted instead of printed
+ * @param  [in] msgs messages, a START is issued for each and a STOP only after
+ *              messages without I2C_M_NOSTOP
+ * @param  [in] count number of messages
+ * @retval TWI_SUCCESS (0) if ok
+ */
+static uint8_t I2cTransfer(struct i2c_msg_s *msgs, int count) {
+    if (!_dev) {
+        _err_count++;
+        return TWI_OTHER_ERROR;
     }
 
-    // Setup for the transfer
-    msg.frequency = _freq;
-    msg.addr      = address;
-    msg.flags     = (flags | I2C_M_READ);
-    msg.buffer    = _rx_buf;
-    msg.length    = quantity;
-
-    // Then perform the transfer.
-    ret = I2C_TRANSFER(_dev, &msg, 1);
-    if (ret < 0) {
-        ::printf("ERROR: Failed to read from i2c (errno = %d)\n", errno);
-        return 0;
+    int ret = I2C_TRANSFER(_dev, msgs, count);
+    if (ret >= 0) {
+        return TWI_SUCCESS;
     }
 
-    // set rx buffer iterator vars
-    _rx_buf_index = 0;
-    _rx_buf_len = quantity;
+    _err_count++;
+    _last_errno = ret;
 
-    return quantity;
+    if (ret == -ENODEV) {
+        // device not found
+        return TWI_NACK_ON_ADDRESS;
+    }
+    return TWI_OTHER_ERROR;
 }
 
-static uint8_t I2cTransmit(uint8_t _tx_address, bool sendStop) {
-    struct i2c_msg_s msg;
-    unsigned int flags = 0;
-    int ret;
+/**
+ * @brief  Write the register address, then read into data after a repeated start
+ */
+static uint8_t I2cWriteRead(uint8_t address, uint8_t *reg, uint8_t reg_len, uint8_t *data, uint16_t size) {
+    struct i2c_msg_s msgs[2];
 
-    if (!sendStop) {
-        flags |= I2C_M_NOSTOP;
-    }
+    I2cSetupMsg(&msgs[0], address, I2C_M_NOSTOP, reg, reg_len);
+    I2cSetupMsg(&msgs[1], address, I2C_M_READ, data, size);
 
-    // Setup for the transfer
-    msg.frequency = _freq;
-    msg.addr      = _tx_address;
-    msg.flags     =  flags;
-    msg.buffer    = _tx_buf;
-    msg.length    = _tx_buf_len;
+    return I2cTransfer(msgs, 2);
+}
 
-    // Then perform the transfer.
-    ret = I2C_TRANSFER(_dev, &msg, 1);
-     _tx_buf_len = 0;
+static uint8_t I2cTransmit(uint8_t _tx_address) {
+    struct i2c_msg_s msg;
 
-    if (ret == -ENODEV) {
-        // device not found
-        return TWI_NACK_ON_ADDRESS;
-    }
-    return (ret < 0) ? TWI_OTHER_ERROR : TWI_SUCCESS;
+    I2cSetupMsg(&msg, _tx_address, 0, _tx_buf, _tx_buf_len);
+    _tx_buf_len = 0;
+
+    return I2cTransfer(&msg, 1);
 }
 
 uint8_t i2c_write_reg(uint8_t i2c_addr, uint8_t reg_addr, uint8_t data) {
@@ -150,88 +151,156 @@ uint8_t i2c_write_reg(uint8_t i2c_addr, uint8_t reg_addr, uint8_t data) {
     _tx_buf[1] = data;
     _tx_buf_len = 2;
     
-    return I2cTransmit(i2c_addr, true);
+    return I2cTransmit(i2c_addr);
  }
 
 uint8_t i2c_read_reg(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data) {
-    _tx_buf[0] = reg_addr;
-    _tx_buf_len = 1;
-
-    if (I2cTransmit(i2c_addr, false) != TWI_SUCCESS) {
-        return TWI_OTHER_ERROR;
-    }
-
-    I2cRequest(i2c_addr, 1, true);
-
-    *data = _rx_buf[0];
-    return TWI_SUCCESS;
+    return I2cWriteRead(i2c_addr, &reg_addr, 1, data, 1);
 }
 
 uint8_t i2c_write_regs(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
+    if (size > TWI_TX_BUF_LEN - 1) {
+        return TWI_DATA_TOO_LONG;
+    }
+
     _tx_buf[0] = reg_addr;
     memcpy(&_tx_buf[1], data, size);
     _tx_buf_len = size + 1;
     
-    return I2cTransmit(i2c_addr, true);
+    return I2cTransmit(i2c_addr);
  }
 
 uint8_t i2c_read_regs(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
-    _tx_buf[0] = reg_addr;
-    _tx_buf_len = 1;
-
-    if (I2cTransmit(i2c_addr, false) != TWI_SUCCESS) {
-        printf("i2c_read_regs, I2cTransmit err\r\n");
-        return TWI_OTHER_ERROR;
-    }
-
-    uint16_t read = I2cRequest(i2c_addr, size, true);
-
-    memcpy(data, _rx_buf, size);
-
-    return TWI_SUCCESS;
+    return I2cWriteRead(i2c_addr, &reg_addr, 1, data, size);
 }
 
 uint8_t i2c_read_data(uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    struct i2c_msg_s msg;
 
-    uint16_t read = I2cRequest(i2c_addr, size, true);
-
-    memcpy(data, _rx_buf, size);
+    I2cSetupMsg(&msg, i2c_addr, I2C_M_READ, data, size);
 
-    return TWI_SUCCESS;
+    return I2cTransfer(&msg, 1);
 }
 
 uint8_t i2c_write_data(uint8_t i2c_addr, uint8_t *data, uint16_t size) {
-    memcpy(_tx_buf, data, size);
-    _tx_buf_len = size;
-    
-    return I2cTransmit(i2c_addr, true);
+    struct i2c_msg_s msg;
+
+    I2cSetupMsg(&msg, i2c_addr, 0, data, size);
+
+    return I2cTransfer(&msg, 1);
 }
 
 uint8_t i2c_write_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
-    uint8_t reg [2] = {0};
-    memcpy(&reg, &reg_addr, 2);
-    _tx_buf [0] = reg[1];
-    _tx_buf [1] = reg[0];
-    _tx_buf_len = 2;
+    if (size > TWI_TX_BUF_LEN - 2) {
+        return TWI_DATA_TOO_LONG;
+    }
+
+    _tx_buf [0] = (uint8_t) (reg_addr >> 8);
+    _tx_buf [1] = (uint8_t) reg_addr;
     memcpy(&_tx_buf[2], data, size);
-    _tx_buf_len += size;
+    _tx_buf_len = size + 2;
     
-    return I2cTransmit(i2c_addr, true);
+    return I2cTransmit(i2c_addr);
 }
 
 uint8_t i2c_read_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
-    uint8_t reg [2] = {0};
-    memcpy(&reg, &reg_addr, 2);
-    _tx_buf [0] = reg[1];
-    _tx_buf [1] = reg[0];
-    _tx_buf_len = 2;
+    uint8_t reg[2] = { (uint8_t) (reg_addr >> 8), (uint8_t) reg_addr };
 
-    if (I2cTransmit(i2c_addr, false) != TWI_SUCCESS) {
-        printf("i2c_read_regs_16addr, I2cTransmit err\r\n");
-        return TWI_OTHER_ERROR;
+    return I2cWriteRead(i2c_addr, reg, 2, data, size);
+}
+
+void i2c_queue_init(i2c_queue_t *queue) {
+    queue->count = 0;
+}
+
+static i2c_xfer_t* I2cQueueAdd(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size, bool read) {
+    if (queue->count >= TWI_QUEUE_MAX_XFERS) {
+        return nullptr;
+    }
+
+    i2c_xfer_t *xfer = &queue->xfers[queue->count++];
+    xfer->i2c_addr = i2c_addr;
+    xfer->reg_len = 0;
+    xfer->data = data;
+    xfer->size = size;
+    xfer->read = read;
+    xfer->status = TWI_OTHER_ERROR;
+
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_regs(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
+    i2c_xfer_t *xfer = I2cQueueAdd(queue, i2c_addr, data, size, true);
+    if (xfer) {
+        xfer->reg[0] = reg_addr;
+        xfer->reg_len = 1;
+    }
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_regs_16addr(i2c_queue_t *queue, uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
+    i2c_xfer_t *xfer = I2cQueueAdd(queue, i2c_addr, data, size, true);
+    if (xfer) {
+        xfer->reg[0] = (uint8_t) (reg_addr >> 8);
+        xfer->reg[1] = (uint8_t) reg_addr;
+        xfer->reg_len = 2;
+    }
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return I2cQueueAdd(queue, i2c_addr, data, size, true);
+}
+
+i2c_xfer_t* i2c_queue_write_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return I2cQueueAdd(queue, i2c_addr, data, size, false);
+}
+
+/**
+ * @brief  Build the message list of one queued transaction
+ * @retval number of messages added
+ */
+static int I2cQueueMsgs(i2c_xfer_t *xfer, struct i2c_msg_s *msgs) {
+    int count = 0;
+
+    if (xfer->reg_len > 0) {
+        I2cSetupMsg(&msgs[count++], xfer->i2c_addr, I2C_M_NOSTOP, xfer->reg, xfer->reg_len);
+    }
+    I2cSetupMsg(&msgs[count++], xfer->i2c_addr, xfer->read ? I2C_M_READ : 0, xfer->data, xfer->size);
+
+    return count;
+}
+
+uint8_t i2c_queue_submit(i2c_queue_t *queue) {
+    struct i2c_msg_s msgs[TWI_QUEUE_MAX_MSGS];
+    int count = 0;
+
+    if (queue->count == 0) {
+        return TWI_SUCCESS;
+    }
+
+    for (uint8_t ix = 0; ix < queue->count; ix++) {
+        count += I2cQueueMsgs(&queue->xfers[ix], &msgs[count]);
+    }
+
+    uint8_t ret = I2cTransfer(msgs, count);
+    if (ret == TWI_SUCCESS) {
+        for (uint8_t ix = 0; ix < queue->count; ix++) {
+            queue->xfers[ix].status = TWI_SUCCESS;
+        }
+        return TWI_SUCCESS;
+    }
+
+    // the bus cycle aborts on the first NACK, so retry one by one to find out
+    // which device failed and still deliver the data of the others
+    ret = TWI_SUCCESS;
+    for (uint8_t ix = 0; ix < queue->count; ix++) {
+        count = I2cQueueMsgs(&queue->xfers[ix], msgs);
+        queue->xfers[ix].status = I2cTransfer(msgs, count);
+        if (queue->xfers[ix].status != TWI_SUCCESS) {
+            ret = queue->xfers[ix].status;
+        }
     }
-    uint16_t read = I2cRequest(i2c_addr, size, true);
-    memcpy(data, _rx_buf, size);
 
-    return TWI_SUCCESS;
+    return ret;
 }
@@ -36,6 +36,8 @@
 #ifndef LIS2MDL_REGS_H
 #define LIS2MDL_REGS_H
 
+#include "../I2c/I2c.h"
+
 #ifdef __cplusplus
   extern "C" {
 #endif
@@ -230,6 +232,9 @@ typedef struct {
 #define LIS2MDL_TEMP_OUT_L_REG          0x6EU
 #define LIS2MDL_TEMP_OUT_H_REG          0x6FU
 
+/** STATUS_REG, OUTX/Y/Z_L/H, TEMP_OUT_L/H read by lis2mdl_queue_data_get **/
+#define LIS2MDL_DATA_BURST_LEN          9U
+
 /**
   * @defgroup LIS2MDL_Register_Union
   * @brief    This union group all the registers that has a bit-field
@@ -323,6 +328,8 @@ int32_t lis2mdl_magnetic_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t lis2mdl_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
+i2c_xfer_t* lis2mdl_queue_data_get(i2c_queue_t *queue, uint8_t *buff);
+
 int32_t lis2mdl_device_id_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t lis2mdl_reset_set(stmdev_ctx_t *ctx, uint8_t val);
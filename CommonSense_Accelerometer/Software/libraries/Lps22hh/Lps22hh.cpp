@@ -578,6 +578,20 @@ int32_t lps22hh_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff) {
     return ret;
 }
 
+/**
+  * @brief  Queue a burst read of status, pressure and temperature so it runs
+  *         in the same bus cycle as other sensors (IF_ADD_INC must be set,
+  *         which is the reset default).[get]
+  *
+  * @param  queue   I2C transaction queue
+  * @param  buff    LPS22HH_DATA_BURST_LEN bytes: status, pressure, temperature
+  * @retval         queued transaction, nullptr if the queue is full
+  *
+  */
+i2c_xfer_t* lps22hh_queue_data_get(i2c_queue_t *queue, uint8_t *buff) {
+    return i2c_queue_read_regs(queue, LPS22HH_I2C_ADD, LPS22HH_STATUS, buff, LPS22HH_DATA_BURST_LEN);
+}
+
 /**
   * @brief  Pressure output from FIFO value.[get]
   *
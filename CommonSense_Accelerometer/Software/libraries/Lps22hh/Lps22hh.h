@@ -36,6 +36,8 @@
 #ifndef LPS22HH_REGS_H
 #define LPS22HH_REGS_H
 
+#include "../I2c/I2c.h"
+
 #ifdef __cplusplus
   extern "C" {
 #endif
@@ -266,6 +268,9 @@ typedef struct {
 #define LPS22HH_PRESS_OUT_H                     0x2AU
 #define LPS22HH_TEMP_OUT_L                      0x2BU
 #define LPS22HH_TEMP_OUT_H                      0x2CU
+
+/** STATUS, PRESS_OUT_XL/L/H, TEMP_OUT_L/H read by lps22hh_queue_data_get **/
+#define LPS22HH_DATA_BURST_LEN                  6U
 #define LPS22HH_FIFO_DATA_OUT_PRESS_XL          0x78U
 #define LPS22HH_FIFO_DATA_OUT_PRESS_L           0x79U
 #define LPS22HH_FIFO_DATA_OUT_PRESS_H           0x7AU
@@ -367,6 +372,8 @@ int32_t lps22hh_pressure_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t lps22hh_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
+i2c_xfer_t* lps22hh_queue_data_get(i2c_queue_t *queue, uint8_t *buff);
+
 int32_t lps22hh_fifo_pressure_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t lps22hh_fifo_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
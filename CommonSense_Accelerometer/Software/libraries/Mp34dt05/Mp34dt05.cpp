@@ -46,6 +46,7 @@
 #include <signal.h>
 #include <errno.h>
 #include <string.h>
+#include <unistd.h>
 #include <nuttx/timers/timer.h>
 #include "cxd56_gpio.h"
 #include "arch/board/board.h"
@@ -59,6 +60,7 @@
 #include <nuttx/audio/audio.h>
 #include <nuttx/audio/i2s.h>
 #include "Mp34dt05.h"
+#include "PdmDecimator.h"
 //#include <cxd56_audio.h>
 
 
@@ -597,6 +599,212 @@ void Mp34dt05Init (void) {
     //i2schar_receiver(0);
 } 
 
+/****************************************************************************
+ * PDM capture
+ *
+ * The microphone clock and data lines are on I2S0, so the I2S peripheral
+ * shifts in the PDM stream by DMA: every bit clock edge is one PDM bit and
+ * consecutive 16 bit words form one continuous bitstream. The I2S port has
+ * to run 16 bit stereo frames at MP34DT05_I2S_SAMPLERATE, which gives the
+ * 1.024 MHz bit clock for 16 kHz PCM after decimating by 64.
+ *
+ * A capture thread reads blocks from the I2S character device, decimates
+ * them and queues the PCM samples in a FIFO that Mp34dt05Read() drains,
+ * or hands them to the callback set with Mp34dt05SetCallback().
+ ****************************************************************************/
+
+#ifndef MP34DT05_I2S_DEVPATH
+#  define MP34DT05_I2S_DEVPATH "/dev/i2schar0"
+#endif
+
+#define MP34DT05_I2S_SAMPLERATE     32000
+/* 512 bytes of PDM = 256 words = 64 PCM samples (4 ms) per block */
+#define MP34DT05_PDM_BLOCK_BYTES    512
+/* PCM FIFO size in samples, must be a power of 2 */
+#define MP34DT05_PCM_FIFO_SIZE      4096
+#define MP34DT05_THREAD_PRIORITY    110
+#define MP34DT05_THREAD_STACK_SIZE  2048
+
+static PdmDecimator pdmDecimator;
+static int16_t pcmFifo[MP34DT05_PCM_FIFO_SIZE];
+static volatile uint32_t pcmHead = 0;
+static volatile uint32_t pcmTail = 0;
+static volatile uint32_t pcmOverruns = 0;
+static volatile Mp34dt05Callback pcmCallback = NULL;
+
+static volatile bool captureRunning = false;
+static pthread_t captureThread;
+static int captureFd = -1;
+static FAR struct ap_buffer_s *captureApb = NULL;
+
+/**
+ * @brief  Queue PCM samples, samples that do not fit are dropped and counted
+ * @param  [in] pcm samples
+ * @param  [in] count number of samples
+ * @retval None
+ */
+static void pcmFifoWrite(const int16_t *pcm, uint32_t count)
+{
+    uint32_t head = pcmHead;
+    uint32_t free = MP34DT05_PCM_FIFO_SIZE - (head - pcmTail);
+
+    if (count > free) {
+        pcmOverruns += count - free;
+        count = free;
+    }
+
+    uint32_t offset = head & (MP34DT05_PCM_FIFO_SIZE - 1);
+    uint32_t first = MP34DT05_PCM_FIFO_SIZE - offset;
+    if (first > count) {
+        first = count;
+    }
+
+    memcpy(&pcmFifo[offset], pcm, first * sizeof(int16_t));
+    memcpy(&pcmFifo[0], &pcm[first], (count - first) * sizeof(int16_t));
+
+    pcmHead = head + count;
+}
+
+static pthread_addr_t captureTask(pthread_addr_t arg)
+{
+    int16_t pcm[(MP34DT05_PDM_BLOCK_BYTES / sizeof(uint16_t) / PDM_DECIMATOR_FIR_DECIMATION) + 1];
+    int bufsize = sizeof(struct ap_buffer_s) + MP34DT05_PDM_BLOCK_BYTES;
+
+    while (captureRunning) {
+        int nread = read(captureFd, captureApb, bufsize);
+        if (nread < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            printf("Mp34dt05: ERROR: read failed: %d\n", errno);
+            break;
+        }
+
+        size_t samples = pdmDecimator.process((const uint16_t *)captureApb->samp,
+            captureApb->nbytes / sizeof(uint16_t), pcm);
+
+        Mp34dt05Callback callback = pcmCallback;
+        if (callback != NULL) {
+            callback(pcm, samples);
+        }
+        else {
+            pcmFifoWrite(pcm, samples);
+        }
+    }
+
+    /* Device and thread are released by Mp34dt05Stop() */
+    captureRunning = false;
+    return NULL;
+}
+
+bool Mp34dt05Start (void)
+{
+    struct audio_buf_desc_s desc;
+    struct sched_param param;
+    pthread_attr_t attr;
+
+    if (captureRunning) {
+        return true;
+    }
+
+    /* The capture thread stops by itself on a read error, join it and
+       release the device before opening it again */
+    if (captureFd >= 0) {
+        Mp34dt05Stop();
+    }
+
+    captureFd = open(MP34DT05_I2S_DEVPATH, O_RDONLY);
+    if (captureFd < 0) {
+        printf("Mp34dt05: ERROR: failed to open %s: %d\n", MP34DT05_I2S_DEVPATH, errno);
+        return false;
+    }
+
+    desc.numbytes = MP34DT05_PDM_BLOCK_BYTES;
+    desc.u.ppBuffer = &captureApb;
+    if (apb_alloc(&desc) < 0) {
+        printf("Mp34dt05: ERROR: failed to allocate buffer\n");
+        close(captureFd);
+        captureFd = -1;
+        return false;
+    }
+
+    pdmDecimator.reset();
+    pcmHead = 0;
+    pcmTail = 0;
+    pcmOverruns = 0;
+    captureRunning = true;
+
+    pthread_attr_init(&attr);
+    param.sched_priority = MP34DT05_THREAD_PRIORITY;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setstacksize(&attr, MP34DT05_THREAD_STACK_SIZE);
+
+    if (pthread_create(&captureThread, &attr, captureTask, NULL) != 0) {
+        printf("Mp34dt05: ERROR: failed to start capture thread\n");
+        captureRunning = false;
+        apb_free(captureApb);
+        captureApb = NULL;
+        close(captureFd);
+        captureFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void Mp34dt05Stop (void)
+{
+    if (captureFd < 0) {
+        return;
+    }
+
+    captureRunning = false;
+    pthread_join(captureThread, NULL);
+
+    apb_free(captureApb);
+    captureApb = NULL;
+    close(captureFd);
+    captureFd = -1;
+}
+
+size_t Mp34dt05Read (int16_t *pcm, size_t maxSamples)
+{
+    uint32_t tail = pcmTail;
+    uint32_t count = pcmHead - tail;
+
+    if (count > maxSamples) {
+        count = maxSamples;
+    }
+
+    uint32_t offset = tail & (MP34DT05_PCM_FIFO_SIZE - 1);
+    uint32_t first = MP34DT05_PCM_FIFO_SIZE - offset;
+    if (first > count) {
+        first = count;
+    }
+
+    memcpy(pcm, &pcmFifo[offset], first * sizeof(int16_t));
+    memcpy(&pcm[first], &pcmFifo[0], (count - first) * sizeof(int16_t));
+
+    pcmTail = tail + count;
+
+    return count;
+}
+
+uint32_t Mp34dt05GetOverruns (void)
+{
+    return pcmOverruns;
+}
+
+void Mp34dt05SetCallback (Mp34dt05Callback callback)
+{
+    pcmCallback = callback;
+}
+
+void Mp34dt05SetGain (uint8_t shift)
+{
+    pdmDecimator.setGain(shift);
+}
+
 
 #if 0 // Last test
 
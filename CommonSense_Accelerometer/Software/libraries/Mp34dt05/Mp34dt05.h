@@ -36,6 +36,7 @@
 #define MP34DT05_H
 
 #include "stdint.h"
+#include "stddef.h"
 
 
 /****************************************************************************
@@ -157,6 +158,55 @@ pthread_addr_t i2schar_receiver(pthread_addr_t arg);
 
 void Mp34dt05Init (void);
 
+/**
+ * @brief  Start I2S capture and PDM to PCM conversion (16 kHz, 16 bit, mono)
+ * @param  None
+ * @retval false if the I2S device could not be opened or the thread not started
+ */
+bool Mp34dt05Start (void);
+
+/**
+ * @brief  Stop capture and release the I2S device
+ * @param  None
+ * @retval None
+ */
+void Mp34dt05Stop (void);
+
+/**
+ * @brief  Get the PCM samples captured since the last call
+ * @param  [out] pcm output buffer
+ * @param  [in] maxSamples size of pcm in samples
+ * @retval number of samples copied
+ */
+size_t Mp34dt05Read (int16_t *pcm, size_t maxSamples);
+
+/**
+ * @brief  Number of PCM samples dropped because Mp34dt05Read() was not called in time
+ * @param  None
+ * @retval dropped samples since Mp34dt05Start()
+ */
+uint32_t Mp34dt05GetOverruns (void);
+
+/**
+ * @brief  Callback for captured PCM samples, runs in the capture thread
+ */
+typedef void (*Mp34dt05Callback)(const int16_t *pcm, size_t samples);
+
+/**
+ * @brief  Hand captured samples to a callback instead of the FIFO
+ * @param  [in] callback called from the capture thread for every decimated
+ *         block, NULL to queue samples for Mp34dt05Read() again
+ * @retval None
+ */
+void Mp34dt05SetCallback (Mp34dt05Callback callback);
+
+/**
+ * @brief  Set the PCM gain
+ * @param  [in] shift left shift of the decimator output (0..7)
+ * @retval None
+ */
+void Mp34dt05SetGain (uint8_t shift);
+
 #if 0
 #define MIC_BUF_SIZE 512
 
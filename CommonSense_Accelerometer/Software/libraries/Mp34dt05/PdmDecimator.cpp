@@ -0,0 +1,192 @@
+/**
+ ******************************************************************************
+ * @file    PdmDecimator.cpp
+ * @date    19 October 2026
+ * @brief   Table-driven PDM to PCM decimator
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+#include <string.h>
+#include "PdmDecimator.h"
+
+/** sinc^4 with a decimation of 16 has 4 * (16 - 1) + 1 taps, padded to 64 */
+#define CIC_ORDER           4
+#define CIC_TAPS            64
+#define CIC_LUT_BYTES       (CIC_TAPS / 8)
+/** CIC output is +-65536 at full scale, scaled to +-16384 for the FIR stage */
+#define CIC_OUTPUT_SHIFT    2
+/** DC blocker pole, 0.995 in Q15 (about 13 Hz corner at 16 kHz) */
+#define DC_BLOCKER_POLE     32604
+/** Extra precision of the DC blocker state, avoids a truncation limit cycle offset */
+#define DC_BLOCKER_FRAC     8
+
+/**
+ * Second stage low-pass, Kaiser (beta 7) windowed sinc in Q15, unity DC gain.
+ * Designed for 64 kHz in, cut-off 6.5 kHz: -3 dB at 6 kHz, < -70 dB from 9 kHz.
+ */
+static const int16_t firCoefs[PDM_DECIMATOR_FIR_TAPS] = {
+        2,      2,      0,     -6,    -15,    -20,    -16,      3,
+       35,     67,     80,     54,    -17,   -114,   -199,   -218,
+     -131,     60,    300,    488,    505,    278,   -178,   -731,
+    -1152,  -1180,   -618,    579,   2257,   4087,   5644,   6538,
+     6538,   5644,   4087,   2257,    579,   -618,  -1180,  -1152,
+     -731,   -178,    278,    505,    488,    300,     60,   -131,
+     -218,   -199,   -114,    -17,     54,     80,     67,     35,
+        3,    -16,    -20,    -15,     -6,      0,      2,      2,
+};
+
+/** Partial CIC sums for every byte position in the 64 bit window and every byte value */
+static int16_t cicLut[CIC_LUT_BYTES][256];
+static bool cicLutReady = false;
+
+/**
+ * @brief Fill the CIC lookup table
+ * @details The sinc^4 impulse response is the 16 sample boxcar convolved with
+ *          itself 4 times. Every table entry holds the filter output of the 8
+ *          taps covered by one byte, with a 1 bit counted as +1 and a 0 bit as -1.
+ */
+void PdmDecimator::buildLut(void)
+{
+    int32_t taps[CIC_TAPS];
+    int32_t tmp[CIC_TAPS];
+    int len = 1;
+
+    memset(taps, 0, sizeof(taps));
+    taps[0] = 1;
+
+    for (int order = 0; order < CIC_ORDER; order++) {
+        memset(tmp, 0, sizeof(tmp));
+        for (int i = 0; i < len; i++) {
+            for (int j = 0; j < PDM_DECIMATOR_WORD_BITS; j++) {
+                tmp[i + j] += taps[i];
+            }
+        }
+        len += PDM_DECIMATOR_WORD_BITS - 1;
+        memcpy(taps, tmp, sizeof(taps));
+    }
+
+    for (int byte = 0; byte < CIC_LUT_BYTES; byte++) {
+        for (int value = 0; value < 256; value++) {
+            int32_t sum = 0;
+            for (int bit = 0; bit < 8; bit++) {
+                int32_t tap = taps[(byte * 8) + bit];
+                sum += (value & (0x80 >> bit)) ? tap : -tap;
+            }
+            cicLut[byte][value] = (int16_t)sum;
+        }
+    }
+
+    cicLutReady = true;
+}
+
+PdmDecimator::PdmDecimator() : gain(PDM_DECIMATOR_DEFAULT_GAIN)
+{
+    if (!cicLutReady) {
+        buildLut();
+    }
+    reset();
+}
+
+void PdmDecimator::reset(void)
+{
+    /* Alternating bits is the PDM code for silence */
+    cicHistory[0] = 0x5555;
+    cicHistory[1] = 0x5555;
+    cicHistory[2] = 0x5555;
+    memset(firDelay, 0, sizeof(firDelay));
+    firIndex = 0;
+    firPhase = 0;
+    dcIn = 0;
+    dcOut = 0;
+}
+
+void PdmDecimator::setGain(uint8_t shift)
+{
+    gain = (shift > 7) ? 7 : shift;
+}
+
+size_t PdmDecimator::process(const uint16_t *pdm, size_t words, int16_t *pcm)
+{
+    size_t out = 0;
+    uint16_t w0 = cicHistory[0];
+    uint16_t w1 = cicHistory[1];
+    uint16_t w2 = cicHistory[2];
+
+    for (size_t ix = 0; ix < words; ix++) {
+        uint16_t w3 = pdm[ix];
+
+        /* CIC stage, one output per PDM word */
+        int32_t cic = cicLut[0][w0 >> 8] + cicLut[1][w0 & 0xFF]
+                    + cicLut[2][w1 >> 8] + cicLut[3][w1 & 0xFF]
+                    + cicLut[4][w2 >> 8] + cicLut[5][w2 & 0xFF]
+                    + cicLut[6][w3 >> 8] + cicLut[7][w3 & 0xFF];
+        w0 = w1;
+        w1 = w2;
+        w2 = w3;
+
+        /* Delay line is stored twice, so the taps are always contiguous */
+        cic >>= CIC_OUTPUT_SHIFT;
+        firDelay[firIndex] = cic;
+        firDelay[firIndex + PDM_DECIMATOR_FIR_TAPS] = cic;
+        firIndex = (firIndex + 1) & (PDM_DECIMATOR_FIR_TAPS - 1);
+
+        if (++firPhase < PDM_DECIMATOR_FIR_DECIMATION) {
+            continue;
+        }
+        firPhase = 0;
+
+        /* FIR stage, only evaluated for the kept samples */
+        const int32_t *x = &firDelay[firIndex];
+        int32_t acc = 0;
+        for (int tap = 0; tap < PDM_DECIMATOR_FIR_TAPS; tap++) {
+            acc += x[tap] * firCoefs[tap];
+        }
+        int32_t sample = acc >> 15;
+
+        /* DC blocker, PDM microphones have a large offset */
+        dcOut = (sample - dcIn) * (1 << DC_BLOCKER_FRAC)
+              + (int32_t)(((int64_t)dcOut * DC_BLOCKER_POLE) >> 15);
+        dcIn = sample;
+
+        sample = (dcOut >> DC_BLOCKER_FRAC) * (1 << gain);
+        if (sample > INT16_MAX) {
+            sample = INT16_MAX;
+        }
+        else if (sample < INT16_MIN) {
+            sample = INT16_MIN;
+        }
+        pcm[out++] = (int16_t)sample;
+    }
+
+    cicHistory[0] = w0;
+    cicHistory[1] = w1;
+    cicHistory[2] = w2;
+
+    return out;
+}
@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file    PdmDecimator.h
+ * @date    19 October 2026
+ * @brief   Table-driven PDM to PCM decimator
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+#ifndef PDM_DECIMATOR_H
+#define PDM_DECIMATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** PDM bits per 16 bit I2S word, one word is one first stage output */
+#define PDM_DECIMATOR_WORD_BITS     16
+/** Second stage (FIR) decimation factor */
+#define PDM_DECIMATOR_FIR_DECIMATION 4
+/** Total decimation, 1.024 MHz PDM clock -> 16 kHz PCM */
+#define PDM_DECIMATOR_DECIMATION    (PDM_DECIMATOR_WORD_BITS * PDM_DECIMATOR_FIR_DECIMATION)
+/** Number of FIR taps of the second stage */
+#define PDM_DECIMATOR_FIR_TAPS      64
+/** Default output gain as left shift */
+#define PDM_DECIMATOR_DEFAULT_GAIN  1
+
+/**
+ * @brief Converts a packed 1 bit PDM stream to 16 bit PCM
+ * @details First stage is a 4th order CIC (sinc^4) decimating by 16, evaluated
+ *          as a 64 tap FIR on the last 4 PDM words with a byte lookup table,
+ *          so one output costs 8 table reads. Second stage is a 64 tap FIR
+ *          low-pass decimating by 4, followed by a DC blocker.
+ *          PDM words are taken MSB first, as shifted in by the I2S peripheral.
+ */
+class PdmDecimator
+{
+public:
+    PdmDecimator();
+
+    /**
+     * @brief Clear the filter state, keeps the gain
+     */
+    void reset(void);
+
+    /**
+     * @brief Set the output gain
+     * @param [in] shift left shift applied before saturating to 16 bit (0..7)
+     */
+    void setGain(uint8_t shift);
+
+    /**
+     * @brief Decimate a block of PDM words
+     * @param [in] pdm packed PDM words, 16 bits each, oldest bit in the MSB
+     * @param [in] words number of words in pdm
+     * @param [out] pcm output buffer, needs room for (words + 3) / 4 samples
+     * @retval number of PCM samples written
+     */
+    size_t process(const uint16_t *pdm, size_t words, int16_t *pcm);
+
+private:
+    static void buildLut(void);
+
+    uint16_t cicHistory[3];
+    int32_t firDelay[PDM_DECIMATOR_FIR_TAPS * 2];
+    uint8_t firIndex;
+    uint8_t firPhase;
+    int32_t dcIn;
+    int32_t dcOut;
+    uint8_t gain;
+};
+
+#endif // PDM_DECIMATOR_H
@@ -0,0 +1,248 @@
+/**
+ ******************************************************************************
+ * @file    SensorHub.cpp
+ * @date    19 October 2026
+ * @brief   Burst polling of the on-board I2C sensors
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+#include "SensorHub.h"
+#include "../I2c/I2c.h"
+#include "../Hts221/Hts221.h"
+#include "../Lis2mdl/Lis2mdl.h"
+#include "../Lps22hh/Lps22hh.h"
+#include "../Lsm6dso32/Lsm6dso32.h"
+#include "../Sgp4x/sensirion_i2c_hal.h"
+#include "../Sgp4x/sgp41_i2c.h"
+#include "../GasCompensation/GasCompensation.h"
+
+#include <string.h>
+
+static uint32_t hub_sensors = 0;
+
+static lin_t hts221_lin_hum;
+static lin_t hts221_lin_temp;
+static gas_compensation_t gas_comp;
+static bool sgp41_started = false;
+
+// burst buffers, filled by the queued bus cycle
+static uint8_t gyro_status;
+static uint8_t gyro_buf[6];
+static uint8_t mag_buf[LIS2MDL_DATA_BURST_LEN];
+static uint8_t press_buf[LPS22HH_DATA_BURST_LEN];
+static uint8_t hum_buf[HTS221_DATA_BURST_LEN];
+static uint8_t gas_buf[SGP41_RAW_SIGNALS_LEN];
+static uint8_t gas_cmd[SGP41_MEASURE_RAW_CMD_LEN];
+
+static inline int16_t RawToInt16(const uint8_t *buf) {
+    return (int16_t) ((uint16_t) buf[1] << 8 | buf[0]);
+}
+
+static float LinearInterpolation(const lin_t *lin, int16_t x) {
+    return ((lin->y1 - lin->y0) * x + ((lin->x1 * lin->y0) - (lin->x0 * lin->y1)))
+         / (lin->x1 - lin->x0);
+}
+
+static bool Lsm6dso32Init(void) {
+    uint8_t whoamI = 0;
+    lsm6dso32_device_id_get(nullptr, &whoamI);
+    if (whoamI != LSM6DSO32_ID) {
+        return false;
+    }
+
+    lsm6dso32_i3c_disable_set(nullptr, LSM6DSO32_I3C_DISABLE);
+    lsm6dso32_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lsm6dso32_gy_full_scale_set(nullptr, LSM6DSO32_2000dps);
+    lsm6dso32_gy_data_rate_set(nullptr, LSM6DSO32_GY_ODR_417Hz_HIGH_PERF);
+    return true;
+}
+
+static bool Lis2mdlInit(void) {
+    uint8_t whoamI = 0;
+    lis2mdl_device_id_get(nullptr, &whoamI);
+    if (whoamI != LIS2MDL_ID) {
+        return false;
+    }
+
+    lis2mdl_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lis2mdl_data_rate_set(nullptr, LIS2MDL_ODR_100Hz);
+    lis2mdl_set_rst_mode_set(nullptr, LIS2MDL_SENS_OFF_CANC_EVERY_ODR);
+    lis2mdl_offset_temp_comp_set(nullptr, PROPERTY_ENABLE);
+    lis2mdl_operating_mode_set(nullptr, LIS2MDL_CONTINUOUS_MODE);
+    return true;
+}
+
+static bool Lps22hhInit(void) {
+    uint8_t whoamI = 0;
+    lps22hh_device_id_get(nullptr, &whoamI);
+    if (whoamI != LPS22HH_ID) {
+        return false;
+    }
+
+    lps22hh_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lps22hh_data_rate_set(nullptr, LPS22HH_50_Hz_LOW_NOISE);
+    return true;
+}
+
+static bool Hts221Init(void) {
+    uint8_t whoamI = 0;
+    hts221_device_id_get(nullptr, &whoamI);
+    if (whoamI != HTS221_ID) {
+        return false;
+    }
+
+    if (!GasCompensationReadCalibration(&hts221_lin_hum, &hts221_lin_temp)) {
+        return false;
+    }
+    GasCompensationInit(&gas_comp, &hts221_lin_hum, &hts221_lin_temp);
+
+    hts221_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    hts221_data_rate_set(nullptr, HTS221_ODR_12Hz5);
+    hts221_power_on_set(nullptr, PROPERTY_ENABLE);
+    return true;
+}
+
+static bool Sgp41Init(void) {
+    uint16_t serial_number[3];
+
+    sensirion_i2c_hal_init();
+    sgp41_started = false;
+    return sgp41_get_serial_number(serial_number, 3) == 0;
+}
+
+uint32_t SensorHubInit(uint32_t sensors) {
+    i2c_init();
+
+    hub_sensors = 0;
+    GasCompensationInit(&gas_comp, nullptr, nullptr);
+    if ((sensors & SENSOR_HUB_GYRO) && Lsm6dso32Init()) {
+        hub_sensors |= SENSOR_HUB_GYRO;
+    }
+    if ((sensors & SENSOR_HUB_MAG) && Lis2mdlInit()) {
+        hub_sensors |= SENSOR_HUB_MAG;
+    }
+    if ((sensors & SENSOR_HUB_PRESSURE) && Lps22hhInit()) {
+        hub_sensors |= SENSOR_HUB_PRESSURE;
+    }
+    if ((sensors & SENSOR_HUB_HUMIDITY) && Hts221Init()) {
+        hub_sensors |= SENSOR_HUB_HUMIDITY;
+    }
+    if ((sensors & SENSOR_HUB_GAS) && Sgp41Init()) {
+        hub_sensors |= SENSOR_HUB_GAS;
+    }
+
+    return hub_sensors;
+}
+
+uint32_t SensorHubRead(uint32_t sensors, float values[SENSOR_HUB_N_SENSORS][SENSOR_HUB_MAX_VALUES]) {
+    i2c_queue_t queue;
+    i2c_xfer_t *gyro_xfer = nullptr, *gyro_status_xfer = nullptr;
+    i2c_xfer_t *mag_xfer = nullptr, *press_xfer = nullptr, *hum_xfer = nullptr;
+    i2c_xfer_t *gas_xfer = nullptr;
+    uint32_t fresh = 0;
+
+    sensors &= hub_sensors;
+
+    i2c_queue_init(&queue);
+    if (sensors & SENSOR_HUB_GYRO) {
+        gyro_status_xfer = i2c_queue_read_regs(&queue, LSM6DSO32_I2C_ADD, LSM6DSO32_STATUS_REG, &gyro_status, 1);
+        gyro_xfer = i2c_queue_read_regs(&queue, LSM6DSO32_I2C_ADD, LSM6DSO32_OUTX_L_G, gyro_buf, sizeof(gyro_buf));
+    }
+    if (sensors & SENSOR_HUB_MAG) {
+        mag_xfer = lis2mdl_queue_data_get(&queue, mag_buf);
+    }
+    if (sensors & SENSOR_HUB_PRESSURE) {
+        press_xfer = lps22hh_queue_data_get(&queue, press_buf);
+    }
+    if (sensors & SENSOR_HUB_HUMIDITY) {
+        hum_xfer = hts221_queue_data_get(&queue, hum_buf);
+    }
+    if (sensors & SENSOR_HUB_GAS) {
+        // read the measurement started in the previous cycle and start the next one,
+        // compensated with the humidity and temperature of the previous cycle
+        if (sgp41_started) {
+            gas_xfer = sgp41_queue_read_raw_signals(&queue, gas_buf);
+        }
+        sgp41_queue_measure_raw_signals(&queue, gas_comp.rh_ticks, gas_comp.t_ticks, gas_cmd);
+    }
+
+    if (queue.count == 0) {
+        return 0;
+    }
+
+    i2c_queue_submit(&queue);
+
+    if (gyro_xfer && gyro_xfer->status == TWI_SUCCESS && gyro_status_xfer->status == TWI_SUCCESS
+        && ((lsm6dso32_status_reg_t *) &gyro_status)->gda) {
+        for (int i = 0; i < 3; i++) {
+            values[SENSOR_HUB_GYRO_POS][i] = lsm6dso32_from_fs2000_to_mdps(RawToInt16(&gyro_buf[2 * i])) / 1000.0f;
+        }
+        fresh |= SENSOR_HUB_GYRO;
+    }
+
+    if (mag_xfer && mag_xfer->status == TWI_SUCCESS && ((lis2mdl_status_reg_t *) &mag_buf[0])->zyxda) {
+        for (int i = 0; i < 3; i++) {
+            values[SENSOR_HUB_MAG_POS][i] = lis2mdl_from_lsb_to_mgauss(RawToInt16(&mag_buf[1 + 2 * i]));
+        }
+        fresh |= SENSOR_HUB_MAG;
+    }
+
+    if (press_xfer && press_xfer->status == TWI_SUCCESS && ((lps22hh_status_t *) &press_buf[0])->p_da) {
+        int32_t raw_pressure = (int32_t) press_buf[3] << 16 | (int32_t) press_buf[2] << 8 | press_buf[1];
+        values[SENSOR_HUB_PRESSURE_POS][0] = lps22hh_from_lsb_to_hpa(raw_pressure);
+        values[SENSOR_HUB_PRESSURE_POS][1] = lps22hh_from_lsb_to_celsius(RawToInt16(&press_buf[4]));
+        fresh |= SENSOR_HUB_PRESSURE;
+    }
+
+    if (hum_xfer && hum_xfer->status == TWI_SUCCESS) {
+        GasCompensationUpdate(&gas_comp, hum_buf);
+    }
+    if (hum_xfer && hum_xfer->status == TWI_SUCCESS && ((hts221_status_reg_t *) &hum_buf[0])->h_da) {
+        float humidity = LinearInterpolation(&hts221_lin_hum, RawToInt16(&hum_buf[1]));
+        values[SENSOR_HUB_HUMIDITY_POS][0] = humidity < 0.0f ? 0.0f : (humidity > 100.0f ? 100.0f : humidity);
+        values[SENSOR_HUB_HUMIDITY_POS][1] = LinearInterpolation(&hts221_lin_temp, RawToInt16(&hum_buf[3]));
+        fresh |= SENSOR_HUB_HUMIDITY;
+    }
+
+    if (gas_xfer && gas_xfer->status == TWI_SUCCESS) {
+        uint16_t sraw_voc, sraw_nox;
+        if (sgp41_decode_raw_signals(gas_buf, &sraw_voc, &sraw_nox) == 0) {
+            values[SENSOR_HUB_GAS_POS][0] = (float) sraw_voc;
+            values[SENSOR_HUB_GAS_POS][1] = (float) sraw_nox;
+            fresh |= SENSOR_HUB_GAS;
+        }
+    }
+    if (sensors & SENSOR_HUB_GAS) {
+        // the start command is the last transaction of the cycle
+        sgp41_started = (queue.xfers[queue.count - 1].status == TWI_SUCCESS);
+    }
+
+    return fresh;
+}
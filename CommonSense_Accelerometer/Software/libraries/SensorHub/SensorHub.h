@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ * @file    SensorHub.h
+ * @date    19 October 2026
+ * @brief   Burst polling of the on-board I2C sensors
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+#include <stdint.h>
+
+// sensor positions, shared with sensors/ei_fusion_sampler.h
+#define SENSOR_HUB_GYRO_POS     (0)         // LSM6DSO32: x, y, z [dps]
+#define SENSOR_HUB_MAG_POS      (1)         // LIS2MDL: x, y, z [mG]
+#define SENSOR_HUB_PRESSURE_POS (2)         // LPS22HH: pressure [hPa], temperature [degC]
+#define SENSOR_HUB_HUMIDITY_POS (3)         // HTS221: humidity [%RH], temperature [degC]
+#define SENSOR_HUB_GAS_POS      (4)         // SGP41: SRAW_VOC, SRAW_NOX [ticks]
+
+#define SENSOR_HUB_GYRO         (1 << SENSOR_HUB_GYRO_POS)
+#define SENSOR_HUB_MAG          (1 << SENSOR_HUB_MAG_POS)
+#define SENSOR_HUB_PRESSURE     (1 << SENSOR_HUB_PRESSURE_POS)
+#define SENSOR_HUB_HUMIDITY     (1 << SENSOR_HUB_HUMIDITY_POS)
+#define SENSOR_HUB_GAS          (1 << SENSOR_HUB_GAS_POS)
+
+#define SENSOR_HUB_N_SENSORS    (5)
+#define SENSOR_HUB_MAX_VALUES   (3)
+
+/**
+ * @brief  Check and configure sensors for continuous polling
+ * @param  [in] sensors SENSOR_HUB_* mask
+ * @retval Mask of the sensors that answered
+ */
+uint32_t SensorHubInit(uint32_t sensors);
+
+/**
+ * @brief  Read sensors in one I2C bus cycle and convert to physical units
+ * @param  [in] sensors SENSOR_HUB_* mask of the sensors to read
+ * @param  [out] values SENSOR_HUB_MAX_VALUES values per sensor, indexed by bit position,
+ *               only written for sensors with new data
+ * @retval Mask of the sensors that had new data
+ */
+uint32_t SensorHubRead(uint32_t sensors, float values[SENSOR_HUB_N_SENSORS][SENSOR_HUB_MAX_VALUES]);
+
+#endif // SENSOR_HUB_H
@@ -39,12 +39,19 @@
 #ifndef SGP41_I2C_H
 #define SGP41_I2C_H
 
+#include "../I2c/I2c.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 #include "sensirion_config.h"
 
+/* Bytes of the measure raw command including arguments and CRCs */
+#define SGP41_MEASURE_RAW_CMD_LEN 8
+/* Bytes of the raw signals answer, SRAW_VOC and SRAW_NOX each with CRC */
+#define SGP41_RAW_SIGNALS_LEN 6
+
 /**
  * sgp41_execute_conditioning() - This command starts the conditioning, i.e.,
  * the VOC pixel will be operated at the same temperature as it is by calling
@@ -88,6 +95,50 @@ int16_t sgp41_execute_conditioning(uint16_t default_rh, uint16_t default_t, uint
  */
 int16_t sgp41_measure_raw_signals(uint16_t relative_humidity, uint16_t temperature, uint16_t* sraw_voc, uint16_t* sraw_nox);
 
+/**
+ * sgp41_queue_measure_raw_signals() - Queue the measure raw command without
+ * waiting for the result. The answer is ready 50 ms later and is read with
+ * sgp41_queue_read_raw_signals() in the next bus cycle.
+ *
+ * @param queue I2C transaction queue
+ *
+ * @param relative_humidity See sgp41_measure_raw_signals()
+ *
+ * @param temperature See sgp41_measure_raw_signals()
+ *
+ * @param command SGP41_MEASURE_RAW_CMD_LEN bytes, must stay valid until the
+ * queue is submitted
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sgp41_queue_measure_raw_signals(i2c_queue_t* queue, uint16_t relative_humidity, uint16_t temperature, uint8_t* command);
+
+/**
+ * sgp41_queue_read_raw_signals() - Queue the read of a measurement started
+ * before. Decode the buffer with sgp41_decode_raw_signals() after submit.
+ *
+ * @param queue I2C transaction queue
+ *
+ * @param buffer SGP41_RAW_SIGNALS_LEN bytes
+ *
+ * @return queued transaction, NULL if the queue is full
+ */
+i2c_xfer_t* sgp41_queue_read_raw_signals(i2c_queue_t* queue, uint8_t* buffer);
+
+/**
+ * sgp41_decode_raw_signals() - Check the CRCs of a raw signals answer and
+ * extract SRAW_VOC and SRAW_NOX
+ *
+ * @param buffer SGP41_RAW_SIGNALS_LEN bytes read from the sensor
+ *
+ * @param sraw_voc See sgp41_measure_raw_signals()
+ *
+ * @param sraw_nox See sgp41_measure_raw_signals()
+ *
+ * @return 0 on success, an error code otherwise
+ */
+int16_t sgp41_decode_raw_signals(const uint8_t* buffer, uint16_t* sraw_voc, uint16_t* sraw_nox);
+
 /**
  * sgp41_execute_self_test() - This command triggers the built-in self-test
  * checking for integrity of both hotplate and MOX material and returns the
@@ -4,6 +4,7 @@
 #include <arch/board/board.h>
 #include <arch/cxd56xx/pin.h>
 #include <cxd56_uart.h>
+#include <cxd56_clock.h>
 #include <hardware/cxd5602_memorymap.h>
 
 #include "ei_device_sony_spresense.h"
@@ -12,6 +13,9 @@
 #include "Wire.h"
 #include "KX126.h"
 #include "File.h"
+#include "LowPower.h"
+#include "Mp34dt05.h"
+#include "SensorHub.h"
 
 #include "Tests.h"
 
@@ -192,6 +196,59 @@ int spresense_getAcc(float acc_val[3])
     return (int)kx126.get_val(acc_val);
 }
 
+/**
+ * @brief Configure the I2C sensors polled by the fusion sampler
+ *
+ * @param sensors SENSOR_HUB_* mask
+ * @return uint32_t mask of the sensors that answered
+ */
+uint32_t spresense_setupFusion(uint32_t sensors)
+{
+    return SensorHubInit(sensors);
+}
+
+/**
+ * @brief Read the given sensors in a single I2C bus cycle
+ *
+ * @param sensors SENSOR_HUB_* mask
+ * @param values Converted values, per sensor position
+ * @return uint32_t mask of the sensors that had new data
+ */
+uint32_t spresense_getFusion(uint32_t sensors, float values[][SENSOR_HUB_MAX_VALUES])
+{
+    return SensorHubRead(sensors, values);
+}
+
+/**
+ * @brief Yield the CPU for the given time, the idle task puts the core in WFI
+ *
+ * @param us
+ */
+void spresense_sleep_us(uint32_t us)
+{
+    usleep(us);
+}
+
+/**
+ * @brief Switch between full speed and the lowest CPU clock (DVFS)
+ *
+ * @param low
+ */
+void spresense_set_low_clock(bool low)
+{
+    LowPower.clockMode(low ? CLOCK_MODE_8MHz : CLOCK_MODE_156MHz);
+}
+
+/**
+ * @brief Current CPU clock, changes with the LowPower clock modes
+ *
+ * @return uint32_t clock in Hz
+ */
+uint32_t spresense_get_cpu_freq_hz(void)
+{
+    return cxd56_get_cpu_baseclk();
+}
+
 /**
  * @brief Create audio instance and setup audio channel
  * @details Uses PCM format MONO @ 16KHz
@@ -229,6 +286,13 @@ bool spresense_startStopAudio(bool start)
 {
     bool cmdOk = true;
 
+    if(start == true) {
+        cmdOk = Mp34dt05Start();
+    }
+    else {
+        Mp34dt05Stop();
+    }
+
     // if(start == true) {
     //     cmdOk = spresense_setupAudio() ? false : true;
     //     theAudio->startRecorder();
@@ -250,6 +314,13 @@ bool spresense_startStopAudio(bool start)
  */
 void spresense_pauseAudio(bool pause)
 {
+    if(pause == true) {
+        Mp34dt05Stop();
+    }
+    else {
+        Mp34dt05Start();
+    }
+
     // if(pause == true) {
     //     theAudio->stopRecorder();
     // }
@@ -258,6 +329,16 @@ void spresense_pauseAudio(bool pause)
     // }
 }
 
+/**
+ * @brief Deliver audio from the capture thread instead of spresense_getAudio()
+ *
+ * @param callback called with every block of 16 bit samples, NULL to poll again
+ */
+void spresense_setAudioCallback(void (*callback)(const int16_t *samples, size_t n_samples))
+{
+    Mp34dt05SetCallback(callback);
+}
+
 /**
  * @brief Puts a sample array in audio_buffer with size in bytes
  *
@@ -269,6 +350,12 @@ bool spresense_getAudio(char *audio_buffer, unsigned int* size)
 {
     bool data_ready = false;
 
+    size_t samples = Mp34dt05Read((int16_t *)audio_buffer, buffer_size / sizeof(int16_t));
+    if(samples > 0) {
+        *size = samples * sizeof(int16_t);
+        data_ready = true;
+    }
+
     // err_t err = theAudio->readFrames(audio_buffer, buffer_size, (uint32_t *)size);
 
     // if(((err == AUDIOLIB_ECODE_OK) || (err == AUDIOLIB_ECODE_INSUFFICIENT_BUFFER_AREA)) && (*size > 0)) {
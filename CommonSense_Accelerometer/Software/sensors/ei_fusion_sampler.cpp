@@ -0,0 +1,337 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+
+#include "ei_fusion_sampler.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+#include "model-parameters/model_metadata.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define CONVERT_G_TO_MS2    9.80665f
+
+extern int spresense_getAcc(float acc_val[3]);
+extern uint32_t spresense_setupFusion(uint32_t sensors);
+extern uint32_t spresense_getFusion(uint32_t sensors, float values[][EI_FUSION_MAX_VALUES]);
+
+/** Frame layout used when the model does not bring its own (define EI_FUSION_AXES to override) */
+#if defined(EI_FUSION_AXES)
+static const ei_fusion_axis_t default_axes[] = EI_FUSION_AXES;
+#elif EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ENVIRONMENTAL
+static const ei_fusion_axis_t default_axes[] = {
+    { EI_FUSION_HUMIDITY, 1 }, { EI_FUSION_HUMIDITY, 0 }, { EI_FUSION_PRESSURE, 0 },
+};
+#else
+static const ei_fusion_axis_t default_axes[] = {
+    { EI_FUSION_ACC, 0 }, { EI_FUSION_ACC, 1 }, { EI_FUSION_ACC, 2 },
+    { EI_FUSION_GYRO, 0 }, { EI_FUSION_GYRO, 1 }, { EI_FUSION_GYRO, 2 },
+    { EI_FUSION_MAG, 0 }, { EI_FUSION_MAG, 1 }, { EI_FUSION_MAG, 2 },
+};
+#endif
+
+static const uint32_t poll_interval_ms[EI_FUSION_N_SENSORS] = {
+    EI_FUSION_GYRO_POLL_MS,
+    EI_FUSION_MAG_POLL_MS,
+    EI_FUSION_PRESSURE_POLL_MS,
+    EI_FUSION_HUMIDITY_POLL_MS,
+    EI_FUSION_GAS_POLL_MS,
+    EI_FUSION_ACC_POLL_MS,
+};
+
+/** Readings of a slow sensor within one window */
+typedef struct {
+    uint32_t t_us;
+    float values[EI_FUSION_MAX_VALUES];
+} fusion_reading_t;
+
+typedef struct {
+    uint32_t divider;           // poll every n-th sample
+    fusion_reading_t *log;      // NULL if polled on every sample
+    size_t log_size;
+    size_t log_count;
+    float last[EI_FUSION_MAX_VALUES];
+} fusion_sensor_t;
+
+/* Private variables ------------------------------------------------------- */
+static ei_fusion_axis_t fusion_axes[EI_FUSION_MAX_AXES];
+static size_t fusion_n_axes;
+static uint32_t fusion_used;
+static fusion_sensor_t fusion_sensors[EI_FUSION_N_SENSORS];
+static uint32_t *sample_t_us;
+static size_t max_window_samples;
+
+static float *window_frame;
+static size_t window_samples;
+static size_t sample_ix;
+static uint64_t window_start_us;
+
+/**
+ * @brief      Get the frame layout for the current model
+ *
+ * @param[out] n_axes  Number of columns
+ *
+ * @return     Axes, one per column
+ */
+const ei_fusion_axis_t *ei_fusion_default_axes(size_t *n_axes)
+{
+    *n_axes = sizeof(default_axes) / sizeof(default_axes[0]);
+    return default_axes;
+}
+
+/**
+ * @brief      Release the buffers
+ */
+void ei_fusion_deinit(void)
+{
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        if (fusion_sensors[s].log) {
+            ei_free(fusion_sensors[s].log);
+        }
+    }
+    memset(fusion_sensors, 0, sizeof(fusion_sensors));
+
+    if (sample_t_us) {
+        ei_free(sample_t_us);
+        sample_t_us = NULL;
+    }
+    fusion_used = 0;
+    fusion_n_axes = 0;
+}
+
+/**
+ * @brief      Set up the sensors in the frame layout. Every sensor is polled at
+ *             its own rate, slow sensors are resampled onto the sample timeline
+ *             when the window ends.
+ *
+ * @param[in]  axes         Frame layout, one entry per column
+ * @param[in]  n_axes       Number of columns
+ * @param[in]  interval_ms  Time between two samples
+ * @param[in]  max_samples  Longest window in samples
+ *
+ * @return     false if a sensor does not answer or on allocation failure
+ */
+bool ei_fusion_init(const ei_fusion_axis_t *axes, size_t n_axes, float interval_ms, size_t max_samples)
+{
+    ei_fusion_deinit();
+
+    if (n_axes == 0 || n_axes > EI_FUSION_MAX_AXES || max_samples == 0 || interval_ms <= 0.0f) {
+        return false;
+    }
+
+    for (size_t ix = 0; ix < n_axes; ix++) {
+        if (axes[ix].sensor >= EI_FUSION_N_SENSORS || axes[ix].value >= EI_FUSION_MAX_VALUES) {
+            return false;
+        }
+        fusion_axes[ix] = axes[ix];
+        fusion_used |= (1 << axes[ix].sensor);
+    }
+    fusion_n_axes = n_axes;
+
+    uint32_t i2c_sensors = fusion_used & ~(1 << EI_FUSION_ACC);
+    if (i2c_sensors) {
+        uint32_t found = spresense_setupFusion(i2c_sensors);
+        if (found != i2c_sensors) {
+            ei_printf("ERR: fusion sensors missing (0x%lx of 0x%lx)\n",
+                (unsigned long)found, (unsigned long)i2c_sensors);
+            fusion_used = 0;
+            return false;
+        }
+    }
+
+    sample_t_us = (uint32_t *)ei_malloc(max_samples * sizeof(uint32_t));
+    if (!sample_t_us) {
+        ei_fusion_deinit();
+        return false;
+    }
+    max_window_samples = max_samples;
+
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        if (!(fusion_used & (1 << s))) {
+            continue;
+        }
+
+        fusion_sensor_t *sensor = &fusion_sensors[s];
+        sensor->divider = (uint32_t)((float)poll_interval_ms[s] / interval_ms + 0.5f);
+        if (sensor->divider <= 1) {
+            sensor->divider = 1;
+            continue;
+        }
+
+        // one reading every divider samples, plus the first and last sample
+        sensor->log_size = max_samples / sensor->divider + 2;
+        sensor->log = (fusion_reading_t *)ei_malloc(sensor->log_size * sizeof(fusion_reading_t));
+        if (!sensor->log) {
+            ei_fusion_deinit();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Start a window, samples are written as they are read
+ *
+ * @param      frame      n_samples * n_axes values
+ * @param[in]  n_samples  Samples in this window (at most max_samples)
+ */
+void ei_fusion_window_start(float *frame, size_t n_samples)
+{
+    window_frame = frame;
+    window_samples = n_samples < max_window_samples ? n_samples : max_window_samples;
+    sample_ix = 0;
+    window_start_us = ei_read_timer_us();
+
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        fusion_sensors[s].log_count = 0;
+    }
+}
+
+/**
+ * @brief      Read one sample, timing is left to the caller
+ *             (see ei_scheduler_wait_sample()). All I2C sensors that are due
+ *             are read in one bus cycle.
+ *
+ * @return     0 if ok, -1 if a sensor could not be read or the window is full
+ */
+int ei_fusion_read_sample(void)
+{
+    float values[EI_FUSION_N_SENSORS][EI_FUSION_MAX_VALUES];
+    uint32_t due = 0;
+
+    if (!window_frame || sample_ix >= window_samples) {
+        return -1;
+    }
+
+    uint32_t t_us = (uint32_t)(ei_read_timer_us() - window_start_us);
+    sample_t_us[sample_ix] = t_us;
+
+    bool last_sample = (sample_ix == window_samples - 1);
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        uint32_t divider = fusion_sensors[s].divider;
+        if ((fusion_used & (1 << s)) && (sample_ix % divider == 0 || last_sample)) {
+            due |= (1 << s);
+        }
+    }
+
+    uint32_t fresh = 0;
+    uint32_t i2c_due = due & ~(1 << EI_FUSION_ACC);
+    if (i2c_due) {
+        fresh = spresense_getFusion(i2c_due, values);
+    }
+
+    if (due & (1 << EI_FUSION_ACC)) {
+        if (spresense_getAcc(values[EI_FUSION_ACC])) {
+            return -1;
+        }
+        for (int i = 0; i < 3; i++) {
+            values[EI_FUSION_ACC][i] *= CONVERT_G_TO_MS2;
+        }
+        fresh |= (1 << EI_FUSION_ACC);
+    }
+
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        fusion_sensor_t *sensor = &fusion_sensors[s];
+        if (!(fresh & (1 << s))) {
+            continue;
+        }
+
+        memcpy(sensor->last, values[s], sizeof(sensor->last));
+        if (sensor->log && sensor->log_count < sensor->log_size) {
+            fusion_reading_t *reading = &sensor->log[sensor->log_count++];
+            reading->t_us = t_us;
+            memcpy(reading->values, values[s], sizeof(reading->values));
+        }
+    }
+
+    // sensors read on every sample go straight into the frame, if a reading
+    // had no new data the previous value is held
+    float *row = &window_frame[sample_ix * fusion_n_axes];
+    for (size_t ix = 0; ix < fusion_n_axes; ix++) {
+        const fusion_sensor_t *sensor = &fusion_sensors[fusion_axes[ix].sensor];
+        if (!sensor->log) {
+            row[ix] = sensor->last[fusion_axes[ix].value];
+        }
+    }
+
+    sample_ix++;
+
+    return 0;
+}
+
+/**
+ * @brief      Resample the slow sensors onto the sample timestamps of the window.
+ *             Values between two readings are interpolated linearly, before the
+ *             first and after the last reading they are held.
+ */
+void ei_fusion_window_end(void)
+{
+    if (!window_frame) {
+        return;
+    }
+
+    for (int s = 0; s < EI_FUSION_N_SENSORS; s++) {
+        const fusion_sensor_t *sensor = &fusion_sensors[s];
+        if (!sensor->log) {
+            continue;
+        }
+
+        size_t reading = 0;
+        for (size_t sample = 0; sample < sample_ix; sample++) {
+            uint32_t t_us = sample_t_us[sample];
+            float *row = &window_frame[sample * fusion_n_axes];
+
+            while (reading + 1 < sensor->log_count && sensor->log[reading + 1].t_us <= t_us) {
+                reading++;
+            }
+
+            const float *v0;
+            const float *v1 = NULL;
+            float frac = 0.0f;
+
+            if (sensor->log_count == 0) {
+                v0 = sensor->last;
+            }
+            else if (reading + 1 >= sensor->log_count || t_us <= sensor->log[reading].t_us) {
+                v0 = sensor->log[reading].values;
+            }
+            else {
+                const fusion_reading_t *r0 = &sensor->log[reading];
+                const fusion_reading_t *r1 = &sensor->log[reading + 1];
+                v0 = r0->values;
+                v1 = r1->values;
+                frac = (float)(t_us - r0->t_us) / (float)(r1->t_us - r0->t_us);
+            }
+
+            for (size_t ix = 0; ix < fusion_n_axes; ix++) {
+                if (fusion_axes[ix].sensor != s) {
+                    continue;
+                }
+                uint8_t value = fusion_axes[ix].value;
+                row[ix] = v1 ? v0[value] + (v1[value] - v0[value]) * frac : v0[value];
+            }
+        }
+    }
+
+    window_frame = NULL;
+}
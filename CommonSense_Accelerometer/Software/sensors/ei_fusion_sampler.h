@@ -0,0 +1,75 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_FUSION_SAMPLER_H
+#define EI_FUSION_SAMPLER_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+
+/** Sensor positions, the I2C sensors match libraries/SensorHub/SensorHub.h */
+#define EI_FUSION_GYRO          0   // x, y, z [dps]
+#define EI_FUSION_MAG           1   // x, y, z [mG]
+#define EI_FUSION_PRESSURE      2   // pressure [hPa], temperature [degC]
+#define EI_FUSION_HUMIDITY      3   // humidity [%RH], temperature [degC]
+#define EI_FUSION_GAS           4   // SRAW_VOC, SRAW_NOX [ticks]
+#define EI_FUSION_ACC           5   // x, y, z [m/s2], read with spresense_getAcc
+#define EI_FUSION_N_SENSORS     6
+#define EI_FUSION_MAX_VALUES    3
+#define EI_FUSION_MAX_AXES      16
+
+/** Poll interval per sensor (close to its ODR), 0 polls on every sample */
+#ifndef EI_FUSION_ACC_POLL_MS
+#define EI_FUSION_ACC_POLL_MS       0
+#endif
+#ifndef EI_FUSION_GYRO_POLL_MS
+#define EI_FUSION_GYRO_POLL_MS      0
+#endif
+#ifndef EI_FUSION_MAG_POLL_MS
+#define EI_FUSION_MAG_POLL_MS       10
+#endif
+#ifndef EI_FUSION_PRESSURE_POLL_MS
+#define EI_FUSION_PRESSURE_POLL_MS  20
+#endif
+#ifndef EI_FUSION_HUMIDITY_POLL_MS
+#define EI_FUSION_HUMIDITY_POLL_MS  80
+#endif
+#ifndef EI_FUSION_GAS_POLL_MS
+#define EI_FUSION_GAS_POLL_MS       1000
+#endif
+
+/** One column of the frame */
+typedef struct {
+    uint8_t sensor;     // EI_FUSION_*
+    uint8_t value;      // index in the values of that sensor
+} ei_fusion_axis_t;
+
+/* Function prototypes ----------------------------------------------------- */
+const ei_fusion_axis_t *ei_fusion_default_axes(size_t *n_axes);
+bool ei_fusion_init(const ei_fusion_axis_t *axes, size_t n_axes, float interval_ms, size_t max_samples);
+void ei_fusion_deinit(void);
+void ei_fusion_window_start(float *frame, size_t n_samples);
+int ei_fusion_read_sample(void);
+void ei_fusion_window_end(void);
+
+#endif
@@ -70,6 +70,27 @@ int ei_inertial_read_data(void)
     return 0;
 }
 
+/**
+ * @brief      Read a single sample and call callback to handle, timing is
+ *             left to the caller (see ei_scheduler_wait_sample())
+ */
+int ei_inertial_read_sample(void)
+{
+    float acc_data[3];
+
+    if(spresense_getAcc(acc_data)) {
+        return -1;
+    }
+
+    imu_data[0] = acc_data[0] * CONVERT_G_TO_MS2;
+    imu_data[1] = acc_data[1] * CONVERT_G_TO_MS2;
+    imu_data[2] = acc_data[2] * CONVERT_G_TO_MS2;
+
+    cb_sampler((const void *)&imu_data[0], SIZEOF_N_AXIS_SAMPLED);
+
+    return 0;
+}
+
 /**
  * @brief      Setup timing and data handle callback function
  *
@@ -34,6 +34,7 @@ typedef float sample_format_t;
 
 /* Function prototypes ----------------------------------------------------- */
 int ei_inertial_read_data(void);
+int ei_inertial_read_sample(void);
 bool ei_inertial_sample_start(sampler_callback callback, float sample_interval_ms);
 bool ei_inertial_setup_data_sampling(void);
 
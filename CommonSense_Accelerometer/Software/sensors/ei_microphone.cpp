@@ -23,6 +23,9 @@
 /* Include ----------------------------------------------------------------- */
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <semaphore.h>
 
 #include "ei_microphone.h"
 #include "ei_sony_spresense_fs_commands.h"
@@ -32,11 +35,13 @@
 #include "ei_config_types.h"
 #include "sensor_aq_mbedtls_hs256.h"
 #include "sensor_aq_none.h"
-#include "arm_math.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
 
 /* Extern sony lib functions */
 extern bool spresense_startStopAudio(bool start);
 extern bool spresense_getAudio(char *audio_buffer, unsigned int* size);
+extern void spresense_pauseAudio(bool pause);
+extern void spresense_setAudioCallback(void (*callback)(const int16_t *samples, size_t n_samples));
 
 /* Audio sampling config */
 #define AUDIO_SAMPLING_FREQUENCY            16000
@@ -46,13 +51,29 @@ extern bool spresense_getAudio(char *audio_buffer, unsigned int* size);
 #define AUDIO_DSP_SAMPLE_BUFFER_SIZE        1600//(AUDIO_SAMPLES_PER_MS * AUDIO_DSP_SAMPLE_LENGTH_MS * AUDIO_DSP_SAMPLE_RESOLUTION)
 
 
-/** Status and control struct for inferencing struct */
+/**
+ * Lock-free single producer, single consumer ring of audio slices.
+ * head is only written by the producer (audio capture thread), tail only by
+ * the consumer (inference), so neither side needs a lock. The slice handed to
+ * the classifier stays owned by the consumer until the next record call.
+ * One slot is always being written, so n_slots - 1 slices can be queued.
+ * The consumer blocks on slice_ready, which the producer posts for every
+ * published slice. A reset is requested by the consumer and carried out by
+ * the producer, which owns the slice being written.
+ */
 typedef struct {
-    int16_t *buffers[2];
-    uint8_t buf_select;
-    uint8_t buf_ready;
-    uint32_t buf_count;
+    int16_t *slots;
+    uint32_t n_slots;
     uint32_t n_samples;
+    volatile uint32_t head;         /**< Slices completed by the producer */
+    volatile uint32_t tail;         /**< Slices released by the consumer */
+    uint32_t fill;                  /**< Samples written to the slice at head */
+    int16_t *read_slot;             /**< Slice currently used by the classifier */
+    volatile uint32_t dropped;      /**< Slices lost because the ring was full */
+    volatile bool reset;            /**< Producer restarts the slice at head when set */
+    volatile uint32_t reset_head;   /**< head when the producer did the reset */
+    bool resync;                    /**< Consumer skips to reset_head once the reset is done */
+    sem_t slice_ready;
 } inference_t;
 
 extern ei_config_t *ei_config_get_config();
@@ -113,22 +134,51 @@ static void audio_buffer_callback(void *buffer, uint32_t n_bytes)
 }
 
 /**
- * @brief      Inference audio callback, store samples in ram buffer
- *             Signal when buffer is full, and swap buffers
- * @param      buffer   Pointer to source buffer
- * @param[in]  n_bytes  Number of bytes to write
+ * @brief      Inference audio callback, runs in the audio capture thread
+ *             Store samples in the slice at head, publish it when full
+ * @param      samples    Captured samples
+ * @param[in]  n_samples  Number of samples
  */
-static void audio_buffer_inference_callback(void *buffer, uint32_t n_bytes)
+static void audio_buffer_inference_callback(const int16_t *samples, size_t n_samples)
 {
-    int16_t *samples = (int16_t *)buffer;
+    if (inference.reset) {
+        // the partial slice holds audio from before the reset
+        inference.fill = 0;
+        inference.reset_head = inference.head;
+        __sync_synchronize();
+        inference.reset = false;
+        sem_post(&inference.slice_ready);
+    }
+
+    while (n_samples > 0) {
+        uint32_t head = inference.head;
+        int16_t *slot = &inference.slots[(head & (inference.n_slots - 1)) * inference.n_samples];
 
-    for(uint32_t i = 0; i < (n_bytes >> 1); i++) {
-        inference.buffers[inference.buf_select][inference.buf_count++] = samples[i];
+        uint32_t copy = inference.n_samples - inference.fill;
+        if (copy > n_samples) {
+            copy = n_samples;
+        }
+
+        memcpy(&slot[inference.fill], samples, copy * sizeof(int16_t));
+        inference.fill += copy;
+        samples += copy;
+        n_samples -= copy;
+
+        if (inference.fill < inference.n_samples) {
+            break;
+        }
+        inference.fill = 0;
 
-        if(inference.buf_count >= inference.n_samples) {
-            inference.buf_select ^= 1;
-            inference.buf_count = 0;
-            inference.buf_ready = 1;
+        if ((head + 1 - inference.tail) >= inference.n_slots) {
+            // ring full, publishing would hand out the slot at tail for
+            // writing, so this slice is dropped and its slot reused
+            inference.dropped++;
+        }
+        else {
+            // make sure the samples are stored before the slice is published
+            __sync_synchronize();
+            inference.head = head + 1;
+            sem_post(&inference.slice_ready);
         }
     }
 }
@@ -154,7 +204,7 @@ static void get_dsp_data(void (*callback)(void *buffer, uint32_t n_bytes))
 
     // callback((void *)&audio_buffer[0], length * sizeof(short));
 
-    size_t length;
+    unsigned int length;
     if(spresense_getAudio((char *)&audio_buffer[0], &length)) {
         callback((void *)&audio_buffer[0], length);
     }
@@ -315,62 +365,138 @@ bool ei_microphone_record(uint32_t sample_length_ms, uint32_t start_delay_ms, bo
     return true;
 }
 
-bool ei_microphone_inference_start(uint32_t n_samples)
+/**
+ * @brief      Allocate the slice ring and start audio capture
+ *
+ * @param[in]  n_samples  Samples per slice
+ * @param[in]  n_slots    Number of slices in the ring, power of 2 (>= 2)
+ *
+ * @return     false if n_slots is invalid or allocation failed
+ */
+bool ei_microphone_inference_start(uint32_t n_samples, uint32_t n_slots)
 {
-
-    inference.buffers[0] = (int16_t *)ei_malloc(n_samples * sizeof(int16_t));
-
-    if (inference.buffers[0] == NULL) {
+    if (n_slots < 2 || (n_slots & (n_slots - 1)) != 0) {
         return false;
     }
 
-    inference.buffers[1] = (int16_t *)ei_malloc(n_samples * sizeof(int16_t));
+    inference.slots = (int16_t *)ei_malloc(n_slots * n_samples * sizeof(int16_t));
 
-    if (inference.buffers[1] == NULL) {
-        ei_free(inference.buffers[0]);
+    if (inference.slots == NULL) {
         return false;
     }
 
-    inference.buf_select = 0;
-    inference.buf_count = 0;
+    inference.n_slots = n_slots;
     inference.n_samples = n_samples;
-    inference.buf_ready = 0;
-
-    spresense_startStopAudio(true);
+    inference.head = 0;
+    inference.tail = 0;
+    inference.fill = 0;
+    inference.read_slot = NULL;
+    inference.dropped = 0;
+    inference.reset = false;
+    inference.resync = false;
+    sem_init(&inference.slice_ready, 0, 0);
+
+    spresense_setAudioCallback(&audio_buffer_inference_callback);
+    if (!spresense_startStopAudio(true)) {
+        spresense_setAudioCallback(NULL);
+        sem_destroy(&inference.slice_ready);
+        ei_free(inference.slots);
+        inference.slots = NULL;
+        return false;
+    }
 
     return true;
 }
 
+/**
+ * @brief      Block until the capture thread posts the semaphore. The
+ *             simulator, which delivers audio from its virtual clock instead
+ *             of a thread, overrides this to run the clock.
+ *
+ * @param      ready  Semaphore posted by audio_buffer_inference_callback()
+ */
+__attribute__((weak)) void ei_microphone_wait_capture(sem_t *ready)
+{
+    while (sem_wait(ready) != 0 && errno == EINTR) {};
+}
+
+/**
+ * @brief      Release the previous slice and wait until the capture thread
+ *             has published the next one
+ *
+ * @return     true when a new slice is available
+ */
 bool ei_microphone_inference_record(void)
 {
-    inference.buf_ready = 0;
-    inference.buf_count = 0;
+    if (inference.read_slot != NULL) {
+        // done reading the slice before the producer may reuse it
+        __sync_synchronize();
+        inference.read_slot = NULL;
+        inference.tail = inference.tail + 1;
+    }
 
-    while (inference.buf_ready == 0) {
-        get_dsp_data(&audio_buffer_inference_callback);
-    };
+    if (inference.resync) {
+        while (inference.reset) {
+            ei_microphone_wait_capture(&inference.slice_ready);
+        }
+        __sync_synchronize();
+        inference.tail = inference.reset_head;
+        inference.resync = false;
+    }
+
+    // posts from slices that were dropped or skipped only cost an extra check
+    while (inference.head == inference.tail) {
+        ei_microphone_wait_capture(&inference.slice_ready);
+    }
+    __sync_synchronize();
     record_ready = false;
-    inference.buf_ready = 0;
+
+    inference.read_slot = &inference.slots[(inference.tail & (inference.n_slots - 1)) * inference.n_samples];
 
     return true;
 }
 
 /**
  * @brief      Reset buffer counters for non-continuous inferecing
+ *             Drops all queued slices, the capture thread restarts the slice
+ *             it is writing so the next slice starts with fresh audio. The
+ *             I2S device keeps running.
  */
 void ei_microphone_inference_reset_buffers(void)
 {
-    inference.buf_ready = 0;
-    inference.buf_count = 0;
+    // fill belongs to the capture thread, the next record call waits for it
+    inference.read_slot = NULL;
+    inference.resync = true;
+    __sync_synchronize();
+    inference.reset = true;
     record_ready = true;
 }
 
+/**
+ * @brief      Number of slices dropped since ei_microphone_inference_start()
+ *             because inference did not keep up with the audio
+ */
+uint32_t ei_microphone_inference_get_dropped_slices(void)
+{
+    return inference.dropped;
+}
+
+/**
+ * @brief      Number of completed slices waiting to be classified
+ */
+uint32_t ei_microphone_inference_get_pending_slices(void)
+{
+    uint32_t pending = inference.head - inference.tail;
+
+    return (inference.read_slot != NULL && pending > 0) ? pending - 1 : pending;
+}
+
 /**
  * Get raw audio signal data
  */
 int ei_microphone_audio_signal_get_data(size_t offset, size_t length, float *out_ptr)
 {
-    arm_q15_to_float(&inference.buffers[inference.buf_select ^ 1][offset], out_ptr, length);
+    ei::numpy::int16_to_float(&inference.read_slot[offset], out_ptr, length);
 
     return 0;
 }
@@ -379,9 +505,12 @@ bool ei_microphone_inference_end(void)
 {
     record_ready = false;
     spresense_startStopAudio(false);
+    spresense_setAudioCallback(NULL);
+    sem_destroy(&inference.slice_ready);
 
-    ei_free(inference.buffers[0]);
-    ei_free(inference.buffers[1]);
+    ei_free(inference.slots);
+    inference.slots = NULL;
+    inference.read_slot = NULL;
     return true;
 }
 
@@ -28,13 +28,20 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+/** Default number of slices in the inference ring, must be a power of 2 */
+#ifndef EI_MICROPHONE_INFERENCE_SLOTS
+#define EI_MICROPHONE_INFERENCE_SLOTS   4
+#endif
+
 /* Function prototypes ----------------------------------------------------- */
 void ei_microphone_init(void);
-bool ei_microphone_inference_start(uint32_t n_samples);
+bool ei_microphone_inference_start(uint32_t n_samples, uint32_t n_slots = EI_MICROPHONE_INFERENCE_SLOTS);
 
 bool ei_microphone_sample_start(void);
 bool ei_microphone_inference_record(void);
 void ei_microphone_inference_reset_buffers(void);
+uint32_t ei_microphone_inference_get_dropped_slices(void);
+uint32_t ei_microphone_inference_get_pending_slices(void);
 int ei_microphone_audio_signal_get_data(size_t offset, size_t length, float *out_ptr);
 bool ei_microphone_inference_end(void);
 
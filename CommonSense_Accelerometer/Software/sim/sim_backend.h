@@ -0,0 +1,61 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_BACKEND_H
+#define SIM_BACKEND_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include "sim_signal.h"
+
+/** Sensor sources, units are the ones the hooks report */
+typedef enum {
+    SIM_SOURCE_ACC = 0,         // g
+    SIM_SOURCE_GYRO,            // dps
+    SIM_SOURCE_MAG,             // mgauss
+    SIM_SOURCE_PRESSURE,        // hPa, degC
+    SIM_SOURCE_HUMIDITY,        // %RH, degC
+    SIM_SOURCE_GAS,             // SRAW_VOC, SRAW_NOX ticks
+    SIM_SOURCE_AUDIO,           // 16 bit PCM
+    SIM_N_SOURCES
+} sim_source_id_t;
+
+typedef struct {
+    /** Follow the wall clock instead of running as fast as possible */
+    bool realtime;
+    /** Time one sensor read takes */
+    uint32_t read_us;
+    /** Sample times and sleeps are off by up to this much (uniform) */
+    uint32_t jitter_us;
+    /** Audio sample rate */
+    uint32_t audio_hz;
+} sim_timing_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void sim_clock_init(const sim_timing_t *timing);
+uint64_t sim_now_us(void);
+void sim_advance_us(uint32_t us);
+uint64_t sim_sample_time_us(void);
+sim_signal_t *sim_source(sim_source_id_t source);
+bool sim_read_source(sim_source_id_t source, float *out);
+
+#endif
@@ -0,0 +1,493 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Simulated I2C bus for host builds, replaces libraries/I2c and the Sensirion
+ * HAL. The STM drivers and the SGP41 driver run unmodified against register
+ * models of the sensors, output registers are filled from the simulation
+ * sources at the sensor ODR. Every transfer takes the bus time it would take
+ * at the configured frequency.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include <math.h>
+
+#include "sim_backend.h"
+#include "../libraries/I2c/I2c.h"
+#include "../libraries/Hts221/Hts221.h"
+#include "../libraries/Lis2mdl/Lis2mdl.h"
+#include "../libraries/Lps22hh/Lps22hh.h"
+#include "../libraries/Lsm6dso32/Lsm6dso32.h"
+#include "../libraries/Sgp4x/sensirion_i2c.h"
+#include "../libraries/Sgp4x/sensirion_i2c_hal.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define SGP41_ADDR              0x59
+#define SGP41_CMD_CONDITIONING  0x2612
+#define SGP41_CMD_MEASURE_RAW   0x2619
+#define SGP41_CMD_SELF_TEST     0x280E
+#define SGP41_CMD_HEATER_OFF    0x3615
+#define SGP41_CMD_SERIAL        0x3682
+#define SGP41_MAX_WORDS         3
+
+/* start, address byte and stop */
+#define BUS_OVERHEAD_BITS       20
+
+typedef struct sim_device_s {
+    uint8_t addr;
+    sim_source_id_t source;
+    uint8_t regs[256];
+    uint8_t status_reg;
+    uint8_t data_ready;         // status bits set when a sample is latched
+    uint8_t out_first;          // reading any output register clears data_ready
+    uint8_t out_last;
+    uint8_t increment_bit;      // 0 if the address always increments
+    uint32_t odr_us;
+    uint64_t latched_us;
+    bool latched;
+    void (*latch)(struct sim_device_s *dev, const float *values);
+} sim_device_t;
+
+typedef struct {
+    uint16_t words[SGP41_MAX_WORDS];
+    uint8_t n_words;
+    uint64_t ready_us;
+} sgp41_answer_t;
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t bus_freq = TWI_FREQ_100KHZ;
+static uint32_t err_count = 0;
+static sgp41_answer_t sgp41_answer;
+
+/* Register models --------------------------------------------------------- */
+static void put_int16(uint8_t *regs, uint8_t reg, float value)
+{
+    int32_t raw = (int32_t)lrintf(value);
+    raw = raw > INT16_MAX ? INT16_MAX : (raw < INT16_MIN ? INT16_MIN : raw);
+    regs[reg] = (uint8_t)raw;
+    regs[reg + 1] = (uint8_t)((uint16_t)raw >> 8);
+}
+
+static void latch_lsm6dso32(sim_device_t *dev, const float *dps)
+{
+    for (int i = 0; i < 3; i++) {
+        put_int16(dev->regs, LSM6DSO32_OUTX_L_G + 2 * i, dps[i] * 1000.0f / 70.0f);
+    }
+}
+
+static void latch_lis2mdl(sim_device_t *dev, const float *mgauss)
+{
+    for (int i = 0; i < 3; i++) {
+        put_int16(dev->regs, LIS2MDL_OUTX_L_REG + 2 * i, mgauss[i] / 1.5f);
+    }
+}
+
+static void latch_lps22hh(sim_device_t *dev, const float *values)
+{
+    uint32_t raw = (uint32_t)lrintf(values[0] * 4096.0f) & 0xFFFFFF;
+    dev->regs[LPS22HH_PRESS_OUT_XL] = (uint8_t)raw;
+    dev->regs[LPS22HH_PRESS_OUT_XL + 1] = (uint8_t)(raw >> 8);
+    dev->regs[LPS22HH_PRESS_OUT_XL + 2] = (uint8_t)(raw >> 16);
+    put_int16(dev->regs, LPS22HH_TEMP_OUT_L, values[1] * 100.0f);
+}
+
+/* calibration points written into the HTS221 model by sim_i2c_reset() */
+#define HTS221_SIM_H0_RH    20.0f
+#define HTS221_SIM_H1_RH    80.0f
+#define HTS221_SIM_H0_OUT   -4000
+#define HTS221_SIM_H1_OUT   8000
+#define HTS221_SIM_T0_DEGC  10.0f
+#define HTS221_SIM_T1_DEGC  40.0f
+#define HTS221_SIM_T0_OUT   -200
+#define HTS221_SIM_T1_OUT   1000
+
+static void latch_hts221(sim_device_t *dev, const float *values)
+{
+    float hum = HTS221_SIM_H0_OUT + (values[0] - HTS221_SIM_H0_RH)
+        * (HTS221_SIM_H1_OUT - HTS221_SIM_H0_OUT) / (HTS221_SIM_H1_RH - HTS221_SIM_H0_RH);
+    float temp = HTS221_SIM_T0_OUT + (values[1] - HTS221_SIM_T0_DEGC)
+        * (HTS221_SIM_T1_OUT - HTS221_SIM_T0_OUT) / (HTS221_SIM_T1_DEGC - HTS221_SIM_T0_DEGC);
+    put_int16(dev->regs, HTS221_HUMIDITY_OUT_L, hum);
+    put_int16(dev->regs, HTS221_TEMP_OUT_L, temp);
+}
+
+static sim_device_t devices[] = {
+    { LSM6DSO32_I2C_ADD, SIM_SOURCE_GYRO, {0}, LSM6DSO32_STATUS_REG, 0x02,
+        LSM6DSO32_OUTX_L_G, LSM6DSO32_OUTZ_H_G, 0, 2398, 0, false, &latch_lsm6dso32 },
+    { LIS2MDL_I2C_ADD, SIM_SOURCE_MAG, {0}, LIS2MDL_STATUS_REG, 0x08,
+        LIS2MDL_OUTX_L_REG, LIS2MDL_OUTZ_H_REG, 0, 10000, 0, false, &latch_lis2mdl },
+    { LPS22HH_I2C_ADD, SIM_SOURCE_PRESSURE, {0}, LPS22HH_STATUS, 0x03,
+        LPS22HH_PRESS_OUT_XL, LPS22HH_TEMP_OUT_H, 0, 20000, 0, false, &latch_lps22hh },
+    { HTS221_I2C_ADDRESS, SIM_SOURCE_HUMIDITY, {0}, HTS221_STATUS_REG, 0x03,
+        HTS221_HUMIDITY_OUT_L, HTS221_TEMP_OUT_H, HTS221_AUTO_INCREMENT, 80000, 0, false, &latch_hts221 },
+};
+
+#define N_DEVICES   (sizeof(devices) / sizeof(devices[0]))
+
+static sim_device_t *find_device(uint8_t addr)
+{
+    for (size_t ix = 0; ix < N_DEVICES; ix++) {
+        if (devices[ix].addr == addr) {
+            return &devices[ix];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief      Latch a new sample once an ODR period has passed
+ */
+static void refresh_device(sim_device_t *dev)
+{
+    uint64_t now = sim_now_us();
+    if (dev->latched && now - dev->latched_us < dev->odr_us) {
+        return;
+    }
+
+    float values[SIM_SIGNAL_MAX_CHANNELS] = { 0 };
+    sim_read_source(dev->source, values);
+    dev->latch(dev, values);
+    dev->regs[dev->status_reg] |= dev->data_ready;
+
+    // keep the ODR grid, a late read does not shift the following samples
+    dev->latched_us = dev->latched ? dev->latched_us + ((now - dev->latched_us) / dev->odr_us) * dev->odr_us : now;
+    dev->latched = true;
+}
+
+static uint8_t device_read(sim_device_t *dev, uint8_t reg, uint8_t *data, uint16_t size)
+{
+    bool increment = true;
+    bool output_read = false;
+
+    if (dev->increment_bit) {
+        increment = (reg & dev->increment_bit) != 0;
+        reg &= ~dev->increment_bit;
+    }
+
+    refresh_device(dev);
+
+    for (uint16_t ix = 0; ix < size; ix++) {
+        data[ix] = dev->regs[reg];
+        if (reg >= dev->out_first && reg <= dev->out_last) {
+            output_read = true;
+        }
+        if (increment) {
+            reg++;
+        }
+    }
+
+    if (output_read) {
+        dev->regs[dev->status_reg] &= ~dev->data_ready;
+    }
+
+    return TWI_SUCCESS;
+}
+
+static uint8_t device_write(sim_device_t *dev, uint8_t reg, const uint8_t *data, uint16_t size)
+{
+    bool increment = true;
+
+    if (dev->increment_bit) {
+        increment = (reg & dev->increment_bit) != 0;
+        reg &= ~dev->increment_bit;
+    }
+
+    for (uint16_t ix = 0; ix < size; ix++) {
+        dev->regs[reg] = data[ix];
+        if (increment) {
+            reg++;
+        }
+    }
+
+    return TWI_SUCCESS;
+}
+
+/* SGP41 command model ----------------------------------------------------- */
+static void sgp41_answer_set(uint64_t delay_us, const uint16_t *words, uint8_t n_words)
+{
+    memcpy(sgp41_answer.words, words, n_words * sizeof(uint16_t));
+    sgp41_answer.n_words = n_words;
+    sgp41_answer.ready_us = sim_now_us() + delay_us;
+}
+
+static uint8_t sgp41_write(const uint8_t *data, uint16_t size)
+{
+    if (size < 2) {
+        return TWI_NACK_ON_DATA;
+    }
+
+    uint16_t command = (uint16_t)data[0] << 8 | data[1];
+    float gas[SIM_SIGNAL_MAX_CHANNELS] = { 0 };
+    uint16_t words[SGP41_MAX_WORDS];
+
+    sgp41_answer.n_words = 0;
+
+    switch (command) {
+        case SGP41_CMD_SERIAL:
+            words[0] = 0x0000;
+            words[1] = 0x05E1;
+            words[2] = 0x5A41;
+            sgp41_answer_set(1000, words, 3);
+            break;
+        case SGP41_CMD_SELF_TEST:
+            words[0] = 0xD400;
+            sgp41_answer_set(320000, words, 1);
+            break;
+        case SGP41_CMD_CONDITIONING:
+        case SGP41_CMD_MEASURE_RAW:
+            if (size < 8) {
+                return TWI_NACK_ON_DATA;
+            }
+            sim_read_source(SIM_SOURCE_GAS, gas);
+            words[0] = (uint16_t)(gas[0] < 0.0f ? 0.0f : (gas[0] > 65535.0f ? 65535.0f : gas[0]));
+            words[1] = (uint16_t)(gas[1] < 0.0f ? 0.0f : (gas[1] > 65535.0f ? 65535.0f : gas[1]));
+            sgp41_answer_set(50000, words, command == SGP41_CMD_MEASURE_RAW ? 2 : 1);
+            break;
+        case SGP41_CMD_HEATER_OFF:
+            break;
+        default:
+            return TWI_NACK_ON_DATA;
+    }
+
+    return TWI_SUCCESS;
+}
+
+static uint8_t sgp41_read(uint8_t *data, uint16_t size)
+{
+    // the sensor does not acknowledge while measuring
+    if (sgp41_answer.n_words == 0 || sim_now_us() < sgp41_answer.ready_us) {
+        return TWI_NACK_ON_ADDRESS;
+    }
+
+    uint16_t ix = 0;
+    for (uint8_t w = 0; w < sgp41_answer.n_words && ix + 3 <= size; w++) {
+        data[ix] = (uint8_t)(sgp41_answer.words[w] >> 8);
+        data[ix + 1] = (uint8_t)sgp41_answer.words[w];
+        data[ix + 2] = sensirion_i2c_generate_crc(&data[ix], 2);
+        ix += 3;
+    }
+    memset(&data[ix], 0xFF, size - ix);
+
+    return TWI_SUCCESS;
+}
+
+/* Bus --------------------------------------------------------------------- */
+static void bus_time(uint16_t bytes)
+{
+    sim_advance_us((uint32_t)(((uint64_t)BUS_OVERHEAD_BITS + bytes * 9) * 1000000 / bus_freq));
+}
+
+static uint8_t bus_transfer(uint8_t addr, const uint8_t *reg, uint8_t reg_len, uint8_t *data, uint16_t size, bool read)
+{
+    uint8_t ret = TWI_NACK_ON_ADDRESS;
+    sim_device_t *dev = find_device(addr);
+
+    bus_time(reg_len + size);
+
+    if (addr == SGP41_ADDR) {
+        ret = read ? sgp41_read(data, size) : sgp41_write(data, size);
+    }
+    else if (dev && reg_len == 1) {
+        ret = read ? device_read(dev, reg[0], data, size) : device_write(dev, reg[0], data, size);
+    }
+    else if (dev && reg_len == 0 && !read && size > 0) {
+        ret = device_write(dev, data[0], &data[1], size - 1);
+    }
+
+    if (ret != TWI_SUCCESS) {
+        err_count++;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief      Power-on state of the register models
+ */
+static void sim_i2c_reset(void)
+{
+    for (size_t ix = 0; ix < N_DEVICES; ix++) {
+        memset(devices[ix].regs, 0, sizeof(devices[ix].regs));
+        devices[ix].latched = false;
+    }
+
+    find_device(LSM6DSO32_I2C_ADD)->regs[LSM6DSO32_WHO_AM_I] = LSM6DSO32_ID;
+    find_device(LSM6DSO32_I2C_ADD)->regs[LSM6DSO32_CTRL3_C] = 0x04;
+    find_device(LIS2MDL_I2C_ADD)->regs[LIS2MDL_WHO_AM_I] = LIS2MDL_ID;
+    find_device(LPS22HH_I2C_ADD)->regs[LPS22HH_WHO_AM_I] = LPS22HH_ID;
+
+    uint8_t *hts = find_device(HTS221_I2C_ADDRESS)->regs;
+    hts[HTS221_WHO_AM_I] = HTS221_ID;
+    hts[HTS221_H0_RH_X2] = (uint8_t)(HTS221_SIM_H0_RH * 2);
+    hts[HTS221_H1_RH_X2] = (uint8_t)(HTS221_SIM_H1_RH * 2);
+    hts[HTS221_T0_DEGC_X8] = (uint8_t)(HTS221_SIM_T0_DEGC * 8);
+    hts[HTS221_T1_DEGC_X8] = (uint8_t)(HTS221_SIM_T1_DEGC * 8);
+    hts[HTS221_T1_T0_MSB] = (uint8_t)(((int)(HTS221_SIM_T1_DEGC * 8) >> 8) << 2 | ((int)(HTS221_SIM_T0_DEGC * 8) >> 8));
+    put_int16(hts, HTS221_H0_T0_OUT_L, HTS221_SIM_H0_OUT);
+    put_int16(hts, HTS221_H1_T0_OUT_L, HTS221_SIM_H1_OUT);
+    put_int16(hts, HTS221_T0_OUT_L, HTS221_SIM_T0_OUT);
+    put_int16(hts, HTS221_T1_OUT_L, HTS221_SIM_T1_OUT);
+
+    sgp41_answer.n_words = 0;
+}
+
+/* I2c.h ------------------------------------------------------------------- */
+void i2c_init(void) {
+    static bool reset_done = false;
+
+    if (!reset_done) {
+        sim_i2c_reset();
+        reset_done = true;
+    }
+}
+
+void i2c_set_freq(uint32_t freq) {
+    bus_freq = freq;
+}
+
+uint32_t i2c_get_error_count(void) {
+    return err_count;
+}
+
+int i2c_get_last_errno(void) {
+    return 0;
+}
+
+uint8_t i2c_write_reg(uint8_t i2c_addr, uint8_t reg_addr, uint8_t data) {
+    return bus_transfer(i2c_addr, &reg_addr, 1, &data, 1, false);
+}
+
+uint8_t i2c_read_reg(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data) {
+    return bus_transfer(i2c_addr, &reg_addr, 1, data, 1, true);
+}
+
+uint8_t i2c_write_regs(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
+    return bus_transfer(i2c_addr, &reg_addr, 1, data, size, false);
+}
+
+uint8_t i2c_read_regs(uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
+    return bus_transfer(i2c_addr, &reg_addr, 1, data, size, true);
+}
+
+uint8_t i2c_read_data(uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return bus_transfer(i2c_addr, NULL, 0, data, size, true);
+}
+
+uint8_t i2c_write_data(uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return bus_transfer(i2c_addr, NULL, 0, data, size, false);
+}
+
+uint8_t i2c_write_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
+    uint8_t reg[2] = { (uint8_t) (reg_addr >> 8), (uint8_t) reg_addr };
+    return bus_transfer(i2c_addr, reg, 2, data, size, false);
+}
+
+uint8_t i2c_read_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
+    uint8_t reg[2] = { (uint8_t) (reg_addr >> 8), (uint8_t) reg_addr };
+    return bus_transfer(i2c_addr, reg, 2, data, size, true);
+}
+
+void i2c_queue_init(i2c_queue_t *queue) {
+    queue->count = 0;
+}
+
+static i2c_xfer_t* queue_add(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size, bool read) {
+    if (queue->count >= TWI_QUEUE_MAX_XFERS) {
+        return nullptr;
+    }
+
+    i2c_xfer_t *xfer = &queue->xfers[queue->count++];
+    xfer->i2c_addr = i2c_addr;
+    xfer->reg_len = 0;
+    xfer->data = data;
+    xfer->size = size;
+    xfer->read = read;
+    xfer->status = TWI_OTHER_ERROR;
+
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_regs(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size) {
+    i2c_xfer_t *xfer = queue_add(queue, i2c_addr, data, size, true);
+    if (xfer) {
+        xfer->reg[0] = reg_addr;
+        xfer->reg_len = 1;
+    }
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_regs_16addr(i2c_queue_t *queue, uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size) {
+    i2c_xfer_t *xfer = queue_add(queue, i2c_addr, data, size, true);
+    if (xfer) {
+        xfer->reg[0] = (uint8_t) (reg_addr >> 8);
+        xfer->reg[1] = (uint8_t) reg_addr;
+        xfer->reg_len = 2;
+    }
+    return xfer;
+}
+
+i2c_xfer_t* i2c_queue_read_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return queue_add(queue, i2c_addr, data, size, true);
+}
+
+i2c_xfer_t* i2c_queue_write_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size) {
+    return queue_add(queue, i2c_addr, data, size, false);
+}
+
+uint8_t i2c_queue_submit(i2c_queue_t *queue) {
+    uint8_t ret = TWI_SUCCESS;
+
+    for (uint8_t ix = 0; ix < queue->count; ix++) {
+        i2c_xfer_t *xfer = &queue->xfers[ix];
+        xfer->status = bus_transfer(xfer->i2c_addr, xfer->reg, xfer->reg_len, xfer->data, xfer->size, xfer->read);
+        if (xfer->status != TWI_SUCCESS) {
+            ret = xfer->status;
+        }
+    }
+
+    return ret;
+}
+
+/* sensirion_i2c_hal.h ----------------------------------------------------- */
+int16_t sensirion_i2c_hal_select_bus(uint8_t bus_idx) {
+    return 0;
+}
+
+void sensirion_i2c_hal_init(void) {
+    i2c_init();
+}
+
+void sensirion_i2c_hal_free(void) {
+}
+
+int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
+    return (int8_t) i2c_read_data(address, data, count);
+}
+
+int8_t sensirion_i2c_hal_write(uint8_t address, uint8_t* data, uint16_t count) {
+    return (int8_t) i2c_write_data(address, data, count);
+}
+
+void sensirion_i2c_hal_sleep_usec(uint32_t useconds) {
+    sim_advance_us(useconds);
+}
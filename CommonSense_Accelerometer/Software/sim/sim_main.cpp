@@ -0,0 +1,489 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Host simulation backend, takes the place of main.cpp and the Spresense
+ * libraries. The hooks the application calls are served from simulation
+ * sources (recordings or generators) on a virtual clock, so the sampler, DSP
+ * and classifier run unmodified and faster than real time. Build with
+ * 'make sim', see usage() for the options.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <semaphore.h>
+
+#include "sim_backend.h"
+#include "SensorHub.h"
+#include "../libraries/I2c/I2c.h"
+#include "firmware-sdk/ei_camera_interface.h"
+
+/* Constant defines -------------------------------------------------------- */
+/** Virtual time one poll of the clock costs, so busy-waits make progress */
+#define SIM_CLOCK_POLL_US       1
+/** Same chunk size as the PDM driver delivers */
+#define SIM_AUDIO_CHUNK         800
+
+/* Extern reference -------------------------------------------------------- */
+extern int ei_main();
+
+/* Private variables ------------------------------------------------------- */
+static sim_timing_t sim_timing = { false, 50, 0, 16000 };
+static sim_signal_t sources[SIM_N_SOURCES];
+static uint64_t clock_us;
+static uint64_t wall_start_us;
+static uint32_t jitter_state = 0x9E3779B9;
+
+static bool audio_running = false;
+static uint64_t audio_pos_us;
+static void (*audio_callback)(const int16_t *samples, size_t n_samples) = NULL;
+static bool audio_delivering = false;
+
+static const char *script = "AT+RUNIMPULSE";
+static size_t script_pos = 0;
+static bool script_done = false;
+static uint64_t stop_at_us = 10000000;
+static bool stop_sent = false;
+static bool source_ended = false;
+
+static uint64_t wall_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t next_jitter(uint32_t range)
+{
+    if (range == 0) {
+        return 0;
+    }
+    jitter_state ^= jitter_state << 13;
+    jitter_state ^= jitter_state >> 17;
+    jitter_state ^= jitter_state << 5;
+    return jitter_state % (range + 1);
+}
+
+static void deliver_audio(void);
+
+/* Virtual clock ----------------------------------------------------------- */
+
+/**
+ * @brief      Start the clock at 0
+ */
+void sim_clock_init(const sim_timing_t *timing)
+{
+    sim_timing = *timing;
+    clock_us = 0;
+    wall_start_us = wall_us();
+}
+
+uint64_t sim_now_us(void)
+{
+    if (sim_timing.realtime) {
+        return wall_us() - wall_start_us;
+    }
+    return clock_us;
+}
+
+/**
+ * @brief      Let time pass, sleeps in real time mode
+ */
+void sim_advance_us(uint32_t us)
+{
+    if (sim_timing.realtime) {
+        usleep(us);
+    }
+    else {
+        clock_us += us;
+    }
+    deliver_audio();
+}
+
+/**
+ * @brief      Time at which a sensor read samples its signal, off by the jitter
+ */
+uint64_t sim_sample_time_us(void)
+{
+    uint64_t now = sim_now_us();
+    uint32_t jitter = next_jitter(2 * sim_timing.jitter_us);
+
+    if (jitter < sim_timing.jitter_us && now < sim_timing.jitter_us - jitter) {
+        return 0;
+    }
+    return now + jitter - sim_timing.jitter_us;
+}
+
+sim_signal_t *sim_source(sim_source_id_t source)
+{
+    return &sources[source];
+}
+
+/**
+ * @brief      Sample a source now
+ *
+ * @return     false (and stop the run) when a recording has ended
+ */
+bool sim_read_source(sim_source_id_t source, float *out)
+{
+    if (!sim_signal_value(&sources[source], sim_sample_time_us(), out)) {
+        source_ended = true;
+        return false;
+    }
+    return true;
+}
+
+/* Spresense hooks --------------------------------------------------------- */
+extern "C" void spresense_time_cb(uint32_t *sec, uint32_t *nano)
+{
+    if (!sim_timing.realtime) {
+        clock_us += SIM_CLOCK_POLL_US;
+    }
+
+    deliver_audio();
+
+    uint64_t now = sim_now_us();
+    *sec = (uint32_t)(now / 1000000);
+    *nano = (uint32_t)(now % 1000000) * 1000;
+}
+
+/**
+ * @brief      Feeds the command script, sends 'b' once the run time has passed
+ *             and ends the simulation when the application is back at the prompt
+ */
+char spresense_getchar(void)
+{
+    if (!script_done) {
+        char c = script[script_pos++];
+        if (c == '\0') {
+            script_done = true;
+            stop_at_us += sim_now_us();
+            return '\r';
+        }
+        return c;
+    }
+
+    if (stop_sent) {
+        uint64_t wall = wall_us() - wall_start_us;
+        uint64_t simulated = sim_now_us();
+        printf("\nSimulated %.3f s in %.3f s (%.1fx real time), %lu I2C errors\n",
+            simulated / 1e6, wall / 1e6, wall ? (double)simulated / wall : 0.0,
+            (unsigned long)i2c_get_error_count());
+        exit(source_ended ? 2 : 0);
+    }
+
+    if (source_ended || sim_now_us() >= stop_at_us) {
+        stop_sent = true;
+        return 'b';
+    }
+
+    return 0;
+}
+
+void spresense_putchar(char byte)
+{
+    putchar(byte);
+}
+
+extern "C" void spresense_ledcontrol(uint32_t led, bool on_off)
+{
+}
+
+extern "C" void cxd56_setbaud(uintptr_t uartbase, uint32_t basefreq, uint32_t baud)
+{
+}
+
+void set_max_data_output_baudrate_c()
+{
+}
+
+void set_default_data_output_baudrate_c()
+{
+}
+
+int spresense_getAcc(float acc_val[3])
+{
+    sim_advance_us(sim_timing.read_us);
+    return sim_read_source(SIM_SOURCE_ACC, acc_val) ? 0 : -1;
+}
+
+uint32_t spresense_setupFusion(uint32_t sensors)
+{
+    return SensorHubInit(sensors);
+}
+
+uint32_t spresense_getFusion(uint32_t sensors, float values[][SENSOR_HUB_MAX_VALUES])
+{
+    return SensorHubRead(sensors, values);
+}
+
+void spresense_sleep_us(uint32_t us)
+{
+    sim_advance_us(us + next_jitter(sim_timing.jitter_us));
+}
+
+void spresense_set_low_clock(bool low)
+{
+}
+
+int spresense_setupAudio(void)
+{
+    return 0;
+}
+
+bool spresense_startStopAudio(bool start)
+{
+    audio_running = start;
+    audio_pos_us = sim_now_us();
+    return true;
+}
+
+void spresense_pauseAudio(bool pause)
+{
+    spresense_startStopAudio(!pause);
+}
+
+/**
+ * @brief      The PDM driver calls back from its capture thread, here the
+ *             clock delivers every full chunk as it passes
+ */
+void spresense_setAudioCallback(void (*callback)(const int16_t *samples, size_t n_samples))
+{
+    audio_callback = callback;
+}
+
+/**
+ * @brief      Next samples of the audio source from audio_pos_us on
+ */
+static void read_audio(int16_t *samples, uint64_t count)
+{
+    for (uint64_t ix = 0; ix < count; ix++) {
+        float value;
+        uint64_t t = audio_pos_us + ix * 1000000 / sim_timing.audio_hz;
+        if (!sim_signal_value(&sources[SIM_SOURCE_AUDIO], t, &value)) {
+            source_ended = true;
+            value = 0.0f;
+        }
+        samples[ix] = (int16_t)(value > 32767.0f ? 32767.0f : (value < -32768.0f ? -32768.0f : value));
+    }
+    audio_pos_us += count * 1000000 / sim_timing.audio_hz;
+}
+
+/**
+ * @brief      Replaces the blocking wait of ei_microphone, there is no capture
+ *             thread: run the clock until the callback posted the semaphore
+ */
+void ei_microphone_wait_capture(sem_t *ready)
+{
+    while (sem_trywait(ready) != 0) {
+        sim_advance_us((uint32_t)((uint64_t)SIM_AUDIO_CHUNK * 1000000 / sim_timing.audio_hz));
+    }
+}
+
+static void deliver_audio(void)
+{
+    if (!audio_callback || !audio_running || audio_delivering) {
+        return;
+    }
+
+    audio_delivering = true;
+    while (audio_callback && audio_running &&
+           (sim_now_us() - audio_pos_us) * sim_timing.audio_hz / 1000000 >= SIM_AUDIO_CHUNK) {
+        int16_t samples[SIM_AUDIO_CHUNK];
+        read_audio(samples, SIM_AUDIO_CHUNK);
+        audio_callback(samples, SIM_AUDIO_CHUNK);
+    }
+    audio_delivering = false;
+}
+
+/**
+ * @brief      Samples that have arrived since the last call, in virtual time
+ *             the clock runs ahead until a full chunk is available
+ */
+bool spresense_getAudio(char *audio_buffer, unsigned int* size)
+{
+    if (!audio_running) {
+        return false;
+    }
+
+    uint64_t now = sim_now_us();
+    uint64_t due = (now - audio_pos_us) * sim_timing.audio_hz / 1000000;
+    if (due < SIM_AUDIO_CHUNK && !sim_timing.realtime) {
+        sim_advance_us((uint32_t)((SIM_AUDIO_CHUNK - due) * 1000000 / sim_timing.audio_hz));
+        due = SIM_AUDIO_CHUNK;
+    }
+    if (due == 0) {
+        return false;
+    }
+    if (due > SIM_AUDIO_CHUNK) {
+        due = SIM_AUDIO_CHUNK;
+    }
+
+    read_audio((int16_t *)audio_buffer, due);
+    *size = (unsigned int)(due * sizeof(int16_t));
+
+    return true;
+}
+
+/* Files go to the working directory */
+static FILE *sim_file = NULL;
+
+extern "C" bool spresense_openFile(const char *name, bool write)
+{
+    if (sim_file) {
+        fclose(sim_file);
+    }
+    sim_file = fopen(name, write ? "wb" : "rb");
+    return sim_file != NULL;
+}
+
+extern "C" bool spresense_closeFile(const char *name)
+{
+    if (sim_file) {
+        fclose(sim_file);
+        sim_file = NULL;
+    }
+    return true;
+}
+
+extern "C" bool spresense_writeToFile(const char *name, const uint8_t *buf, uint32_t length)
+{
+    return sim_file && fwrite(buf, 1, length, sim_file) == length;
+}
+
+extern "C" uint32_t spresense_readFromFile(const char *name, uint8_t *buf, uint32_t length)
+{
+    return sim_file ? (uint32_t)fread(buf, 1, length, sim_file) : 0;
+}
+
+/** No camera in the simulation */
+class SimCamera : public EiCamera {
+public:
+    bool ei_camera_capture_rgb888_packed_big_endian(uint8_t *image, uint32_t image_size_B,
+        uint16_t hsize, uint16_t vsize) { return false; }
+    uint16_t get_min_width() { return 0; }
+    uint16_t get_min_height() { return 0; }
+    bool init() { return false; }
+};
+
+EiCamera *EiCamera::get_camera()
+{
+    static SimCamera camera;
+    return &camera;
+}
+
+/* Main -------------------------------------------------------------------- */
+static void usage(const char *name)
+{
+    printf("Usage: %s [options]\n"
+        "  --acc SPEC        accelerometer, g (default offset=0,0,1)\n"
+        "  --gyro SPEC       gyroscope, dps\n"
+        "  --mag SPEC        magnetometer, mgauss\n"
+        "  --pressure SPEC   pressure hPa, temperature degC\n"
+        "  --humidity SPEC   humidity %%RH, temperature degC\n"
+        "  --gas SPEC        SGP41 SRAW_VOC, SRAW_NOX ticks\n"
+        "  --audio SPEC      microphone, 16 bit PCM\n"
+        "  --cmd AT          command to run (default AT+RUNIMPULSE)\n"
+        "  --duration S      stop after S simulated seconds (default 10)\n"
+        "  --read-us US      time one accelerometer read takes (default 50)\n"
+        "  --jitter-us US    sample time and sleep jitter (default 0)\n"
+        "  --audio-hz HZ     microphone sample rate (default 16000)\n"
+        "  --realtime        follow the wall clock\n"
+        "SPEC: file.csv | file.cbor | offset=..;sine=HZ,AMPL[,CH];bearing=..;noise=..\n"
+        "      (see sim_signal_parse())\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    static const struct { const char *option; sim_source_id_t source; size_t channels; const char *init; } source_options[] = {
+        { "--acc", SIM_SOURCE_ACC, 3, "offset=0,0,1" },
+        { "--gyro", SIM_SOURCE_GYRO, 3, "offset=0" },
+        { "--mag", SIM_SOURCE_MAG, 3, "offset=200,-50,-400" },
+        { "--pressure", SIM_SOURCE_PRESSURE, 2, "offset=1013.25,25" },
+        { "--humidity", SIM_SOURCE_HUMIDITY, 2, "offset=45,25" },
+        { "--gas", SIM_SOURCE_GAS, 2, "offset=30000,15000" },
+        { "--audio", SIM_SOURCE_AUDIO, 1, "offset=0" },
+    };
+    sim_timing_t timing = sim_timing;
+
+    for (size_t ix = 0; ix < sizeof(source_options) / sizeof(source_options[0]); ix++) {
+        sim_signal_init(&sources[source_options[ix].source], source_options[ix].channels);
+        sim_signal_parse(&sources[source_options[ix].source], source_options[ix].init);
+    }
+
+    for (int arg = 1; arg < argc; arg++) {
+        const char *value = arg + 1 < argc ? argv[arg + 1] : NULL;
+        bool known = false;
+
+        for (size_t ix = 0; ix < sizeof(source_options) / sizeof(source_options[0]) && value; ix++) {
+            if (strcmp(argv[arg], source_options[ix].option) == 0) {
+                sim_signal_t *signal = &sources[source_options[ix].source];
+                sim_signal_free(signal);
+                sim_signal_init(signal, source_options[ix].channels);
+                if (!sim_signal_parse(signal, value)) {
+                    fprintf(stderr, "Invalid source '%s'\n", value);
+                    return 1;
+                }
+                known = true;
+            }
+        }
+
+        if (known) {
+            arg++;
+        }
+        else if (strcmp(argv[arg], "--cmd") == 0 && value) {
+            script = argv[++arg];
+        }
+        else if (strcmp(argv[arg], "--duration") == 0 && value) {
+            stop_at_us = (uint64_t)(atof(argv[++arg]) * 1000000.0);
+        }
+        else if (strcmp(argv[arg], "--read-us") == 0 && value) {
+            timing.read_us = (uint32_t)atoi(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "--jitter-us") == 0 && value) {
+            timing.jitter_us = (uint32_t)atoi(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "--audio-hz") == 0 && value) {
+            timing.audio_hz = (uint32_t)atoi(argv[++arg]);
+        }
+        else if (strcmp(argv[arg], "--realtime") == 0) {
+            timing.realtime = true;
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (timing.audio_hz == 0) {
+        timing.audio_hz = 16000;
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    sim_clock_init(&timing);
+
+    return ei_main();
+}
@@ -0,0 +1,443 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sim_signal.h"
+#include "qcbor.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define SIM_PI              3.14159265358979f
+#define SIM_LINE_MAX        512
+#define SIM_SEED_DEFAULT    0x2545F491
+
+/* Private functions ------------------------------------------------------- */
+static uint32_t next_random(sim_signal_t *signal)
+{
+    // xorshift32, the seed is the running state
+    uint32_t x = signal->seed ? signal->seed : SIM_SEED_DEFAULT;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    signal->seed = x;
+    return x;
+}
+
+static float next_gaussian(sim_signal_t *signal)
+{
+    float u1 = ((float)(next_random(signal) >> 8) + 1.0f) / 16777217.0f;
+    float u2 = (float)(next_random(signal) >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * SIM_PI * u2);
+}
+
+static bool push_sample(sim_signal_t *signal, const float *row, size_t n_values)
+{
+    if ((signal->n_samples & (signal->n_samples - 1)) == 0) {
+        size_t capacity = signal->n_samples ? signal->n_samples * 2 : 64;
+        float *values = (float *)realloc(signal->values, capacity * signal->channels * sizeof(float));
+        if (!values) {
+            return false;
+        }
+        signal->values = values;
+    }
+
+    float *sample = &signal->values[signal->n_samples * signal->channels];
+    for (size_t ch = 0; ch < signal->channels; ch++) {
+        sample[ch] = ch < n_values ? row[ch] : 0.0f;
+    }
+    signal->n_samples++;
+
+    return true;
+}
+
+static size_t parse_floats(const char *str, float *out, size_t max_values)
+{
+    size_t n = 0;
+    char *end;
+
+    while (n < max_values) {
+        float value = strtof(str, &end);
+        if (end == str) {
+            break;
+        }
+        out[n++] = value;
+        str = end;
+        while (*str == ',' || *str == ' ' || *str == '\t') {
+            str++;
+        }
+    }
+
+    return n;
+}
+
+static float bearing_value(const sim_bearing_t *bearing, float t)
+{
+    float fault_hz = bearing->shaft_hz * bearing->fault_order;
+    if (fault_hz <= 0.0f) {
+        return 0.0f;
+    }
+
+    // ringing of the last two impacts, older ones have decayed
+    float period = 1.0f / fault_hz;
+    float since = fmodf(t, period);
+    float value = 0.0f;
+    for (int k = 0; k < 2; k++) {
+        float dt = since + k * period;
+        if (dt <= t) {
+            value += expf(-bearing->decay * dt) * sinf(2.0f * SIM_PI * bearing->resonance_hz * dt);
+        }
+    }
+
+    float gain = bearing->amplitude;
+    if (bearing->modulation > 0.0f) {
+        gain *= 1.0f + bearing->modulation * cosf(2.0f * SIM_PI * bearing->shaft_hz * t);
+    }
+
+    return gain * value;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief      Reset a signal to a constant zero
+ *
+ * @param      signal    The signal
+ * @param[in]  channels  Values per sample
+ */
+void sim_signal_init(sim_signal_t *signal, size_t channels)
+{
+    memset(signal, 0, sizeof(sim_signal_t));
+    signal->channels = channels > SIM_SIGNAL_MAX_CHANNELS ? SIM_SIGNAL_MAX_CHANNELS : channels;
+    signal->loop = true;
+    signal->seed = SIM_SEED_DEFAULT;
+}
+
+/**
+ * @brief      Release replay data
+ */
+void sim_signal_free(sim_signal_t *signal)
+{
+    free(signal->values);
+    signal->values = NULL;
+    signal->n_samples = 0;
+}
+
+/**
+ * @brief      Set up a signal from a spec, items are separated by ';'
+ *               file.csv | file.cbor         replay a recording
+ *               interval=MS                  replay sample interval (CSV without timestamps)
+ *               noloop                       stop at the end of the recording
+ *               offset=A[,B,C]               constant per channel
+ *               sine=HZ,AMPL[,CH[,DEG]]      tone, all channels if CH is omitted
+ *               bearing=SHAFT_HZ,ORDER,RES_HZ,DECAY,AMPL[,MOD[,CH]]
+ *               noise=STDDEV                 gaussian noise
+ *               seed=N                       noise seed
+ *             e.g. "offset=0,0,1;sine=25,0.2;bearing=25,3.57,2800,900,0.5;noise=0.01"
+ *
+ * @return     false on a syntax error or if a file could not be read
+ */
+bool sim_signal_parse(sim_signal_t *signal, const char *spec)
+{
+    char item[SIM_LINE_MAX];
+    float args[8];
+
+    while (*spec) {
+        size_t len = strcspn(spec, ";");
+        if (len >= sizeof(item)) {
+            return false;
+        }
+        memcpy(item, spec, len);
+        item[len] = '\0';
+        spec += len + (spec[len] == ';' ? 1 : 0);
+
+        char *value = strchr(item, '=');
+        if (!value) {
+            const char *ext = strrchr(item, '.');
+            bool ok;
+            if (strcmp(item, "noloop") == 0) {
+                signal->loop = false;
+                ok = true;
+            }
+            else if (ext && strcmp(ext, ".cbor") == 0) {
+                ok = sim_signal_load_cbor(signal, item);
+            }
+            else {
+                ok = sim_signal_load_csv(signal, item);
+            }
+            if (!ok) {
+                return false;
+            }
+            continue;
+        }
+
+        *value++ = '\0';
+        size_t n = parse_floats(value, args, 8);
+
+        if (strcmp(item, "offset") == 0 && n > 0) {
+            for (size_t ch = 0; ch < signal->channels; ch++) {
+                signal->offset[ch] = args[ch < n ? ch : n - 1];
+            }
+        }
+        else if (strcmp(item, "sine") == 0 && n >= 2 && signal->n_tones < SIM_SIGNAL_MAX_TONES) {
+            sim_tone_t *tone = &signal->tones[signal->n_tones++];
+            tone->freq_hz = args[0];
+            tone->amplitude = args[1];
+            tone->channel = n > 2 ? (uint8_t)args[2] : SIM_SIGNAL_ALL_CHANNELS;
+            tone->phase = n > 3 ? args[3] * SIM_PI / 180.0f : 0.0f;
+        }
+        else if (strcmp(item, "bearing") == 0 && n >= 5) {
+            signal->bearing.shaft_hz = args[0];
+            signal->bearing.fault_order = args[1];
+            signal->bearing.resonance_hz = args[2];
+            signal->bearing.decay = args[3];
+            signal->bearing.amplitude = args[4];
+            signal->bearing.modulation = n > 5 ? args[5] : 0.0f;
+            signal->bearing.channel = n > 6 ? (uint8_t)args[6] : SIM_SIGNAL_ALL_CHANNELS;
+            signal->has_bearing = true;
+        }
+        else if (strcmp(item, "noise") == 0 && n == 1) {
+            signal->noise = args[0];
+        }
+        else if (strcmp(item, "seed") == 0 && n == 1) {
+            signal->seed = (uint32_t)args[0];
+        }
+        else if (strcmp(item, "interval") == 0 && n == 1 && args[0] > 0.0f) {
+            signal->interval_ms = args[0];
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Load a CSV recording (e.g. a Studio export). Header lines are
+ *             skipped, a leading "timestamp" column (ms) sets the interval.
+ *
+ * @return     false if the file has no samples
+ */
+bool sim_signal_load_csv(sim_signal_t *signal, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return false;
+    }
+
+    char line[SIM_LINE_MAX];
+    float row[SIM_SIGNAL_MAX_CHANNELS + 1];
+    bool timestamps = false;
+    float first_ts = 0.0f;
+    size_t start = signal->n_samples;
+
+    while (fgets(line, sizeof(line), file)) {
+        const char *p = line;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0' || *p == '\r' || *p == '\n') {
+            continue;
+        }
+        if (!(*p == '-' || *p == '+' || *p == '.' || (*p >= '0' && *p <= '9'))) {
+            timestamps = (strncmp(p, "timestamp", 9) == 0);
+            continue;
+        }
+
+        size_t n = parse_floats(p, row, SIM_SIGNAL_MAX_CHANNELS + 1);
+        if (timestamps) {
+            if (n < 2) {
+                continue;
+            }
+            if (signal->n_samples == start) {
+                first_ts = row[0];
+            }
+            else if (signal->n_samples == start + 1 && signal->interval_ms == 0.0f) {
+                signal->interval_ms = row[0] - first_ts;
+            }
+            if (!push_sample(signal, &row[1], n - 1)) {
+                break;
+            }
+        }
+        else if (!push_sample(signal, row, n)) {
+            break;
+        }
+    }
+    fclose(file);
+
+    return signal->n_samples > start;
+}
+
+/**
+ * @brief      Load a data acquisition file (CBOR), uses payload.interval_ms
+ *             and payload.values
+ *
+ * @return     false if the file could not be decoded or has no samples
+ */
+bool sim_signal_load_cbor(sim_signal_t *signal, const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *cbor = (uint8_t *)malloc(size > 0 ? size : 1);
+    if (!cbor || fread(cbor, 1, size, file) != (size_t)size) {
+        free(cbor);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    QCBORDecodeContext ctx;
+    QCBORItem item;
+    UsefulBufC buf = { cbor, (size_t)size };
+    QCBORDecode_Init(&ctx, buf, QCBOR_DECODE_MODE_NORMAL);
+
+    int values_level = -1;
+    float row[SIM_SIGNAL_MAX_CHANNELS];
+    size_t cols = 0;
+    bool in_row = false;
+    size_t start = signal->n_samples;
+
+    while (QCBORDecode_GetNext(&ctx, &item) == QCBOR_SUCCESS) {
+        bool number = (item.uDataType == QCBOR_TYPE_DOUBLE || item.uDataType == QCBOR_TYPE_INT64
+            || item.uDataType == QCBOR_TYPE_UINT64);
+        float value = item.uDataType == QCBOR_TYPE_DOUBLE ? (float)item.val.dfnum
+            : item.uDataType == QCBOR_TYPE_INT64 ? (float)item.val.int64 : (float)item.val.uint64;
+
+        if (values_level < 0) {
+            if (item.uLabelType != QCBOR_TYPE_TEXT_STRING) {
+                continue;
+            }
+            UsefulBufC label = item.label.string;
+            if (label.len == 11 && memcmp(label.ptr, "interval_ms", 11) == 0 && number) {
+                if (signal->interval_ms == 0.0f) {
+                    signal->interval_ms = value;
+                }
+            }
+            else if (label.len == 6 && memcmp(label.ptr, "values", 6) == 0 && item.uDataType == QCBOR_TYPE_ARRAY) {
+                values_level = item.uNestingLevel;
+            }
+            continue;
+        }
+
+        if (item.uNestingLevel <= values_level) {
+            break;
+        }
+
+        if (item.uDataType == QCBOR_TYPE_ARRAY && item.uNestingLevel == values_level + 1) {
+            in_row = true;
+            cols = 0;
+        }
+        else if (number && item.uNestingLevel == values_level + 1) {
+            push_sample(signal, &value, 1);
+        }
+        else if (number && in_row && item.uNestingLevel == values_level + 2) {
+            if (cols < SIM_SIGNAL_MAX_CHANNELS) {
+                row[cols++] = value;
+            }
+            // last value of the row
+            if (item.uNextNestLevel <= values_level + 1) {
+                push_sample(signal, row, cols);
+                in_row = false;
+            }
+        }
+    }
+
+    free(cbor);
+
+    return signal->n_samples > start;
+}
+
+/**
+ * @brief      Evaluate the signal at a point in time, replay data is
+ *             interpolated between samples
+ *
+ * @param      signal  The signal
+ * @param[in]  t_us    Time since the start of the simulation
+ * @param[out] out     One value per channel
+ *
+ * @return     false once a recording without loop has ended
+ */
+bool sim_signal_value(sim_signal_t *signal, uint64_t t_us, float *out)
+{
+    float t = (float)((double)t_us / 1000000.0);
+
+    for (size_t ch = 0; ch < signal->channels; ch++) {
+        out[ch] = signal->offset[ch];
+    }
+
+    if (signal->n_samples > 0) {
+        float interval_ms = signal->interval_ms > 0.0f ? signal->interval_ms : 1.0f;
+        double pos = ((double)t_us / 1000.0) / interval_ms;
+        size_t ix = (size_t)pos;
+        float frac = (float)(pos - (double)ix);
+
+        if (!signal->loop && ix >= signal->n_samples) {
+            return false;
+        }
+        size_t ix0 = ix % signal->n_samples;
+        size_t ix1 = (ix0 + 1 < signal->n_samples) ? ix0 + 1 : (signal->loop ? 0 : ix0);
+
+        const float *s0 = &signal->values[ix0 * signal->channels];
+        const float *s1 = &signal->values[ix1 * signal->channels];
+        for (size_t ch = 0; ch < signal->channels; ch++) {
+            out[ch] = s0[ch] + (s1[ch] - s0[ch]) * frac;
+        }
+    }
+
+    for (size_t ix = 0; ix < signal->n_tones; ix++) {
+        const sim_tone_t *tone = &signal->tones[ix];
+        float value = tone->amplitude * sinf(2.0f * SIM_PI * fmodf(tone->freq_hz * t, 1.0f) + tone->phase);
+        for (size_t ch = 0; ch < signal->channels; ch++) {
+            if (tone->channel == SIM_SIGNAL_ALL_CHANNELS || tone->channel == ch) {
+                out[ch] += value;
+            }
+        }
+    }
+
+    if (signal->has_bearing) {
+        float value = bearing_value(&signal->bearing, t);
+        for (size_t ch = 0; ch < signal->channels; ch++) {
+            if (signal->bearing.channel == SIM_SIGNAL_ALL_CHANNELS || signal->bearing.channel == ch) {
+                out[ch] += value;
+            }
+        }
+    }
+
+    if (signal->noise > 0.0f) {
+        for (size_t ch = 0; ch < signal->channels; ch++) {
+            out[ch] += signal->noise * next_gaussian(signal);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SIM_SIGNAL_H
+#define SIM_SIGNAL_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Constant defines -------------------------------------------------------- */
+#define SIM_SIGNAL_MAX_CHANNELS     3
+#define SIM_SIGNAL_MAX_TONES        8
+/** Tone or fault applied to every channel */
+#define SIM_SIGNAL_ALL_CHANNELS     0xFF
+
+typedef struct {
+    float freq_hz;
+    float amplitude;
+    float phase;
+    uint8_t channel;
+} sim_tone_t;
+
+/**
+ * Localized bearing defect: every pass of a rolling element over the defect
+ * (fault order times the shaft rate) rings the structural resonance, the
+ * ringing decays exponentially. Inner race faults are amplitude modulated
+ * with the shaft rotation (modulation > 0).
+ */
+typedef struct {
+    float shaft_hz;
+    float fault_order;
+    float resonance_hz;
+    float decay;
+    float amplitude;
+    float modulation;
+    uint8_t channel;
+} sim_bearing_t;
+
+typedef struct {
+    size_t channels;
+    float offset[SIM_SIGNAL_MAX_CHANNELS];
+
+    /* Generators, summed */
+    sim_tone_t tones[SIM_SIGNAL_MAX_TONES];
+    size_t n_tones;
+    sim_bearing_t bearing;
+    bool has_bearing;
+    float noise;
+    uint32_t seed;
+
+    /* Replay, values are interleaved per sample and take the place of the offset */
+    float *values;
+    size_t n_samples;
+    float interval_ms;
+    bool loop;
+} sim_signal_t;
+
+/* Function prototypes ----------------------------------------------------- */
+void sim_signal_init(sim_signal_t *signal, size_t channels);
+void sim_signal_free(sim_signal_t *signal);
+bool sim_signal_parse(sim_signal_t *signal, const char *spec);
+bool sim_signal_load_csv(sim_signal_t *signal, const char *path);
+bool sim_signal_load_cbor(sim_signal_t *signal, const char *path);
+bool sim_signal_value(sim_signal_t *signal, uint64_t t_us, float *out);
+
+#endif
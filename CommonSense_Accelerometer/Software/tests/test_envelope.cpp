@@ -0,0 +1,172 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * spectral::feature::envelope_analysis: a resonance amplitude modulated at
+ * a bearing fault frequency, under a strong shaft component outside the
+ * band, has to give an envelope spectrum that peaks at the modulation
+ * frequency with about the rectified modulation amplitude, and without the
+ * shaft line. An axis without modulation has no such peak.
+ * extract_envelope_features() has to give the same values per axis.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "test.h"
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define FREQUENCY           10000.0f
+#define FRAMES              10000
+#define AXES                2
+#define BAND_LOW            2000.0f
+#define BAND_HIGH           4000.0f
+#define FILTER_ORDER        4
+/* Envelope rate 10 kHz / 15 = 666.7 Hz */
+#define ENVELOPE_MAX_FREQ   260.0f
+#define FFT_LENGTH          256
+#define BINS                (FFT_LENGTH / 2 + 1)
+#define RESONANCE_FREQ      3000.0
+#define RESONANCE_AMPLITUDE 0.5
+#define MODULATION_DEPTH    0.8
+/* Fault frequency on bin 34 of the envelope spectrum, 88.5 Hz */
+#define FAULT_BIN           34
+#define SHAFT_FREQ          25.0
+#define SHAFT_AMPLITUDE     2.0
+
+/* Private variables ------------------------------------------------------- */
+static float signal_buffer[FRAMES * AXES];
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Interleaved frames: axis 0 has the modulated resonance and
+ *             the shaft, axis 1 the resonance without modulation and the
+ *             shaft
+ */
+static void make_signal(void)
+{
+    const double fault_freq = FAULT_BIN * (FREQUENCY / 15.0) / FFT_LENGTH;
+
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        double t = frame / FREQUENCY;
+        double shaft = SHAFT_AMPLITUDE * sin(2.0 * M_PI * SHAFT_FREQ * t) + 1.0;
+        double carrier = RESONANCE_AMPLITUDE * sin(2.0 * M_PI * RESONANCE_FREQ * t);
+        double modulation = 1.0 + MODULATION_DEPTH * cos(2.0 * M_PI * fault_freq * t);
+
+        signal_buffer[frame * AXES + 0] = (float)(shaft + carrier * modulation);
+        signal_buffer[frame * AXES + 1] = (float)(shaft + carrier);
+    }
+}
+
+/**
+ * @brief      One row per axis, scaled
+ */
+static void make_input(matrix_t *input, float scale)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t axis = 0; axis < AXES; axis++) {
+            input->buffer[axis * FRAMES + frame] = signal_buffer[frame * AXES + axis] * scale;
+        }
+    }
+}
+
+static size_t strongest_bin(const float *row)
+{
+    size_t peak = 1;
+    for (size_t ix = 2; ix < BINS; ix++) {
+        if (row[ix] > row[peak]) {
+            peak = ix;
+        }
+    }
+    return peak;
+}
+
+static void check_envelope(void)
+{
+    matrix_t input(AXES, FRAMES);
+    matrix_t output(AXES, BINS);
+    float envelope_freq = 0.0f;
+
+    make_input(&input, 1.0f);
+    int ret = spectral::feature::envelope_analysis(&output, &input, FREQUENCY, BAND_LOW, BAND_HIGH,
+        FILTER_ORDER, ENVELOPE_MAX_FREQ, FFT_LENGTH, &envelope_freq);
+    TEST_CHECK(ret == EIDSP_OK, "envelope_analysis returned %d", ret);
+    TEST_CHECK_NEAR(envelope_freq, FREQUENCY / 15, 1e-3, "envelope sampling frequency");
+
+    const float *modulated = output.buffer;
+    const float *plain = output.buffer + BINS;
+    const size_t shaft_bin = (size_t)lrint(SHAFT_FREQ / (envelope_freq / FFT_LENGTH));
+
+    size_t peak = strongest_bin(modulated);
+    TEST_CHECK(peak == FAULT_BIN, "envelope peak at bin %d (%g Hz)", (int)peak, peak * envelope_freq / FFT_LENGTH);
+    // the rectified carrier is (2 / pi) * amplitude * (1 + depth * cos)
+    const double expected = 2.0 / M_PI * RESONANCE_AMPLITUDE * MODULATION_DEPTH;
+    TEST_CHECK_NEAR(modulated[FAULT_BIN], expected, 0.1 * expected, "fault line amplitude");
+    TEST_CHECK(modulated[shaft_bin] < 0.05f * modulated[FAULT_BIN],
+        "shaft line %g in the envelope, fault line %g", modulated[shaft_bin], modulated[FAULT_BIN]);
+    TEST_CHECK(plain[FAULT_BIN] < 0.05f * modulated[FAULT_BIN],
+        "axis without modulation has %g at the fault line", plain[FAULT_BIN]);
+}
+
+/**
+ * @brief      The DSP block scales, transposes and flattens around the feature
+ */
+static void check_extract(void)
+{
+    const float scale = 2.0f;
+    matrix_t input(AXES, FRAMES);
+    matrix_t expected(AXES, BINS);
+    matrix_t output(1, AXES * BINS);
+    ei_dsp_config_envelope_t config = { 1, AXES, scale, BAND_LOW, BAND_HIGH, FILTER_ORDER,
+        ENVELOPE_MAX_FREQ, FFT_LENGTH };
+    signal_t signal;
+
+    make_input(&input, scale);
+    spectral::feature::envelope_analysis(&expected, &input, FREQUENCY, BAND_LOW, BAND_HIGH,
+        FILTER_ORDER, ENVELOPE_MAX_FREQ, FFT_LENGTH, NULL);
+
+    numpy::signal_from_buffer(signal_buffer, FRAMES * AXES, &signal);
+    int ret = extract_envelope_features(&signal, &output, &config, FREQUENCY);
+    TEST_CHECK(ret == EIDSP_OK, "extract returned %d", ret);
+    TEST_CHECK(output.rows == 1 && output.cols == AXES * BINS, "output is %dx%d", (int)output.rows, (int)output.cols);
+    TEST_CHECK(memcmp(output.buffer, expected.buffer, sizeof(float) * AXES * BINS) == 0,
+        "extract differs from envelope_analysis");
+
+    // invalid bands
+    matrix_t features(AXES, BINS);
+    make_input(&input, 1.0f);
+    ret = spectral::feature::envelope_analysis(&features, &input, FREQUENCY, BAND_LOW, FREQUENCY / 2,
+        FILTER_ORDER, ENVELOPE_MAX_FREQ, FFT_LENGTH, NULL);
+    TEST_CHECK(ret == EIDSP_PARAMETER_INVALID, "band up to Nyquist returned %d", ret);
+    ret = spectral::feature::envelope_analysis(&features, &input, FREQUENCY, BAND_HIGH, BAND_LOW,
+        FILTER_ORDER, ENVELOPE_MAX_FREQ, FFT_LENGTH, NULL);
+    TEST_CHECK(ret == EIDSP_PARAMETER_INVALID, "reversed band returned %d", ret);
+}
+
+int main(void)
+{
+    make_signal();
+    check_envelope();
+    check_extract();
+
+    return test_result("test_envelope");
+}
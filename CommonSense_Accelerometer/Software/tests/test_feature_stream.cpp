@@ -0,0 +1,198 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Continuous MFE / MFCC extraction (extract_*_per_slice_features) against
+ * the batch path: the slices of one recording have to produce the same rows,
+ * bit for bit, as speechpy::feature::mfe() / mfcc() over the whole recording
+ * with the same preemphasis, for any slice size.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "test.h"
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define FREQUENCY           16000
+#define AUDIO_SAMPLES       16000
+
+/* Private variables ------------------------------------------------------- */
+static float audio[AUDIO_SAMPLES];
+static const size_t slice_sizes[] = { 160, 250, 1000, 4000 };
+static class speechpy::processing::preemphasis *batch_preemphasis;
+
+/* Private functions ------------------------------------------------------- */
+static int batch_preemphasis_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    return batch_preemphasis->get_data(offset, length, out_ptr);
+}
+
+/**
+ * @brief      Tones and pseudo random noise in 16 bit range. The batch
+ *             preemphasis wraps around to the end of the buffer for the
+ *             first samples where the stream starts from silence, so the
+ *             last samples are zero.
+ */
+static void make_audio(int pre_shift)
+{
+    uint32_t seed = 1;
+    for (size_t ix = 0; ix < AUDIO_SAMPLES; ix++) {
+        seed = seed * 1664525 + 1013904223;
+        float t = (float)ix / FREQUENCY;
+        audio[ix] = 6000.0f * sinf(2.0f * (float)M_PI * 440.0f * t) +
+            2000.0f * sinf(2.0f * (float)M_PI * 3100.0f * t * (1.0f + t)) +
+            (float)((int32_t)(seed >> 16) - 32768) / 16.0f;
+    }
+    for (int ix = 0; ix < pre_shift; ix++) {
+        audio[AUDIO_SAMPLES - 1 - ix] = 0.0f;
+    }
+}
+
+/**
+ * @brief      Run the recording through the per slice extractor
+ * @return     number of rows produced
+ */
+template<typename config_t>
+static size_t run_slices(int (*extract)(signal_t *, matrix_t *, void *, const float, matrix_size_t *),
+    config_t *config, size_t slice_size, matrix_t *out)
+{
+    size_t rows = 0;
+
+    ei_dsp_clear_continuous_audio_state();
+    memset(out->buffer, 0, out->rows * out->cols * sizeof(float));
+
+    for (size_t offset = 0; offset < AUDIO_SAMPLES; offset += slice_size) {
+        size_t length = AUDIO_SAMPLES - offset < slice_size ? AUDIO_SAMPLES - offset : slice_size;
+        signal_t signal;
+        numpy::signal_from_buffer(&audio[offset], length, &signal);
+
+        matrix_size_t size = { 0, 0 };
+        int ret = extract(&signal, out, config, FREQUENCY, &size);
+        TEST_CHECK(ret == EIDSP_OK, "slice at %u: %d", (unsigned)offset, ret);
+        if (ret != EIDSP_OK) {
+            return 0;
+        }
+        rows += size.rows;
+    }
+
+    return rows;
+}
+
+/**
+ * @brief      Compare the first rows of the stream with the batch rows
+ */
+static void check_rows(const char *what, size_t slice_size, const matrix_t *stream, size_t stream_rows,
+    const matrix_t *batch, size_t extra_rows)
+{
+    TEST_CHECK(stream_rows == batch->rows + extra_rows, "%s, slice %u: %u rows, batch %u",
+        what, (unsigned)slice_size, (unsigned)stream_rows, (unsigned)batch->rows);
+    if (stream_rows != batch->rows + extra_rows) {
+        return;
+    }
+
+    // the stream matrix holds all rows, oldest first
+    const float *first = stream->buffer + (stream->rows - stream_rows) * stream->cols;
+    TEST_CHECK(memcmp(first, batch->buffer, batch->rows * batch->cols * sizeof(float)) == 0,
+        "%s, slice %u: rows differ", what, (unsigned)slice_size);
+}
+
+static void test_mfe(uint16_t version)
+{
+    static ei_dsp_config_mfe_t config;
+    config = { version, 1, 0.02015f, 0.01015f, 40, 512, 0, 0, 101, -52 };
+    make_audio(version >= 3 ? 1 : 0);
+
+    signal_t signal;
+    numpy::signal_from_buffer(audio, AUDIO_SAMPLES, &signal);
+    class speechpy::processing::preemphasis pre(&signal, 1, 0.98f, true);
+    batch_preemphasis = &pre;
+    signal_t batch_signal = signal;
+    if (version >= 3) {
+        batch_signal.get_data = &batch_preemphasis_get_data;
+    }
+
+    matrix_size_t size = speechpy::feature::calculate_mfe_buffer_size(AUDIO_SAMPLES, FREQUENCY,
+        config.frame_length, config.frame_stride, config.num_filters, version);
+    matrix_t batch(size.rows, size.cols);
+    matrix_t energy(size.rows, 1);
+    int ret = speechpy::feature::mfe(&batch, &energy, &batch_signal, FREQUENCY, config.frame_length,
+        config.frame_stride, config.num_filters, config.fft_length, config.low_frequency,
+        config.high_frequency, version);
+    TEST_CHECK(ret == EIDSP_OK, "MFE v%u batch: %d", version, ret);
+
+    // version 1 leaves out the last frame of a window, the stream emits it
+    size_t extra_rows = version == 1 ? 1 : 0;
+    matrix_t stream(size.rows + extra_rows, size.cols);
+
+    char what[32];
+    snprintf(what, sizeof(what), "MFE v%u", version);
+    for (size_t ix = 0; ix < sizeof(slice_sizes) / sizeof(slice_sizes[0]); ix++) {
+        size_t rows = run_slices(&extract_mfe_per_slice_features, &config, slice_sizes[ix], &stream);
+        check_rows(what, slice_sizes[ix], &stream, rows, &batch, extra_rows);
+    }
+}
+
+static void test_mfcc(int pre_shift)
+{
+    static ei_dsp_config_mfcc_t config;
+    config = { 2, 1, 13, 0.02f, 0.01f, 32, 256, 101, 0, 0, 0.98f, pre_shift };
+    make_audio(pre_shift);
+
+    signal_t signal;
+    numpy::signal_from_buffer(audio, AUDIO_SAMPLES, &signal);
+    class speechpy::processing::preemphasis pre(&signal, pre_shift, config.pre_cof, false);
+    batch_preemphasis = &pre;
+    signal_t batch_signal = signal;
+    batch_signal.get_data = &batch_preemphasis_get_data;
+
+    matrix_size_t size = speechpy::feature::calculate_mfcc_buffer_size(AUDIO_SAMPLES, FREQUENCY,
+        config.frame_length, config.frame_stride, config.num_cepstral, 2);
+    matrix_t batch(size.rows, size.cols);
+    int ret = speechpy::feature::mfcc(&batch, &batch_signal, FREQUENCY, config.frame_length,
+        config.frame_stride, config.num_cepstral, config.num_filters, config.fft_length,
+        config.low_frequency, config.high_frequency, true, 2);
+    TEST_CHECK(ret == EIDSP_OK, "MFCC batch: %d", ret);
+
+    matrix_t stream(size.rows, size.cols);
+
+    char what[32];
+    snprintf(what, sizeof(what), "MFCC shift %d", pre_shift);
+    for (size_t ix = 0; ix < sizeof(slice_sizes) / sizeof(slice_sizes[0]); ix++) {
+        size_t rows = run_slices(&extract_mfcc_per_slice_features, &config, slice_sizes[ix], &stream);
+        check_rows(what, slice_sizes[ix], &stream, rows, &batch, 0);
+    }
+}
+
+int main(void)
+{
+    for (uint16_t version = 1; version <= 4; version++) {
+        test_mfe(version);
+    }
+
+    test_mfcc(1);
+    test_mfcc(2);
+
+    ei_dsp_clear_continuous_audio_state();
+
+    return test_result("test_feature_stream");
+}
@@ -0,0 +1,346 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * Top-K peak selection of processing::find_fft_peaks: for float, i16 and
+ * i32 spectra the strongest peaks have to come out in the same order, with
+ * the same frequencies and the same threshold zeroing as the vector and
+ * sort implementation it replaced, also when there are fewer peaks than
+ * output rows or more candidates than the search looks at. The parabolic
+ * and gaussian interpolation have to recover the position and height of a
+ * peak that lies between two bins.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include <algorithm>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/spectral/processing.hpp"
+
+using namespace ei;
+using namespace ei::spectral;
+
+/* Constant defines -------------------------------------------------------- */
+#define SAMPLING_FREQ       100.0f
+#define RANDOM_SPECTRA      500
+/* Sub-bin position of the interpolation checks */
+#define PEAK_BIN            20.3f
+#define PEAK_AMPLITUDE      5.0f
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t random_state = 1;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static uint32_t random_next(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return random_state >> 8;
+}
+
+/**
+ * @brief      Reference, the find_fft_peaks() before the top-K selection:
+ *             collect the first candidates in bin order, zero the ones
+ *             below the threshold, sort them on amplitude
+ */
+static void reference_fft_peaks(matrix_t *fft_matrix, matrix_t *output_matrix, float sampling_freq,
+    float threshold, uint16_t fft_length)
+{
+    int N = static_cast<int>(fft_length);
+    float T = 1.0f / sampling_freq;
+
+    std::vector<float> freq_space(fft_matrix->cols);
+    numpy::linspace(0.0f, 1.0f / (2.0f * T), floor(N / 2), freq_space.data());
+
+    matrix_t peaks_matrix(output_matrix->rows * 10, 1);
+    uint16_t peak_count;
+    processing::find_peak_indexes(fft_matrix, &peaks_matrix, 0.0f, &peak_count);
+
+    std::vector<processing::freq_peak_t> peaks;
+    for (uint16_t ix = 0; ix < peak_count; ix++) {
+        processing::freq_peak_t d;
+        d.freq = freq_space[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
+        d.amplitude = fft_matrix->buffer[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
+        if (d.amplitude < threshold) {
+            d.freq = 0.0f;
+            d.amplitude = 0.0f;
+        }
+        peaks.push_back(d);
+    }
+    std::sort(peaks.begin(), peaks.end(),
+        [](const processing::freq_peak_t & a, const processing::freq_peak_t & b) -> bool
+    {
+        return a.amplitude > b.amplitude;
+    });
+
+    for (size_t row = 0; row < output_matrix->rows; row++) {
+        output_matrix->buffer[row * 2 + 0] = row < peaks.size() ? peaks[row].freq : 0.0f;
+        output_matrix->buffer[row * 2 + 1] = row < peaks.size() ? peaks[row].amplitude : 0.0f;
+    }
+}
+
+/**
+ * @brief      Reference for the fixed point spectra, candidates are limited
+ *             to four per output row
+ */
+template<typename matrix_type, typename peak_type, typename T>
+static void reference_fft_peaks_fixed(matrix_type *fft_matrix, matrix_type *output_matrix,
+    float sampling_freq, float threshold, uint16_t fft_length,
+    int (*float_to_fixed)(const float *, T *, size_t))
+{
+    int N = static_cast<int>(fft_length);
+    float T_s = 1.0f / sampling_freq;
+
+    T stop_point;
+    float stop = (((1.0f / (2.0f * T_s))) / N);
+    float_to_fixed(&stop, &stop_point, 1);
+
+    std::vector<T> freq_space(fft_matrix->cols);
+    numpy::linspace(static_cast<T>(0), stop_point, (N >> 1), freq_space.data());
+
+    matrix_type peaks_matrix(output_matrix->rows * 4, 1);
+    uint16_t peak_count;
+    processing::find_peak_indexes(fft_matrix, &peaks_matrix, 0, &peak_count);
+
+    T fixed_threshold;
+    threshold /= fft_length;
+    float_to_fixed(&threshold, &fixed_threshold, 1);
+
+    std::vector<peak_type> peaks;
+    for (uint16_t ix = 0; ix < peak_count; ix++) {
+        peak_type d;
+        d.freq = freq_space[static_cast<uint32_t>(peaks_matrix.buffer[ix])];
+        d.amplitude = fft_matrix->buffer[peaks_matrix.buffer[ix]];
+        if (d.amplitude < fixed_threshold) {
+            d.freq = 0;
+            d.amplitude = 0;
+        }
+        peaks.push_back(d);
+    }
+    std::sort(peaks.begin(), peaks.end(),
+        [](const peak_type & a, const peak_type & b) -> bool
+    {
+        return a.amplitude > b.amplitude;
+    });
+
+    for (size_t row = 0; row < output_matrix->rows; row++) {
+        output_matrix->buffer[row * 2 + 0] = row < peaks.size() ? peaks[row].freq : 0;
+        output_matrix->buffer[row * 2 + 1] = row < peaks.size() ? peaks[row].amplitude : 0;
+    }
+}
+
+/**
+ * @brief      Random spectrum with distinct values, so the order of the
+ *             sorted peaks does not depend on how ties are broken. Every
+ *             fourth spectrum only rises with a few bumps, so it has fewer
+ *             peaks than output rows.
+ */
+template<typename T>
+static void random_spectrum(T *spectrum, size_t bins, uint32_t range, uint32_t spectrum_ix)
+{
+    std::vector<uint32_t> values(bins);
+    for (size_t ix = 0; ix < bins; ix++) {
+        values[ix] = (uint32_t)(((uint64_t)ix * range) / bins);
+    }
+
+    if (spectrum_ix % 4 == 0) {
+        // monotonic ramp with two bumps
+        std::swap(values[bins / 3], values[bins / 3 + 1]);
+        std::swap(values[bins / 2], values[bins / 2 + 1]);
+    }
+    else {
+        for (size_t ix = bins - 1; ix > 0; ix--) {
+            std::swap(values[ix], values[random_next() % (ix + 1)]);
+        }
+    }
+
+    for (size_t ix = 0; ix < bins; ix++) {
+        spectrum[ix] = static_cast<T>(values[ix]);
+    }
+}
+
+/**
+ * @brief      Compare find_fft_peaks() with the reference on random float spectra
+ */
+static void check_float(void)
+{
+    static const uint16_t fft_lengths[] = { 16, 64, 128, 256 };
+    int mismatches = 0;
+
+    for (uint32_t spectrum_ix = 0; spectrum_ix < RANDOM_SPECTRA; spectrum_ix++) {
+        uint16_t fft_length = fft_lengths[spectrum_ix % 4];
+        size_t bins = fft_length / 2 + 1;
+        size_t rows = 1 + random_next() % 8;
+        float threshold = (float)(random_next() % bins) / 10.0f;
+
+        matrix_t fft_matrix(1, bins);
+        random_spectrum(fft_matrix.buffer, bins, bins * 10, spectrum_ix);
+        for (size_t ix = 0; ix < bins; ix++) {
+            fft_matrix.buffer[ix] /= 100.0f;
+        }
+
+        matrix_t expected(rows, 2);
+        matrix_t output(rows, 2);
+        reference_fft_peaks(&fft_matrix, &expected, SAMPLING_FREQ, threshold, fft_length);
+        int ret = processing::find_fft_peaks(&fft_matrix, &output, SAMPLING_FREQ, threshold, fft_length);
+        TEST_CHECK(ret == EIDSP_OK, "float returned %d", ret);
+
+        for (size_t ix = 0; ix < rows * 2; ix++) {
+            if (output.buffer[ix] != expected.buffer[ix]) {
+                mismatches++;
+            }
+        }
+    }
+
+    TEST_CHECK(mismatches == 0, "float: %d values differ from the sorted reference", mismatches);
+}
+
+/**
+ * @brief      Compare a fixed point find_fft_peaks() with the reference on
+ *             random spectra, values over the full range of T
+ */
+template<typename matrix_type, typename peak_type, typename T>
+static void check_fixed(const char *what, uint32_t range, int32_t offset,
+    int (*float_to_fixed)(const float *, T *, size_t))
+{
+    static const uint16_t fft_lengths[] = { 16, 64, 128, 256 };
+    int mismatches = 0;
+    int zeroed = 0;
+
+    for (uint32_t spectrum_ix = 0; spectrum_ix < RANDOM_SPECTRA; spectrum_ix++) {
+        uint16_t fft_length = fft_lengths[spectrum_ix % 4];
+        size_t bins = fft_length / 2 + 1;
+        size_t rows = 1 + random_next() % 8;
+        // threshold / fft_length in q15 / q31 covers part of the spectrum
+        float threshold = (float)(random_next() % 100) / 100.0f * fft_length;
+
+        matrix_type fft_matrix(1, bins);
+        random_spectrum(fft_matrix.buffer, bins, range, spectrum_ix);
+        for (size_t ix = 0; ix < bins; ix++) {
+            fft_matrix.buffer[ix] = static_cast<T>(fft_matrix.buffer[ix] + offset);
+        }
+
+        matrix_type expected(rows, 2);
+        matrix_type output(rows, 2);
+        reference_fft_peaks_fixed<matrix_type, peak_type, T>(&fft_matrix, &expected,
+            SAMPLING_FREQ, threshold, fft_length, float_to_fixed);
+        int ret = processing::find_fft_peaks(&fft_matrix, &output, SAMPLING_FREQ, threshold, fft_length);
+        TEST_CHECK(ret == EIDSP_OK, "%s returned %d", what, ret);
+
+        for (size_t ix = 0; ix < rows * 2; ix++) {
+            if (output.buffer[ix] != expected.buffer[ix]) {
+                mismatches++;
+            }
+        }
+        for (size_t row = 0; row < rows; row++) {
+            if (expected.buffer[row * 2 + 1] == 0) {
+                zeroed++;
+            }
+        }
+    }
+
+    TEST_CHECK(mismatches == 0, "%s: %d values differ from the sorted reference", what, mismatches);
+    TEST_CHECK(zeroed > 0, "%s: no peak fell below the threshold", what);
+}
+
+/**
+ * @brief      Fewer peaks than rows and the threshold, checked by hand
+ */
+static void check_zero_fill(void)
+{
+    // peaks at bins 2 (0.8), 4 (0.3) and 7 (0.6), fft_length 16 so bin 7 is the stop frequency
+    float spectrum[] = { 0.0f, 0.1f, 0.8f, 0.1f, 0.3f, 0.2f, 0.1f, 0.6f, 0.0f };
+    matrix_t fft_matrix(1, 9, spectrum);
+    matrix_t output(5, 2);
+
+    processing::find_fft_peaks(&fft_matrix, &output, SAMPLING_FREQ, 0.5f, 16);
+
+    TEST_CHECK_NEAR(output.buffer[0], 2 * SAMPLING_FREQ / 2 / 7, 1e-5, "freq of the strongest peak");
+    TEST_CHECK(output.buffer[1] == 0.8f, "strongest peak %g", output.buffer[1]);
+    TEST_CHECK(output.buffer[2] == SAMPLING_FREQ / 2, "last bin maps to %g", output.buffer[2]);
+    TEST_CHECK(output.buffer[3] == 0.6f, "second peak %g", output.buffer[3]);
+    TEST_CHECK(output.buffer[4] == 0.0f && output.buffer[5] == 0.0f, "peak below threshold not zeroed");
+    for (size_t ix = 6; ix < 10; ix++) {
+        TEST_CHECK(output.buffer[ix] == 0.0f, "row %d not zero filled", (int)(ix / 2));
+    }
+}
+
+/**
+ * @brief      Sub-bin peak, sampled from a parabola or from a Gaussian
+ */
+static void check_interpolation(void)
+{
+    const uint16_t fft_length = 128;
+    const size_t bins = fft_length / 2 + 1;
+    const float bin_hz = SAMPLING_FREQ / fft_length;
+    matrix_t parabola(1, bins);
+    matrix_t gaussian(1, bins);
+    matrix_t output(1, 2);
+
+    for (size_t ix = 0; ix < bins; ix++) {
+        float d = (float)ix - PEAK_BIN;
+        parabola.buffer[ix] = fmaxf(PEAK_AMPLITUDE - 0.2f * d * d, 0.0f);
+        gaussian.buffer[ix] = PEAK_AMPLITUDE * expf(-d * d / (2.0f * 1.5f * 1.5f));
+    }
+
+    processing::find_fft_peaks(&parabola, &output, SAMPLING_FREQ, 0.0f, fft_length,
+        processing::fft_peak_interpolation_parabolic);
+    TEST_CHECK_NEAR(output.buffer[0], PEAK_BIN * bin_hz, 1e-3, "parabolic freq");
+    TEST_CHECK_NEAR(output.buffer[1], PEAK_AMPLITUDE, 1e-4, "parabolic amplitude");
+
+    processing::find_fft_peaks(&gaussian, &output, SAMPLING_FREQ, 0.0f, fft_length,
+        processing::fft_peak_interpolation_gaussian);
+    TEST_CHECK_NEAR(output.buffer[0], PEAK_BIN * bin_hz, 1e-3, "gaussian freq");
+    TEST_CHECK_NEAR(output.buffer[1], PEAK_AMPLITUDE, 1e-4, "gaussian amplitude");
+
+    // a parabola through a Gaussian peak is close, but not exact
+    processing::find_fft_peaks(&gaussian, &output, SAMPLING_FREQ, 0.0f, fft_length,
+        processing::fft_peak_interpolation_parabolic);
+    TEST_CHECK_NEAR(output.buffer[0], PEAK_BIN * bin_hz, 0.1 * bin_hz, "parabolic freq of a gaussian");
+
+    // without interpolation the bin wins, at the studio frequency
+    processing::find_fft_peaks(&gaussian, &output, SAMPLING_FREQ, 0.0f, fft_length);
+    TEST_CHECK_NEAR(output.buffer[0], 20 * (SAMPLING_FREQ / 2) / (fft_length / 2 - 1), 1e-4, "bin freq");
+    TEST_CHECK(output.buffer[1] == gaussian.buffer[20], "bin amplitude %g", output.buffer[1]);
+
+    // above the threshold after interpolation, below it at the bin
+    processing::find_fft_peaks(&gaussian, &output, SAMPLING_FREQ, PEAK_AMPLITUDE - 1e-3f, fft_length,
+        processing::fft_peak_interpolation_gaussian);
+    TEST_CHECK(output.buffer[1] > 0.0f, "interpolated peak zeroed by the threshold");
+    processing::find_fft_peaks(&gaussian, &output, SAMPLING_FREQ, PEAK_AMPLITUDE - 1e-3f, fft_length);
+    TEST_CHECK(output.buffer[0] == 0.0f && output.buffer[1] == 0.0f, "bin peak not zeroed by the threshold");
+}
+
+int main(void)
+{
+    check_float();
+    check_fixed<matrix_i16_t, processing::freq_peak_i16_t, EIDSP_i16>("i16", 65535, -32768,
+        numpy::float_to_int16);
+    check_fixed<matrix_i32_t, processing::freq_peak_i32_t, EIDSP_i32>("i32", 1u << 30, -(1 << 29),
+        numpy::float_to_int32);
+    check_zero_fill();
+    check_interpolation();
+
+    return test_result("test_fft_peaks");
+}
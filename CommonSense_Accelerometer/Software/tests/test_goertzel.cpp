@@ -0,0 +1,184 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * spectral::goertzel_bank: with a Hann window a sine of amplitude A has to
+ * read A at its frequency, also between bins, and a frequency without a
+ * tone has to read close to 0. Both windows have to match a direct DTFT of
+ * the windowed signal. extract_goertzel_features() has to give the same
+ * values, axis major, when it streams the signal in chunks.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "test.h"
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define FREQUENCY           1000.0f
+#define FRAMES              500
+#define AXES                3
+#define FREQUENCY_COUNT     4
+
+/* Private variables ------------------------------------------------------- */
+/* Three tones, not on a bin (2 Hz), and one frequency without a tone */
+static const float frequencies[FREQUENCY_COUNT] = { 29.7f, 59.4f, 107.3f, 200.0f };
+/* Amplitude of every tone on every axis */
+static const float amplitudes[AXES][FREQUENCY_COUNT - 1] = {
+    { 1.0f, 3.0f, 0.5f },
+    { 3.0f, 0.5f, 1.0f },
+    { 0.5f, 1.0f, 3.0f },
+};
+static float signal_buffer[FRAMES * AXES];
+
+/* Private functions ------------------------------------------------------- */
+
+static void make_signal(void)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t axis = 0; axis < AXES; axis++) {
+            double v = 0.0;
+            for (size_t ix = 0; ix < FREQUENCY_COUNT - 1; ix++) {
+                v += amplitudes[axis][ix] * sin(2.0 * M_PI * frequencies[ix] * frame / FREQUENCY + 0.3 * ix);
+            }
+            signal_buffer[frame * AXES + axis] = (float)v;
+        }
+    }
+}
+
+/**
+ * @brief      Amplitude at freq from the DTFT of the windowed axis, in double
+ */
+static double dtft_amplitude(size_t axis, double freq, bool hann_window)
+{
+    double re = 0.0, im = 0.0, window_sum = 0.0;
+
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        double w = hann_window ? 0.5 - 0.5 * cos(2.0 * M_PI * frame / FRAMES) : 1.0;
+        double v = signal_buffer[frame * AXES + axis] * w;
+        re += v * cos(2.0 * M_PI * freq * frame / FREQUENCY);
+        im -= v * sin(2.0 * M_PI * freq * frame / FREQUENCY);
+        window_sum += w;
+    }
+
+    return 2.0 * sqrt(re * re + im * im) / window_sum;
+}
+
+static void run_bank(ei::spectral::goertzel_bank *bank, matrix_t *output)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        bank->push_frame(&signal_buffer[frame * AXES]);
+    }
+    bank->magnitudes(output);
+}
+
+/**
+ * @brief      Both windows against the DTFT, Hann against the tone amplitudes
+ */
+static void check_bank(bool hann_window)
+{
+    ei::spectral::goertzel_bank bank;
+    matrix_t output(AXES, FREQUENCY_COUNT);
+    const char *window = hann_window ? "hann" : "rectangular";
+    double max_error = 0.0;
+    double max_leak = 0.0;
+
+    int ret = bank.init(frequencies, FREQUENCY_COUNT, AXES, FREQUENCY, FRAMES, hann_window);
+    TEST_CHECK(ret == EIDSP_OK, "%s: init returned %d", window, ret);
+    run_bank(&bank, &output);
+    TEST_CHECK(bank.get_samples() == FRAMES, "%s: %d samples", window, (int)bank.get_samples());
+
+    for (size_t axis = 0; axis < AXES; axis++) {
+        for (size_t ix = 0; ix < FREQUENCY_COUNT; ix++) {
+            double expected = dtft_amplitude(axis, frequencies[ix], hann_window);
+            max_error = fmax(max_error, fabs(output.buffer[axis * FREQUENCY_COUNT + ix] - expected));
+
+            if (ix == FREQUENCY_COUNT - 1) {
+                max_leak = fmax(max_leak, output.buffer[axis * FREQUENCY_COUNT + ix]);
+            }
+            else if (hann_window) {
+                TEST_CHECK_NEAR(output.buffer[axis * FREQUENCY_COUNT + ix], amplitudes[axis][ix],
+                    0.01 * amplitudes[axis][ix], "hann tone amplitude");
+            }
+        }
+    }
+
+    TEST_CHECK(max_error <= 1e-3, "%s: error against the DTFT %g", window, max_error);
+    if (hann_window) {
+        TEST_CHECK(max_leak < 0.005, "hann: %g at the frequency without a tone", max_leak);
+    }
+    else {
+        // rectangular leaks more, but the DTFT says how much
+        TEST_CHECK(max_leak > 0.005, "rectangular: leak %g lower than expected", max_leak);
+    }
+
+    // a new window after reset gives the same values
+    matrix_t again(AXES, FREQUENCY_COUNT);
+    bank.reset();
+    run_bank(&bank, &again);
+    TEST_CHECK(memcmp(output.buffer, again.buffer, sizeof(float) * AXES * FREQUENCY_COUNT) == 0,
+        "%s: reset does not start a new window", window);
+}
+
+/**
+ * @brief      The DSP block streams the signal in chunks and scales it
+ */
+static void check_extract(void)
+{
+    ei::spectral::goertzel_bank bank;
+    matrix_t expected(AXES, FREQUENCY_COUNT);
+    matrix_t output(1, AXES * FREQUENCY_COUNT);
+    ei_dsp_config_goertzel_t config = { 1, AXES, 2.0f, "29.7,59.4, 107.3,200", true };
+    signal_t signal;
+
+    bank.init(frequencies, FREQUENCY_COUNT, AXES, FREQUENCY, FRAMES, true);
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        bank.push_frame(&signal_buffer[frame * AXES], 2.0f);
+    }
+    bank.magnitudes(&expected);
+
+    numpy::signal_from_buffer(signal_buffer, FRAMES * AXES, &signal);
+    int ret = extract_goertzel_features(&signal, &output, &config, FREQUENCY);
+    TEST_CHECK(ret == EIDSP_OK, "extract returned %d", ret);
+    TEST_CHECK(memcmp(output.buffer, expected.buffer, sizeof(float) * AXES * FREQUENCY_COUNT) == 0,
+        "extract differs from the bank");
+    TEST_CHECK_NEAR(output.buffer[FREQUENCY_COUNT + 0], 2.0f * amplitudes[1][0], 0.02 * amplitudes[1][0],
+        "scaled amplitude, axis major");
+
+    matrix_t wrong_size(1, AXES * FREQUENCY_COUNT - 1);
+    ret = extract_goertzel_features(&signal, &wrong_size, &config, FREQUENCY);
+    TEST_CHECK(ret == EIDSP_MATRIX_SIZE_MISMATCH, "wrong output size returned %d", ret);
+
+    float above_nyquist = FREQUENCY / 2 + 1.0f;
+    ret = bank.init(&above_nyquist, 1, AXES, FREQUENCY, FRAMES, true);
+    TEST_CHECK(ret == EIDSP_PARAMETER_INVALID, "frequency above Nyquist returned %d", ret);
+    TEST_CHECK(bank.push_frame(signal_buffer) == EIDSP_NOT_SUPPORTED, "push_frame after a failed init");
+}
+
+int main(void)
+{
+    make_signal();
+    check_bank(true);
+    check_bank(false);
+    check_extract();
+
+    return test_result("test_goertzel");
+}
@@ -0,0 +1,233 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * Single pass moments of numpy::moments_row / numpy::moments against the
+ * two pass numpy::mean, stdev, skew, kurtosis, rms, min and max, for row
+ * lengths that are and are not multiples of EIDSP_MOMENTS_BLOCK and of the
+ * unrolled 4 samples. On a signal with a large offset the moments have to
+ * stay as close to a double precision reference as on the same signal
+ * without the offset.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+
+using namespace ei;
+
+/* Constant defines -------------------------------------------------------- */
+#define LARGE_OFFSET        10000.0f
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t random_state = 1;
+
+/* Private types ----------------------------------------------------------- */
+typedef struct {
+    double mean;
+    double variance;
+    double skewness;
+    double kurtosis;
+} reference_t;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static float random_sample(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return (float)(random_state >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+/**
+ * @brief      Skewed signal: a tone, noise and one sided spikes
+ */
+static void make_signal(float *out, size_t size, float offset)
+{
+    for (size_t ix = 0; ix < size; ix++) {
+        float v = sinf(0.3f * ix) + 0.5f * random_sample();
+        if (ix % 7 == 3) {
+            v += 2.0f;
+        }
+        out[ix] = offset + v;
+    }
+}
+
+/**
+ * @brief      Central moments in double, two pass
+ */
+static reference_t reference_moments(const float *src, size_t size)
+{
+    reference_t ref;
+    double sum = 0.0;
+    for (size_t ix = 0; ix < size; ix++) {
+        sum += src[ix];
+    }
+    ref.mean = sum / size;
+
+    double m_2 = 0.0, m_3 = 0.0, m_4 = 0.0;
+    for (size_t ix = 0; ix < size; ix++) {
+        double d = src[ix] - ref.mean;
+        m_2 += d * d;
+        m_3 += d * d * d;
+        m_4 += d * d * d * d;
+    }
+    ref.variance = m_2 / size;
+    ref.skewness = ref.variance == 0.0 ? 0.0 : (m_3 / size) / pow(ref.variance, 1.5);
+    ref.kurtosis = ref.variance == 0.0 ? -3.0 : (m_4 / size) / (ref.variance * ref.variance) - 3.0;
+    return ref;
+}
+
+/**
+ * @brief      moments() of a matrix against the per row numpy functions
+ */
+static void check_against_numpy(size_t rows, size_t cols)
+{
+    matrix_t input(rows, cols);
+    matrix_t mean(rows, 1), stdev(rows, 1), skew(rows, 1), kurtosis(rows, 1);
+    matrix_t rms(rows, 1), min(rows, 1), max(rows, 1);
+    std::vector<moments_t> moments(rows);
+    char what[64];
+
+    for (size_t row = 0; row < rows; row++) {
+        make_signal(input.buffer + row * cols, cols, (float)row - 1.0f);
+    }
+
+    TEST_CHECK(numpy::moments(&input, moments.data()) == EIDSP_OK, "moments failed");
+    numpy::mean(&input, &mean);
+    numpy::stdev(&input, &stdev);
+    numpy::skew(&input, &skew);
+    numpy::kurtosis(&input, &kurtosis);
+    numpy::rms(&input, &rms);
+    numpy::min(&input, &min);
+    numpy::max(&input, &max);
+
+    for (size_t row = 0; row < rows; row++) {
+        const moments_t &m = moments[row];
+        snprintf(what, sizeof(what), "cols %d row %d", (int)cols, (int)row);
+
+        TEST_CHECK(fabsf(m.mean - mean.buffer[row]) <= 1e-5f * (1.0f + fabsf(mean.buffer[row])),
+            "%s: mean %g vs %g", what, m.mean, mean.buffer[row]);
+        TEST_CHECK(fabsf(sqrtf(m.variance) - stdev.buffer[row]) <= 1e-4f * (1e-3f + stdev.buffer[row]),
+            "%s: stdev %g vs %g", what, sqrtf(m.variance), stdev.buffer[row]);
+        TEST_CHECK(fabsf(m.skewness - skew.buffer[row]) <= 1e-3f,
+            "%s: skew %g vs %g", what, m.skewness, skew.buffer[row]);
+        TEST_CHECK(fabsf(m.kurtosis - kurtosis.buffer[row]) <= 1e-3f,
+            "%s: kurtosis %g vs %g", what, m.kurtosis, kurtosis.buffer[row]);
+        TEST_CHECK(fabsf(m.rms - rms.buffer[row]) <= 1e-5f * (1.0f + rms.buffer[row]),
+            "%s: rms %g vs %g", what, m.rms, rms.buffer[row]);
+        TEST_CHECK(m.min == min.buffer[row] && m.max == max.buffer[row],
+            "%s: min/max %g/%g vs %g/%g", what, m.min, m.max, min.buffer[row], max.buffer[row]);
+        float peak = fmaxf(-m.min, m.max);
+        TEST_CHECK_NEAR(m.crest_factor, peak / m.rms, 1e-5 * (peak / m.rms), "crest factor");
+    }
+}
+
+/**
+ * @brief      The same signal with and without a large offset, against the
+ *             double reference
+ */
+static void check_large_offset(size_t size)
+{
+    std::vector<float> plain(size);
+    std::vector<float> offset(size);
+    moments_t m_plain, m_offset;
+    char what[64];
+
+    make_signal(plain.data(), size, 0.0f);
+    for (size_t ix = 0; ix < size; ix++) {
+        offset[ix] = plain[ix] + LARGE_OFFSET;
+    }
+    // the offset signal is rounded to the float grid around LARGE_OFFSET, compare with its own reference
+    reference_t ref = reference_moments(offset.data(), size);
+    numpy::moments_row(plain.data(), size, &m_plain);
+    numpy::moments_row(offset.data(), size, &m_offset);
+    snprintf(what, sizeof(what), "offset, size %d", (int)size);
+
+    TEST_CHECK(fabs(m_offset.mean - ref.mean) <= 1e-6 * LARGE_OFFSET,
+        "%s: mean %g vs %g", what, m_offset.mean, ref.mean);
+    TEST_CHECK(fabs(m_offset.variance - ref.variance) <= 1e-3 * ref.variance,
+        "%s: variance %g vs %g", what, m_offset.variance, ref.variance);
+    TEST_CHECK(fabs(m_offset.skewness - ref.skewness) <= 1e-3,
+        "%s: skewness %g vs %g", what, m_offset.skewness, ref.skewness);
+    TEST_CHECK(fabs(m_offset.kurtosis - ref.kurtosis) <= 1e-3,
+        "%s: kurtosis %g vs %g", what, m_offset.kurtosis, ref.kurtosis);
+
+    // the shape of the signal does not change with the offset
+    TEST_CHECK(fabsf(m_offset.variance - m_plain.variance) <= 1e-3f * m_plain.variance,
+        "%s: variance %g, %g without offset", what, m_offset.variance, m_plain.variance);
+    TEST_CHECK(fabsf(m_offset.skewness - m_plain.skewness) <= 1e-2f,
+        "%s: skewness %g, %g without offset", what, m_offset.skewness, m_plain.skewness);
+    TEST_CHECK(fabsf(m_offset.kurtosis - m_plain.kurtosis) <= 1e-2f,
+        "%s: kurtosis %g, %g without offset", what, m_offset.kurtosis, m_plain.kurtosis);
+
+    // sum(x^2) / n - mean^2 in float cancels on this signal
+    float sum = 0.0f, sum_sq = 0.0f;
+    for (size_t ix = 0; ix < size; ix++) {
+        sum += offset[ix];
+        sum_sq += offset[ix] * offset[ix];
+    }
+    float naive = sum_sq / size - (sum / size) * (sum / size);
+    TEST_CHECK(fabs(naive - ref.variance) > 0.1 * ref.variance, "%s: naive variance %g is accurate", what, naive);
+}
+
+/**
+ * @brief      Constant rows: no spread, skewness 0, kurtosis -3
+ */
+static void check_constant(size_t size)
+{
+    std::vector<float> src(size, 3.5f);
+    moments_t m;
+
+    numpy::moments_row(src.data(), size, &m);
+    TEST_CHECK(m.mean == 3.5f && m.variance == 0.0f, "constant %d: mean %g variance %g", (int)size, m.mean, m.variance);
+    TEST_CHECK(m.skewness == 0.0f && m.kurtosis == -3.0f, "constant %d: skewness %g kurtosis %g",
+        (int)size, m.skewness, m.kurtosis);
+    TEST_CHECK(m.crest_factor == 1.0f, "constant %d: crest factor %g", (int)size, m.crest_factor);
+}
+
+int main(void)
+{
+    // around the unrolling and the block size
+    static const size_t sizes[] = {
+        1, 2, 3, 4, 5, 7, 8,
+        EIDSP_MOMENTS_BLOCK - 1, EIDSP_MOMENTS_BLOCK, EIDSP_MOMENTS_BLOCK + 1,
+        EIDSP_MOMENTS_BLOCK + 3, 2 * EIDSP_MOMENTS_BLOCK, 2 * EIDSP_MOMENTS_BLOCK + 5,
+        100, 257, 1000, 4099
+    };
+
+    for (size_t ix = 0; ix < sizeof(sizes) / sizeof(sizes[0]); ix++) {
+        check_against_numpy(3, sizes[ix]);
+        check_constant(sizes[ix]);
+        if (sizes[ix] >= 8) {
+            check_large_offset(sizes[ix]);
+        }
+    }
+
+    matrix_t empty(1, 0);
+    moments_t m;
+    TEST_CHECK(numpy::moments(&empty, &m) == EIDSP_MATRIX_SIZE_MISMATCH, "empty row accepted");
+
+    return test_result("test_moments");
+}
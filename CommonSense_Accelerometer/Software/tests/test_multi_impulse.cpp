@@ -0,0 +1,122 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Two compiled models in one application: the model in tflite-model/ and a
+ * second copy of it exported as second_model_* (compiled with
+ * -DEI_TRAINED_MODEL_PREFIX=second_model). Both are registered on one
+ * multi-impulse runtime, their shared DSP block has to run once and both have
+ * to classify like run_classifier(). A block of another implementation
+ * version must not be shared.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "test.h"
+#include "edge-impulse-sdk/classifier/ei_run_multi_impulse.h"
+
+/* Extern reference -------------------------------------------------------- */
+TfLiteStatus second_model_init(void*(*alloc_fnc)(size_t,size_t));
+TfLiteTensor *second_model_input(int index);
+TfLiteTensor *second_model_output(int index);
+TfLiteStatus second_model_invoke();
+TfLiteStatus second_model_reset(void (*free_fnc)(void* ptr));
+
+/* Private variables ------------------------------------------------------- */
+static float window[EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE];
+
+static const ei_impulse_model_t second_model = {
+    "second",
+    ei_dsp_blocks,
+    ei_dsp_blocks_size,
+    EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,
+    EI_CLASSIFIER_FREQUENCY,
+    EI_CLASSIFIER_NN_INPUT_FRAME_SIZE,
+    &second_model_init,
+    &second_model_input,
+    &second_model_output,
+    &second_model_invoke,
+    &second_model_reset,
+    ei_classifier_inferencing_categories,
+    EI_CLASSIFIER_LABEL_COUNT,
+    NULL,
+};
+
+int main(void)
+{
+    for (size_t ix = 0; ix < EI_CLASSIFIER_RAW_SAMPLE_COUNT; ix++) {
+        window[ix * 3 + 0] = sinf(ix * 0.3f) * 3.0f + 0.1f * ix;
+        window[ix * 3 + 1] = cosf(ix * 0.77f) * 2.0f;
+        window[ix * 3 + 2] = 9.8f + sinf(ix * 1.9f);
+    }
+
+    signal_t signal;
+    numpy::signal_from_buffer(window, EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE, &signal);
+
+    ei_impulse_result_t reference;
+    TEST_CHECK(run_classifier(&signal, &reference, false) == EI_IMPULSE_OK, "run_classifier");
+
+    ei_multi_impulse_t runtime;
+    ei_multi_impulse_init(&runtime);
+    TEST_CHECK(ei_multi_impulse_register(&runtime, ei_multi_impulse_default_model()) == EI_IMPULSE_OK, "register default");
+    TEST_CHECK(ei_multi_impulse_register(&runtime, &second_model) == EI_IMPULSE_OK, "register second");
+    TEST_CHECK(runtime.dsp_size == 1, "%d unique DSP blocks", (int)runtime.dsp_size);
+    TEST_CHECK(runtime.features_size == EI_CLASSIFIER_NN_INPUT_FRAME_SIZE, "%d shared features", (int)runtime.features_size);
+
+    ei_multi_impulse_result_t results[2];
+    TEST_CHECK(run_multi_impulse(&runtime, &signal, results) == EI_IMPULSE_OK, "run_multi_impulse");
+
+    for (size_t model_ix = 0; model_ix < 2; model_ix++) {
+        TEST_CHECK(results[model_ix].label_count == EI_CLASSIFIER_LABEL_COUNT, "label count");
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            TEST_CHECK(strcmp(results[model_ix].classification[ix].label, reference.classification[ix].label) == 0,
+                "label %s", results[model_ix].classification[ix].label);
+            TEST_CHECK_NEAR(results[model_ix].classification[ix].value, reference.classification[ix].value, 1e-6,
+                reference.classification[ix].label);
+        }
+    }
+
+    // same config by value at another address is shared, another implementation version is not
+    ei_dsp_config_spectral_analysis_t config_copy = *(const ei_dsp_config_spectral_analysis_t*)ei_dsp_blocks[0].config;
+    ei_model_dsp_t block_copy = ei_dsp_blocks[0];
+    block_copy.config = &config_copy;
+
+    ei_impulse_model_t copy_model = second_model;
+    copy_model.name = "copy";
+    copy_model.dsp_blocks = &block_copy;
+    copy_model.dsp_blocks_size = 1;
+    TEST_CHECK(ei_multi_impulse_register(&runtime, &copy_model) == EI_IMPULSE_OK, "register copy");
+    TEST_CHECK(runtime.dsp_size == 1, "copy of the config: %d unique DSP blocks", (int)runtime.dsp_size);
+
+    ei_dsp_config_spectral_analysis_t config_version = config_copy;
+    config_version.implementation_version++;
+    ei_model_dsp_t block_version = ei_dsp_blocks[0];
+    block_version.config = &config_version;
+
+    ei_impulse_model_t version_model = copy_model;
+    version_model.name = "version";
+    version_model.dsp_blocks = &block_version;
+    TEST_CHECK(ei_multi_impulse_register(&runtime, &version_model) == EI_IMPULSE_OK, "register version");
+    TEST_CHECK(runtime.dsp_size == 2, "other version: %d unique DSP blocks", (int)runtime.dsp_size);
+
+    return test_result("test_multi_impulse");
+}
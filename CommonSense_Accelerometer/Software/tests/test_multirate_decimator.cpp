@@ -0,0 +1,125 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Anti-aliasing of spectral::multirate_decimator: a tone that would alias
+ * into the passband of an output has to be attenuated for composite ratios
+ * as well as for ratios with a prime factor above
+ * EIDSP_DECIMATOR_MAX_STAGE_RATIO, which run as one longer stage. Ratios
+ * that would need more than 255 taps are rejected.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/spectral/decimator.hpp"
+
+/* Constant defines -------------------------------------------------------- */
+#define FREQUENCY           6667.0f
+#define AMPLITUDE           10000.0
+/* Output frames per tone, the first ones are skipped while the filters settle */
+#define OUTPUT_FRAMES       400
+#define SETTLE_FRAMES       100
+#define SWEEP_TONES         200
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Peak output amplitude of a tone, relative to its input
+ *             amplitude, or -1 if the decimator rejects the ratio
+ */
+static double tone_gain(uint16_t ratio, double frequency, uint8_t filter_size = 31)
+{
+    ei::spectral::multirate_decimator decimator;
+
+    if (decimator.init(FREQUENCY, 1, &ratio, 1, filter_size) != ei::EIDSP_OK) {
+        return -1.0;
+    }
+
+    size_t frames = (size_t)ratio * OUTPUT_FRAMES;
+    std::vector<EIDSP_i16> input(frames);
+    std::vector<EIDSP_i16> output(decimator.get_max_output_frames(frames, 0));
+    EIDSP_i16 *dest = output.data();
+    size_t out_frames = 0;
+
+    for (size_t ix = 0; ix < frames; ix++) {
+        input[ix] = (EIDSP_i16)lrint(AMPLITUDE * sin(2.0 * M_PI * frequency * ix / FREQUENCY));
+    }
+    decimator.process(input.data(), frames, &dest, &out_frames);
+
+    double peak = 0.0;
+    for (size_t ix = SETTLE_FRAMES; ix < out_frames; ix++) {
+        peak = fmax(peak, fabs((double)output[ix]));
+    }
+
+    return peak / AMPLITUDE;
+}
+
+/**
+ * @brief      Largest gain of the tones between from_nyquist times the output
+ *             Nyquist frequency and the input Nyquist frequency
+ */
+static double worst_alias(uint16_t ratio, double from_nyquist)
+{
+    double nyquist = FREQUENCY / ratio / 2.0;
+    double worst = 0.0;
+
+    for (int tone = 0; tone < SWEEP_TONES; tone++) {
+        double frequency = from_nyquist * nyquist +
+            (FREQUENCY / 2.0 - from_nyquist * nyquist) * tone / (SWEEP_TONES - 1);
+        worst = fmax(worst, tone_gain(ratio, frequency));
+    }
+
+    return worst;
+}
+
+int main(void)
+{
+    // 8 and 64 are native stages, 53 and 106 = 2 x 53 need a long stage
+    const uint16_t ratios[] = { 8, 53, 64, 100, 105, 106 };
+
+    for (size_t ix = 0; ix < sizeof(ratios) / sizeof(ratios[0]); ix++) {
+        uint16_t ratio = ratios[ix];
+        double nyquist = FREQUENCY / ratio / 2.0;
+
+        double pass = tone_gain(ratio, 0.4 * nyquist);
+        // tones from 1.2 x Nyquist alias into the passband (cutoff 0.8 x Nyquist)
+        double edge = worst_alias(ratio, 1.2);
+        // from 1.5 x Nyquist into its lower half
+        double deep = worst_alias(ratio, 1.5);
+
+        TEST_CHECK(pass >= 0.8, "ratio %u: passband gain %.4f", ratio, pass);
+        TEST_CHECK(edge <= 0.16, "ratio %u: alias gain %.4f near the cutoff", ratio, edge);
+        TEST_CHECK(deep <= 0.03, "ratio %u: alias gain %.4f", ratio, deep);
+    }
+
+    // a tone that used to pass a single 31 tap stage almost unfiltered
+    TEST_CHECK(tone_gain(106, 78.6) <= 0.01, "ratio 106: 78.6 Hz aliased");
+
+    // 107 and 127 are prime, 31 taps would scale past 255
+    TEST_CHECK(tone_gain(107, 155.8) < 0.0, "ratio 107 accepted with 31 taps");
+    TEST_CHECK(tone_gain(127, 155.8) < 0.0, "ratio 127 accepted with 31 taps");
+    double short_taps = tone_gain(107, 155.8, 15);
+    TEST_CHECK(short_taps >= 0.0 && short_taps <= 0.01, "ratio 107, 15 taps: 155.8 Hz gain %.4f", short_taps);
+
+    return test_result("test_multirate_decimator");
+}
@@ -0,0 +1,132 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Computed order tracking (spectral::order_tracker) at a known speed: orders
+ * of the shaft have to come out at their amplitude, a tone above the output
+ * Nyquist frequency must not alias into the order spectrum, and an offset
+ * must stay constant while the speed, and with it the anti-alias filter,
+ * changes.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/spectral/order_tracking.hpp"
+
+/* Constant defines -------------------------------------------------------- */
+#define FREQUENCY           1000.0f
+#define SAMPLES_PER_REV     32
+#define RPM                 600.0f
+#define INPUT_FRAMES        20000
+/* Output samples skipped while the filter settles, and the analysed window */
+#define SETTLE_SAMPLES      (8 * SAMPLES_PER_REV)
+#define WINDOW_REVS         16
+#define WINDOW_SAMPLES      (WINDOW_REVS * SAMPLES_PER_REV)
+/* Vibration at order 3, and a tone at 250 Hz that aliases to order 7 */
+#define ORDER               3
+#define ORDER_AMPLITUDE     0.5
+#define TONE_HZ             250.0
+#define ALIAS_ORDER         7
+#define OFFSET              1.0
+
+/* Private functions ------------------------------------------------------- */
+static void init_tracker(ei::spectral::order_tracker *tracker, uint16_t axes)
+{
+    ei::spectral::order_tracker_config_t config;
+
+    config.sampling_freq = FREQUENCY;
+    config.axes = axes;
+    config.samples_per_revolution = SAMPLES_PER_REV;
+    config.pulses_per_revolution = 1.0f;
+    config.min_rpm = 60.0f;
+    config.max_rpm = 3000.0f;
+    config.speed_smoothing = 1.0f;
+    config.hysteresis = 0.1f;
+
+    TEST_CHECK(tracker->init(&config) == ei::EIDSP_OK, "init");
+}
+
+/**
+ * @brief      Amplitude of an order in a window of whole revolutions
+ */
+static double order_amplitude(const float *angular, double order)
+{
+    double re = 0.0, im = 0.0;
+
+    for (size_t ix = 0; ix < WINDOW_SAMPLES; ix++) {
+        double phase = 2.0 * M_PI * order * ix / SAMPLES_PER_REV;
+        re += angular[ix] * cos(phase);
+        im += angular[ix] * sin(phase);
+    }
+
+    return (order == 0.0 ? 1.0 : 2.0) * sqrt(re * re + im * im) / WINDOW_SAMPLES;
+}
+
+int main(void)
+{
+    ei::spectral::order_tracker tracker;
+    std::vector<float> angular;
+    float output[16];
+    size_t output_frames;
+
+    init_tracker(&tracker, 1);
+    tracker.set_rpm(RPM);
+    TEST_CHECK(tracker.get_max_output_frames() <= sizeof(output) / sizeof(output[0]), "output buffer");
+
+    for (size_t ix = 0; ix < INPUT_FRAMES; ix++) {
+        double t = ix / FREQUENCY;
+        float frame = (float)(OFFSET +
+            ORDER_AMPLITUDE * sin(2.0 * M_PI * ORDER * RPM / 60.0 * t) +
+            sin(2.0 * M_PI * TONE_HZ * t));
+
+        TEST_CHECK(tracker.push(&frame, output, &output_frames) == ei::EIDSP_OK, "push %u", (unsigned)ix);
+        angular.insert(angular.end(), output, output + output_frames);
+    }
+
+    TEST_CHECK(angular.size() >= SETTLE_SAMPLES + WINDOW_SAMPLES, "%u angular samples", (unsigned)angular.size());
+
+    for (size_t start = SETTLE_SAMPLES; start + WINDOW_SAMPLES <= angular.size(); start += WINDOW_SAMPLES) {
+        const float *window = &angular[start];
+        TEST_CHECK_NEAR(order_amplitude(window, 0), OFFSET, 0.01, "offset");
+        TEST_CHECK_NEAR(order_amplitude(window, ORDER), ORDER_AMPLITUDE, 0.02, "order amplitude");
+        double alias = order_amplitude(window, ALIAS_ORDER);
+        TEST_CHECK(alias <= 0.02, "250 Hz tone at order %d: %.4f", ALIAS_ORDER, alias);
+    }
+
+    // an offset only, the speed and the filter change every 100 ms
+    init_tracker(&tracker, 1);
+    double worst = 0.0;
+    for (size_t ix = 0; ix < INPUT_FRAMES; ix++) {
+        float frame = (float)OFFSET;
+        if (ix % 100 == 0) {
+            tracker.set_rpm((ix / 100) % 2 ? RPM : 1.1f * RPM);
+        }
+        tracker.push(&frame, output, &output_frames);
+        for (size_t out = 0; out < output_frames; out++) {
+            worst = fmax(worst, fabs(output[out] - OFFSET));
+        }
+    }
+    TEST_CHECK(worst <= 1e-4, "offset moves by %g while the speed changes", worst);
+
+    return test_result("test_order_tracker");
+}
@@ -0,0 +1,165 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * PDM to PCM decimation of the MP34DT05 capture path on synthetic bitstreams.
+ * A second order sigma-delta modulator running at the 1.024 MHz PDM clock
+ * encodes test signals, which must decode to the right amplitude with a
+ * clean spectrum, independently of how the stream is split into blocks.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include <stdlib.h>
+#include "test.h"
+#include "PdmDecimator.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define PDM_RATE            1024000
+#define PCM_RATE            (PDM_RATE / PDM_DECIMATOR_DECIMATION)
+#define PCM_SAMPLES         4096
+#define PDM_WORDS           (PCM_SAMPLES * PDM_DECIMATOR_FIR_DECIMATION)
+/* Samples skipped at the start, lets the filters and DC blocker settle */
+#define SETTLE_SAMPLES      1024
+#define TONE_HZ             1000.0
+#define FULL_SCALE          32768.0
+
+/**
+ * @brief      Second order sigma-delta modulator, packs bits MSB first
+ * @param      amplitude  tone amplitude, 1.0 is full scale
+ * @param      offset     DC offset added to the tone
+ */
+static void modulate(double amplitude, double offset, uint16_t *pdm, size_t words)
+{
+    double i1 = 0.0, i2 = 0.0, y = 0.0;
+
+    for (size_t w = 0; w < words; w++) {
+        uint16_t word = 0;
+        for (int bit = 0; bit < 16; bit++) {
+            double t = (double)(w * 16 + bit) / PDM_RATE;
+            double x = offset + amplitude * sin(2.0 * M_PI * TONE_HZ * t);
+            i1 += x - y;
+            i2 += i1 - y;
+            y = (i2 >= 0.0) ? 1.0 : -1.0;
+            word = (uint16_t)((word << 1) | (y > 0.0 ? 1 : 0));
+        }
+        pdm[w] = word;
+    }
+}
+
+/**
+ * @brief      Least squares fit of the test tone, returns its amplitude and
+ *             the SNR of the residual in dB
+ */
+static double fit_tone(const int16_t *pcm, size_t count, double *snr_db)
+{
+    double re = 0.0, im = 0.0, mean = 0.0;
+
+    for (size_t ix = 0; ix < count; ix++) {
+        double phase = 2.0 * M_PI * TONE_HZ * ix / PCM_RATE;
+        re += pcm[ix] * cos(phase);
+        im += pcm[ix] * sin(phase);
+        mean += pcm[ix];
+    }
+    re *= 2.0 / count;
+    im *= 2.0 / count;
+    mean /= count;
+
+    double signal = 0.0, noise = 0.0;
+    for (size_t ix = 0; ix < count; ix++) {
+        double phase = 2.0 * M_PI * TONE_HZ * ix / PCM_RATE;
+        double fit = mean + re * cos(phase) + im * sin(phase);
+        signal += (fit - mean) * (fit - mean);
+        noise += (pcm[ix] - fit) * (pcm[ix] - fit);
+    }
+
+    *snr_db = 10.0 * log10(signal / noise);
+    return sqrt(re * re + im * im);
+}
+
+static uint16_t pdm[PDM_WORDS];
+static int16_t pcm[PCM_SAMPLES + 1];
+static int16_t pcm_split[PCM_SAMPLES + 1];
+
+int main(void)
+{
+    PdmDecimator decimator;
+    double snr_db;
+
+    // -6 dBFS tone, the record length holds a whole number of periods
+    modulate(0.5, 0.0, pdm, PDM_WORDS);
+    size_t count = decimator.process(pdm, PDM_WORDS, pcm);
+    TEST_CHECK(count == PCM_SAMPLES, "%u samples", (unsigned)count);
+    double amplitude = fit_tone(&pcm[SETTLE_SAMPLES], PCM_SAMPLES - SETTLE_SAMPLES, &snr_db);
+    // gain 1 maps PDM full scale to 16 bit full scale
+    TEST_CHECK_NEAR(amplitude, 0.5 * FULL_SCALE, 0.02 * 0.5 * FULL_SCALE, "-6 dBFS amplitude");
+    TEST_CHECK(snr_db > 65.0, "SNR %.1f dB", snr_db);
+
+    // odd block sizes give the same stream as one block
+    decimator.reset();
+    size_t split = 0;
+    for (size_t offset = 0; offset < PDM_WORDS; ) {
+        size_t words = 1 + (size_t)(rand() % 300);
+        if (words > PDM_WORDS - offset) {
+            words = PDM_WORDS - offset;
+        }
+        split += decimator.process(&pdm[offset], words, &pcm_split[split]);
+        offset += words;
+    }
+    TEST_CHECK(split == count, "%u vs %u samples", (unsigned)split, (unsigned)count);
+    TEST_CHECK(memcmp(pcm, pcm_split, count * sizeof(int16_t)) == 0, "split output differs");
+
+    // gain doubles the amplitude per step
+    decimator.reset();
+    decimator.setGain(PDM_DECIMATOR_DEFAULT_GAIN + 1);
+    modulate(0.2, 0.0, pdm, PDM_WORDS);
+    decimator.process(pdm, PDM_WORDS, pcm);
+    amplitude = fit_tone(&pcm[SETTLE_SAMPLES], PCM_SAMPLES - SETTLE_SAMPLES, &snr_db);
+    TEST_CHECK_NEAR(amplitude, 2.0 * 0.2 * FULL_SCALE, 0.02 * 0.4 * FULL_SCALE, "gain 2 amplitude");
+    decimator.setGain(PDM_DECIMATOR_DEFAULT_GAIN);
+
+    // the microphone offset is removed by the DC blocker
+    decimator.reset();
+    modulate(0.1, 0.3, pdm, PDM_WORDS);
+    decimator.process(pdm, PDM_WORDS, pcm);
+    double mean = 0.0;
+    for (size_t ix = PCM_SAMPLES - 1024; ix < PCM_SAMPLES; ix++) {
+        mean += pcm[ix];
+    }
+    mean /= 1024;
+    TEST_CHECK(fabs(mean) < 0.01 * FULL_SCALE, "DC left after blocker %f", mean);
+
+    // alternating bits is silence
+    decimator.reset();
+    for (size_t ix = 0; ix < PDM_WORDS; ix++) {
+        pdm[ix] = 0x5555;
+    }
+    decimator.process(pdm, PDM_WORDS, pcm);
+    int16_t peak = 0;
+    for (size_t ix = 0; ix < PCM_SAMPLES; ix++) {
+        int16_t value = (int16_t)abs(pcm[ix]);
+        peak = value > peak ? value : peak;
+    }
+    TEST_CHECK(peak <= 1, "silence peak %d", peak);
+
+    return test_result("test_pdm_decimator");
+}
@@ -0,0 +1,389 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * spectral::psd_accumulator: the Welch estimate of a window has to match a
+ * double precision Welch (Hann, constant detrend, one-sided density, as
+ * scipy.signal.welch), the average has to be the plain mean for the first
+ * 1 / alpha windows and an EWMA after, band edges have to select the bins
+ * in [low, high), and the trend ring has to wrap and return the right
+ * slopes. A tone drifting by a fixed step per window has to show up as that
+ * peak drift, with the band power of the sine.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/spectral/psd_accumulator.hpp"
+
+using namespace ei;
+using namespace ei::spectral;
+
+/* Constant defines -------------------------------------------------------- */
+#define SAMPLING_FREQ       100.0f
+#define N_FFT               256
+#define BINS                (N_FFT / 2 + 1)
+#define WINDOW_SIZE         1024
+/* Drifting tone */
+#define TONE_FREQ           10.0
+#define TONE_AMPLITUDE      2.0
+#define TONE_DRIFT          0.01
+#define DRIFT_WINDOWS       400
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t random_state = 1;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static float random_sample(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return (float)(random_state >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+static psd_accumulator_config_t make_config(float alpha, uint16_t trend_length, uint32_t trend_interval)
+{
+    psd_accumulator_config_t config;
+
+    config.sampling_freq = SAMPLING_FREQ;
+    config.n_fft = N_FFT;
+    config.overlap = N_FFT / 2;
+    config.alpha = alpha;
+    config.trend_length = trend_length;
+    config.trend_interval = trend_interval;
+    config.trend_low_freq = 0.0f;
+    config.trend_high_freq = 0.0f;
+    return config;
+}
+
+/**
+ * @brief      Welch PSD in double: periodic Hann, constant detrend per
+ *             segment, one-sided density
+ */
+static void reference_welch(const float *input, size_t input_size, size_t overlap, double *psd)
+{
+    double window[N_FFT];
+    double window_power = 0.0;
+    size_t segments = 0;
+
+    for (size_t ix = 0; ix < N_FFT; ix++) {
+        window[ix] = 0.5 - 0.5 * cos(2.0 * M_PI * ix / N_FFT);
+        window_power += window[ix] * window[ix];
+    }
+    for (size_t k = 0; k < BINS; k++) {
+        psd[k] = 0.0;
+    }
+
+    for (size_t start = 0; start + N_FFT <= input_size; start += N_FFT - overlap) {
+        double mean = 0.0;
+        for (size_t ix = 0; ix < N_FFT; ix++) {
+            mean += input[start + ix];
+        }
+        mean /= N_FFT;
+
+        for (size_t k = 0; k < BINS; k++) {
+            double re = 0.0, im = 0.0;
+            for (size_t ix = 0; ix < N_FFT; ix++) {
+                double v = (input[start + ix] - mean) * window[ix];
+                double phase = -2.0 * M_PI * (double)((k * ix) % N_FFT) / N_FFT;
+                re += v * cos(phase);
+                im += v * sin(phase);
+            }
+            psd[k] += re * re + im * im;
+        }
+        segments++;
+    }
+
+    for (size_t k = 0; k < BINS; k++) {
+        double scale = 1.0 / (SAMPLING_FREQ * window_power * segments);
+        psd[k] *= (k == 0 || k == BINS - 1) ? scale : 2.0 * scale;
+    }
+}
+
+/**
+ * @brief      First window against the double Welch, noise plus a tone
+ */
+static void check_welch(void)
+{
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(0.1f, 0, 1);
+    std::vector<float> input(WINDOW_SIZE + 100);
+    double expected[BINS];
+
+    for (size_t ix = 0; ix < input.size(); ix++) {
+        input[ix] = 3.0f + 0.5f * random_sample() + (float)(TONE_AMPLITUDE * sin(2.0 * M_PI * 7.3 * ix / SAMPLING_FREQ));
+    }
+
+    TEST_CHECK(accumulator.init(&config) == EIDSP_OK, "init failed");
+    // the last 100 samples do not fill a segment and are not used
+    TEST_CHECK(accumulator.add_window(input.data(), input.size()) == EIDSP_OK, "add_window failed");
+    reference_welch(input.data(), input.size(), N_FFT / 2, expected);
+
+    const float *psd = accumulator.get_psd();
+    double peak = 0.0;
+    for (size_t k = 0; k < BINS; k++) {
+        peak = fmax(peak, expected[k]);
+    }
+    double max_error = 0.0;
+    for (size_t k = 0; k < BINS; k++) {
+        max_error = fmax(max_error, fabs(psd[k] - expected[k]));
+    }
+    TEST_CHECK(max_error <= 1e-5 * peak, "welch: error %g, peak %g", max_error, peak);
+    TEST_CHECK(accumulator.get_bins() == BINS, "bins %d", (int)accumulator.get_bins());
+
+    // density: the sine power plus the noise power (uniform, 0.25 / 3)
+    TEST_CHECK_NEAR(accumulator.band_power(0.0f, 0.0f), TONE_AMPLITUDE * TONE_AMPLITUDE / 2 + 0.25 / 3,
+        0.05 * (TONE_AMPLITUDE * TONE_AMPLITUDE / 2), "total power");
+
+    // without overlap
+    config.overlap = 0;
+    TEST_CHECK(accumulator.init(&config) == EIDSP_OK, "init failed");
+    accumulator.add_window(input.data(), input.size());
+    reference_welch(input.data(), input.size(), 0, expected);
+    max_error = 0.0;
+    for (size_t k = 0; k < BINS; k++) {
+        max_error = fmax(max_error, fabs(accumulator.get_psd()[k] - expected[k]));
+    }
+    TEST_CHECK(max_error <= 1e-5 * peak, "welch without overlap: error %g", max_error);
+
+    TEST_CHECK(accumulator.add_window(input.data(), N_FFT - 1) == EIDSP_BUFFER_SIZE_MISMATCH,
+        "short window accepted");
+    config.n_fft = 100;
+    TEST_CHECK(accumulator.init(&config) == EIDSP_PARAMETER_INVALID, "n_fft 100 accepted");
+    float zeros[BINS] = { 0 };
+    TEST_CHECK(accumulator.add_psd(zeros, BINS) == EIDSP_NOT_SUPPORTED, "add_psd after a failed init");
+}
+
+/**
+ * @brief      Plain mean for the first 1 / alpha windows, EWMA after
+ */
+static void check_average(void)
+{
+    const float alpha = 0.25f;
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(alpha, 0, 1);
+    float psd[BINS];
+    double expected = 0.0;
+    int mismatches = 0;
+
+    accumulator.init(&config);
+
+    for (uint32_t window = 1; window <= 20; window++) {
+        float value = (float)((window * 7) % 11) + 1.0f;
+        for (size_t k = 0; k < BINS; k++) {
+            psd[k] = value * (k + 1);
+        }
+        accumulator.add_psd(psd, BINS);
+
+        double weight = window <= 4 ? 1.0 / window : alpha;
+        expected += weight * (value - expected);
+        for (size_t k = 0; k < BINS; k++) {
+            if (fabs(accumulator.get_psd()[k] - expected * (k + 1)) > 1e-5 * expected * (k + 1)) {
+                mismatches++;
+            }
+        }
+
+        // the plain mean of the first windows
+        if (window == 4) {
+            TEST_CHECK_NEAR(accumulator.get_psd()[0], (8 + 4 + 11 + 7) / 4.0, 1e-5, "mean of 4 windows");
+        }
+    }
+
+    TEST_CHECK(mismatches == 0, "%d bins differ from the mean / EWMA reference", mismatches);
+    TEST_CHECK(accumulator.get_windows() == 20, "windows %u", (unsigned)accumulator.get_windows());
+    TEST_CHECK(accumulator.add_psd(psd, BINS - 1) == EIDSP_BUFFER_SIZE_MISMATCH, "short PSD accepted");
+
+    accumulator.reset();
+    TEST_CHECK(accumulator.get_windows() == 0 && accumulator.get_psd()[5] == 0.0f, "reset kept the PSD");
+    accumulator.add_psd(psd, BINS);
+    TEST_CHECK(accumulator.get_psd()[5] == psd[5], "first window after reset is not taken as is");
+}
+
+/**
+ * @brief      Bins in [low, high), high 0 or past Nyquist is up to Nyquist
+ */
+static void check_band_bins(void)
+{
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(1.0f, 0, 1);
+    const float df = SAMPLING_FREQ / N_FFT;
+    float psd[BINS];
+
+    // bin k holds k + 1, so the sum tells which bins were used
+    for (size_t k = 0; k < BINS; k++) {
+        psd[k] = (float)(k + 1);
+    }
+    accumulator.init(&config);
+    accumulator.add_psd(psd, BINS);
+
+    struct {
+        float low;
+        float high;
+        size_t start;
+        size_t end;
+    } bands[] = {
+        { 2 * df, 5 * df, 2, 5 },               // edges on bins: low in, high out
+        { 2.5f * df, 5.5f * df, 3, 6 },         // edges between bins
+        { 2.5f * df, 2.7f * df, 3, 3 },         // no bin
+        { -1.0f, 3 * df, 0, 3 },                // below 0
+        { 10 * df, 0.0f, 10, BINS },            // up to and including Nyquist
+        { 10 * df, SAMPLING_FREQ / 2, 10, BINS - 1 },
+        { 10 * df, SAMPLING_FREQ, 10, BINS },   // past Nyquist
+    };
+
+    for (size_t ix = 0; ix < sizeof(bands) / sizeof(bands[0]); ix++) {
+        double expected = 0.0;
+        for (size_t k = bands[ix].start; k < bands[ix].end; k++) {
+            expected += k + 1;
+        }
+        float power = accumulator.band_power(bands[ix].low, bands[ix].high);
+        TEST_CHECK(fabs(power - expected * df) <= 1e-5 * (expected * df + 1.0),
+            "band %d [%g, %g): power %g, expected bins %d..%d (%g)", (int)ix, bands[ix].low, bands[ix].high,
+            power, (int)bands[ix].start, (int)bands[ix].end, expected * df);
+    }
+
+    float freq, power;
+    TEST_CHECK(accumulator.find_peak(2.5f * df, 2.7f * df, &freq, &power) == EIDSP_PARAMETER_INVALID,
+        "peak in a band without bins");
+    // rising PSD: the peak is the last bin of the band, no interpolation at the edge
+    TEST_CHECK(accumulator.find_peak(0.0f, 0.0f, &freq, &power) == EIDSP_OK, "find_peak failed");
+    TEST_CHECK_NEAR(freq, SAMPLING_FREQ / 2, 1e-4, "peak at Nyquist");
+    TEST_CHECK(power == (float)BINS, "peak power %g", power);
+}
+
+/**
+ * @brief      Gaussian interpolation of a peak between two bins
+ */
+static void check_peak(void)
+{
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(1.0f, 0, 1);
+    const float df = SAMPLING_FREQ / N_FFT;
+    float psd[BINS];
+    float freq, power;
+
+    for (size_t k = 0; k < BINS; k++) {
+        float d = (float)k - 20.3f;
+        psd[k] = 100.0f * expf(-d * d / 8.0f);
+    }
+    accumulator.init(&config);
+    TEST_CHECK(accumulator.find_peak(0.0f, 0.0f, &freq, &power) == EIDSP_NOT_SUPPORTED, "peak without windows");
+    accumulator.add_psd(psd, BINS);
+
+    TEST_CHECK(accumulator.find_peak(0.0f, 0.0f, &freq, &power) == EIDSP_OK, "find_peak failed");
+    TEST_CHECK_NEAR(freq, 20.3 * df, 1e-3 * df, "interpolated peak freq");
+    TEST_CHECK_NEAR(power, 100.0, 1e-3, "interpolated peak power");
+}
+
+/**
+ * @brief      Trend points every trend_interval windows, ring of trend_length
+ */
+static void check_trend(void)
+{
+    const uint16_t trend_length = 5;
+    const uint32_t trend_interval = 2;
+    const float df = SAMPLING_FREQ / N_FFT;
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(1.0f, trend_length, trend_interval);
+    psd_trend_point_t points[8];
+    float psd[BINS];
+
+    config.trend_low_freq = 10 * df;
+    config.trend_high_freq = 40 * df;
+    accumulator.init(&config);
+
+    TEST_CHECK(accumulator.get_trend(points, 8) == 0, "trend before the first point");
+    TEST_CHECK(accumulator.peak_drift() == 0.0f, "drift without points");
+
+    // a Gaussian peak moving 0.1 bin per window, on a level rising 0.5 per window
+    for (uint32_t window = 1; window <= 13; window++) {
+        float center = 20.0f + 0.1f * window;
+        for (size_t k = 0; k < BINS; k++) {
+            float d = (float)k - center;
+            psd[k] = 0.5f * window + 100.0f * expf(-d * d / 8.0f);
+        }
+        accumulator.add_psd(psd, BINS);
+
+        if (window == 2) {
+            TEST_CHECK(accumulator.get_trend(points, 8) == 1, "one point after %u windows", (unsigned)window);
+            TEST_CHECK(accumulator.peak_drift() == 0.0f, "drift from a single point");
+        }
+    }
+
+    // points at windows 2, 4, .. 12, the ring keeps the last five, oldest first
+    size_t count = accumulator.get_trend(points, 8);
+    TEST_CHECK(count == trend_length, "%d trend points", (int)count);
+    for (size_t ix = 0; ix < count; ix++) {
+        TEST_CHECK(points[ix].window == 4 + 2 * ix, "point %d at window %u", (int)ix, (unsigned)points[ix].window);
+    }
+    count = accumulator.get_trend(points, 3);
+    TEST_CHECK(count == 3 && points[0].window == 8 && points[2].window == 12,
+        "last 3 points: %d, windows %u..%u", (int)count, (unsigned)points[0].window, (unsigned)points[2].window);
+
+    // the level adds 0.5 * 30 bins * df per window, the Gaussian keeps its area
+    TEST_CHECK_NEAR(accumulator.band_power_drift(), 0.5 * 30 * df, 1e-3 * 0.5 * 30 * df, "band power drift");
+    // a Gaussian on a level is not exactly Gaussian, the interpolation is close
+    TEST_CHECK_NEAR(accumulator.peak_drift(), 0.1 * df, 0.02 * 0.1 * df, "peak drift");
+}
+
+/**
+ * @brief      A tone drifting TONE_DRIFT Hz per window, through add_window()
+ */
+static void check_drifting_tone(void)
+{
+    psd_accumulator accumulator;
+    psd_accumulator_config_t config = make_config(0.2f, 32, 10);
+    std::vector<float> input(WINDOW_SIZE);
+    double phase = 0.0;
+
+    config.trend_low_freq = 5.0f;
+    config.trend_high_freq = 20.0f;
+    accumulator.init(&config);
+
+    for (uint32_t window = 0; window < DRIFT_WINDOWS; window++) {
+        double freq = TONE_FREQ + TONE_DRIFT * window;
+        for (size_t ix = 0; ix < WINDOW_SIZE; ix++) {
+            input[ix] = (float)(TONE_AMPLITUDE * sin(phase));
+            phase += 2.0 * M_PI * freq / SAMPLING_FREQ;
+        }
+        accumulator.add_window(input.data(), WINDOW_SIZE);
+    }
+
+    TEST_CHECK_NEAR(accumulator.peak_drift(), TONE_DRIFT, 0.02 * TONE_DRIFT, "tone drift (Hz / window)");
+    TEST_CHECK_NEAR(accumulator.band_power(5.0f, 20.0f), TONE_AMPLITUDE * TONE_AMPLITUDE / 2,
+        1e-3 * TONE_AMPLITUDE * TONE_AMPLITUDE / 2, "tone band power");
+    TEST_CHECK(fabsf(accumulator.band_power_drift()) < 1e-4f, "band power drift %g", accumulator.band_power_drift());
+}
+
+int main(void)
+{
+    check_welch();
+    check_average();
+    check_band_bins();
+    check_peak();
+    check_trend();
+    check_drifting_tone();
+
+    return test_result("test_psd_accumulator");
+}
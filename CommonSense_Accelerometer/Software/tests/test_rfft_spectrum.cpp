@@ -0,0 +1,232 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * numpy::rfft_spectrum against a direct DFT: magnitude and power of every
+ * bin, with the scale, for power of two and mixed radix lengths, inputs
+ * shorter than n_fft (zero padded, also odd lengths) and longer (truncated).
+ * numpy::rfft, processing::periodogram and speechpy power_spectrum have to
+ * give the same result with a caller scratch buffer as with NULL, and stay
+ * inside rfft_scratch_size().
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/numpy.hpp"
+#include "edge-impulse-sdk/dsp/spectral/processing.hpp"
+#include "edge-impulse-sdk/dsp/speechpy/processing.hpp"
+
+using namespace ei;
+
+/* Constant defines -------------------------------------------------------- */
+#define SAMPLING_FREQ       100.0f
+/* Values after the scratch buffer that must not be written */
+#define GUARD_VALUES        16
+#define GUARD               12345.0f
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t random_state = 1;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static float random_sample(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return (float)(random_state >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+/**
+ * @brief      |X[k]|^2 of the first n samples of src, zero padded to n_fft
+ */
+static double dft_power(const float *src, size_t n, size_t n_fft, size_t k)
+{
+    double re = 0.0;
+    double im = 0.0;
+
+    for (size_t ix = 0; ix < n && ix < n_fft; ix++) {
+        double phase = -2.0 * M_PI * (double)((k * ix) % n_fft) / (double)n_fft;
+        re += src[ix] * cos(phase);
+        im += src[ix] * sin(phase);
+    }
+
+    return re * re + im * im;
+}
+
+/**
+ * @brief      rfft_spectrum() of one signal against the DFT, both types
+ */
+static void check_spectrum(size_t n_fft, size_t src_size)
+{
+    const size_t bins = n_fft / 2 + 1;
+    const float scale = 0.5f;
+    std::vector<float> src(src_size);
+    // garbage past src_size, rfft_spectrum has to pad with zeros
+    std::vector<float> fft_input(n_fft, 1000.0f);
+    std::vector<float> output(n_fft + 2);
+    char what[64];
+
+    for (size_t ix = 0; ix < src_size; ix++) {
+        src[ix] = random_sample();
+    }
+
+    // |X| is at most the sum of the samples
+    double tolerance = 1e-5 * (double)(src_size < n_fft ? src_size : n_fft);
+    double max_error_mag = 0.0;
+    double max_error_pow = 0.0;
+
+    memcpy(fft_input.data(), src.data(), (src_size < n_fft ? src_size : n_fft) * sizeof(float));
+    int ret = numpy::rfft_spectrum(fft_input.data(), src_size, output.data(), n_fft, rfft_magnitude, scale);
+    snprintf(what, sizeof(what), "magnitude n_fft %d src_size %d", (int)n_fft, (int)src_size);
+    TEST_CHECK(ret == EIDSP_OK, "%s returned %d", what, ret);
+    for (size_t k = 0; k < bins; k++) {
+        double expected = sqrt(dft_power(src.data(), src_size, n_fft, k)) * scale;
+        max_error_mag = fmax(max_error_mag, fabs(output[k] - expected));
+    }
+    TEST_CHECK(max_error_mag <= tolerance, "%s: error %g", what, max_error_mag);
+
+    memcpy(fft_input.data(), src.data(), (src_size < n_fft ? src_size : n_fft) * sizeof(float));
+    ret = numpy::rfft_spectrum(fft_input.data(), src_size, output.data(), n_fft, rfft_power, scale);
+    snprintf(what, sizeof(what), "power n_fft %d src_size %d", (int)n_fft, (int)src_size);
+    TEST_CHECK(ret == EIDSP_OK, "%s returned %d", what, ret);
+    for (size_t k = 0; k < bins; k++) {
+        double power = dft_power(src.data(), src_size, n_fft, k);
+        double expected = power * scale;
+        // relative to |X|, as the error of |X|^2 grows with |X|
+        max_error_pow = fmax(max_error_pow, fabs(output[k] - expected) / (2.0 * sqrt(power) + 1.0));
+    }
+    TEST_CHECK(max_error_pow <= tolerance, "%s: error %g", what, max_error_pow);
+}
+
+/**
+ * @brief      Fill the scratch buffer with garbage, followed by guard values
+ */
+static void fill_scratch(std::vector<float> &scratch, size_t n_fft)
+{
+    size_t size = numpy::rfft_scratch_size(n_fft);
+    scratch.assign(size + GUARD_VALUES, GUARD);
+    for (size_t ix = 0; ix < size; ix++) {
+        scratch[ix] = 1000.0f * random_sample();
+    }
+}
+
+static bool guard_intact(const std::vector<float> &scratch, size_t n_fft)
+{
+    for (size_t ix = numpy::rfft_scratch_size(n_fft); ix < scratch.size(); ix++) {
+        if (scratch[ix] != GUARD) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief      Callers of rfft_spectrum(), with and without caller scratch
+ */
+static void check_scratch(size_t n_fft, size_t src_size)
+{
+    const size_t bins = n_fft / 2 + 1;
+    std::vector<float> src(src_size);
+    std::vector<float> scratch;
+    char what[64];
+
+    for (size_t ix = 0; ix < src_size; ix++) {
+        src[ix] = random_sample();
+    }
+    std::vector<float> src_copy(src);
+    snprintf(what, sizeof(what), "n_fft %d src_size %d", (int)n_fft, (int)src_size);
+
+    // numpy::rfft, magnitude
+    std::vector<float> with_null(bins);
+    std::vector<float> with_scratch(bins);
+    fill_scratch(scratch, n_fft);
+    int ret = numpy::rfft(src.data(), src_size, with_null.data(), bins, n_fft);
+    TEST_CHECK(ret == EIDSP_OK, "rfft %s returned %d", what, ret);
+    ret = numpy::rfft(src.data(), src_size, with_scratch.data(), bins, n_fft, scratch.data());
+    TEST_CHECK(ret == EIDSP_OK, "rfft scratch %s returned %d", what, ret);
+    TEST_CHECK(with_null == with_scratch, "rfft %s: scratch and NULL differ", what);
+    TEST_CHECK(guard_intact(scratch, n_fft), "rfft %s: wrote past the scratch", what);
+    TEST_CHECK(src == src_copy, "rfft %s: changed its input", what);
+    double max_error = 0.0;
+    for (size_t k = 0; k < bins; k++) {
+        max_error = fmax(max_error, fabs(with_null[k] - sqrt(dft_power(src.data(), src_size, n_fft, k))));
+    }
+    TEST_CHECK(max_error <= 1e-5 * n_fft, "rfft %s: error %g", what, max_error);
+
+    // speechpy power spectrum, scaled by 1 / n_fft
+    fill_scratch(scratch, n_fft);
+    ret = speechpy::processing::power_spectrum(src.data(), src_size, with_null.data(), bins, n_fft);
+    TEST_CHECK(ret == EIDSP_OK, "power_spectrum %s returned %d", what, ret);
+    ret = speechpy::processing::power_spectrum(src.data(), src_size, with_scratch.data(), bins, n_fft,
+        scratch.data());
+    TEST_CHECK(ret == EIDSP_OK, "power_spectrum scratch %s returned %d", what, ret);
+    TEST_CHECK(with_null == with_scratch, "power_spectrum %s: scratch and NULL differ", what);
+    TEST_CHECK(guard_intact(scratch, n_fft), "power_spectrum %s: wrote past the scratch", what);
+    max_error = 0.0;
+    for (size_t k = 0; k < bins; k++) {
+        double power = dft_power(src.data(), src_size, n_fft, k);
+        max_error = fmax(max_error, fabs(with_null[k] - power / n_fft) / (2.0 * sqrt(power) + 1.0));
+    }
+    TEST_CHECK(max_error <= 1e-5 * n_fft, "power_spectrum %s: error %g", what, max_error);
+
+    // periodogram detrends its input in place, so every call gets a copy
+    matrix_t input_null(1, src_size);
+    matrix_t input_scratch(1, src_size);
+    memcpy(input_null.buffer, src.data(), src_size * sizeof(float));
+    memcpy(input_scratch.buffer, src.data(), src_size * sizeof(float));
+    matrix_t power_null(1, bins);
+    matrix_t power_scratch(1, bins);
+    matrix_t freqs(1, bins);
+    fill_scratch(scratch, n_fft);
+    ret = spectral::processing::periodogram(&input_null, &power_null, &freqs, SAMPLING_FREQ, n_fft);
+    TEST_CHECK(ret == EIDSP_OK, "periodogram %s returned %d", what, ret);
+    ret = spectral::processing::periodogram(&input_scratch, &power_scratch, &freqs, SAMPLING_FREQ, n_fft,
+        scratch.data());
+    TEST_CHECK(ret == EIDSP_OK, "periodogram scratch %s returned %d", what, ret);
+    TEST_CHECK(memcmp(power_null.buffer, power_scratch.buffer, bins * sizeof(float)) == 0,
+        "periodogram %s: scratch and NULL differ", what);
+    TEST_CHECK(guard_intact(scratch, n_fft), "periodogram %s: wrote past the scratch", what);
+}
+
+int main(void)
+{
+    static const size_t fft_lengths[] = { 16, 64, 100, 256 };
+
+    for (size_t ix = 0; ix < sizeof(fft_lengths) / sizeof(fft_lengths[0]); ix++) {
+        size_t n_fft = fft_lengths[ix];
+
+        // full, odd and zero padded, a single sample, truncated
+        check_spectrum(n_fft, n_fft);
+        check_spectrum(n_fft, n_fft - 1);
+        check_spectrum(n_fft, 37 % n_fft | 1);
+        check_spectrum(n_fft, 1);
+        check_spectrum(n_fft, n_fft + 13);
+
+        check_scratch(n_fft, n_fft);
+        check_scratch(n_fft, 37 % n_fft | 1);
+        check_scratch(n_fft, n_fft * 2 + 1);
+    }
+
+    return test_result("test_rfft_spectrum");
+}
@@ -0,0 +1,182 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Duty cycle of the inference scheduler on its virtual clock
+ * (ei_scheduler_simulate), against the time the CPU is known to be busy:
+ * reading samples, classifying and busy-waiting the sleep guard before every
+ * deadline. Also checks the motion wake condition, and that no sample is late
+ * when sleeps wake on an OS tick, as NuttX usleep() does.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include "test.h"
+#include "ei_scheduler.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define WINDOWS             20
+#define SAMPLES             63
+#define SAMPLE_INTERVAL_US  16000
+#define SAMPLE_READ_US      200
+#define INFERENCE_US        3000
+/** CONFIG_USEC_PER_TICK of the exported NuttX config */
+#define TICK_US             10000
+
+/* Private variables ------------------------------------------------------- */
+static uint64_t tick_clock_us;
+
+static uint64_t tick_now_us(void)
+{
+    return tick_clock_us++;
+}
+
+/**
+ * @brief      Wake on the tick interrupt that ends the requested time, which is
+ *             up to one tick after (or before) now + us
+ */
+static void tick_sleep_us(uint32_t us)
+{
+    uint64_t ticks = (us + TICK_US - 1) / TICK_US;
+    tick_clock_us = (tick_clock_us / TICK_US + ticks) * TICK_US;
+}
+
+static void tick_set_low_clock(bool low)
+{
+    (void)low;
+}
+
+static bool tick_stop_requested(void)
+{
+    return false;
+}
+
+/**
+ * @brief      Run windows on the tick quantised clock
+ *
+ * @return     Number of late windows and samples
+ */
+static uint32_t run_on_ticks(const ei_scheduler_config_t *config)
+{
+    ei_scheduler_hal_t hal = { &tick_now_us, &tick_sleep_us, &tick_set_low_clock, &tick_stop_requested };
+
+    tick_clock_us = 3456;
+    ei_scheduler_init(config, &hal);
+    for (uint32_t w = 0; w < WINDOWS; w++) {
+        ei_scheduler_wait_window();
+        for (uint32_t s = 0; s < SAMPLES; s++) {
+            ei_scheduler_wait_sample();
+            tick_clock_us += SAMPLE_READ_US;
+        }
+        tick_clock_us += INFERENCE_US;
+    }
+
+    ei_scheduler_stats_t stats;
+    ei_scheduler_get_stats(&stats);
+    return stats.late;
+}
+
+/**
+ * @brief      The first sample of a window is read right away, every other
+ *             sample and every window after the first busy-wait the guard.
+ *             The run ends with the inference of the last window.
+ */
+static float expected_duty_cycle(const ei_scheduler_config_t *config)
+{
+    float guard_us = (float)config->sleep_guard_us;
+    float window_busy_us = SAMPLES * SAMPLE_READ_US + INFERENCE_US + (SAMPLES - 1) * guard_us;
+    float busy_us = WINDOWS * window_busy_us + (WINDOWS - 1) * guard_us;
+    float elapsed_us = (WINDOWS - 1) * config->window_interval_ms * 1000.0f +
+        (SAMPLES - 1) * (float)config->sample_interval_us + SAMPLE_READ_US + INFERENCE_US;
+    return busy_us / elapsed_us;
+}
+
+int main(void)
+{
+    ei_scheduler_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.window_interval_ms = 5000;
+    config.sample_interval_us = SAMPLE_INTERVAL_US;
+
+    const uint32_t guards_us[] = { 0, 500, 2000 };
+    for (size_t ix = 0; ix < sizeof(guards_us) / sizeof(guards_us[0]); ix++) {
+        config.sleep_guard_us = guards_us[ix];
+        float duty_cycle = ei_scheduler_simulate(&config, WINDOWS, SAMPLES, SAMPLE_READ_US, INFERENCE_US);
+        float expected = expected_duty_cycle(&config);
+        // + every poll of the virtual clock costs 1 us
+        TEST_CHECK(fabsf(duty_cycle - expected) < 0.005f * expected + 0.0001f,
+            "guard %u us: duty cycle %f, expected %f", (unsigned)guards_us[ix], duty_cycle, expected);
+    }
+
+    // back to back windows never sleep
+    config.window_interval_ms = 0;
+    config.sample_interval_us = SAMPLE_READ_US;
+    config.sleep_guard_us = 2000;
+    float duty_cycle = ei_scheduler_simulate(&config, WINDOWS, SAMPLES, SAMPLE_READ_US, INFERENCE_US);
+    TEST_CHECK(duty_cycle > 0.99f, "back to back: duty cycle %f", duty_cycle);
+
+    // back to back windows and the first sample of a window have no deadline to miss
+    config.sample_interval_us = SAMPLE_INTERVAL_US;
+    config.sleep_guard_us = TICK_US + 2000;
+    uint32_t late = run_on_ticks(&config);
+    TEST_CHECK(late == 0, "back to back: %u late", (unsigned)late);
+
+    // sleeps that wake on a tick overshoot a guard below one tick
+    config.window_interval_ms = 5000;
+    config.sleep_guard_us = 2000;
+    late = run_on_ticks(&config);
+    TEST_CHECK(late > WINDOWS * (SAMPLES - 1) / 2, "guard 2000 us on ticks: only %u late", (unsigned)late);
+
+    config.sleep_guard_us = TICK_US + 2000;
+    late = run_on_ticks(&config);
+    TEST_CHECK(late == 0, "guard of a tick + 2000 us: %u late", (unsigned)late);
+
+    // motion threshold, on the last configuration
+    float still[3 * 8];
+    float moving[3 * 8];
+    for (size_t ix = 0; ix < 8; ix++) {
+        still[ix * 3 + 0] = 0.01f * (ix % 2);
+        still[ix * 3 + 1] = 0.0f;
+        still[ix * 3 + 2] = 9.81f;
+        moving[ix * 3 + 0] = 0.0f;
+        moving[ix * 3 + 1] = ix == 5 ? 1.0f : 0.0f;
+        moving[ix * 3 + 2] = 9.81f;
+    }
+    config.motion_threshold = 0.5f;
+    ei_scheduler_init(&config, NULL);
+    TEST_CHECK(!ei_scheduler_should_infer(still, 3 * 8, 3), "still window classified");
+    TEST_CHECK(ei_scheduler_should_infer(moving, 3 * 8, 3), "moving window skipped");
+
+    ei_scheduler_stats_t stats;
+    ei_scheduler_get_stats(&stats);
+    TEST_CHECK(stats.inferences == 1 && stats.skipped == 1, "%u inferences, %u skipped",
+        (unsigned)stats.inferences, (unsigned)stats.skipped);
+
+    // a simulation in between leaves the running statistics alone
+    ei_scheduler_simulate(&config, 2, SAMPLES, SAMPLE_READ_US, INFERENCE_US);
+    ei_scheduler_get_stats(&stats);
+    TEST_CHECK(stats.inferences == 1 && stats.skipped == 1 && stats.windows == 0,
+        "after simulate: %u inferences, %u skipped, %u windows",
+        (unsigned)stats.inferences, (unsigned)stats.skipped, (unsigned)stats.windows);
+
+    return test_result("test_scheduler");
+}
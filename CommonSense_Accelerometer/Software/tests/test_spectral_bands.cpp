@@ -0,0 +1,305 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * Spectral power bands: the bin ranges of processing::spectral_power_bands_init()
+ * have to follow the edge[ex] <= freq < edge[ex + 1] rule, also for edges
+ * that lie exactly on a bin, repeated edges and edges outside the spectrum.
+ * The float band means have to match the loop over every bin and edge they
+ * replaced, the q15 means an exact reference, including bands whose sum does
+ * not fit in 16 bits.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/dsp/spectral/processing.hpp"
+
+using namespace ei;
+using namespace ei::spectral;
+
+/* Constant defines -------------------------------------------------------- */
+#define SAMPLING_FREQ       100.0f
+#define N_FFT               128
+#define BINS                (N_FFT / 2 + 1)
+#define RANDOM_EDGE_SETS    500
+#define MAX_EDGES           12
+
+/* Private variables ------------------------------------------------------- */
+static uint32_t random_state = 1;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static uint32_t random_next(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return random_state >> 8;
+}
+
+/**
+ * @brief      Reference, the spectral_power_edges() before the band ranges:
+ *             look up the band of every bin, average the buckets
+ */
+static void reference_power_edges(const float *power, const float *freqs, size_t bins,
+    const float *edges, size_t edges_count, float *output)
+{
+    std::vector<float> buckets(edges_count - 1, 0.0f);
+    std::vector<float> bucket_count(edges_count - 1, 0.0f);
+
+    for (size_t ix = 0; ix < bins; ix++) {
+        for (size_t ex = 0; ex < edges_count - 1; ex++) {
+            if (freqs[ix] >= edges[ex] && freqs[ix] < edges[ex + 1]) {
+                buckets[ex] += power[ix];
+                bucket_count[ex]++;
+                break;
+            }
+        }
+    }
+
+    for (size_t ex = 0; ex < edges_count - 1; ex++) {
+        output[ex] = bucket_count[ex] == 0.0f ? 0.0f : buckets[ex] / bucket_count[ex];
+    }
+}
+
+/**
+ * @brief      Check every bin against the band ranges, by the edge rule
+ */
+template<typename T>
+static int count_misplaced_bins(const T *freqs, size_t bins, const T *edges, size_t edges_count,
+    const processing::spectral_band_t *bands)
+{
+    int misplaced = 0;
+
+    for (size_t ex = 0; ex < edges_count - 1; ex++) {
+        for (size_t ix = 0; ix < bins; ix++) {
+            bool in_band = freqs[ix] >= edges[ex] && freqs[ix] < edges[ex + 1];
+            bool in_range = ix >= bands[ex].start && ix < (size_t)bands[ex].start + bands[ex].count;
+            if (in_band != in_range) {
+                misplaced++;
+            }
+        }
+    }
+
+    return misplaced;
+}
+
+/**
+ * @brief      Bin frequencies as periodogram() returns them
+ */
+static void periodogram_freqs(float *freqs)
+{
+    matrix_t input(1, N_FFT);
+    matrix_t power(1, BINS);
+    matrix_t freq_matrix(1, BINS, freqs);
+
+    processing::periodogram(&input, &power, &freq_matrix, SAMPLING_FREQ, N_FFT);
+}
+
+/**
+ * @brief      Edges on bins, between bins, repeated and past Nyquist
+ */
+static void check_mapping(void)
+{
+    float freqs[BINS];
+    periodogram_freqs(freqs);
+    const float bin_hz = SAMPLING_FREQ / N_FFT;
+
+    const float edges[] = { 0.0f, bin_hz, 4 * bin_hz, 4 * bin_hz, 4.5f * bin_hz, 4.7f * bin_hz,
+        10 * bin_hz, SAMPLING_FREQ / 2, SAMPLING_FREQ };
+    const size_t edges_count = sizeof(edges) / sizeof(edges[0]);
+    processing::spectral_band_t bands[edges_count - 1];
+
+    int ret = processing::spectral_power_bands_init(SAMPLING_FREQ, N_FFT, edges, edges_count, bands);
+    TEST_CHECK(ret == EIDSP_OK, "init returned %d", ret);
+    TEST_CHECK(count_misplaced_bins(freqs, BINS, edges, edges_count, bands) == 0, "bins misplaced");
+
+    // [0, 1) is bin 0, an edge on a bin starts the next band
+    TEST_CHECK(bands[0].start == 0 && bands[0].count == 1, "band 0: %u+%u", bands[0].start, bands[0].count);
+    TEST_CHECK(bands[1].start == 1 && bands[1].count == 3, "band 1: %u+%u", bands[1].start, bands[1].count);
+    TEST_CHECK(bands[2].count == 0, "repeated edge gives %u bins", bands[2].count);
+    TEST_CHECK(bands[3].start == 4 && bands[3].count == 1, "band 3: %u+%u", bands[3].start, bands[3].count);
+    TEST_CHECK(bands[4].count == 0, "band between bins gives %u bins", bands[4].count);
+    TEST_CHECK(bands[5].start == 5 && bands[5].count == 5, "band 5: %u+%u", bands[5].start, bands[5].count);
+    // the Nyquist bin only falls in the band past it
+    TEST_CHECK(bands[6].start + bands[6].count == BINS - 1, "band 6 ends at %u", bands[6].start + bands[6].count);
+    TEST_CHECK(bands[7].start == BINS - 1 && bands[7].count == 1, "band 7: %u+%u", bands[7].start, bands[7].count);
+
+    // both overloads agree
+    processing::spectral_band_t from_freqs[edges_count - 1];
+    processing::spectral_power_bands_init(freqs, BINS, edges, edges_count, from_freqs);
+    int differ = 0;
+    for (size_t ex = 0; ex < edges_count - 1; ex++) {
+        if (from_freqs[ex].start != bands[ex].start || from_freqs[ex].count != bands[ex].count) {
+            differ++;
+        }
+    }
+    TEST_CHECK(differ == 0, "%d bands differ between the overloads", differ);
+
+    // empty bands average to 0, or to the clamp with log output
+    float power[BINS];
+    float output[edges_count - 1];
+    for (size_t ix = 0; ix < BINS; ix++) {
+        power[ix] = (float)(ix + 1);
+    }
+    processing::spectral_power_bands(power, BINS, bands, edges_count - 1, output);
+    TEST_CHECK(output[2] == 0.0f, "empty band mean %g", output[2]);
+    TEST_CHECK(output[1] == 3.0f, "band 1 mean %g", output[1]);
+    processing::spectral_power_bands(power, BINS, bands, edges_count - 1, output, true);
+    TEST_CHECK(output[2] == -10.0f, "empty band log %g", output[2]);
+    TEST_CHECK_NEAR(output[1], log10(3.0), 1e-6, "band 1 log");
+
+    // a band past the spectrum is rejected
+    ret = processing::spectral_power_bands(power, BINS - 1, bands, edges_count - 1, output);
+    TEST_CHECK(ret == EIDSP_BUFFER_SIZE_MISMATCH, "short spectrum returned %d", ret);
+
+    // fewer than two edges, no bands
+    ret = processing::spectral_power_bands_init(SAMPLING_FREQ, N_FFT, edges, 1, bands);
+    TEST_CHECK(ret == EIDSP_OK, "one edge returned %d", ret);
+}
+
+/**
+ * @brief      Random ascending edges, some on bins, some repeated, compared
+ *             with the old loop through spectral_power_edges()
+ */
+static void check_float(void)
+{
+    float freqs[BINS];
+    periodogram_freqs(freqs);
+    const float bin_hz = SAMPLING_FREQ / N_FFT;
+    int misplaced = 0;
+    int mismatches = 0;
+
+    for (uint32_t set = 0; set < RANDOM_EDGE_SETS; set++) {
+        size_t edges_count = 2 + random_next() % (MAX_EDGES - 1);
+        matrix_t edges(edges_count, 1);
+        matrix_t power(1, BINS);
+        matrix_t freq_matrix(1, BINS, freqs);
+        matrix_t output(edges_count - 1, 1);
+        float expected[MAX_EDGES];
+        processing::spectral_band_t bands[MAX_EDGES];
+
+        float edge = (float)(random_next() % 4) * bin_hz;
+        for (size_t ex = 0; ex < edges_count; ex++) {
+            edges.buffer[ex] = edge;
+            switch (random_next() % 4) {
+                case 0: break;                                                  // repeated
+                case 1: edge += (float)(1 + random_next() % 8) * bin_hz; break; // on a bin
+                default: edge += (float)(random_next() % 1000) / 1000.0f * 8 * bin_hz; break;
+            }
+        }
+        for (size_t ix = 0; ix < BINS; ix++) {
+            power.buffer[ix] = (float)(random_next() % 100000) / 1000.0f;
+        }
+
+        processing::spectral_power_bands_init(freqs, BINS, edges.buffer, edges_count, bands);
+        misplaced += count_misplaced_bins(freqs, BINS, edges.buffer, edges_count, bands);
+
+        reference_power_edges(power.buffer, freqs, BINS, edges.buffer, edges_count, expected);
+        int ret = processing::spectral_power_edges(&power, &freq_matrix, &edges, &output, SAMPLING_FREQ);
+        TEST_CHECK(ret == EIDSP_OK, "spectral_power_edges returned %d", ret);
+        for (size_t ex = 0; ex < edges_count - 1; ex++) {
+            if (output.buffer[ex] != expected[ex]) {
+                mismatches++;
+            }
+        }
+    }
+
+    TEST_CHECK(misplaced == 0, "float: %d bins in the wrong band", misplaced);
+    TEST_CHECK(mismatches == 0, "float: %d band means differ from the old loop", mismatches);
+}
+
+/**
+ * @brief      q15 bins and means against an exact reference, the sums of
+ *             the large values do not fit in 16 bits
+ */
+static void check_q15(void)
+{
+    EIDSP_i16 freqs[BINS];
+    EIDSP_i16 power[BINS];
+    int misplaced = 0;
+    int mismatches = 0;
+    int overflows = 0;
+
+    // q15 bin frequencies as periodogram() returns them, ascending
+    for (size_t ix = 0; ix < BINS; ix++) {
+        freqs[ix] = (EIDSP_i16)(ix * 32767 / (BINS - 1));
+    }
+
+    for (uint32_t set = 0; set < RANDOM_EDGE_SETS; set++) {
+        size_t edges_count = 2 + random_next() % (MAX_EDGES - 1);
+        EIDSP_i16 edges[MAX_EDGES];
+        EIDSP_i16 output[MAX_EDGES];
+        processing::spectral_band_t bands[MAX_EDGES];
+
+        int32_t edge = (int32_t)(random_next() % 1000);
+        for (size_t ex = 0; ex < edges_count; ex++) {
+            edges[ex] = (EIDSP_i16)(edge > 32767 ? 32767 : edge);
+            if (random_next() % 4 != 0) {
+                edge += random_next() % 8 == 0 ? freqs[1] : (int32_t)(random_next() % 8000);
+            }
+        }
+        // large positive or negative power, to overflow 16 bit sums
+        for (size_t ix = 0; ix < BINS; ix++) {
+            int32_t v = (int32_t)(random_next() % 32768);
+            power[ix] = (EIDSP_i16)(set % 3 == 0 ? -v : v);
+        }
+
+        processing::spectral_power_bands_init(freqs, BINS, edges, edges_count, bands);
+        misplaced += count_misplaced_bins(freqs, BINS, edges, edges_count, bands);
+
+        int ret = processing::spectral_power_bands(power, BINS, bands, edges_count - 1, output);
+        TEST_CHECK(ret == EIDSP_OK, "q15 returned %d", ret);
+
+        for (size_t ex = 0; ex < edges_count - 1; ex++) {
+            int32_t sum = 0;
+            int32_t count = 0;
+            for (size_t ix = 0; ix < BINS; ix++) {
+                if (freqs[ix] >= edges[ex] && freqs[ix] < edges[ex + 1]) {
+                    sum += power[ix];
+                    count++;
+                }
+            }
+            int32_t expected = count == 0 ? 0 : sum / count;
+            if (sum != (int16_t)sum) {
+                overflows++;
+            }
+            if (output[ex] != expected) {
+                mismatches++;
+            }
+        }
+    }
+
+    TEST_CHECK(misplaced == 0, "q15: %d bins in the wrong band", misplaced);
+    TEST_CHECK(mismatches == 0, "q15: %d band means differ from the int32 reference", mismatches);
+    TEST_CHECK(overflows > 0, "q15: no band sum overflows 16 bits");
+}
+
+int main(void)
+{
+    check_mapping();
+    check_float();
+    check_q15();
+
+    return test_result("test_spectral_bands");
+}
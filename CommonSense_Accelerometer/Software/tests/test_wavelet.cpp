@@ -0,0 +1,348 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/**
+ * Wavelet packet energies and entropies (spectral::feature::
+ * wavelet_packet_analysis): haar has to match a straightforward recursive
+ * decomposition, the node energies of the orthonormal wavelets have to add
+ * up to the mean square of the signal, a constant signal has all energy in
+ * node 0, and an impact has to lower the entropy of the nodes it lands in.
+ * The q15 version has to match the float version, and
+ * extract_wavelet_packet_features() has to give the same values for both.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <string.h>
+#include <vector>
+#include "test.h"
+#include "edge-impulse-sdk/classifier/ei_run_dsp.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define FRAMES              512
+#define AXES                3
+#define DEPTH               3
+#define NODES               (1 << DEPTH)
+#define FEATURES            (2 * NODES)
+
+/* Private variables ------------------------------------------------------- */
+static EIDSP_i16 signal_i16[FRAMES * AXES];
+static float signal_float[FRAMES * AXES];
+static uint32_t random_state = 1;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Deterministic pseudo random numbers, same sequence on every host
+ */
+static float random_sample(void)
+{
+    random_state = random_state * 1664525u + 1013904223u;
+    return (float)(random_state >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+}
+
+/**
+ * @brief      Interleaved q15 frames, tones and noise per axis. The float
+ *             signal holds the same values / 32768.
+ */
+static void make_signal(void)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t axis = 0; axis < AXES; axis++) {
+            float v = 0.3f * sinf(2.0f * (float)M_PI * (axis + 1) * 5.0f * frame / FRAMES) +
+                0.1f * sinf(2.0f * (float)M_PI * 170.0f * frame / FRAMES) + 0.05f * random_sample() +
+                0.1f * axis;
+            signal_i16[frame * AXES + axis] = (EIDSP_i16)lrintf(v * 32768.0f);
+            signal_float[frame * AXES + axis] = signal_i16[frame * AXES + axis] / 32768.0f;
+        }
+    }
+}
+
+/**
+ * @brief      One row per axis
+ */
+static void make_input(matrix_t *input)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t axis = 0; axis < AXES; axis++) {
+            input->buffer[axis * input->cols + frame] = signal_float[frame * AXES + axis];
+        }
+    }
+}
+
+static void make_input(matrix_i16_t *input)
+{
+    for (size_t frame = 0; frame < FRAMES; frame++) {
+        for (size_t axis = 0; axis < AXES; axis++) {
+            input->buffer[axis * input->cols + frame] = signal_i16[frame * AXES + axis];
+        }
+    }
+}
+
+/**
+ * @brief      Haar packet tree in double, children of node n are 2n (approximation)
+ *             and 2n + 1 (detail), with periodic pairs
+ */
+static void reference_haar(const float *x, double *features)
+{
+    std::vector<std::vector<double> > nodes(1, std::vector<double>(x, x + FRAMES));
+
+    for (int level = 0; level < DEPTH; level++) {
+        std::vector<std::vector<double> > next;
+        for (size_t n = 0; n < nodes.size(); n++) {
+            std::vector<double> approximation, detail;
+            for (size_t k = 0; k + 1 < nodes[n].size(); k += 2) {
+                approximation.push_back((nodes[n][k] + nodes[n][k + 1]) / sqrt(2.0));
+                detail.push_back((nodes[n][k + 1] - nodes[n][k]) / sqrt(2.0));
+            }
+            next.push_back(approximation);
+            next.push_back(detail);
+        }
+        nodes.swap(next);
+    }
+
+    for (size_t n = 0; n < NODES; n++) {
+        double energy = 0.0;
+        for (size_t k = 0; k < nodes[n].size(); k++) {
+            energy += nodes[n][k] * nodes[n][k];
+        }
+        double entropy = 0.0;
+        for (size_t k = 0; k < nodes[n].size() && energy > 0.0; k++) {
+            double p = nodes[n][k] * nodes[n][k] / energy;
+            if (p > 0.0) {
+                entropy -= p * log(p);
+            }
+        }
+        features[n] = energy / FRAMES;
+        features[NODES + n] = entropy;
+    }
+}
+
+static double mean_square(const float *x, size_t count)
+{
+    double sum = 0.0;
+    for (size_t ix = 0; ix < count; ix++) {
+        sum += (double)x[ix] * x[ix];
+    }
+    return sum / count;
+}
+
+/**
+ * @brief      Haar against the recursive reference
+ */
+static void check_haar(void)
+{
+    matrix_t input(AXES, FRAMES);
+    matrix_t output(AXES, FEATURES);
+    double expected[FEATURES];
+    double max_energy_error = 0.0, max_entropy_error = 0.0;
+
+    make_input(&input);
+    std::vector<float> original(input.buffer, input.buffer + AXES * FRAMES);
+
+    int ret = spectral::feature::wavelet_packet_analysis(&output, &input, spectral::wavelet_haar, DEPTH);
+    TEST_CHECK(ret == EIDSP_OK, "haar returned %d", ret);
+
+    for (size_t axis = 0; axis < AXES; axis++) {
+        reference_haar(&original[axis * FRAMES], expected);
+        for (size_t ix = 0; ix < NODES; ix++) {
+            max_energy_error = fmax(max_energy_error,
+                fabs(output.buffer[axis * FEATURES + ix] - expected[ix]) / (expected[ix] + 1e-6));
+            max_entropy_error = fmax(max_entropy_error,
+                fabs(output.buffer[axis * FEATURES + NODES + ix] - expected[NODES + ix]));
+        }
+    }
+
+    TEST_CHECK(max_energy_error <= 1e-4, "haar energies: relative error %g", max_energy_error);
+    TEST_CHECK(max_entropy_error <= 1e-4, "haar entropies: error %g", max_entropy_error);
+}
+
+/**
+ * @brief      Energies of every depth add up to the mean square, for a
+ *             constant signal all of it is in node 0
+ */
+static void check_energy(spectral::wavelet_t type, const char *name, double tolerance)
+{
+    for (int depth = 1; depth <= 5; depth++) {
+        const size_t nodes = 1 << depth;
+        matrix_t input(AXES, FRAMES);
+        matrix_t output(AXES, 2 * nodes);
+
+        make_input(&input);
+        std::vector<float> original(input.buffer, input.buffer + AXES * FRAMES);
+        spectral::feature::wavelet_packet_analysis(&output, &input, type, depth);
+
+        for (size_t axis = 0; axis < AXES; axis++) {
+            double total = 0.0;
+            for (size_t node = 0; node < nodes; node++) {
+                total += output.buffer[axis * 2 * nodes + node];
+            }
+            double expected = mean_square(&original[axis * FRAMES], FRAMES);
+            TEST_CHECK(fabs(total - expected) <= tolerance * expected,
+                "%s depth %d axis %d: energies add up to %g, mean square %g", name, depth, (int)axis, total, expected);
+        }
+
+        for (size_t ix = 0; ix < AXES * FRAMES; ix++) {
+            input.buffer[ix] = 0.25f;
+        }
+        spectral::feature::wavelet_packet_analysis(&output, &input, type, depth);
+        double others = 0.0;
+        for (size_t node = 1; node < nodes; node++) {
+            others += output.buffer[node];
+        }
+        TEST_CHECK(fabs(output.buffer[0] - 0.0625) <= 1e-5 && others <= 1e-9,
+            "%s depth %d: constant signal has %g in node 0, %g in the others", name, depth, output.buffer[0], others);
+    }
+}
+
+/**
+ * @brief      An impact concentrates the energy of the nodes it lands in
+ */
+static void check_impact(void)
+{
+    matrix_t input(1, FRAMES);
+    matrix_t output(1, FEATURES);
+    float noise_entropy[NODES];
+
+    random_state = 7;
+    for (size_t ix = 0; ix < FRAMES; ix++) {
+        input.buffer[ix] = 0.01f * random_sample();
+    }
+    std::vector<float> noise(input.buffer, input.buffer + FRAMES);
+
+    spectral::feature::wavelet_packet_analysis(&output, &input, spectral::wavelet_db2, DEPTH);
+    for (size_t node = 0; node < NODES; node++) {
+        noise_entropy[node] = output.buffer[NODES + node];
+        // white noise spreads over the 64 coefficients of every node
+        TEST_CHECK(noise_entropy[node] > 0.8f * logf(FRAMES / NODES), "noise entropy of node %d is %g",
+            (int)node, noise_entropy[node]);
+    }
+
+    memcpy(input.buffer, noise.data(), FRAMES * sizeof(float));
+    input.buffer[200] += 1.0f;
+    input.buffer[201] -= 1.0f;
+    spectral::feature::wavelet_packet_analysis(&output, &input, spectral::wavelet_db2, DEPTH);
+
+    int lowered = 0;
+    for (size_t node = 0; node < NODES; node++) {
+        if (output.buffer[NODES + node] < 0.5f * noise_entropy[node]) {
+            lowered++;
+        }
+    }
+    TEST_CHECK(lowered >= NODES / 2, "impact lowers the entropy of %d nodes", lowered);
+}
+
+/**
+ * @brief      q15 features against the float features of the same signal
+ */
+static void check_i16(spectral::wavelet_t type, const char *name)
+{
+    matrix_t input(AXES, FRAMES);
+    matrix_t output(AXES, FEATURES);
+    matrix_i16_t input_i16(AXES, FRAMES);
+    matrix_i32_t output_i32(AXES, FEATURES);
+    double max_energy_error = 0.0, max_entropy_error = 0.0;
+
+    make_input(&input);
+    make_input(&input_i16);
+    spectral::feature::wavelet_packet_analysis(&output, &input, type, DEPTH);
+    int ret = spectral::feature::wavelet_packet_analysis(&output_i32, &input_i16, type, DEPTH);
+    TEST_CHECK(ret == EIDSP_OK, "%s i16 returned %d", name, ret);
+
+    for (size_t axis = 0; axis < AXES; axis++) {
+        for (size_t node = 0; node < NODES; node++) {
+            size_t ix = axis * FEATURES + node;
+            max_energy_error = fmax(max_energy_error, fabs(output_i32.buffer[ix] / 32768.0 - output.buffer[ix]));
+            max_entropy_error = fmax(max_entropy_error,
+                fabs(output_i32.buffer[ix + NODES] / 32768.0 - output.buffer[ix + NODES]));
+        }
+    }
+
+    TEST_CHECK(max_energy_error <= 2e-5, "%s i16 energies: error %g", name, max_energy_error);
+    TEST_CHECK(max_entropy_error <= 4e-4, "%s i16 entropies: error %g", name, max_entropy_error);
+}
+
+/**
+ * @brief      Both DSP block signatures, against the direct calls
+ */
+static void check_extract(void)
+{
+    ei_dsp_config_wavelet_packet_t config = { 1, AXES, 1.0f, "cdf53", DEPTH };
+    matrix_t input(AXES, FRAMES);
+    matrix_t expected(AXES, FEATURES);
+    matrix_t output(1, AXES * FEATURES);
+    signal_t signal;
+
+    make_input(&input);
+    spectral::feature::wavelet_packet_analysis(&expected, &input, spectral::wavelet_cdf53, DEPTH);
+    numpy::signal_from_buffer(signal_float, FRAMES * AXES, &signal);
+    int ret = extract_wavelet_packet_features(&signal, &output, &config, 100.0f);
+    TEST_CHECK(ret == EIDSP_OK, "extract returned %d", ret);
+    TEST_CHECK(memcmp(output.buffer, expected.buffer, sizeof(float) * AXES * FEATURES) == 0,
+        "extract differs from wavelet_packet_analysis");
+
+    matrix_i16_t input_i16(AXES, FRAMES);
+    matrix_i32_t expected_i32(AXES, FEATURES);
+    matrix_i32_t output_i32(1, AXES * FEATURES);
+    signal_i16_t signal_i16_buffer;
+
+    make_input(&input_i16);
+    spectral::feature::wavelet_packet_analysis(&expected_i32, &input_i16, spectral::wavelet_cdf53, DEPTH);
+    numpy::signal_from_buffer_i16(signal_i16, FRAMES * AXES, &signal_i16_buffer);
+    ret = extract_wavelet_packet_features(&signal_i16_buffer, &output_i32, &config, 100.0f);
+    TEST_CHECK(ret == EIDSP_OK, "extract i16 returned %d", ret);
+    TEST_CHECK(memcmp(output_i32.buffer, expected_i32.buffer, sizeof(EIDSP_i32) * AXES * FEATURES) == 0,
+        "extract i16 differs from wavelet_packet_analysis");
+
+    config.wavelet = "db2";
+    ret = extract_wavelet_packet_features(&signal_i16_buffer, &output_i32, &config, 100.0f);
+    TEST_CHECK(ret == EIDSP_NOT_SUPPORTED, "db2 on i16 returned %d", ret);
+    config.wavelet = "db4";
+    ret = extract_wavelet_packet_features(&signal, &output, &config, 100.0f);
+    TEST_CHECK(ret == EIDSP_PARAMETER_INVALID, "unknown wavelet returned %d", ret);
+
+    // samples past the last multiple of 2^depth are not used
+    matrix_t longer(1, FRAMES + 5);
+    matrix_t exact(1, FRAMES);
+    matrix_t longer_output(1, FEATURES);
+    matrix_t exact_output(1, FEATURES);
+    for (size_t ix = 0; ix < FRAMES + 5; ix++) {
+        longer.buffer[ix] = ix < FRAMES ? signal_float[ix * AXES] : 1.0f;
+    }
+    memcpy(exact.buffer, longer.buffer, FRAMES * sizeof(float));
+    spectral::feature::wavelet_packet_analysis(&longer_output, &longer, spectral::wavelet_haar, DEPTH);
+    spectral::feature::wavelet_packet_analysis(&exact_output, &exact, spectral::wavelet_haar, DEPTH);
+    TEST_CHECK(memcmp(longer_output.buffer, exact_output.buffer, sizeof(float) * FEATURES) == 0,
+        "trailing samples change the features");
+}
+
+int main(void)
+{
+    make_signal();
+    check_haar();
+    check_energy(spectral::wavelet_haar, "haar", 1e-5);
+    check_energy(spectral::wavelet_db2, "db2", 1e-5);
+    check_impact();
+    check_i16(spectral::wavelet_haar, "haar");
+    check_i16(spectral::wavelet_cdf53, "cdf53");
+    check_extract();
+
+    return test_result("test_wavelet");
+}
@@ -37,6 +37,7 @@
 #include "arch/board/board.h"
 #include "spresense-exported-sdk/nuttx/include/unistd.h"
 #include "spresense-exported-sdk/nuttx/include/nuttx/timers/pwm.h"
+#include <time.h>
 
 #include "Appdefines.h"
 #include "libraries/Max7317/Max7317.h"
@@ -103,6 +104,7 @@
 //#define LED_TEST
 //#define BTN_TEST
 //#define GPS_TEST
+//#define I2C_BATCH_TEST
 
 #endif
 
@@ -1184,7 +1186,102 @@ static void gps_test(void) {
 
 #endif // GPS_TEST
 
+#ifdef I2C_BATCH_TEST
 
+static uint8_t batch_hts221[HTS221_DATA_BURST_LEN];
+static uint8_t batch_lps22hh[LPS22HH_DATA_BURST_LEN];
+static uint8_t batch_lis2mdl[LIS2MDL_DATA_BURST_LEN];
+static uint8_t batch_sgp41[SGP41_RAW_SIGNALS_LEN];
+static uint8_t batch_sgp41_cmd[SGP41_MEASURE_RAW_CMD_LEN];
+static i2c_queue_t batch_queue;
+
+static uint32_t batch_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) (ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static void i2c_batch_init(void) {
+    i2c_init();
+
+    hts221_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    hts221_data_rate_set(nullptr, HTS221_ODR_1Hz);
+    hts221_power_on_set(nullptr, PROPERTY_ENABLE);
+
+    lps22hh_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lps22hh_data_rate_set(nullptr, LPS22HH_10_Hz_LOW_NOISE);
+
+    lis2mdl_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lis2mdl_data_rate_set(nullptr, LIS2MDL_ODR_10Hz);
+    lis2mdl_operating_mode_set(nullptr, LIS2MDL_CONTINUOUS_MODE);
+
+    sensirion_i2c_hal_init();
+
+    /* Start the first SGP41 measurement, so the first cycle has a result to read */
+    i2c_queue_init(&batch_queue);
+    sgp41_queue_measure_raw_signals(&batch_queue, 0x8000, 0x6666, batch_sgp41_cmd);
+    i2c_queue_submit(&batch_queue);
+
+    /* One bus cycle: read all sensors and start the next SGP41 measurement */
+    i2c_queue_init(&batch_queue);
+    hts221_queue_data_get(&batch_queue, batch_hts221);
+    lps22hh_queue_data_get(&batch_queue, batch_lps22hh);
+    lis2mdl_queue_data_get(&batch_queue, batch_lis2mdl);
+    sgp41_queue_read_raw_signals(&batch_queue, batch_sgp41);
+    sgp41_queue_measure_raw_signals(&batch_queue, 0x8000, 0x6666, batch_sgp41_cmd);
+
+    usleep(1000 * 100);
+}
+
+static void i2c_batch_loop(void) {
+    uint8_t buff[LIS2MDL_DATA_BURST_LEN];
+    uint16_t sraw_voc = 0;
+    uint16_t sraw_nox = 0;
+
+    /* Register by register, the SGP41 is left out as it blocks for 50 ms */
+    uint32_t start = batch_time_us();
+    hts221_read_reg(nullptr, HTS221_STATUS_REG, buff, 1);
+    hts221_humidity_raw_get(nullptr, buff);
+    hts221_temperature_raw_get(nullptr, buff);
+    lps22hh_read_reg(nullptr, LPS22HH_STATUS, buff, 1);
+    lps22hh_pressure_raw_get(nullptr, buff);
+    lps22hh_temperature_raw_get(nullptr, buff);
+    lis2mdl_mag_data_ready_get(nullptr, buff);
+    lis2mdl_magnetic_raw_get(nullptr, buff);
+    lis2mdl_temperature_raw_get(nullptr, buff);
+    uint32_t sequential_us = batch_time_us() - start;
+
+    start = batch_time_us();
+    uint8_t ret = i2c_queue_submit(&batch_queue);
+    uint32_t batch_us = batch_time_us() - start;
+
+    printf("sequential: %lu us, batch: %lu us (ret %d, errors %lu)\r\n",
+        (unsigned long) sequential_us, (unsigned long) batch_us, ret,
+        (unsigned long) i2c_get_error_count());
+
+    printf("hts221 hum %d temp %d, lps22hh press %ld temp %d, lis2mdl %d %d %d\r\n",
+        (int16_t) (batch_hts221[2] << 8 | batch_hts221[1]),
+        (int16_t) (batch_hts221[4] << 8 | batch_hts221[3]),
+        (long) (batch_lps22hh[3] << 16 | batch_lps22hh[2] << 8 | batch_lps22hh[1]),
+        (int16_t) (batch_lps22hh[5] << 8 | batch_lps22hh[4]),
+        (int16_t) (batch_lis2mdl[2] << 8 | batch_lis2mdl[1]),
+        (int16_t) (batch_lis2mdl[4] << 8 | batch_lis2mdl[3]),
+        (int16_t) (batch_lis2mdl[6] << 8 | batch_lis2mdl[5]));
+
+    if (sgp41_decode_raw_signals(batch_sgp41, &sraw_voc, &sraw_nox) == 0) {
+        printf("sgp41 SRAW_VOC: %u SRAW_NOX: %u\r\n", sraw_voc, sraw_nox);
+    }
+}
+
+static void i2c_batch_test(void) {
+    i2c_batch_init();
+    while (1) {
+        i2c_batch_loop();
+        usleep(1000 * 1000);
+    }
+}
+
+#endif // I2C_BATCH_TEST
 
 
 void tests (void) {    
@@ -1332,5 +1429,11 @@ void tests (void) {
 
 #endif // GPS_TEST
 
+#ifdef I2C_BATCH_TEST
+
+    i2c_batch_test();
+
+#endif // I2C_BATCH_TEST
+
 #endif // ALL_TESTS
 }
@@ -24,6 +24,7 @@
 #define _EDGE_IMPULSE_CONFIG_H_
 
 #include <stdint.h>
+#include <pthread.h>
 #include "ei_config_types.h"
 
 #define EDGE_IMPULSE_MAX_FREQUENCIES        5
@@ -147,6 +148,9 @@ typedef struct {
 // Only single context has to be active, so store this here
 static ei_config_ctx_t *ei_config_ctx = NULL;
 static ei_config_t ei_config = { 0 };
+// Setters run on the AT command thread and the gas sensor thread, every change
+// of ei_config and its save hold this lock
+static pthread_mutex_t ei_config_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /**
  * Initialize the configuration store
@@ -207,11 +211,13 @@ EI_CONFIG_ERROR ei_config_set_wifi(const char *ssid, const char *password, ei_co
     if (strlen(ssid) > 127) return EI_CONFIG_BOUNDS_ERROR;
     if (strlen(password) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.wifi_ssid, ssid, strlen(ssid) + 1);
     memcpy(ei_config.wifi_password, password, strlen(password) + 1);
     ei_config.wifi_security = security;
 
     EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
     if (ei_config_ctx->wifi_settings_changed) {
         if (ei_config_ctx->wifi_settings_changed()) {
@@ -312,11 +318,14 @@ EI_CONFIG_ERROR ei_config_get_data_output_baudrate(ei_device_data_output_baudrat
 EI_CONFIG_ERROR ei_config_set_sample_settings(const char *label, float interval, uint32_t length) {
     if (strlen(label) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.sample_label, label, strlen(label) + 1);
     ei_config.sample_interval_ms = interval;
     ei_config.sample_length_ms = length;
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -324,9 +333,12 @@ EI_CONFIG_ERROR ei_config_set_sample_settings(const char *label, float interval,
  * @param interval How often sampling needs to be done (in ms.)
  */
 EI_CONFIG_ERROR ei_config_set_sample_interval(float interval) {
+    pthread_mutex_lock(&ei_config_lock);
     ei_config.sample_interval_ms = interval;
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -340,12 +352,15 @@ EI_CONFIG_ERROR ei_config_set_sample_settings(const char *label, float interval,
     if (strlen(label) > 127) return EI_CONFIG_BOUNDS_ERROR;
     if (strlen(hmac_key) > 32) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.sample_label, label, strlen(label) + 1);
     ei_config.sample_interval_ms = interval;
     ei_config.sample_length_ms = length;
     memcpy(ei_config.sample_hmac_key, hmac_key, strlen(hmac_key) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -372,9 +387,12 @@ EI_CONFIG_ERROR ei_config_get_sample_settings(char ** label, float *interval, ui
 EI_CONFIG_ERROR ei_config_set_upload_path_settings(const char *upload_path) {
     if (strlen(upload_path) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.upload_path, upload_path, strlen(upload_path) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -386,10 +404,13 @@ EI_CONFIG_ERROR ei_config_set_upload_host_settings(const char *api_key, const ch
     if (strlen(api_key) > 127) return EI_CONFIG_BOUNDS_ERROR;
     if (strlen(upload_host) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.upload_api_key, api_key, strlen(api_key) + 1);
     memcpy(ei_config.upload_host, upload_host, strlen(upload_host) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -399,9 +420,12 @@ EI_CONFIG_ERROR ei_config_set_upload_host_settings(const char *api_key, const ch
 EI_CONFIG_ERROR ei_config_set_upload_host_settings(const char *upload_host) {
     if (strlen(upload_host) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.upload_host, upload_host, strlen(upload_host) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -413,10 +437,13 @@ EI_CONFIG_ERROR ei_config_set_upload_path_settings(const char *api_key, const ch
     if (strlen(api_key) > 127) return EI_CONFIG_BOUNDS_ERROR;
     if (strlen(upload_path) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.upload_api_key, api_key, strlen(api_key) + 1);
     memcpy(ei_config.upload_path, upload_path, strlen(upload_path) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -442,9 +469,12 @@ EI_CONFIG_ERROR ei_config_get_upload_settings(char ** api_key, char ** upload_ho
 EI_CONFIG_ERROR ei_config_set_mgmt_settings(const char *mgmt_url) {
     if (strlen(mgmt_url) > 127) return EI_CONFIG_BOUNDS_ERROR;
 
+    pthread_mutex_lock(&ei_config_lock);
     memcpy(ei_config.mgmt_url, mgmt_url, strlen(mgmt_url) + 1);
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
 
-    return ei_config_save();
+    return r;
 }
 
 /**
@@ -471,9 +501,44 @@ EI_CONFIG_ERROR ei_config_get_mgmt_settings(char ** mgmt_url, bool *is_connected
     return EI_CONFIG_OK;
 }
 
+/**
+ * Set the learned gas index algorithm state, so it survives a reboot
+ * @param state EI_CONFIG_GAS_INDEX_STATE_SIZE values
+ */
+EI_CONFIG_ERROR ei_config_set_gas_index_state(const int32_t *state) {
+    pthread_mutex_lock(&ei_config_lock);
+    memcpy(ei_config.gas_index_state, state, sizeof(ei_config.gas_index_state));
+    ei_config.gas_index_state_valid = true;
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
+
+    return r;
+}
+
+/**
+ * Get the stored gas index algorithm state
+ * @param state Out parameter, EI_CONFIG_GAS_INDEX_STATE_SIZE values
+ * @returns EI_CONFIG_BOUNDS_ERROR if no state was stored yet
+ */
+EI_CONFIG_ERROR ei_config_get_gas_index_state(int32_t *state) {
+    if (ei_config_ctx == NULL) return EI_CONFIG_NO_CONTEXT;
+    pthread_mutex_lock(&ei_config_lock);
+    bool valid = ei_config.gas_index_state_valid;
+    if (valid) {
+        memcpy(state, ei_config.gas_index_state, sizeof(ei_config.gas_index_state));
+    }
+    pthread_mutex_unlock(&ei_config_lock);
+
+    return valid ? EI_CONFIG_OK : EI_CONFIG_BOUNDS_ERROR;
+}
+
 EI_CONFIG_ERROR ei_config_clear() {
+    pthread_mutex_lock(&ei_config_lock);
     memset(&ei_config, 0, sizeof(ei_config_t));
-    return ei_config_save();
+    EI_CONFIG_ERROR r = ei_config_save();
+    pthread_mutex_unlock(&ei_config_lock);
+
+    return r;
 }
 
 ei_config_t *ei_config_get_config() {
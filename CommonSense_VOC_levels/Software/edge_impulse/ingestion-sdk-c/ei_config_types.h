@@ -25,6 +25,9 @@ typedef enum {
     EI_SECURITY_UNKNOWN      = 0xFF,     /*!< unknown/unsupported security in scan results */
 } ei_config_security_t;
 
+// Learned state of the VOC gas index algorithm (mean and std)
+#define EI_CONFIG_GAS_INDEX_STATE_SIZE  2
+
 
 // All the possible configuration options we can set
 typedef struct {
@@ -39,6 +42,8 @@ typedef struct {
     char upload_path[128];
     char upload_api_key[128];
     char mgmt_url[128];
+    int32_t gas_index_state[EI_CONFIG_GAS_INDEX_STATE_SIZE];
+    bool gas_index_state_valid;
     uint32_t magic;
 } ei_config_t;
 
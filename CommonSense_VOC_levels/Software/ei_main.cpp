@@ -31,6 +31,7 @@
 #include "numpy.hpp"
 #include "firmware-sdk/ei_image_lib.h"
 #include "at_cmds.h"
+#include "ei_gas_sensor.h"
 
 /**
  * @brief Init sensors, load config and run command handler
@@ -64,6 +65,8 @@ int ei_main() {
         ei_printf("Loaded configuration\n");
     }
 
+    ei_gas_sensor_init();
+
     /* Setup the command line commands */
     ei_at_register_generic_cmds();
     ei_at_cmd_register("RUNIMPULSE", "Run the impulse", run_nn_normal);
@@ -21,11 +21,13 @@
  */
 
 /* Include ----------------------------------------------------------------- */
+#include <unistd.h>
 #include "ei_device_sony_spresense.h"
 #include "edge-impulse-sdk/classifier/ei_run_classifier.h"
 #include "edge-impulse-sdk/dsp/numpy.hpp"
 #include "ei_microphone.h"
 #include "ei_inertialsensor.h"
+#include "ei_environmental_sensor.h"
 // #include "ei_camera.h"
 
 /* Extern defined spresense library function */
@@ -132,6 +134,209 @@ void run_nn(bool debug) {
     }
 }
 
+#elif defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ENVIRONMENTAL
+
+/* Environmental sensor ---------------------------------------------------- */
+/** Axes of the model, in the order of the training data */
+#ifndef EI_ENV_MODEL_AXES
+#define EI_ENV_MODEL_AXES   { EI_ENV_AXIS_VOC, EI_ENV_AXIS_NOX, EI_ENV_AXIS_HUMIDITY, \
+                              EI_ENV_AXIS_TEMPERATURE, EI_ENV_AXIS_PRESSURE }
+#endif
+/** New samples between two classifications, 1 classifies on every sample */
+#ifndef EI_ENV_INFERENCE_STRIDE
+#define EI_ENV_INFERENCE_STRIDE     1
+#endif
+/** Longest sleep between two checks for a stop request */
+#define ENV_SLEEP_SLICE_MS          100
+
+/** Sensor readings averaged into one model sample, 0 (faster model) uses every reading */
+#define ENV_READS_PER_SAMPLE ((uint32_t)(EI_CLASSIFIER_INTERVAL_MS + EI_ENV_SAMPLE_INTERVAL_MS / 2) / EI_ENV_SAMPLE_INTERVAL_MS)
+
+/* Private variables ------------------------------------------------------- */
+static const uint8_t env_axes[] = EI_ENV_MODEL_AXES;
+static_assert(sizeof(env_axes) == EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,
+              "EI_ENV_MODEL_AXES does not match the axes of the model");
+
+/* Rolling window, env_head is the oldest value and always starts a frame */
+static int16_t env_ring[EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE];
+static size_t env_head;
+static size_t env_frames;
+
+/**
+ * @brief      Add a sample to the window, the oldest sample is dropped once
+ *             the window is full
+ *
+ * @param[in]  values  Sample, indexed by ei_env_axis_t
+ */
+static void env_push(const int16_t values[EI_ENV_N_AXIS])
+{
+    for (size_t axis = 0; axis < sizeof(env_axes); axis++) {
+        env_ring[env_head + axis] = values[env_axes[axis]];
+    }
+
+    env_head += sizeof(env_axes);
+    if (env_head >= EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        env_head = 0;
+    }
+
+    if (env_frames < EI_CLASSIFIER_RAW_SAMPLE_COUNT) {
+        env_frames++;
+    }
+}
+
+/**
+ * @brief      Signal callback, reads the window oldest sample first and
+ *             converts to the model units
+ *
+ * @param[in]  offset   Offset in the window
+ * @param[in]  length   Number of values
+ * @param[out] out_ptr  Values
+ *
+ * @return     0
+ */
+static int env_get_data(size_t offset, size_t length, float *out_ptr)
+{
+    size_t ix = env_head + offset;
+    size_t axis = offset % sizeof(env_axes);
+
+    if (ix >= EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+        ix -= EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        out_ptr[i] = (float)env_ring[ix] * ei_environmental_lsb[env_axes[axis]];
+
+        if (++ix == EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE) {
+            ix = 0;
+        }
+        if (++axis == sizeof(env_axes)) {
+            axis = 0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Sample the environmental sensors and classify the rolling
+ *             window on every new sample. The window spans minutes, so it is
+ *             filled once and then slides, instead of being sampled again for
+ *             every classification. Prints results to terminal.
+ *
+ * @param[in]  debug  The debug
+ */
+void run_nn(bool debug) {
+
+    bool stop_inferencing = false;
+    int32_t sum[EI_ENV_N_AXIS] = { 0 };
+    uint32_t reads = 0;
+    uint32_t since_inference = 0;
+
+    // summary of inferencing settings (from model_metadata.h)
+    ei_printf("Inferencing settings:\n");
+    ei_printf("\tInterval: %.4f ms\n", (float)EI_CLASSIFIER_INTERVAL_MS);
+    ei_printf("\tFrame size: %d\n", EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE);
+    ei_printf("\tSample length: %.4f ms.\n", 1000.0f * static_cast<float>(EI_CLASSIFIER_RAW_SAMPLE_COUNT) /
+                  (1000.0f / static_cast<float>(EI_CLASSIFIER_INTERVAL_MS)));
+    ei_printf("\tNo. of classes: %d\n", sizeof(ei_classifier_inferencing_categories) / sizeof(ei_classifier_inferencing_categories[0]));
+
+    if (EI_CLASSIFIER_INTERVAL_MS < EI_ENV_SAMPLE_INTERVAL_MS) {
+        ei_printf("WARN: sensors update every %d ms, samples are repeated\n", EI_ENV_SAMPLE_INTERVAL_MS);
+    }
+
+    if (!ei_environmental_init()) {
+        EiDevice.set_state(eiStateIdle);
+        return;
+    }
+
+    ei_printf("Starting inferencing, press 'b' to break\n");
+
+    env_head = 0;
+    env_frames = 0;
+
+    uint64_t next_ms = ei_read_timer_ms();
+
+    while (stop_inferencing == false) {
+
+        // sleep in slices until the next reading, so a stop request is noticed
+        // and the gas sensor thread gets the CPU
+        uint64_t now_ms = ei_read_timer_ms();
+        while (next_ms > now_ms) {
+            if (ei_user_invoke_stop_lib()) {
+                ei_printf("Inferencing stopped by user\r\n");
+                stop_inferencing = true;
+                break;
+            }
+            uint64_t slice_ms = next_ms - now_ms;
+            if (slice_ms > ENV_SLEEP_SLICE_MS) {
+                slice_ms = ENV_SLEEP_SLICE_MS;
+            }
+            usleep((useconds_t)(slice_ms * 1000));
+            now_ms = ei_read_timer_ms();
+        }
+        if (stop_inferencing) {
+            break;
+        }
+        next_ms += EI_ENV_SAMPLE_INTERVAL_MS;
+
+        int16_t values[EI_ENV_N_AXIS];
+        if (ei_environmental_read(values)) {
+            ei_printf("Err: failed to get sensor data\r\n");
+            break;
+        }
+
+        for (size_t axis = 0; axis < EI_ENV_N_AXIS; axis++) {
+            sum[axis] += values[axis];
+        }
+        if (++reads < ENV_READS_PER_SAMPLE) {
+            continue;
+        }
+
+        for (size_t axis = 0; axis < EI_ENV_N_AXIS; axis++) {
+            values[axis] = (int16_t)(sum[axis] / (int32_t)reads);
+            sum[axis] = 0;
+        }
+        reads = 0;
+
+        env_push(values);
+
+        if (env_frames < EI_CLASSIFIER_RAW_SAMPLE_COUNT) {
+            ei_printf("Filling window %d/%d\n", (int)env_frames, EI_CLASSIFIER_RAW_SAMPLE_COUNT);
+            continue;
+        }
+
+        if (++since_inference < EI_ENV_INFERENCE_STRIDE) {
+            continue;
+        }
+        since_inference = 0;
+
+        // the window is read in place, oldest sample first
+        signal_t signal;
+        signal.total_length = EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE;
+        signal.get_data = &env_get_data;
+
+        // run the impulse: DSP, neural network and the Anomaly algorithm
+        ei_impulse_result_t result = { 0 };
+        EI_IMPULSE_ERROR ei_error = run_classifier(&signal, &result, debug);
+        if (ei_error != EI_IMPULSE_OK) {
+            ei_printf("Failed to run impulse (%d)\n", ei_error);
+            break;
+        }
+
+        // print the predictions
+        ei_printf("Predictions (DSP: %d ms., Classification: %d ms., Anomaly: %d ms.): \n",
+                  result.timing.dsp, result.timing.classification, result.timing.anomaly);
+        for (size_t ix = 0; ix < EI_CLASSIFIER_LABEL_COUNT; ix++) {
+            ei_printf("    %s: \t%f\r\n", result.classification[ix].label, result.classification[ix].value);
+        }
+#if EI_CLASSIFIER_HAS_ANOMALY == 1
+        ei_printf("    anomaly score: %f\r\n", result.anomaly);
+#endif
+    }
+
+    EiDevice.set_state(eiStateIdle);
+}
+
 #elif defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_MICROPHONE
 void run_nn(bool debug) {
     if (EI_CLASSIFIER_FREQUENCY != 16000) {
@@ -335,6 +540,9 @@ void run_nn_debug(void) {
 void run_nn_continuous_normal(void) {
 #if defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_MICROPHONE
     run_nn_continuous(false);
+#elif defined(EI_CLASSIFIER_SENSOR) && EI_CLASSIFIER_SENSOR == EI_CLASSIFIER_SENSOR_ENVIRONMENTAL
+    // the environmental window always slides
+    run_nn(false);
 #else
     ei_printf("Error no continuous classification available for current model\r\n");
 #endif
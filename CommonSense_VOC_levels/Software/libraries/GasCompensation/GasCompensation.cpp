@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @file    GasCompensation.cpp
+ * @date    19 October 2026
+ * @brief   HTS221 humidity and temperature compensation of SGP41 measurements
+ ******************************************************************************
+ *
+ * COPYRIGHT(c) 2022 Droid-Technologies LLC
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *   1. Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *   3. Neither the name of Droid-Technologies LLC nor the names of its contributors may
+ *      be used to endorse or promote products derived from this software
+ *      without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ******************************************************************************
+ */
+
+
+#include "GasCompensation.h"
+#include "../I2c/I2c.h"
+#include "../Hts221/Hts221.h"
+
+// SGP41 ticks: RH [%] * 65535 / 100, (T [degC] + 45) * 65535 / 175
+#define SGP41_TICKS_PER_RH      (65535.0f / 100.0f)
+#define SGP41_TICKS_PER_DEGC    (65535.0f / 175.0f)
+#define SGP41_T_OFFSET_DEGC     (45.0f)
+
+static inline int16_t RawToInt16(const uint8_t *buf) {
+    return (int16_t) ((uint16_t) buf[1] << 8 | buf[0]);
+}
+
+static inline uint16_t ToTicks(int32_t gain, int32_t offset, int16_t x) {
+    int32_t ticks = (int32_t) (((int64_t) gain * x) >> 16) + offset;
+    return (uint16_t) (ticks < 0 ? 0 : (ticks > 0xFFFF ? 0xFFFF : ticks));
+}
+
+static inline int32_t RoundToInt32(float value) {
+    return (int32_t) (value >= 0.0f ? value + 0.5f : value - 0.5f);
+}
+
+static void LinToGain(const lin_t *lin, float scale, float offset, int32_t *gain, int32_t *ticks_offset) {
+    float slope = (lin->y1 - lin->y0) / (lin->x1 - lin->x0);
+    float intercept = ((lin->x1 * lin->y0) - (lin->x0 * lin->y1)) / (lin->x1 - lin->x0);
+
+    *gain = RoundToInt32(slope * scale * 65536.0f);
+    *ticks_offset = RoundToInt32((intercept + offset) * scale);
+}
+
+bool GasCompensationReadCalibration(lin_t *lin_hum, lin_t *lin_temp) {
+    int32_t ret = 0;
+
+    ret |= hts221_hum_adc_point_0_get(nullptr, &lin_hum->x0);
+    ret |= hts221_hum_rh_point_0_get(nullptr, &lin_hum->y0);
+    ret |= hts221_hum_adc_point_1_get(nullptr, &lin_hum->x1);
+    ret |= hts221_hum_rh_point_1_get(nullptr, &lin_hum->y1);
+    ret |= hts221_temp_adc_point_0_get(nullptr, &lin_temp->x0);
+    ret |= hts221_temp_deg_point_0_get(nullptr, &lin_temp->y0);
+    ret |= hts221_temp_adc_point_1_get(nullptr, &lin_temp->x1);
+    ret |= hts221_temp_deg_point_1_get(nullptr, &lin_temp->y1);
+
+    return ret == 0 && lin_hum->x1 != lin_hum->x0 && lin_temp->x1 != lin_temp->x0;
+}
+
+void GasCompensationInit(gas_compensation_t *comp, const lin_t *lin_hum, const lin_t *lin_temp) {
+    // a zero gain makes every update return the default ticks
+    comp->rh_gain = 0;
+    comp->rh_offset = GAS_COMPENSATION_DEFAULT_RH;
+    comp->t_gain = 0;
+    comp->t_offset = GAS_COMPENSATION_DEFAULT_T;
+
+    if (lin_hum && lin_hum->x1 != lin_hum->x0) {
+        LinToGain(lin_hum, SGP41_TICKS_PER_RH, 0.0f, &comp->rh_gain, &comp->rh_offset);
+    }
+    if (lin_temp && lin_temp->x1 != lin_temp->x0) {
+        LinToGain(lin_temp, SGP41_TICKS_PER_DEGC, SGP41_T_OFFSET_DEGC, &comp->t_gain, &comp->t_offset);
+    }
+
+    comp->rh_ticks = GAS_COMPENSATION_DEFAULT_RH;
+    comp->t_ticks = GAS_COMPENSATION_DEFAULT_T;
+}
+
+bool GasCompensationUpdate(gas_compensation_t *comp, const uint8_t *burst) {
+    const hts221_status_reg_t *status = (const hts221_status_reg_t *) &burst[0];
+
+    if (status->h_da) {
+        comp->rh_ticks = ToTicks(comp->rh_gain, comp->rh_offset, RawToInt16(&burst[1]));
+    }
+    if (status->t_da) {
+        comp->t_ticks = ToTicks(comp->t_gain, comp->t_offset, RawToInt16(&burst[3]));
+    }
+
+    return status->h_da || status->t_da;
+}
+
+bool GasCompensationRead(gas_compensation_t *comp) {
+    uint8_t burst[HTS221_DATA_BURST_LEN];
+
+    if (hts221_data_get(nullptr, burst) != 0) {
+        return false;
+    }
+
+    return GasCompensationUpdate(comp, burst);
+}
@@ -22,6 +22,9 @@
 #ifndef HTS221_REGS_H
 #define HTS221_REGS_H
 
+// outside of the C linkage block, the I2C driver has C++ linkage
+#include "../I2c/I2c.h"
+
 #ifdef __cplusplus
   extern "C" {
 #endif
@@ -196,6 +199,12 @@ typedef struct {
 #define HTS221_T1_OUT_L            0x3EU
 #define HTS221_T1_OUT_H            0x3FU
 
+/** Set in the sub-address to read several registers in one transfer **/
+#define HTS221_AUTO_INCREMENT      0x80U
+
+/** STATUS_REG, HUMIDITY_OUT_L/H, TEMP_OUT_L/H read by hts221_(queue_)data_get **/
+#define HTS221_DATA_BURST_LEN      5U
+
 /**
   * @defgroup HTS221_Register_Union
   * @brief    This union group all the registers that has a bitfield
@@ -281,6 +290,9 @@ int32_t hts221_humidity_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t hts221_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
+int32_t hts221_data_get(stmdev_ctx_t *ctx, uint8_t *buff);
+i2c_xfer_t* hts221_queue_data_get(i2c_queue_t *queue, uint8_t *buff);
+
 int32_t hts221_device_id_get(stmdev_ctx_t *ctx, uint8_t *buff);
 
 int32_t hts221_power_on_set(stmdev_ctx_t *ctx, uint8_t val);
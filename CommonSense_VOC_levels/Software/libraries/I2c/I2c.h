@@ -36,6 +36,7 @@
 #define I2C_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 // return value
 #define TWI_SUCCESS         (0) // success
@@ -49,6 +50,28 @@
 #define TWI_FREQ_400KHZ     (400000)    // fast mode
 #define TWI_FREQ_1MHZ       (1000000)   // fast mode plus
 
+// transactions in one queued bus cycle
+#define TWI_QUEUE_MAX_XFERS (8)
+
+/**
+ * @brief  One queued transaction, the register address (if any) is written and
+ *         data is read or written directly from/to the caller buffer
+ */
+typedef struct {
+    uint8_t i2c_addr;
+    uint8_t reg[2];
+    uint8_t reg_len;
+    uint8_t *data;
+    uint16_t size;
+    bool read;
+    uint8_t status;     // TWI_SUCCESS once submitted without error
+} i2c_xfer_t;
+
+typedef struct {
+    i2c_xfer_t xfers[TWI_QUEUE_MAX_XFERS];
+    uint8_t count;
+} i2c_queue_t;
+
 
 /**
  * @brief  I2C init
@@ -126,5 +149,65 @@ uint8_t i2c_write_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data
  */
 uint8_t i2c_read_regs_16addr(uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size);
 
+/**
+ * @brief  Number of failed transfers since boot, errors are not printed
+ * @param  None
+ * @retval Error count
+ */
+uint32_t i2c_get_error_count(void);
+
+/**
+ * @brief  Result of the last failed I2C_TRANSFER
+ * @param  None
+ * @retval Negated errno
+ */
+int i2c_get_last_errno(void);
+
+/**
+ * @brief  Empty a transaction queue
+ * @param  [in] queue Queue to reset
+ * @retval None
+ */
+void i2c_queue_init(i2c_queue_t *queue);
+
+/**
+ * @brief  Queue a register read (write register address, repeated start, read)
+ * @param  [in] queue Queue to add to
+ * @param  [in] i2c_addr I2C devices address
+ * @param  [in] reg_addr I2C devices register address
+ * @param  [out] data buffer which is filled on submit, must stay valid until then
+ * @param  [in] size size of data to read
+ * @retval Queued transaction, nullptr if the queue is full
+ */
+i2c_xfer_t* i2c_queue_read_regs(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *data, uint16_t size);
+
+/**
+ * @brief  Queue a register read with 16 bit address
+ * @retval Queued transaction, nullptr if the queue is full
+ */
+i2c_xfer_t* i2c_queue_read_regs_16addr(i2c_queue_t *queue, uint8_t i2c_addr, uint16_t reg_addr, uint8_t *data, uint16_t size);
+
+/**
+ * @brief  Queue a plain read, e.g. the result of a command sent before
+ * @retval Queued transaction, nullptr if the queue is full
+ */
+i2c_xfer_t* i2c_queue_read_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size);
+
+/**
+ * @brief  Queue a plain write, e.g. a command to start the next measurement
+ * @retval Queued transaction, nullptr if the queue is full
+ */
+i2c_xfer_t* i2c_queue_write_data(i2c_queue_t *queue, uint8_t i2c_addr, uint8_t *data, uint16_t size);
+
+/**
+ * @brief  Run all queued transactions in a single I2C_TRANSFER. If the bus cycle
+ *         fails, the transactions are retried one by one so that every
+ *         i2c_xfer_t status tells which device failed. The queue is kept and
+ *         can be submitted again for the next poll.
+ * @param  [in] queue Queue to submit
+ * @retval TWI_SUCCESS (0) if all transactions succeeded
+ */
+uint8_t i2c_queue_submit(i2c_queue_t *queue);
+
 
 #endif // I2C_H
@@ -598,6 +598,19 @@ int32_t lis2mdl_temperature_raw_get(stmdev_ctx_t *ctx, uint8_t *buff) {
     return ret;
 }
 
+/**
+  * @brief  Queue a burst read of status, magnetic field and temperature so it
+  *         runs in the same bus cycle as other sensors.[get]
+  *
+  * @param  queue   I2C transaction queue
+  * @param  buff    LIS2MDL_DATA_BURST_LEN bytes: status, x, y, z, temperature
+  * @retval         queued transaction, nullptr if the queue is full
+  *
+  */
+i2c_xfer_t* lis2mdl_queue_data_get(i2c_queue_t *queue, uint8_t *buff) {
+    return i2c_queue_read_regs(queue, LIS2MDL_I2C_ADD, LIS2MDL_STATUS_REG, buff, LIS2MDL_DATA_BURST_LEN);
+}
+
 /**
   * @}
   *
@@ -96,6 +96,41 @@ int16_t sgp41_measure_raw_signals(uint16_t relative_humidity, uint16_t temperatu
     return NO_ERROR;
 }
 
+int16_t sgp41_queue_measure_raw_signals(i2c_queue_t* queue, uint16_t relative_humidity, uint16_t temperature, uint8_t* command) {
+    uint16_t offset = 0;
+    offset = sensirion_i2c_add_command_to_buffer(&command[0], offset, 0x2619);
+
+    offset = sensirion_i2c_add_uint16_t_to_buffer(&command[0], offset,
+                                                  relative_humidity);
+    offset =
+        sensirion_i2c_add_uint16_t_to_buffer(&command[0], offset, temperature);
+
+    if (!i2c_queue_write_data(queue, SGP41_I2C_ADDRESS, &command[0], offset)) {
+        return BYTE_NUM_ERROR;
+    }
+    return NO_ERROR;
+}
+
+i2c_xfer_t* sgp41_queue_read_raw_signals(i2c_queue_t* queue, uint8_t* buffer) {
+    return i2c_queue_read_data(queue, SGP41_I2C_ADDRESS, &buffer[0], SGP41_RAW_SIGNALS_LEN);
+}
+
+int16_t sgp41_decode_raw_signals(const uint8_t* buffer, uint16_t* sraw_voc, uint16_t* sraw_nox) {
+    int16_t error;
+
+    error = sensirion_i2c_check_crc(&buffer[0], SENSIRION_WORD_SIZE, buffer[2]);
+    if (error) {
+        return error;
+    }
+    error = sensirion_i2c_check_crc(&buffer[3], SENSIRION_WORD_SIZE, buffer[5]);
+    if (error) {
+        return error;
+    }
+    *sraw_voc = sensirion_common_bytes_to_uint16_t(&buffer[0]);
+    *sraw_nox = sensirion_common_bytes_to_uint16_t(&buffer[3]);
+    return NO_ERROR;
+}
+
 int16_t sgp41_execute_self_test(uint16_t* test_result) {
     int16_t error;
     uint8_t buffer[3];
@@ -0,0 +1,688 @@
+/*
+ * Copyright (c) 2022, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sensirion_gas_index_algorithm.h"
+
+/*!< the maximum value of fix16_t */
+#define FIX16_MAXIMUM 0x7FFFFFFF
+/*!< the minimum value of fix16_t */
+#define FIX16_MINIMUM 0x80000000
+/*!< the value used to indicate overflows */
+#define FIX16_OVERFLOW 0x80000000
+/*!< fix16_t value of 1 */
+#define FIX16_ONE 0x00010000
+/*!< exp() saturates above and flushes to zero below these arguments */
+#define FIX16_EXP_MAX_ARG F16(10.3972)
+#define FIX16_EXP_MIN_ARG F16(-11.7835)
+
+static void GasIndexAlgorithm__init_instances(GasIndexAlgorithmParams* params);
+static void GasIndexAlgorithm__mean_variance_estimator__set_parameters(
+    GasIndexAlgorithmParams* params);
+static void GasIndexAlgorithm__mean_variance_estimator__set_states(
+    GasIndexAlgorithmParams* params, fix16_t mean, fix16_t std,
+    fix16_t uptime_gamma);
+static fix16_t GasIndexAlgorithm__mean_variance_estimator__get_std(
+    const GasIndexAlgorithmParams* params);
+static fix16_t GasIndexAlgorithm__mean_variance_estimator__get_mean(
+    const GasIndexAlgorithmParams* params);
+static bool GasIndexAlgorithm__mean_variance_estimator__is_initialized(
+    const GasIndexAlgorithmParams* params);
+static void GasIndexAlgorithm__mean_variance_estimator___calculate_gamma(
+    GasIndexAlgorithmParams* params);
+static void GasIndexAlgorithm__mean_variance_estimator__process(
+    GasIndexAlgorithmParams* params, fix16_t sraw);
+static void GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t X0, fix16_t K);
+static fix16_t GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+    const GasIndexAlgorithmParams* params, fix16_t sample);
+static void GasIndexAlgorithm__mox_model__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t SRAW_STD, fix16_t SRAW_MEAN);
+static fix16_t GasIndexAlgorithm__mox_model__process(
+    const GasIndexAlgorithmParams* params, fix16_t sraw);
+static void GasIndexAlgorithm__sigmoid_scaled__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t X0, fix16_t K,
+    fix16_t offset_default);
+static fix16_t GasIndexAlgorithm__sigmoid_scaled__process(
+    const GasIndexAlgorithmParams* params, fix16_t sample);
+static void GasIndexAlgorithm__adaptive_lowpass__set_parameters(
+    GasIndexAlgorithmParams* params);
+static fix16_t GasIndexAlgorithm__adaptive_lowpass__process(
+    GasIndexAlgorithmParams* params, fix16_t sample);
+
+/* Q16.16 helpers ---------------------------------------------------------- */
+
+static inline fix16_t fix16_from_int(int32_t a) {
+    return a * FIX16_ONE;
+}
+
+static inline int32_t fix16_cast_to_int(fix16_t a) {
+    return (a >= 0) ? (a >> 16) : -((-a) >> 16);
+}
+
+static inline fix16_t fix16_saturate(int64_t value) {
+    if (value > (int64_t)FIX16_MAXIMUM) {
+        return FIX16_MAXIMUM;
+    }
+    if (value < -(int64_t)FIX16_MAXIMUM) {
+        return (fix16_t)FIX16_MINIMUM;
+    }
+    return (fix16_t)value;
+}
+
+/* Product of a and b divided by 2^shift, rounded to nearest. Only the result
+ * saturates, the intermediate product is kept in 64 bits. */
+static fix16_t fix16_mul_shift(fix16_t a, fix16_t b, uint32_t shift) {
+    int64_t product = (int64_t)a * (int64_t)b;
+    int64_t half = (int64_t)1 << (15 + shift);
+
+    product = (product >= 0) ? (product + half) : (product - half + 1);
+    return fix16_saturate(product >> (16 + shift));
+}
+
+static fix16_t fix16_mul(fix16_t a, fix16_t b) {
+    return fix16_mul_shift(a, b, 0);
+}
+
+static fix16_t fix16_div(fix16_t a, fix16_t b) {
+    if (b == 0) {
+        return (fix16_t)FIX16_OVERFLOW;
+    }
+
+    int64_t num = (int64_t)a * FIX16_ONE;
+    int64_t half = (b > 0) ? (b / 2) : -(b / 2);
+
+    num = ((num >= 0) == (b > 0)) ? (num + half) : (num - half);
+    return fix16_saturate(num / b);
+}
+
+static fix16_t fix16_sqrt(fix16_t x) {
+    if (x <= 0) {
+        return 0;
+    }
+
+    uint64_t rem = (uint64_t)x << 16;
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 46;
+
+    /* 24 iterations at most, x << 16 is below 2^47 */
+    while (bit > rem) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (rem >= root + bit) {
+            rem -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    /* round to nearest */
+    if (rem > root) {
+        root++;
+    }
+    return (fix16_t)root;
+}
+
+static fix16_t fix16_exp(fix16_t x) {
+    if (x >= FIX16_EXP_MAX_ARG) {
+        return FIX16_MAXIMUM;
+    }
+    if (x <= FIX16_EXP_MIN_ARG) {
+        return 0;
+    }
+
+    /* exp(x) = 2^k * exp(r) with r = x - k * ln(2) in [0, ln(2)) */
+    int32_t k = fix16_mul(x, F16(1.4426950409)) >> 16;
+    fix16_t r = x - k * F16(0.6931471806);
+
+    /* Taylor series of exp(r) in Q2.30, 7 terms are exact to 1 LSB of Q16 */
+    const int64_t one = (int64_t)1 << 30;
+    int64_t r30 = (int64_t)r << 14;
+    int64_t p = one;
+
+    for (int32_t n = 7; n > 0; n--) {
+        p = one + ((p * r30) >> 30) / n;
+    }
+
+    int64_t result;
+    if (k >= 0) {
+        result = ((p << k) + ((int64_t)1 << 13)) >> 14;
+    } else {
+        result = (p + ((int64_t)1 << (13 - k))) >> (14 - k);
+    }
+    return fix16_saturate(result);
+}
+
+/* Algorithm --------------------------------------------------------------- */
+
+void GasIndexAlgorithm_init_with_sampling_interval(
+    GasIndexAlgorithmParams* params, int32_t algorithm_type,
+    int32_t sampling_interval) {
+
+    if (sampling_interval < 1) {
+        sampling_interval = 1;
+    } else if (sampling_interval > GasIndexAlgorithm_MAX_SAMPLING_INTERVAL) {
+        sampling_interval = GasIndexAlgorithm_MAX_SAMPLING_INTERVAL;
+    }
+
+    params->mAlgorithm_Type = algorithm_type;
+    params->mSamplingInterval = fix16_from_int(sampling_interval);
+    if ((algorithm_type == GasIndexAlgorithm_ALGORITHM_TYPE_NOX)) {
+        params->mIndex_Offset = GasIndexAlgorithm_NOX_INDEX_OFFSET_DEFAULT;
+        params->mSraw_Minimum = GasIndexAlgorithm_NOX_SRAW_MINIMUM;
+        params->mGating_Max_Duration_Minutes =
+            GasIndexAlgorithm_GATING_NOX_MAX_DURATION_MINUTES;
+        params->mInit_Duration_Mean = GasIndexAlgorithm_INIT_DURATION_MEAN_NOX;
+        params->mInit_Duration_Variance =
+            GasIndexAlgorithm_INIT_DURATION_VARIANCE_NOX;
+        params->mGating_Threshold = GasIndexAlgorithm_GATING_THRESHOLD_NOX;
+    } else {
+        params->mIndex_Offset = GasIndexAlgorithm_VOC_INDEX_OFFSET_DEFAULT;
+        params->mSraw_Minimum = GasIndexAlgorithm_VOC_SRAW_MINIMUM;
+        params->mGating_Max_Duration_Minutes =
+            GasIndexAlgorithm_GATING_VOC_MAX_DURATION_MINUTES;
+        params->mInit_Duration_Mean = GasIndexAlgorithm_INIT_DURATION_MEAN_VOC;
+        params->mInit_Duration_Variance =
+            GasIndexAlgorithm_INIT_DURATION_VARIANCE_VOC;
+        params->mGating_Threshold = GasIndexAlgorithm_GATING_THRESHOLD_VOC;
+    }
+    params->mIndex_Gain = GasIndexAlgorithm_INDEX_GAIN;
+    params->mTau_Mean_Hours = GasIndexAlgorithm_TAU_MEAN_HOURS;
+    params->mTau_Variance_Hours = GasIndexAlgorithm_TAU_VARIANCE_HOURS;
+    params->mSraw_Std_Initial = GasIndexAlgorithm_SRAW_STD_INITIAL;
+    GasIndexAlgorithm_reset(params);
+}
+
+void GasIndexAlgorithm_init(GasIndexAlgorithmParams* params,
+                            int32_t algorithm_type) {
+    GasIndexAlgorithm_init_with_sampling_interval(
+        params, algorithm_type, GasIndexAlgorithm_DEFAULT_SAMPLING_INTERVAL);
+}
+
+void GasIndexAlgorithm_reset(GasIndexAlgorithmParams* params) {
+    params->mUptime = F16(0.);
+    params->mSraw = F16(0.);
+    params->mGas_Index = F16(0.);
+    GasIndexAlgorithm__init_instances(params);
+}
+
+static void GasIndexAlgorithm__init_instances(GasIndexAlgorithmParams* params) {
+
+    GasIndexAlgorithm__mean_variance_estimator__set_parameters(params);
+    GasIndexAlgorithm__mox_model__set_parameters(
+        params, GasIndexAlgorithm__mean_variance_estimator__get_std(params),
+        GasIndexAlgorithm__mean_variance_estimator__get_mean(params));
+    if ((params->mAlgorithm_Type == GasIndexAlgorithm_ALGORITHM_TYPE_NOX)) {
+        GasIndexAlgorithm__sigmoid_scaled__set_parameters(
+            params, GasIndexAlgorithm_SIGMOID_X0_NOX,
+            GasIndexAlgorithm_SIGMOID_K_NOX,
+            GasIndexAlgorithm_NOX_INDEX_OFFSET_DEFAULT);
+    } else {
+        GasIndexAlgorithm__sigmoid_scaled__set_parameters(
+            params, GasIndexAlgorithm_SIGMOID_X0_VOC,
+            GasIndexAlgorithm_SIGMOID_K_VOC,
+            GasIndexAlgorithm_VOC_INDEX_OFFSET_DEFAULT);
+    }
+    GasIndexAlgorithm__adaptive_lowpass__set_parameters(params);
+}
+
+void GasIndexAlgorithm_get_states(const GasIndexAlgorithmParams* params,
+                                  fix16_t* state0, fix16_t* state1) {
+
+    *state0 = GasIndexAlgorithm__mean_variance_estimator__get_mean(params);
+    *state1 = GasIndexAlgorithm__mean_variance_estimator__get_std(params);
+}
+
+void GasIndexAlgorithm_set_states(GasIndexAlgorithmParams* params,
+                                  fix16_t state0, fix16_t state1) {
+
+    GasIndexAlgorithm__mean_variance_estimator__set_states(
+        params, state0, state1, GasIndexAlgorithm_PERSISTENCE_UPTIME_GAMMA);
+    GasIndexAlgorithm__mox_model__set_parameters(
+        params, GasIndexAlgorithm__mean_variance_estimator__get_std(params),
+        GasIndexAlgorithm__mean_variance_estimator__get_mean(params));
+    params->mSraw = state0;
+}
+
+void GasIndexAlgorithm_process(GasIndexAlgorithmParams* params, int32_t sraw,
+                               int32_t* gas_index) {
+
+    if ((params->mUptime <= GasIndexAlgorithm_INITIAL_BLACKOUT)) {
+        params->mUptime = (params->mUptime + params->mSamplingInterval);
+    } else {
+        if (((sraw > 0) && (sraw < 65000))) {
+            if ((sraw < (params->mSraw_Minimum + 1))) {
+                sraw = (params->mSraw_Minimum + 1);
+            } else if ((sraw > (params->mSraw_Minimum + 32767))) {
+                sraw = (params->mSraw_Minimum + 32767);
+            }
+            params->mSraw = fix16_from_int((sraw - params->mSraw_Minimum));
+        }
+        if (((params->mAlgorithm_Type ==
+              GasIndexAlgorithm_ALGORITHM_TYPE_VOC) ||
+             GasIndexAlgorithm__mean_variance_estimator__is_initialized(
+                 params))) {
+            params->mGas_Index =
+                GasIndexAlgorithm__mox_model__process(params, params->mSraw);
+            params->mGas_Index = GasIndexAlgorithm__sigmoid_scaled__process(
+                params, params->mGas_Index);
+        } else {
+            params->mGas_Index = params->mIndex_Offset;
+        }
+        params->mGas_Index = GasIndexAlgorithm__adaptive_lowpass__process(
+            params, params->mGas_Index);
+        if ((params->mGas_Index < F16(0.5))) {
+            params->mGas_Index = F16(0.5);
+        }
+        if ((params->mSraw > F16(0.))) {
+            GasIndexAlgorithm__mean_variance_estimator__process(params,
+                                                                params->mSraw);
+            GasIndexAlgorithm__mox_model__set_parameters(
+                params,
+                GasIndexAlgorithm__mean_variance_estimator__get_std(params),
+                GasIndexAlgorithm__mean_variance_estimator__get_mean(params));
+        }
+    }
+    *gas_index = fix16_cast_to_int((params->mGas_Index + F16(0.5)));
+}
+
+static void GasIndexAlgorithm__mean_variance_estimator__set_parameters(
+    GasIndexAlgorithmParams* params) {
+
+    /* 1 / 3600 is only 18 LSB in Q16.16, so the hourly rates are computed from
+     * the seconds-based constant to keep the resolution */
+    fix16_t interval_hours =
+        fix16_div(params->mSamplingInterval, F16(3600.));
+
+    params->m_Mean_Variance_Estimator___Initialized = false;
+    params->m_Mean_Variance_Estimator___Mean = F16(0.);
+    params->m_Mean_Variance_Estimator___Sraw_Offset = F16(0.);
+    params->m_Mean_Variance_Estimator___Std = params->mSraw_Std_Initial;
+    params->m_Mean_Variance_Estimator___Gamma_Mean = fix16_div(
+        fix16_mul(F16((64. * 64.) / 3600.), params->mSamplingInterval),
+        (params->mTau_Mean_Hours + interval_hours));
+    params->m_Mean_Variance_Estimator___Gamma_Variance = fix16_div(
+        fix16_mul(F16(64. / 3600.), params->mSamplingInterval),
+        (params->mTau_Variance_Hours + interval_hours));
+    if ((params->mAlgorithm_Type == GasIndexAlgorithm_ALGORITHM_TYPE_NOX)) {
+        params->m_Mean_Variance_Estimator___Gamma_Initial_Mean = fix16_div(
+            fix16_mul(F16(64. * 64.), params->mSamplingInterval),
+            (GasIndexAlgorithm_TAU_INITIAL_MEAN_NOX +
+             params->mSamplingInterval));
+    } else {
+        params->m_Mean_Variance_Estimator___Gamma_Initial_Mean = fix16_div(
+            fix16_mul(F16(64. * 64.), params->mSamplingInterval),
+            (GasIndexAlgorithm_TAU_INITIAL_MEAN_VOC +
+             params->mSamplingInterval));
+    }
+    params->m_Mean_Variance_Estimator___Gamma_Initial_Variance = fix16_div(
+        fix16_mul(F16(64.), params->mSamplingInterval),
+        (GasIndexAlgorithm_TAU_INITIAL_VARIANCE + params->mSamplingInterval));
+    params->m_Mean_Variance_Estimator__Gamma_Mean = F16(0.);
+    params->m_Mean_Variance_Estimator__Gamma_Variance = F16(0.);
+    params->m_Mean_Variance_Estimator___Uptime_Gamma = F16(0.);
+    params->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
+    params->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
+}
+
+static void GasIndexAlgorithm__mean_variance_estimator__set_states(
+    GasIndexAlgorithmParams* params, fix16_t mean, fix16_t std,
+    fix16_t uptime_gamma) {
+
+    params->m_Mean_Variance_Estimator___Mean = mean;
+    params->m_Mean_Variance_Estimator___Std = std;
+    params->m_Mean_Variance_Estimator___Uptime_Gamma = uptime_gamma;
+    params->m_Mean_Variance_Estimator___Initialized = true;
+}
+
+static fix16_t GasIndexAlgorithm__mean_variance_estimator__get_std(
+    const GasIndexAlgorithmParams* params) {
+
+    return params->m_Mean_Variance_Estimator___Std;
+}
+
+static fix16_t GasIndexAlgorithm__mean_variance_estimator__get_mean(
+    const GasIndexAlgorithmParams* params) {
+
+    return (params->m_Mean_Variance_Estimator___Mean +
+            params->m_Mean_Variance_Estimator___Sraw_Offset);
+}
+
+static bool GasIndexAlgorithm__mean_variance_estimator__is_initialized(
+    const GasIndexAlgorithmParams* params) {
+
+    return params->m_Mean_Variance_Estimator___Initialized;
+}
+
+static void GasIndexAlgorithm__mean_variance_estimator___calculate_gamma(
+    GasIndexAlgorithmParams* params) {
+
+    fix16_t uptime_limit;
+    fix16_t sigmoid_gamma_mean;
+    fix16_t gamma_mean;
+    fix16_t gating_threshold_mean;
+    fix16_t sigmoid_gating_mean;
+    fix16_t sigmoid_gamma_variance;
+    fix16_t gamma_variance;
+    fix16_t gating_threshold_variance;
+    fix16_t sigmoid_gating_variance;
+
+    uptime_limit = (GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__FIX16_MAX -
+                    params->mSamplingInterval);
+    if ((params->m_Mean_Variance_Estimator___Uptime_Gamma < uptime_limit)) {
+        params->m_Mean_Variance_Estimator___Uptime_Gamma =
+            (params->m_Mean_Variance_Estimator___Uptime_Gamma +
+             params->mSamplingInterval);
+    }
+    if ((params->m_Mean_Variance_Estimator___Uptime_Gating < uptime_limit)) {
+        params->m_Mean_Variance_Estimator___Uptime_Gating =
+            (params->m_Mean_Variance_Estimator___Uptime_Gating +
+             params->mSamplingInterval);
+    }
+    GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+        params, params->mInit_Duration_Mean,
+        GasIndexAlgorithm_INIT_TRANSITION_MEAN);
+    sigmoid_gamma_mean =
+        GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+            params, params->m_Mean_Variance_Estimator___Uptime_Gamma);
+    gamma_mean =
+        (params->m_Mean_Variance_Estimator___Gamma_Mean +
+         fix16_mul(
+             (params->m_Mean_Variance_Estimator___Gamma_Initial_Mean -
+              params->m_Mean_Variance_Estimator___Gamma_Mean),
+             sigmoid_gamma_mean));
+    gating_threshold_mean =
+        (params->mGating_Threshold +
+         fix16_mul(
+             (GasIndexAlgorithm_GATING_THRESHOLD_INITIAL -
+              params->mGating_Threshold),
+             GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+                 params, params->m_Mean_Variance_Estimator___Uptime_Gating)));
+    GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+        params, gating_threshold_mean,
+        GasIndexAlgorithm_GATING_THRESHOLD_TRANSITION);
+    sigmoid_gating_mean =
+        GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+            params, params->mGas_Index);
+    params->m_Mean_Variance_Estimator__Gamma_Mean =
+        fix16_mul(sigmoid_gating_mean, gamma_mean);
+    GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+        params, params->mInit_Duration_Variance,
+        GasIndexAlgorithm_INIT_TRANSITION_VARIANCE);
+    sigmoid_gamma_variance =
+        GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+            params, params->m_Mean_Variance_Estimator___Uptime_Gamma);
+    gamma_variance =
+        (params->m_Mean_Variance_Estimator___Gamma_Variance +
+         fix16_mul(
+             (params->m_Mean_Variance_Estimator___Gamma_Initial_Variance -
+              params->m_Mean_Variance_Estimator___Gamma_Variance),
+             (sigmoid_gamma_variance - sigmoid_gamma_mean)));
+    gating_threshold_variance =
+        (params->mGating_Threshold +
+         fix16_mul(
+             (GasIndexAlgorithm_GATING_THRESHOLD_INITIAL -
+              params->mGating_Threshold),
+             GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+                 params, params->m_Mean_Variance_Estimator___Uptime_Gating)));
+    GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+        params, gating_threshold_variance,
+        GasIndexAlgorithm_GATING_THRESHOLD_TRANSITION);
+    sigmoid_gating_variance =
+        GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+            params, params->mGas_Index);
+    params->m_Mean_Variance_Estimator__Gamma_Variance =
+        fix16_mul(sigmoid_gating_variance, gamma_variance);
+    params->m_Mean_Variance_Estimator___Gating_Duration_Minutes =
+        (params->m_Mean_Variance_Estimator___Gating_Duration_Minutes +
+         fix16_mul(
+             fix16_div(params->mSamplingInterval, F16(60.)),
+             (fix16_mul((F16(1.) - sigmoid_gating_mean),
+                        (F16(1.) + GasIndexAlgorithm_GATING_MAX_RATIO)) -
+              GasIndexAlgorithm_GATING_MAX_RATIO)));
+    if ((params->m_Mean_Variance_Estimator___Gating_Duration_Minutes <
+         F16(0.))) {
+        params->m_Mean_Variance_Estimator___Gating_Duration_Minutes = F16(0.);
+    }
+    if ((params->m_Mean_Variance_Estimator___Gating_Duration_Minutes >
+         params->mGating_Max_Duration_Minutes)) {
+        params->m_Mean_Variance_Estimator___Uptime_Gating = F16(0.);
+    }
+}
+
+static void GasIndexAlgorithm__mean_variance_estimator__process(
+    GasIndexAlgorithmParams* params, fix16_t sraw) {
+
+    fix16_t delta_sgp;
+    fix16_t c;
+    fix16_t additional_scaling;
+
+    if ((params->m_Mean_Variance_Estimator___Initialized == false)) {
+        params->m_Mean_Variance_Estimator___Initialized = true;
+        params->m_Mean_Variance_Estimator___Sraw_Offset = sraw;
+        params->m_Mean_Variance_Estimator___Mean = F16(0.);
+    } else {
+        if (((params->m_Mean_Variance_Estimator___Mean >= F16(100.)) ||
+             (params->m_Mean_Variance_Estimator___Mean <= F16(-100.)))) {
+            params->m_Mean_Variance_Estimator___Sraw_Offset =
+                (params->m_Mean_Variance_Estimator___Sraw_Offset +
+                 params->m_Mean_Variance_Estimator___Mean);
+            params->m_Mean_Variance_Estimator___Mean = F16(0.);
+        }
+        sraw = (sraw - params->m_Mean_Variance_Estimator___Sraw_Offset);
+        GasIndexAlgorithm__mean_variance_estimator___calculate_gamma(params);
+        delta_sgp = fix16_div(
+            (sraw - params->m_Mean_Variance_Estimator___Mean),
+            GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING);
+        if ((delta_sgp < F16(0.))) {
+            c = (params->m_Mean_Variance_Estimator___Std - delta_sgp);
+        } else {
+            c = (params->m_Mean_Variance_Estimator___Std + delta_sgp);
+        }
+        additional_scaling = F16(1.);
+        if ((c > F16(1440.))) {
+            additional_scaling = fix16_mul(fix16_div(c, F16(1440.)),
+                                           fix16_div(c, F16(1440.)));
+        }
+        params->m_Mean_Variance_Estimator___Std = fix16_mul(
+            fix16_sqrt(fix16_mul(
+                additional_scaling,
+                (GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING -
+                 params->m_Mean_Variance_Estimator__Gamma_Variance))),
+            fix16_sqrt((
+                fix16_mul(
+                    params->m_Mean_Variance_Estimator___Std,
+                    fix16_div(
+                        params->m_Mean_Variance_Estimator___Std,
+                        fix16_mul(
+                            GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING,
+                            additional_scaling))) +
+                fix16_mul(
+                    fix16_div(
+                        fix16_mul(
+                            params->m_Mean_Variance_Estimator__Gamma_Variance,
+                            delta_sgp),
+                        additional_scaling),
+                    delta_sgp))));
+        /* the mean rate carries an additional scaling of 64 for resolution,
+         * it is divided out of the 64 bit product */
+        params->m_Mean_Variance_Estimator___Mean =
+            (params->m_Mean_Variance_Estimator___Mean +
+             fix16_mul_shift(
+                 params->m_Mean_Variance_Estimator__Gamma_Mean, delta_sgp,
+                 GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__ADDITIONAL_GAMMA_MEAN_SCALING_SHIFT));
+    }
+}
+
+static void GasIndexAlgorithm__mean_variance_estimator___sigmoid__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t X0, fix16_t K) {
+
+    params->m_Mean_Variance_Estimator___Sigmoid__K = K;
+    params->m_Mean_Variance_Estimator___Sigmoid__X0 = X0;
+}
+
+static fix16_t GasIndexAlgorithm__mean_variance_estimator___sigmoid__process(
+    const GasIndexAlgorithmParams* params, fix16_t sample) {
+
+    fix16_t x;
+
+    x = fix16_mul(params->m_Mean_Variance_Estimator___Sigmoid__K,
+                  (sample - params->m_Mean_Variance_Estimator___Sigmoid__X0));
+    if ((x < FIX16_EXP_MIN_ARG)) {
+        return F16(1.);
+    } else if ((x > FIX16_EXP_MAX_ARG)) {
+        return F16(0.);
+    } else {
+        return fix16_div(F16(1.), (F16(1.) + fix16_exp(x)));
+    }
+}
+
+static void GasIndexAlgorithm__mox_model__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t SRAW_STD, fix16_t SRAW_MEAN) {
+
+    params->m_Mox_Model__Sraw_Std = SRAW_STD;
+    params->m_Mox_Model__Sraw_Mean = SRAW_MEAN;
+}
+
+static fix16_t GasIndexAlgorithm__mox_model__process(
+    const GasIndexAlgorithmParams* params, fix16_t sraw) {
+
+    if ((params->mAlgorithm_Type == GasIndexAlgorithm_ALGORITHM_TYPE_NOX)) {
+        return fix16_mul(fix16_div((sraw - params->m_Mox_Model__Sraw_Mean),
+                                   GasIndexAlgorithm_SRAW_STD_NOX),
+                         params->mIndex_Gain);
+    } else {
+        return fix16_mul(
+            fix16_div((sraw - params->m_Mox_Model__Sraw_Mean),
+                      (-(params->m_Mox_Model__Sraw_Std +
+                         GasIndexAlgorithm_SRAW_STD_BONUS_VOC))),
+            params->mIndex_Gain);
+    }
+}
+
+static void GasIndexAlgorithm__sigmoid_scaled__set_parameters(
+    GasIndexAlgorithmParams* params, fix16_t X0, fix16_t K,
+    fix16_t offset_default) {
+
+    params->m_Sigmoid_Scaled__K = K;
+    params->m_Sigmoid_Scaled__X0 = X0;
+    params->m_Sigmoid_Scaled__Offset_Default = offset_default;
+}
+
+static fix16_t GasIndexAlgorithm__sigmoid_scaled__process(
+    const GasIndexAlgorithmParams* params, fix16_t sample) {
+
+    fix16_t x;
+    fix16_t shift;
+
+    x = fix16_mul(params->m_Sigmoid_Scaled__K,
+                  (sample - params->m_Sigmoid_Scaled__X0));
+    if ((x < FIX16_EXP_MIN_ARG)) {
+        return GasIndexAlgorithm_SIGMOID_L;
+    } else if ((x > FIX16_EXP_MAX_ARG)) {
+        return F16(0.);
+    } else {
+        if ((sample >= F16(0.))) {
+            if ((params->m_Sigmoid_Scaled__Offset_Default == F16(1.))) {
+                shift = fix16_mul(F16((500. / 499.)),
+                                  (F16(1.) - params->mIndex_Offset));
+            } else {
+                shift = fix16_div(
+                    (GasIndexAlgorithm_SIGMOID_L -
+                     fix16_mul(F16(5.), params->mIndex_Offset)),
+                    F16(4.));
+            }
+            return (fix16_div((GasIndexAlgorithm_SIGMOID_L + shift),
+                              (F16(1.) + fix16_exp(x))) -
+                    shift);
+        } else {
+            return fix16_mul(
+                fix16_div(params->mIndex_Offset,
+                          params->m_Sigmoid_Scaled__Offset_Default),
+                fix16_div(GasIndexAlgorithm_SIGMOID_L,
+                          (F16(1.) + fix16_exp(x))));
+        }
+    }
+}
+
+static void GasIndexAlgorithm__adaptive_lowpass__set_parameters(
+    GasIndexAlgorithmParams* params) {
+
+    params->m_Adaptive_Lowpass__A1 =
+        fix16_div(params->mSamplingInterval,
+                  (GasIndexAlgorithm_LP_TAU_FAST + params->mSamplingInterval));
+    params->m_Adaptive_Lowpass__A2 =
+        fix16_div(params->mSamplingInterval,
+                  (GasIndexAlgorithm_LP_TAU_SLOW + params->mSamplingInterval));
+    params->m_Adaptive_Lowpass___Initialized = false;
+}
+
+static fix16_t GasIndexAlgorithm__adaptive_lowpass__process(
+    GasIndexAlgorithmParams* params, fix16_t sample) {
+
+    fix16_t abs_delta;
+    fix16_t F1;
+    fix16_t tau_a;
+    fix16_t a3;
+
+    if ((params->m_Adaptive_Lowpass___Initialized == false)) {
+        params->m_Adaptive_Lowpass___X1 = sample;
+        params->m_Adaptive_Lowpass___X2 = sample;
+        params->m_Adaptive_Lowpass___X3 = sample;
+        params->m_Adaptive_Lowpass___Initialized = true;
+    }
+    params->m_Adaptive_Lowpass___X1 =
+        (fix16_mul((F16(1.) - params->m_Adaptive_Lowpass__A1),
+                   params->m_Adaptive_Lowpass___X1) +
+         fix16_mul(params->m_Adaptive_Lowpass__A1, sample));
+    params->m_Adaptive_Lowpass___X2 =
+        (fix16_mul((F16(1.) - params->m_Adaptive_Lowpass__A2),
+                   params->m_Adaptive_Lowpass___X2) +
+         fix16_mul(params->m_Adaptive_Lowpass__A2, sample));
+    abs_delta =
+        (params->m_Adaptive_Lowpass___X1 - params->m_Adaptive_Lowpass___X2);
+    if ((abs_delta < F16(0.))) {
+        abs_delta = (-abs_delta);
+    }
+    F1 = fix16_exp(fix16_mul(GasIndexAlgorithm_LP_ALPHA, abs_delta));
+    tau_a = (fix16_mul(
+                 (GasIndexAlgorithm_LP_TAU_SLOW - GasIndexAlgorithm_LP_TAU_FAST),
+                 F1) +
+             GasIndexAlgorithm_LP_TAU_FAST);
+    a3 = fix16_div(params->mSamplingInterval,
+                   (params->mSamplingInterval + tau_a));
+    params->m_Adaptive_Lowpass___X3 =
+        (fix16_mul((F16(1.) - a3), params->m_Adaptive_Lowpass___X3) +
+         fix16_mul(a3, sample));
+    return params->m_Adaptive_Lowpass___X3;
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2022, Sensirion AG
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of Sensirion AG nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GASINDEXALGORITHM_H_
+#define GASINDEXALGORITHM_H_
+
+#include "sensirion_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fixed point arithmetic (Q16.16), no floating point is used per sample */
+typedef int32_t fix16_t;
+
+#define F16(x) \
+    ((fix16_t)(((x) >= 0) ? ((x)*65536.0 + 0.5) : ((x)*65536.0 - 0.5)))
+
+// Should be set by the building toolchain
+#ifndef LIBRARY_VERSION_NAME
+#define LIBRARY_VERSION_NAME "3.2.0-fix16"
+#endif
+
+#define GasIndexAlgorithm_ALGORITHM_TYPE_VOC (0)
+#define GasIndexAlgorithm_ALGORITHM_TYPE_NOX (1)
+#define GasIndexAlgorithm_DEFAULT_SAMPLING_INTERVAL (1)
+#define GasIndexAlgorithm_MAX_SAMPLING_INTERVAL (10)
+#define GasIndexAlgorithm_INITIAL_BLACKOUT (F16(45.))
+#define GasIndexAlgorithm_INDEX_GAIN (F16(230.))
+#define GasIndexAlgorithm_SRAW_STD_INITIAL (F16(50.))
+#define GasIndexAlgorithm_SRAW_STD_BONUS_VOC (F16(220.))
+#define GasIndexAlgorithm_SRAW_STD_NOX (F16(2000.))
+#define GasIndexAlgorithm_TAU_MEAN_HOURS (F16(12.))
+#define GasIndexAlgorithm_TAU_VARIANCE_HOURS (F16(12.))
+#define GasIndexAlgorithm_TAU_INITIAL_MEAN_VOC (F16(20.))
+#define GasIndexAlgorithm_TAU_INITIAL_MEAN_NOX (F16(1200.))
+#define GasIndexAlgorithm_INIT_DURATION_MEAN_VOC (F16((3600. * 0.75)))
+#define GasIndexAlgorithm_INIT_DURATION_MEAN_NOX (F16((3600. * 4.75)))
+#define GasIndexAlgorithm_INIT_TRANSITION_MEAN (F16(0.01))
+#define GasIndexAlgorithm_TAU_INITIAL_VARIANCE (F16(2500.))
+#define GasIndexAlgorithm_INIT_DURATION_VARIANCE_VOC (F16((3600. * 1.45)))
+#define GasIndexAlgorithm_INIT_DURATION_VARIANCE_NOX (F16((3600. * 5.70)))
+#define GasIndexAlgorithm_INIT_TRANSITION_VARIANCE (F16(0.01))
+#define GasIndexAlgorithm_GATING_THRESHOLD_VOC (F16(340.))
+#define GasIndexAlgorithm_GATING_THRESHOLD_NOX (F16(30.))
+#define GasIndexAlgorithm_GATING_THRESHOLD_INITIAL (F16(510.))
+#define GasIndexAlgorithm_GATING_THRESHOLD_TRANSITION (F16(0.09))
+#define GasIndexAlgorithm_GATING_VOC_MAX_DURATION_MINUTES (F16((60. * 3.)))
+#define GasIndexAlgorithm_GATING_NOX_MAX_DURATION_MINUTES (F16((60. * 12.)))
+#define GasIndexAlgorithm_GATING_MAX_RATIO (F16(0.3))
+#define GasIndexAlgorithm_SIGMOID_L (F16(500.))
+#define GasIndexAlgorithm_SIGMOID_K_VOC (F16(-0.0065))
+#define GasIndexAlgorithm_SIGMOID_X0_VOC (F16(213.))
+#define GasIndexAlgorithm_SIGMOID_K_NOX (F16(-0.0101))
+#define GasIndexAlgorithm_SIGMOID_X0_NOX (F16(614.))
+#define GasIndexAlgorithm_VOC_INDEX_OFFSET_DEFAULT (F16(100.))
+#define GasIndexAlgorithm_NOX_INDEX_OFFSET_DEFAULT (F16(1.))
+#define GasIndexAlgorithm_LP_TAU_FAST (F16(20.0))
+#define GasIndexAlgorithm_LP_TAU_SLOW (F16(500.0))
+#define GasIndexAlgorithm_LP_ALPHA (F16(-0.2))
+#define GasIndexAlgorithm_VOC_SRAW_MINIMUM (20000)
+#define GasIndexAlgorithm_NOX_SRAW_MINIMUM (10000)
+#define GasIndexAlgorithm_PERSISTENCE_UPTIME_GAMMA (F16((3. * 3600.)))
+#define GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__GAMMA_SCALING (F16(64.))
+#define GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__ADDITIONAL_GAMMA_MEAN_SCALING_SHIFT (6)
+#define GasIndexAlgorithm_MEAN_VARIANCE_ESTIMATOR__FIX16_MAX (F16(32767.))
+
+/* Number of values returned by GasIndexAlgorithm_get_states() */
+#define GasIndexAlgorithm_STATE_SIZE (2)
+
+/**
+ * Struct to hold all parameters and states of the gas algorithm. All values
+ * are Q16.16 unless noted otherwise, so the struct can be stored as is.
+ */
+typedef struct {
+    int mAlgorithm_Type;
+    fix16_t mSamplingInterval;
+    fix16_t mIndex_Offset;
+    int32_t mSraw_Minimum;
+    fix16_t mGating_Max_Duration_Minutes;
+    fix16_t mInit_Duration_Mean;
+    fix16_t mInit_Duration_Variance;
+    fix16_t mGating_Threshold;
+    fix16_t mIndex_Gain;
+    fix16_t mTau_Mean_Hours;
+    fix16_t mTau_Variance_Hours;
+    fix16_t mSraw_Std_Initial;
+    fix16_t mUptime;
+    fix16_t mSraw;
+    fix16_t mGas_Index;
+    bool m_Mean_Variance_Estimator___Initialized;
+    fix16_t m_Mean_Variance_Estimator___Mean;
+    fix16_t m_Mean_Variance_Estimator___Sraw_Offset;
+    fix16_t m_Mean_Variance_Estimator___Std;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Mean;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Variance;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Mean;
+    fix16_t m_Mean_Variance_Estimator___Gamma_Initial_Variance;
+    fix16_t m_Mean_Variance_Estimator__Gamma_Mean;
+    fix16_t m_Mean_Variance_Estimator__Gamma_Variance;
+    fix16_t m_Mean_Variance_Estimator___Uptime_Gamma;
+    fix16_t m_Mean_Variance_Estimator___Uptime_Gating;
+    fix16_t m_Mean_Variance_Estimator___Gating_Duration_Minutes;
+    fix16_t m_Mean_Variance_Estimator___Sigmoid__K;
+    fix16_t m_Mean_Variance_Estimator___Sigmoid__X0;
+    fix16_t m_Mox_Model__Sraw_Std;
+    fix16_t m_Mox_Model__Sraw_Mean;
+    fix16_t m_Sigmoid_Scaled__K;
+    fix16_t m_Sigmoid_Scaled__X0;
+    fix16_t m_Sigmoid_Scaled__Offset_Default;
+    fix16_t m_Adaptive_Lowpass__A1;
+    fix16_t m_Adaptive_Lowpass__A2;
+    bool m_Adaptive_Lowpass___Initialized;
+    fix16_t m_Adaptive_Lowpass___X1;
+    fix16_t m_Adaptive_Lowpass___X2;
+    fix16_t m_Adaptive_Lowpass___X3;
+} GasIndexAlgorithmParams;
+
+/**
+ * Initialize the gas index algorithm parameters for the specified algorithm
+ * type and reset its internal states. Call this once at the beginning.
+ * @param params            Pointer to the GasIndexAlgorithmParams struct
+ * @param algorithm_type    0 (GasIndexAlgorithm_ALGORITHM_TYPE_VOC) for VOC or
+ *                          1 (GasIndexAlgorithm_ALGORITHM_TYPE_NOX) for NOx
+ * @param sampling_interval Sampling interval in seconds (1 ..
+ *                          GasIndexAlgorithm_MAX_SAMPLING_INTERVAL), must match
+ *                          the rate GasIndexAlgorithm_process() is called at
+ */
+void GasIndexAlgorithm_init_with_sampling_interval(
+    GasIndexAlgorithmParams* params, int32_t algorithm_type,
+    int32_t sampling_interval);
+
+/**
+ * Initialize the gas index algorithm parameters for the specified algorithm
+ * type and reset its internal states, with the default sampling interval of
+ * 1 s.
+ * @param params          Pointer to the GasIndexAlgorithmParams struct
+ * @param algorithm_type  0 (GasIndexAlgorithm_ALGORITHM_TYPE_VOC) for VOC or
+ *                        1 (GasIndexAlgorithm_ALGORITHM_TYPE_NOX) for NOx
+ */
+void GasIndexAlgorithm_init(GasIndexAlgorithmParams* params,
+                            int32_t algorithm_type);
+
+/**
+ * Reset the internal states of the gas index algorithm. Previously set
+ * parameters are kept.
+ * @param params    Pointer to the GasIndexAlgorithmParams struct
+ */
+void GasIndexAlgorithm_reset(GasIndexAlgorithmParams* params);
+
+/**
+ * Get current algorithm states. Retrieved values can be used in
+ * GasIndexAlgorithm_set_states() to resume operation after a short
+ * interruption, skipping initial learning phase.
+ * NOTE: This feature can only be used for VOC algorithm type and only after
+ * at least 3 hours of continuous operation.
+ * @param params    Pointer to the GasIndexAlgorithmParams struct
+ * @param state0    State0 to be stored (learned mean, Q16.16)
+ * @param state1    State1 to be stored (learned standard deviation, Q16.16)
+ */
+void GasIndexAlgorithm_get_states(const GasIndexAlgorithmParams* params,
+                                  fix16_t* state0, fix16_t* state1);
+
+/**
+ * Set previously retrieved algorithm states to resume operation after a short
+ * interruption, skipping initial learning phase. This feature should not be
+ * used after interruptions of more than 10 minutes. Call this once after
+ * GasIndexAlgorithm_init(). Otherwise, the algorithm will start with initial
+ * learning phase.
+ * NOTE: This feature can only be used for VOC algorithm type.
+ * @param params    Pointer to the GasIndexAlgorithmParams struct
+ * @param state0    State0 to be restored
+ * @param state1    State1 to be restored
+ */
+void GasIndexAlgorithm_set_states(GasIndexAlgorithmParams* params,
+                                  fix16_t state0, fix16_t state1);
+
+/**
+ * Calculate the gas index value from the raw sensor value. Runs in constant
+ * time and must be called at the configured sampling interval.
+ *
+ * @param params        Pointer to the GasIndexAlgorithmParams struct
+ * @param sraw          Raw value from the SGP4x sensor
+ * @param gas_index     Calculated gas index value from the raw sensor value.
+ *                      Zero during initial blackout period and 1..500
+ *                      afterwards
+ */
+void GasIndexAlgorithm_process(GasIndexAlgorithmParams* params, int32_t sraw,
+                               int32_t* gas_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GASINDEXALGORITHM_H_ */
@@ -90,8 +90,7 @@ void sensirion_i2c_hal_free(void) {
  * @returns 0 on success, error code otherwise
  */
 int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
-    i2c_read_data(address, data, count);
-    return 0;
+    return (int8_t) i2c_read_data(address, data, count);
 }
 
 /**
@@ -107,8 +106,7 @@ int8_t sensirion_i2c_hal_read(uint8_t address, uint8_t* data, uint16_t count) {
  */
 int8_t sensirion_i2c_hal_write(uint8_t address, uint8_t* data,
                                uint16_t count) {
-    i2c_write_data(address, data, count);
-    return 0;
+    return (int8_t) i2c_write_data(address, data, count);
 }
 
 /**
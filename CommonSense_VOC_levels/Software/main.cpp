@@ -12,6 +12,12 @@
 #include "Wire.h"
 #include "KX126.h"
 #include "File.h"
+#include "sensirion_i2c_hal.h"
+#include "sgp41_i2c.h"
+#include "sensirion_gas_index_algorithm.h"
+#include "Hts221.h"
+#include "GasCompensation.h"
+#include "Lps22hh.h"
 
 #include "Tests.h"
 
@@ -42,6 +48,12 @@ extern "C" void spresense_time_cb(uint32_t *sec, uint32_t *nano);
 #define getreg32(a)     (*(volatile uint32_t *)(a))
 #define CONSOLE_BASE    CXD56_UART1_BASE
 
+/* SGP41 ------------------------------------------------------------------- */
+/** Conditioning the NOx pixel must last 10 s, but no longer */
+#define SGP41_CONDITIONING_S    10
+/** Learned mean and std of the VOC algorithm, NOx does not support persistence */
+#define GAS_STATE_SIZE          GasIndexAlgorithm_STATE_SIZE
+
 /* Private variables ------------------------------------------------------- */
 KX126 kx126(KX126_DEVICE_ADDRESS_1F);
 
@@ -49,6 +61,14 @@ KX126 kx126(KX126_DEVICE_ADDRESS_1F);
 //AudioClass *theAudio;
 static const int32_t buffer_size = 1600; /*768sample,1ch,16bit*/
 
+/* Gas index algorithms, updated with every SGP41 measurement (1 Hz) */
+static GasIndexAlgorithmParams voc_algorithm;
+static GasIndexAlgorithmParams nox_algorithm;
+static uint32_t sgp41_conditioning;
+/* HTS221 humidity and temperature as SGP41 ticks, refreshed every measurement */
+static gas_compensation_t gas_comp;
+static bool hts221_present;
+
 extern "C" {
 
 // Declared weak in Arduino.h to allow user redefinitions.
@@ -192,6 +212,173 @@ int spresense_getAcc(float acc_val[3])
     return (int)kx126.get_val(acc_val);
 }
 
+/**
+ * @brief Start the HTS221 used for compensation, without it the SGP41
+ *        measures with the default 50 %RH / 25 degC
+ */
+static void init_gas_compensation(void)
+{
+    uint8_t whoamI = 0;
+    lin_t lin_hum;
+    lin_t lin_temp;
+
+    GasCompensationInit(&gas_comp, NULL, NULL);
+    hts221_present = false;
+
+    hts221_device_id_get(nullptr, &whoamI);
+    if (whoamI != HTS221_ID || !GasCompensationReadCalibration(&lin_hum, &lin_temp)) {
+        printf("Humidity sensor (HTS221) missing, gas measurements are not compensated\r\n");
+        return;
+    }
+
+    GasCompensationInit(&gas_comp, &lin_hum, &lin_temp);
+
+    hts221_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    hts221_data_rate_set(nullptr, HTS221_ODR_1Hz);
+    hts221_power_on_set(nullptr, PROPERTY_ENABLE);
+    hts221_present = true;
+}
+
+/**
+ * @brief Start the SGP41 and reset the VOC and NOx gas index algorithms
+ *
+ * @return int 0 if the SGP41 answered
+ */
+int spresense_setupGas(void)
+{
+    uint16_t serial_number[3];
+
+    sensirion_i2c_hal_init();
+    init_gas_compensation();
+
+    GasIndexAlgorithm_init(&voc_algorithm, GasIndexAlgorithm_ALGORITHM_TYPE_VOC);
+    GasIndexAlgorithm_init(&nox_algorithm, GasIndexAlgorithm_ALGORITHM_TYPE_NOX);
+    sgp41_conditioning = SGP41_CONDITIONING_S;
+
+    return sgp41_get_serial_number(serial_number, 3);
+}
+
+/**
+ * @brief Measure the SGP41 and run the gas index algorithms, call once per
+ *        second. The first calls condition the NOx pixel, during which the NOx
+ *        index stays at its offset. The HTS221 is read in the same cycle to
+ *        compensate the measurement.
+ *
+ * @param gas_index VOC and NOx index (0 during the initial blackout, 1..500)
+ * @param sraw      VOC and NOx raw ticks
+ * @return int 0 on success
+ */
+int spresense_getGas(int32_t gas_index[2], uint16_t sraw[2])
+{
+    int16_t error;
+
+    /* on a bus error the previous ticks are used */
+    GasCompensationRead(&gas_comp);
+
+    if (sgp41_conditioning > 0) {
+        sgp41_conditioning--;
+        sraw[1] = 0;
+        error = sgp41_execute_conditioning(gas_comp.rh_ticks, gas_comp.t_ticks, &sraw[0]);
+    }
+    else {
+        error = sgp41_measure_raw_signals(gas_comp.rh_ticks, gas_comp.t_ticks, &sraw[0], &sraw[1]);
+    }
+
+    if (error) {
+        return error;
+    }
+
+    GasIndexAlgorithm_process(&voc_algorithm, sraw[0], &gas_index[0]);
+    GasIndexAlgorithm_process(&nox_algorithm, sraw[1], &gas_index[1]);
+
+    return 0;
+}
+
+/**
+ * @brief Get the learned state of the VOC algorithm, to be stored. Only valid
+ *        after 3 hours of operation.
+ *
+ * @param state VOC mean, VOC std (Q16.16)
+ */
+void spresense_getGasState(int32_t state[GAS_STATE_SIZE])
+{
+    GasIndexAlgorithm_get_states(&voc_algorithm, &state[0], &state[1]);
+}
+
+/**
+ * @brief Restore a stored VOC state, this skips its initial learning phase.
+ *        The NOx algorithm always starts learning from scratch.
+ *
+ * @param state VOC mean, VOC std (Q16.16)
+ */
+void spresense_setGasState(const int32_t state[GAS_STATE_SIZE])
+{
+    GasIndexAlgorithm_set_states(&voc_algorithm, state[0], state[1]);
+}
+
+/**
+ * @brief Get the humidity and temperature of the last gas measurement, this
+ *        does not access the bus
+ *
+ * @param ticks humidity and temperature as SGP41 ticks
+ *              (%RH = ticks * 100 / 65535, degC = ticks * 175 / 65535 - 45)
+ */
+void spresense_getHumidity(uint16_t ticks[2])
+{
+    ticks[0] = gas_comp.rh_ticks;
+    ticks[1] = gas_comp.t_ticks;
+}
+
+/**
+ * @brief Check if the HTS221 answered in spresense_setupGas, otherwise
+ *        spresense_getHumidity only returns the default 50 %RH / 25 degC
+ *
+ * @return true if humidity and temperature are measured
+ */
+bool spresense_hasHumidity(void)
+{
+    return hts221_present;
+}
+
+/**
+ * @brief Start the LPS22HH at 1 Hz, continuous mode
+ *
+ * @return int 0 if the LPS22HH answered
+ */
+int spresense_setupPressure(void)
+{
+    uint8_t whoamI = 0;
+
+    lps22hh_device_id_get(nullptr, &whoamI);
+    if (whoamI != LPS22HH_ID) {
+        return -1;
+    }
+
+    lps22hh_block_data_update_set(nullptr, PROPERTY_ENABLE);
+    lps22hh_data_rate_set(nullptr, LPS22HH_1_Hz_LOW_NOISE);
+
+    return 0;
+}
+
+/**
+ * @brief Read the last LPS22HH pressure conversion
+ *
+ * @param pressure raw pressure (hPa = pressure / 4096)
+ * @return int 0 on success
+ */
+int spresense_getPressure(int32_t *pressure)
+{
+    uint8_t buff[3];
+
+    if (lps22hh_pressure_raw_get(nullptr, buff) != 0) {
+        return -1;
+    }
+
+    *pressure = ((int32_t)buff[2] << 16) | ((int32_t)buff[1] << 8) | buff[0];
+
+    return 0;
+}
+
 /**
  * @brief Create audio instance and setup audio channel
  * @details Uses PCM format MONO @ 16KHz
@@ -0,0 +1,86 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+
+#include "ei_environmental_sensor.h"
+#include "ei_device_sony_spresense.h"
+
+extern bool spresense_hasHumidity(void);
+extern int spresense_setupPressure(void);
+extern int spresense_getPressure(int32_t *pressure);
+
+/* Public variables -------------------------------------------------------- */
+const float ei_environmental_lsb[EI_ENV_N_AXIS] = { 1.0f, 1.0f, 0.01f, 0.01f, 0.1f };
+
+/**
+ * @brief      Start the pressure sensor. The gas sensor, which also reads the
+ *             humidity, is started by ei_gas_sensor_init().
+ *
+ * @return     false if the humidity or the pressure sensor does not answer,
+ *             the model would get constant values on those axes
+ */
+bool ei_environmental_init(void)
+{
+    if (!spresense_hasHumidity()) {
+        ei_printf("ERR: Humidity sensor (HTS221) missing or not working correctly\r\n");
+        return false;
+    }
+
+    if (spresense_setupPressure() != 0) {
+        ei_printf("ERR: Pressure sensor (LPS22HH) missing or not working correctly\r\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Get the last gas, humidity and temperature measurement of the
+ *             gas sensor thread and read the pressure, call at
+ *             EI_ENV_SAMPLE_INTERVAL_MS. Values are converted with integer
+ *             math only, see ei_environmental_lsb for the units.
+ *
+ * @param[out] values  Sample, indexed by ei_env_axis_t
+ *
+ * @return     0 on success
+ */
+int ei_environmental_read(int16_t values[EI_ENV_N_AXIS])
+{
+    int32_t gas_index[EI_GAS_N_AXIS];
+    uint16_t ticks[2];
+    int32_t pressure;
+
+    /* with the humidity and temperature that compensated this gas measurement */
+    if (ei_gas_sensor_read(gas_index, ticks) != 0 || spresense_getPressure(&pressure) != 0) {
+        return -1;
+    }
+
+    values[EI_ENV_AXIS_VOC] = (int16_t)gas_index[0];
+    values[EI_ENV_AXIS_NOX] = (int16_t)gas_index[1];
+    values[EI_ENV_AXIS_HUMIDITY] = (int16_t)(((int32_t)ticks[0] * 10000 + 32767) / 65535);
+    values[EI_ENV_AXIS_TEMPERATURE] = (int16_t)(((int32_t)ticks[1] * 17500 + 32767) / 65535 - 4500);
+    values[EI_ENV_AXIS_PRESSURE] = (int16_t)((pressure * 10 + 2048) >> 12);
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_ENVIRONMENTAL_SENSOR
+#define EI_ENVIRONMENTAL_SENSOR
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include "ei_gas_sensor.h"
+
+/** Axes of an environmental sample, stored as int16 (value = raw * lsb) */
+typedef enum {
+    EI_ENV_AXIS_VOC = 0,        /**< VOC index, 1 / LSB */
+    EI_ENV_AXIS_NOX,            /**< NOx index, 1 / LSB */
+    EI_ENV_AXIS_HUMIDITY,       /**< 0.01 %RH / LSB */
+    EI_ENV_AXIS_TEMPERATURE,    /**< 0.01 degC / LSB */
+    EI_ENV_AXIS_PRESSURE,       /**< 0.1 hPa / LSB */
+    EI_ENV_N_AXIS
+} ei_env_axis_t;
+
+/** All axes are refreshed with the gas measurement */
+#define EI_ENV_SAMPLE_INTERVAL_MS   EI_GAS_SAMPLE_INTERVAL_MS
+
+extern const float ei_environmental_lsb[EI_ENV_N_AXIS];
+
+/* Function prototypes ----------------------------------------------------- */
+bool ei_environmental_init(void);
+int ei_environmental_read(int16_t values[EI_ENV_N_AXIS]);
+
+#endif
@@ -0,0 +1,223 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "ei_config_types.h"
+#include "ei_gas_sensor.h"
+#include "edge-impulse-sdk/porting/ei_classifier_porting.h"
+
+extern EI_CONFIG_ERROR ei_config_get_gas_index_state(int32_t *state);
+extern EI_CONFIG_ERROR ei_config_set_gas_index_state(const int32_t *state);
+
+extern int spresense_setupGas(void);
+extern int spresense_getGas(int32_t gas_index[2], uint16_t sraw[2]);
+extern void spresense_getHumidity(uint16_t ticks[2]);
+extern void spresense_getGasState(int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE]);
+extern void spresense_setGasState(const int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE]);
+
+/* Constant defines -------------------------------------------------------- */
+#define EI_GAS_THREAD_PRIORITY      100
+#define EI_GAS_THREAD_STACK_SIZE    2048
+
+/* Private variables ------------------------------------------------------- */
+static pthread_t gas_thread;
+static pthread_mutex_t sample_lock = PTHREAD_MUTEX_INITIALIZER;
+static int32_t last_gas_index[EI_GAS_N_AXIS];
+static uint16_t last_humidity_ticks[2];
+static bool sample_valid = false;
+static uint32_t uptime_samples;
+static uint32_t samples_since_save;
+
+/* Private functions ------------------------------------------------------- */
+
+/**
+ * @brief      Run the gas index algorithms at EI_GAS_SAMPLE_INTERVAL_MS, for
+ *             whatever model is loaded. Falls behind rather than catching up,
+ *             the algorithms expect a fixed interval between samples.
+ */
+static void *gas_task(void *arg)
+{
+    uint64_t next_ms = ei_read_timer_ms();
+
+    while (1) {
+        ei_gas_sensor_sample();
+
+        next_ms += EI_GAS_SAMPLE_INTERVAL_MS;
+        uint64_t now_ms = ei_read_timer_ms();
+        if (now_ms < next_ms) {
+            usleep((useconds_t)((next_ms - now_ms) * 1000));
+        }
+        else {
+            next_ms = now_ms;
+        }
+    }
+
+    return NULL;
+}
+
+/* Public functions -------------------------------------------------------- */
+
+/**
+ * @brief      Start the SGP41, restore the learned VOC state from the config,
+ *             so a reboot does not restart the learning phase, and start the
+ *             1 Hz measurement thread. Sensirion only validates the restored
+ *             state for interruptions up to 10 minutes, after a long
+ *             power-off the baseline takes a while to adapt again.
+ *
+ * @return     false if the sensor does not answer or the thread did not start
+ */
+bool ei_gas_sensor_init(void)
+{
+    struct sched_param param;
+    pthread_attr_t attr;
+
+    if (spresense_setupGas() != 0) {
+        ei_printf("ERR: Gas sensor (SGP41) missing or not working correctly\r\n");
+        return false;
+    }
+
+    if (ei_gas_sensor_restore_state()) {
+        ei_printf("Restored gas index state\r\n");
+    }
+
+    pthread_attr_init(&attr);
+    param.sched_priority = EI_GAS_THREAD_PRIORITY;
+    pthread_attr_setschedparam(&attr, &param);
+    pthread_attr_setstacksize(&attr, EI_GAS_THREAD_STACK_SIZE);
+
+    if (pthread_create(&gas_thread, &attr, gas_task, NULL) != 0) {
+        ei_printf("ERR: Failed to start the gas sensor thread\r\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Get the last VOC and NOx index and the humidity and temperature
+ *             that compensated that measurement
+ *
+ * @param[out] gas_index       VOC and NOx index
+ * @param[out] humidity_ticks  humidity and temperature as SGP41 ticks
+ *
+ * @return     0 on success, -1 if there is no measurement yet
+ */
+int ei_gas_sensor_read(int32_t gas_index[EI_GAS_N_AXIS], uint16_t humidity_ticks[2])
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&sample_lock);
+    if (sample_valid) {
+        memcpy(gas_index, last_gas_index, sizeof(last_gas_index));
+        memcpy(humidity_ticks, last_humidity_ticks, sizeof(last_humidity_ticks));
+        ret = 0;
+    }
+    pthread_mutex_unlock(&sample_lock);
+
+    return ret;
+}
+
+/**
+ * @brief      Measure once and update the gas index algorithms, called by the
+ *             measurement thread every EI_GAS_SAMPLE_INTERVAL_MS. The learned
+ *             state is stored after EI_GAS_STATE_MIN_UPTIME samples and every
+ *             EI_GAS_STATE_SAVE_INTERVAL samples after that.
+ *
+ * @return     0 on success
+ */
+int ei_gas_sensor_sample(void)
+{
+    int32_t gas_index[EI_GAS_N_AXIS];
+    uint16_t humidity_ticks[2];
+    uint16_t sraw[2];
+
+    if (spresense_getGas(gas_index, sraw) != 0) {
+        return -1;
+    }
+    spresense_getHumidity(humidity_ticks);
+
+    pthread_mutex_lock(&sample_lock);
+    memcpy(last_gas_index, gas_index, sizeof(last_gas_index));
+    memcpy(last_humidity_ticks, humidity_ticks, sizeof(last_humidity_ticks));
+    sample_valid = true;
+    pthread_mutex_unlock(&sample_lock);
+
+    if (uptime_samples < EI_GAS_STATE_MIN_UPTIME) {
+        uptime_samples++;
+    }
+
+    if (++samples_since_save >= EI_GAS_STATE_SAVE_INTERVAL && uptime_samples >= EI_GAS_STATE_MIN_UPTIME) {
+        ei_gas_sensor_save_state();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Load the learned VOC state from the config into the algorithm.
+ *             A restored state already has the uptime it was stored with, so
+ *             it is stored again after EI_GAS_STATE_SAVE_INTERVAL samples
+ *             instead of after another EI_GAS_STATE_MIN_UPTIME.
+ *
+ * @return     false if no state was stored, the algorithm learns from scratch
+ */
+bool ei_gas_sensor_restore_state(void)
+{
+    int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE];
+    bool restored = ei_config_get_gas_index_state(state) == EI_CONFIG_OK;
+
+    if (restored) {
+        spresense_setGasState(state);
+    }
+
+    uptime_samples = restored ? EI_GAS_STATE_MIN_UPTIME : 0;
+    samples_since_save = 0;
+
+    return restored;
+}
+
+/**
+ * @brief      Store the learned VOC state in the config. The NOx algorithm
+ *             does not support restoring its state, so it always relearns.
+ *
+ * @return     false before EI_GAS_STATE_MIN_UPTIME samples, or if the config
+ *             could not be written
+ */
+bool ei_gas_sensor_save_state(void)
+{
+    int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE];
+
+    if (uptime_samples < EI_GAS_STATE_MIN_UPTIME) {
+        return false;
+    }
+
+    samples_since_save = 0;
+    spresense_getGasState(state);
+
+    return ei_config_set_gas_index_state(state) == EI_CONFIG_OK;
+}
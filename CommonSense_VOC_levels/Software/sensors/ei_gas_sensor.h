@@ -0,0 +1,44 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef EI_GAS_SENSOR
+#define EI_GAS_SENSOR
+
+/* Include ----------------------------------------------------------------- */
+#include <stdint.h>
+
+/** VOC and NOx gas index, updated at 1 Hz */
+#define EI_GAS_N_AXIS               2
+#define EI_GAS_SAMPLE_INTERVAL_MS   1000
+/** The learned VOC state is only valid after 3 hours of operation (samples) */
+#define EI_GAS_STATE_MIN_UPTIME     (3 * 3600)
+/** From then on the state is stored in the config every hour (samples) */
+#define EI_GAS_STATE_SAVE_INTERVAL  3600
+
+/* Function prototypes ----------------------------------------------------- */
+bool ei_gas_sensor_init(void);
+int ei_gas_sensor_read(int32_t gas_index[EI_GAS_N_AXIS], uint16_t humidity_ticks[2]);
+int ei_gas_sensor_sample(void);
+bool ei_gas_sensor_restore_state(void);
+bool ei_gas_sensor_save_state(void);
+
+#endif
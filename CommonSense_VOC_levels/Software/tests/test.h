@@ -0,0 +1,63 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Minimal checks for the host tests in tests/. Every test is its own program,
+ * 'make test' builds and runs all of them, a test fails when main() returns
+ * non-zero.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+/* Include ----------------------------------------------------------------- */
+#include <stdio.h>
+#include <math.h>
+
+/* Private variables ------------------------------------------------------- */
+static int test_checks = 0;
+static int test_failures = 0;
+
+/* Check macros ------------------------------------------------------------ */
+#define TEST_CHECK(cond, ...) do {                                  \
+        test_checks++;                                              \
+        if (!(cond)) {                                              \
+            test_failures++;                                        \
+            printf("%s:%d: check failed: %s: ", __FILE__, __LINE__, #cond); \
+            printf(__VA_ARGS__);                                    \
+            printf("\n");                                           \
+        }                                                           \
+    } while (0)
+
+#define TEST_CHECK_NEAR(a, b, tolerance, what) \
+    TEST_CHECK(fabs((double)(a) - (double)(b)) <= (tolerance), "%s: %g vs %g", what, (double)(a), (double)(b))
+
+/**
+ * @brief      Print the outcome, return it from main()
+ */
+static inline int test_result(const char *name)
+{
+    printf("%s: %d checks, %d failed\n", name, test_checks, test_failures);
+    return test_failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,259 @@
+/* Edge Impulse ingestion SDK
+ * Copyright (c) 2021 EdgeImpulse Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Replay of a synthetic SGP41 recording, about 17 hours at 1 Hz with a slow
+ * baseline drift and VOC events, through the fixed-point gas index algorithm
+ * and the gas sensor sampling (ei_gas_sensor_sample). Checks the index range
+ * and response, that the learned VOC state is only stored after 3 hours of
+ * uptime and hourly from then on, that an algorithm restored from the
+ * stored state tracks the one that kept running, and that after a reboot
+ * the restored state is stored again an hour later.
+ */
+
+/* Include ----------------------------------------------------------------- */
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "test.h"
+#include "ei_config_types.h"
+#include "ei_gas_sensor.h"
+#include "sensirion_gas_index_algorithm.h"
+
+/* Constant defines -------------------------------------------------------- */
+#define REPLAY_SAMPLES      60000
+#define VOC_BASELINE        30000
+#define NOX_BASELINE        15000
+/* VOC event: the VOC raw signal drops while it lasts */
+#define EVENT_PERIOD        7200
+#define EVENT_START         1800
+#define EVENT_LENGTH        600
+#define EVENT_DEPTH         1000
+/* Sample at which the running state is copied to a restored instance */
+#define RESTORE_SAMPLE      (5 * 3600 + 600)
+
+/* Private variables ------------------------------------------------------- */
+static GasIndexAlgorithmParams voc_algorithm;
+static GasIndexAlgorithmParams nox_algorithm;
+static uint32_t replay_ix;
+static uint32_t noise_seed = 1;
+
+static int32_t stored_state[EI_CONFIG_GAS_INDEX_STATE_SIZE];
+static uint32_t saves;
+static uint32_t first_save_sample;
+static uint32_t last_save_sample;
+static bool save_interval_ok = true;
+
+/* Private functions ------------------------------------------------------- */
+static int32_t noise(int32_t amplitude)
+{
+    noise_seed = noise_seed * 1664525 + 1013904223;
+    return (int32_t)((noise_seed >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+static bool in_event(uint32_t ix)
+{
+    return ix % EVENT_PERIOD >= EVENT_START && ix % EVENT_PERIOD < EVENT_START + EVENT_LENGTH;
+}
+
+/**
+ * @brief      Raw VOC ticks: baseline with a drift of +-30 ticks over 8 hours
+ */
+static uint16_t replay_voc(uint32_t ix)
+{
+    int32_t sraw = VOC_BASELINE + (int32_t)(30.0 * sin(2.0 * M_PI * ix / (8.0 * 3600.0))) + noise(20);
+    if (in_event(ix)) {
+        sraw -= EVENT_DEPTH;
+    }
+    return (uint16_t)sraw;
+}
+
+static uint16_t replay_nox(uint32_t ix)
+{
+    return (uint16_t)(NOX_BASELINE + noise(10));
+}
+
+/* Hooks of main.cpp, the sensor is replaced by the recording ------------- */
+int spresense_setupGas(void)
+{
+    GasIndexAlgorithm_init(&voc_algorithm, GasIndexAlgorithm_ALGORITHM_TYPE_VOC);
+    GasIndexAlgorithm_init(&nox_algorithm, GasIndexAlgorithm_ALGORITHM_TYPE_NOX);
+    return 0;
+}
+
+int spresense_getGas(int32_t gas_index[2], uint16_t sraw[2])
+{
+    sraw[0] = replay_voc(replay_ix);
+    sraw[1] = replay_nox(replay_ix);
+    GasIndexAlgorithm_process(&voc_algorithm, sraw[0], &gas_index[0]);
+    GasIndexAlgorithm_process(&nox_algorithm, sraw[1], &gas_index[1]);
+    return 0;
+}
+
+void spresense_getHumidity(uint16_t ticks[2])
+{
+    ticks[0] = 0x8000;
+    ticks[1] = 0x6666;
+}
+
+void spresense_getGasState(int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE])
+{
+    GasIndexAlgorithm_get_states(&voc_algorithm, &state[0], &state[1]);
+}
+
+void spresense_setGasState(const int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE])
+{
+    GasIndexAlgorithm_set_states(&voc_algorithm, state[0], state[1]);
+}
+
+/* Config store ------------------------------------------------------------ */
+EI_CONFIG_ERROR ei_config_set_gas_index_state(const int32_t *state)
+{
+    memcpy(stored_state, state, sizeof(stored_state));
+
+    if (saves == 0) {
+        first_save_sample = replay_ix + 1;
+    }
+    else if (replay_ix + 1 - last_save_sample != EI_GAS_STATE_SAVE_INTERVAL) {
+        save_interval_ok = false;
+    }
+    last_save_sample = replay_ix + 1;
+    saves++;
+
+    return EI_CONFIG_OK;
+}
+
+EI_CONFIG_ERROR ei_config_get_gas_index_state(int32_t *state)
+{
+    if (saves == 0) {
+        return EI_CONFIG_BOUNDS_ERROR;
+    }
+    memcpy(state, stored_state, sizeof(stored_state));
+    return EI_CONFIG_OK;
+}
+
+/* Porting ----------------------------------------------------------------- */
+void ei_printf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
+
+uint64_t ei_read_timer_ms()
+{
+    return replay_ix * (uint64_t)EI_GAS_SAMPLE_INTERVAL_MS;
+}
+
+int main(void)
+{
+    GasIndexAlgorithmParams restored;
+    int32_t gas_index[EI_GAS_N_AXIS];
+    uint16_t humidity_ticks[2];
+    int32_t voc_min = 500, voc_max = 0, nox_max = 0;
+    int32_t quiet_min = 500, quiet_max = 0, event_peak = 0;
+    int32_t restored_diff = 0;
+    bool blackout_ok = true;
+
+    spresense_setupGas();
+    TEST_CHECK(!ei_gas_sensor_restore_state(), "restored a state that was never stored");
+    TEST_CHECK(ei_gas_sensor_read(gas_index, humidity_ticks) != 0, "read before the first sample");
+
+    for (replay_ix = 0; replay_ix < REPLAY_SAMPLES; replay_ix++) {
+        TEST_CHECK(ei_gas_sensor_sample() == 0, "sample %u", (unsigned)replay_ix);
+        TEST_CHECK(ei_gas_sensor_read(gas_index, humidity_ticks) == 0, "read %u", (unsigned)replay_ix);
+
+        int32_t voc = gas_index[0];
+        int32_t nox = gas_index[1];
+
+        // the algorithm reports 0 while its uptime is up to 45 s
+        if (replay_ix <= 45) {
+            blackout_ok = blackout_ok && voc == 0;
+            continue;
+        }
+
+        voc_min = voc < voc_min ? voc : voc_min;
+        voc_max = voc > voc_max ? voc : voc_max;
+        nox_max = nox > nox_max ? nox : nox_max;
+
+        // after learning, the quiet time just before every event sits at the offset
+        if (replay_ix > 3 * 3600 && replay_ix % EVENT_PERIOD >= EVENT_START - 300 &&
+            replay_ix % EVENT_PERIOD < EVENT_START) {
+            quiet_min = voc < quiet_min ? voc : quiet_min;
+            quiet_max = voc > quiet_max ? voc : quiet_max;
+        }
+        if (replay_ix > 3 * 3600 && in_event(replay_ix)) {
+            event_peak = voc > event_peak ? voc : event_peak;
+        }
+
+        // continue a second instance from the stored state, as after a reboot
+        if (replay_ix == RESTORE_SAMPLE) {
+            int32_t state[EI_CONFIG_GAS_INDEX_STATE_SIZE];
+            TEST_CHECK(ei_config_get_gas_index_state(state) == EI_CONFIG_OK, "no stored state");
+            GasIndexAlgorithm_init(&restored, GasIndexAlgorithm_ALGORITHM_TYPE_VOC);
+            GasIndexAlgorithm_set_states(&restored, state[0], state[1]);
+        }
+        else if (replay_ix > RESTORE_SAMPLE) {
+            int32_t restored_voc;
+            GasIndexAlgorithm_process(&restored, replay_voc(replay_ix), &restored_voc);
+            // the restored low-pass starts from the current sample, skip its settling
+            if (replay_ix > RESTORE_SAMPLE + 600) {
+                int32_t diff = abs(restored_voc - voc);
+                restored_diff = diff > restored_diff ? diff : restored_diff;
+            }
+        }
+    }
+
+    TEST_CHECK(blackout_ok, "VOC index not 0 during the initial blackout");
+    TEST_CHECK(voc_min >= 1 && voc_max <= 500, "VOC index out of range: %d..%d", (int)voc_min, (int)voc_max);
+    TEST_CHECK(nox_max <= 5, "NOx index %d without NOx", (int)nox_max);
+    TEST_CHECK(quiet_min >= 85 && quiet_max <= 125, "VOC index %d..%d at the baseline", (int)quiet_min, (int)quiet_max);
+    TEST_CHECK(event_peak >= 300, "VOC index peaks at %d during events", (int)event_peak);
+    // only mean and std are stored, the std estimate of the restored instance
+    // needs hours to converge, which shows most during the events
+    TEST_CHECK(restored_diff <= 10, "restored instance differs by %d", (int)restored_diff);
+
+    // the VOC state is only valid after 3 hours, then it is stored hourly
+    TEST_CHECK(first_save_sample == EI_GAS_STATE_MIN_UPTIME, "first save after %u samples", (unsigned)first_save_sample);
+    TEST_CHECK(save_interval_ok, "state not stored every %d samples", EI_GAS_STATE_SAVE_INTERVAL);
+    TEST_CHECK(saves == 1 + (REPLAY_SAMPLES - EI_GAS_STATE_MIN_UPTIME) / EI_GAS_STATE_SAVE_INTERVAL,
+        "%u saves", (unsigned)saves);
+
+    // reboot: the restored state does not wait for another 3 hours
+    uint32_t saves_before_reboot = saves;
+    spresense_setupGas();
+    TEST_CHECK(ei_gas_sensor_restore_state(), "stored state not restored");
+    uint32_t reboot_ix = replay_ix;
+    for (; replay_ix < reboot_ix + EI_GAS_STATE_SAVE_INTERVAL; replay_ix++) {
+        ei_gas_sensor_sample();
+    }
+    TEST_CHECK(saves == saves_before_reboot + 1 && last_save_sample == reboot_ix + EI_GAS_STATE_SAVE_INTERVAL,
+        "after a reboot: %u saves, last after %u samples", (unsigned)(saves - saves_before_reboot),
+        (unsigned)(last_save_sample - reboot_ix));
+
+    printf("VOC baseline %d..%d, event peak %d, restored diff %d\n",
+        (int)quiet_min, (int)quiet_max, (int)event_peak, (int)restored_diff);
+
+    return test_result("test_gas_index");
+}